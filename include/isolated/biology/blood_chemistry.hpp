@@ -6,9 +6,11 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
 
 namespace isolated {
 namespace biology {
@@ -25,6 +27,27 @@ enum class AcidBaseDisorder {
   MIXED = 5
 };
 
+/**
+ * @brief Arrhythmia risk factors from electrolytes and pH.
+ */
+enum class CardiacRisk : uint8_t {
+  HYPOKALEMIA,
+  HYPERKALEMIA,
+  HYPOCALCEMIA,
+  HYPERCALCEMIA,
+  ACIDOSIS,
+  ALKALOSIS,
+  COUNT
+};
+
+constexpr size_t CARDIAC_RISK_COUNT = static_cast<size_t>(CardiacRisk::COUNT);
+
+/** Risk (0-1) per factor, indexed by CardiacRisk; 0 when absent. */
+using CardiacRiskFactors = std::array<double, CARDIAC_RISK_COUNT>;
+
+/** Display name ("hypokalemia_risk"), for the UI. */
+const char *cardiac_risk_name(CardiacRisk risk);
+
 /**
  * @brief Arterial blood gas values.
  */
@@ -84,7 +107,7 @@ public:
   void clear_lactate(double dt);
 
   // Cardiac risk factors
-  std::unordered_map<std::string, double> get_cardiac_risk_factors() const;
+  CardiacRiskFactors get_cardiac_risk_factors() const;
 
   // Public state
   BloodGasValues abg;
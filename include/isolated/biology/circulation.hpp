@@ -7,8 +7,9 @@
 
 #include <array>
 #include <cmath>
-#include <string>
-#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
 
 namespace isolated {
 namespace biology {
@@ -24,11 +25,28 @@ enum class HemorrhageClass {
   CLASS_IV = 4   // >40% loss
 };
 
+/**
+ * @brief Major vessels, indexing every body's vessel array.
+ */
+enum class Vessel : uint8_t {
+  AORTA,
+  CAROTID_LEFT,
+  CAROTID_RIGHT,
+  FEMORAL_LEFT,
+  FEMORAL_RIGHT,
+  VENA_CAVA,
+  COUNT
+};
+
+constexpr size_t VESSEL_COUNT = static_cast<size_t>(Vessel::COUNT);
+
+/** Display name ("femoral_left"), for the UI. */
+const char *vessel_name(Vessel vessel);
+
 /**
  * @brief Blood vessel segment.
  */
 struct VesselSegment {
-  std::string name;
   double diameter_mm;
   double length_mm;
   double wall_thickness_mm;
@@ -82,6 +100,9 @@ public:
   std::pair<double, double> get_blood_pressure() const;
   double get_instantaneous_pressure(double time_in_cycle) const;
   HemorrhageClass get_hemorrhage_class() const;
+  const VesselSegment &vessel(Vessel v) const {
+    return vessels_[static_cast<size_t>(v)];
+  }
 
   // Public state
   double heart_rate = 70.0;
@@ -128,10 +149,8 @@ private:
   double ph_ = 7.4;
   double arterial_po2_ = 95.0;
 
-  // Vessels
-  std::unordered_map<std::string, VesselSegment> major_vessels_;
-
-  void create_vessel_network();
+  // Vessels, indexed by Vessel
+  std::array<VesselSegment, VESSEL_COUNT> vessels_;
 };
 
 } // namespace biology
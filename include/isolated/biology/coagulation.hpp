@@ -10,6 +10,8 @@
 #include <cstdint>
 #include <vector>
 
+#include <isolated/biology/ode.hpp>
+
 namespace isolated {
 namespace biology {
 
@@ -79,6 +81,15 @@ public:
 
   State step(double dt);
 
+  /**
+   * @brief step() with the cascade, factor and platelet recovery and clot
+   * growth integrated adaptively instead of by one Euler step, for the
+   * multi-second macro-steps the biology clock runs coagulation at. Clots
+   * turn stable, age and lyse once per call.
+   */
+  State step_integrated(double dt, OdeIntegrator &integrator,
+                        OdeMethod method = OdeMethod::DORMAND_PRINCE);
+
   // Cascade activation
   void activate_extrinsic_pathway(double tissue_factor);
   void activate_intrinsic_pathway(double contact_activation);
@@ -107,6 +118,29 @@ private:
   AnticoagulantType active_anticoagulant_ = AnticoagulantType::NONE;
   double anticoagulant_level_ = 0.0;
 
+  /**
+   * @brief The continuous part of step() as an OdeSystem: factor activity
+   * and concentration, platelets, D-dimer, then fibrin mass and stability
+   * of each clot that is not yet stable.
+   */
+  class Cascade : public OdeSystem {
+  public:
+    static constexpr size_t FACTORS = 6;
+    static constexpr size_t CLOT_BASE = 2 * FACTORS + 3;
+
+    explicit Cascade(CoagulationSystem &system);
+
+    size_t dimension() const override { return CLOT_BASE + 2 * forming_.size(); }
+    void get_state(double *y) const override;
+    void set_state(const double *y) override;
+    void derivatives(double t, const double *y, double *dydt) const override;
+
+  private:
+    CoagulationSystem &system_;
+    ClottingFactor *factors_[FACTORS];
+    std::vector<Clot *> forming_;
+  };
+
   void cascade_extrinsic(double dt);
   void cascade_intrinsic(double dt);
   void cascade_common(double dt);
@@ -314,6 +348,103 @@ inline double CoagulationSystem::compute_clot_time(double severity) const {
   return base_time / (factor_modifier * platelet_modifier * severity);
 }
 
+inline CoagulationSystem::Cascade::Cascade(CoagulationSystem &system)
+    : system_(system),
+      factors_{&system.state_.factor_VII, &system.state_.factor_VIII,
+               &system.state_.factor_IX,  &system.state_.factor_X,
+               &system.state_.factor_II,  &system.state_.fibrinogen} {
+  for (auto &clot : system.clots_) {
+    if (!clot.is_stable) forming_.push_back(&clot);
+  }
+}
+
+inline void CoagulationSystem::Cascade::get_state(double *y) const {
+  for (size_t f = 0; f < FACTORS; ++f) {
+    y[f] = factors_[f]->activity;
+    y[FACTORS + f] = factors_[f]->concentration;
+  }
+  const State &s = system_.state_;
+  y[2 * FACTORS] = s.platelet_count;
+  y[2 * FACTORS + 1] = s.activated_platelets;
+  y[2 * FACTORS + 2] = s.d_dimer;
+  for (size_t c = 0; c < forming_.size(); ++c) {
+    y[CLOT_BASE + 2 * c] = forming_[c]->fibrin_mass;
+    y[CLOT_BASE + 2 * c + 1] = forming_[c]->stability;
+  }
+}
+
+inline void CoagulationSystem::Cascade::set_state(const double *y) {
+  for (size_t f = 0; f < FACTORS; ++f) {
+    factors_[f]->activity = y[f];
+    factors_[f]->concentration = y[FACTORS + f];
+  }
+  State &s = system_.state_;
+  s.platelet_count = y[2 * FACTORS];
+  s.activated_platelets = y[2 * FACTORS + 1];
+  s.d_dimer = y[2 * FACTORS + 2];
+  for (size_t c = 0; c < forming_.size(); ++c) {
+    forming_[c]->fibrin_mass = y[CLOT_BASE + 2 * c];
+    forming_[c]->stability = y[CLOT_BASE + 2 * c + 1];
+  }
+}
+
+inline void CoagulationSystem::Cascade::derivatives(double, const double *y,
+                                                    double *dydt) const {
+  // Factor order: VII, VIII, IX, X, II, fibrinogen
+  const double vii = y[0], viii = y[1], ix = y[2], x = y[3], ii = y[4];
+  double *d = dydt;
+
+  // Natural regeneration toward normal
+  for (size_t f = 0; f < FACTORS; ++f) {
+    bool inhibited = factors_[f]->inhibited;
+    d[f] = inhibited ? 0.0 : (1.0 - y[f]) * 0.001;
+    d[FACTORS + f] = inhibited ? 0.0 : (1.0 - y[FACTORS + f]) * 0.0001;
+  }
+
+  // Extrinsic: VII activates X
+  if (vii > 1.0) {
+    double activation = (vii - 1.0) * 0.5;
+    d[3] += activation;
+    d[0] -= activation * 0.1;
+  }
+  // Intrinsic: VIII + IX activate X
+  if (viii > 1.0 && ix > 1.0) {
+    d[3] += std::min(viii, ix) * 0.3;
+  }
+  // Common: Xa turns prothrombin to thrombin
+  if (x > 1.0 && !factors_[3]->inhibited) {
+    d[4] += (x - 1.0) * 0.4;
+  }
+
+  d[2 * FACTORS] = (250000.0 - y[2 * FACTORS]) * 0.0001;
+  d[2 * FACTORS + 1] = -0.01 * y[2 * FACTORS + 1];
+  d[2 * FACTORS + 2] = -0.001 * y[2 * FACTORS + 2];
+
+  // Thrombin lays fibrin into clots still forming
+  bool thrombin = ii > 1.0 && !factors_[4]->inhibited;
+  for (size_t c = 0; c < forming_.size(); ++c) {
+    d[CLOT_BASE + 2 * c] = thrombin ? ii - 1.0 : 0.0;
+    d[CLOT_BASE + 2 * c + 1] = thrombin ? 0.01 : 0.0;
+  }
+}
+
+inline CoagulationSystem::State
+CoagulationSystem::step_integrated(double dt, OdeIntegrator &integrator,
+                                   OdeMethod method) {
+  Cascade cascade(*this);
+  integrator.integrate(cascade, dt, method);
+
+  for (auto &clot : clots_) {
+    if (!clot.is_stable && clot.stability >= 1.0) {
+      clot.is_stable = true;
+    }
+  }
+  process_clots(dt);
+  update_lab_values();
+  clear_anticoagulant(dt);
+  return state_;
+}
+
 inline CoagulationSystem::State CoagulationSystem::step(double dt) {
   cascade_extrinsic(dt);
   cascade_intrinsic(dt);
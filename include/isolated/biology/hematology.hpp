@@ -61,8 +61,8 @@ public:
     double altitude_adaptation = 14.0; // days for full adaptation
   };
 
-  explicit HematologySystem(const Config &config = Config{})
-      : config_(config) {}
+  HematologySystem() { config_ = Config{}; }
+  explicit HematologySystem(const Config &config) : config_(config) {}
 
   /**
    * @brief Update hematology state.
@@ -12,8 +12,10 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <string>
+#include <cstddef>
+#include <cstdint>
 
 namespace isolated {
 namespace biology {
@@ -22,6 +24,20 @@ namespace biology {
 // LYMPHATIC STATE
 // ============================================================================
 
+/**
+ * @brief Lymph drainage regions, each with its own node basin: axillary
+ * nodes drain the arms, inguinal nodes the legs.
+ */
+enum class LymphRegion : uint8_t { ARM, LEG, COUNT };
+
+constexpr size_t LYMPH_REGION_COUNT = static_cast<size_t>(LymphRegion::COUNT);
+
+/** Display name ("arm"), for the UI. */
+inline const char *lymph_region_name(LymphRegion region) {
+  constexpr const char *NAMES[LYMPH_REGION_COUNT] = {"arm", "leg"};
+  return NAMES[static_cast<size_t>(region)];
+}
+
 struct LymphaticState {
   // Fluid balance
   double interstitial_fluid = 2.5;     // L (normal ~3L)
@@ -32,11 +48,17 @@ struct LymphaticState {
   double edema_volume = 0.0;   // L excess fluid
   double edema_severity = 0.0; // 0-1 (pitting edema grading)
 
-  // Regional (simplified)
-  double arm_edema = 0.0;
-  double leg_edema = 0.0;
+  // Regional (simplified), indexed by LymphRegion
+  std::array<double, LYMPH_REGION_COUNT> regional_edema = {};
   double pulmonary_edema = 0.0; // Dangerous
 
+  double &edema(LymphRegion region) {
+    return regional_edema[static_cast<size_t>(region)];
+  }
+  double edema(LymphRegion region) const {
+    return regional_edema[static_cast<size_t>(region)];
+  }
+
   // Lymph node function
   double node_filtering = 1.0;    // 0-1 immune filtering capacity
   double node_inflammation = 0.0; // 0-1 lymphadenopathy
@@ -59,7 +81,8 @@ public:
     double hydrostatic_pressure = 30.0;   // mmHg capillary
   };
 
-  explicit LymphaticSystem(const Config &config = Config{}) : config_(config) {}
+  LymphaticSystem() { config_ = Config{}; }
+  explicit LymphaticSystem(const Config &config) : config_(config) {}
 
   /**
    * @brief Update lymphatic system.
@@ -80,16 +103,15 @@ public:
 
   void apply_venous_obstruction(double severity) {
     // DVT, heart failure → increased capillary pressure
-    state_.leg_edema += severity * 0.5;
+    state_.edema(LymphRegion::LEG) += severity * 0.5;
     state_.edema_volume += severity * 0.3;
   }
 
-  void apply_lymph_node_removal(const std::string &region) {
+  void apply_lymph_node_removal(LymphRegion region) {
+    // The region the nodes drained swells
     state_.lymphatic_damage += 0.3;
-    if (region == "arm") {
-      state_.arm_edema += 0.2;
-      state_.lymphedema = true;
-    }
+    state_.edema(region) += 0.2;
+    state_.lymphedema = true;
   }
 
   void apply_capillary_leak(double severity) {
@@ -164,7 +186,8 @@ private:
 
     // Redistribute to regions
     if (state_.edema_volume > 2.0) {
-      state_.leg_edema = std::min(1.0, (state_.edema_volume - 2.0) / 3.0);
+      state_.edema(LymphRegion::LEG) =
+          std::min(1.0, (state_.edema_volume - 2.0) / 3.0);
     }
 
     // Pulmonary edema slowly resolves
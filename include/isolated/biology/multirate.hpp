@@ -0,0 +1,216 @@
+#pragma once
+
+/**
+ * @file multirate.hpp
+ * @brief Multi-rate stepping of biology subsystems with interpolated coupling.
+ */
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace isolated {
+namespace biology {
+
+// ============================================================================
+// COUPLING SIGNALS
+// ============================================================================
+
+/**
+ * @brief Where a consumer last read a signal's running integral.
+ */
+struct SignalCursor {
+  double integral = 0.0;
+  double time = 0.0;
+};
+
+/**
+ * @brief Value one subsystem publishes for others running at other rates.
+ *
+ * A fast consumer reads a slow producer with at(), which interpolates
+ * between the last two samples and extrapolates their trend for at most
+ * one sample interval past the newest. A slow consumer reads a fast
+ * producer with mean(), the time average since its last read, so that
+ * nothing the producer did between the consumer's updates is lost.
+ */
+class CouplingSignal {
+public:
+  CouplingSignal() = default;
+  /** Signal that already reads `initial` at time zero. */
+  explicit CouplingSignal(double initial)
+      : value_(initial), prev_value_(initial), sampled_(true) {}
+
+  void publish(double t, double value);
+
+  double value() const { return value_; }
+  double time() const { return time_; }
+
+  /**
+   * @brief Value at time t, interpolated from the last two samples.
+   */
+  double at(double t) const;
+
+  /**
+   * @brief Trapezoid time integral up to the newest sample.
+   */
+  double integral() const { return integral_; }
+
+  /**
+   * @brief Mean since the cursor, which is then moved to the newest
+   * sample. The newest value when no time has passed.
+   */
+  double mean(SignalCursor &cursor) const;
+
+private:
+  double value_ = 0.0;
+  double time_ = 0.0;
+  double prev_value_ = 0.0;
+  double prev_time_ = 0.0;
+  double integral_ = 0.0;
+  bool sampled_ = false;
+};
+
+// ============================================================================
+// MULTI-RATE SCHEDULER
+// ============================================================================
+
+/**
+ * @brief Steps each subsystem at its own rate on a shared clock.
+ *
+ * Each subsystem runs every `period` seconds of simulated time and is given
+ * the time since its previous run, so the cardiac cycle can step several
+ * times a second while hematology steps once a minute. Within one advance()
+ * subsystems run in time order; subsystems due at the same time run in the
+ * order they were added, so producers should be added before consumers.
+ *
+ * Cost is proportional to elapsed time over period, summed over
+ * subsystems. For fast-forwarding (sleep, multi-day travel) advance() can
+ * use each subsystem's max_period instead: the largest step it stays
+ * stable at.
+ */
+class MultiRateScheduler {
+public:
+  using StepFn = std::function<void(double dt)>;
+  using SubsystemId = size_t;
+
+  /**
+   * @brief Add a subsystem; it first runs one period from now.
+   * @param period Seconds between runs; must be positive, or advance()
+   * would never get past the subsystem
+   * @param max_period Seconds between runs while fast-forwarding; at least period
+   * @throws std::invalid_argument if period is not positive.
+   */
+  SubsystemId add(std::string name, double period, StepFn step, double max_period = 0.0);
+
+  /**
+   * @brief Run every subsystem due within the next dt seconds.
+   * @param fast_forward Schedule next runs at max_period
+   * @return Subsystem runs performed.
+   */
+  size_t advance(double dt, bool fast_forward = false);
+
+  double time() const { return now_; }
+  size_t size() const { return subsystems_.size(); }
+  const std::string &name(SubsystemId id) const { return subsystems_[id].name; }
+  double period(SubsystemId id) const { return subsystems_[id].period; }
+  size_t run_count(SubsystemId id) const { return subsystems_[id].runs; }
+
+private:
+  struct Subsystem {
+    std::string name;
+    double period;
+    double max_period;
+    StepFn step;
+    double last_run = 0.0;
+    double next_due = 0.0;
+    size_t runs = 0;
+  };
+
+  std::vector<Subsystem> subsystems_;
+  double now_ = 0.0;
+};
+
+// ============================================================================
+// INLINE IMPLEMENTATIONS
+// ============================================================================
+
+inline void CouplingSignal::publish(double t, double value) {
+  if (!sampled_) {
+    prev_time_ = t;
+    prev_value_ = value;
+    sampled_ = true;
+  } else {
+    integral_ += 0.5 * (value_ + value) * (t - time_);
+    prev_time_ = time_;
+    prev_value_ = value_;
+  }
+  time_ = t;
+  value_ = value;
+}
+
+inline double CouplingSignal::at(double t) const {
+  double span = time_ - prev_time_;
+  if (span <= 0.0) return value_;
+  // Past the newest sample, follow the trend for one interval only
+  double s = std::min((t - prev_time_) / span, 2.0);
+  s = std::max(s, 0.0);
+  return prev_value_ + s * (value_ - prev_value_);
+}
+
+inline double CouplingSignal::mean(SignalCursor &cursor) const {
+  double elapsed = time_ - cursor.time;
+  double result = elapsed > 0.0 ? (integral_ - cursor.integral) / elapsed : value_;
+  cursor.integral = integral_;
+  cursor.time = time_;
+  return result;
+}
+
+inline MultiRateScheduler::SubsystemId
+MultiRateScheduler::add(std::string name, double period, StepFn step, double max_period) {
+  if (!(period > 0.0)) {
+    throw std::invalid_argument("MultiRateScheduler: '" + name +
+                                "' needs a positive period");
+  }
+  Subsystem s;
+  s.name = std::move(name);
+  s.period = period;
+  s.max_period = std::max(period, max_period);
+  s.step = std::move(step);
+  s.last_run = now_;
+  s.next_due = now_ + period;
+  subsystems_.push_back(std::move(s));
+  return subsystems_.size() - 1;
+}
+
+inline size_t MultiRateScheduler::advance(double dt, bool fast_forward) {
+  // Absorb rounding so a period of 0.1 stepped by 0.1 stays on schedule
+  const double end = now_ + dt;
+  const double slack = 1e-9 * std::max(1.0, end);
+  size_t runs = 0;
+
+  for (;;) {
+    Subsystem *next = nullptr;
+    for (auto &s : subsystems_) {
+      if (s.next_due <= end + slack && (!next || s.next_due < next->next_due)) {
+        next = &s;
+      }
+    }
+    if (!next) break;
+
+    now_ = std::max(now_, next->next_due);
+    next->step(now_ - next->last_run);
+    next->last_run = now_;
+    next->next_due = now_ + (fast_forward ? next->max_period : next->period);
+    ++next->runs;
+    ++runs;
+  }
+
+  now_ = std::max(now_, end);
+  return runs;
+}
+
+} // namespace biology
+} // namespace isolated
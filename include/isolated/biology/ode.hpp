@@ -0,0 +1,124 @@
+#pragma once
+
+/**
+ * @file ode.hpp
+ * @brief Adaptive, error-controlled ODE integration for biology subsystems.
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace isolated {
+namespace biology {
+
+/**
+ * @brief State vector and derivatives a subsystem exposes for integration.
+ */
+class OdeSystem {
+public:
+  virtual ~OdeSystem() = default;
+
+  virtual size_t dimension() const = 0;
+  virtual void get_state(double *y) const = 0;
+  virtual void set_state(const double *y) = 0;
+
+  /**
+   * @brief dy/dt at state y, t seconds into the current integrate() call.
+   */
+  virtual void derivatives(double t, const double *y, double *dydt) const = 0;
+
+  /**
+   * @brief Whether component i is stiff. Only stiff components are treated
+   * implicitly by OdeMethod::IMEX.
+   */
+  virtual bool is_stiff(size_t i) const {
+    (void)i;
+    return true;
+  }
+};
+
+enum class OdeMethod {
+  DORMAND_PRINCE, // Explicit RK 5(4): non-stiff, cheapest per step
+  ROSENBROCK,     // Linearly implicit 2(3), L-stable: stiff systems
+  IMEX            // ROSENBROCK with only the stiff block made implicit
+};
+
+struct OdeConfig {
+  double rel_tol = 1e-4;
+  double abs_tol = 1e-6;
+  double min_step = 1e-6;   // Seconds; below this the integration gives up
+  double max_step = 0.0;    // Seconds; 0 for no limit
+  size_t max_steps = 10000; // Substeps per integrate() call
+};
+
+struct OdeStats {
+  size_t accepted = 0;
+  size_t rejected = 0;
+  size_t evaluations = 0; // derivatives() calls
+  size_t jacobians = 0;
+  bool ok = true;         // False if min_step or max_steps was hit
+};
+
+/**
+ * @brief Integrates an OdeSystem over a macro-step in adaptive substeps.
+ *
+ * Substep size is chosen from an embedded error estimate so every
+ * component stays within abs_tol + rel_tol * |y|. The last accepted size
+ * carries over to the next integrate() call, so use one integrator per
+ * system instance.
+ *
+ * ROSENBROCK is the Shampine-Reichelt 2(3) pair (MATLAB's ode23s): one LU
+ * of I - h d J per substep, no Newton iteration, and stable for any step on
+ * decaying modes, so fast equilibria don't limit the step. It is a
+ * W-method, accurate to second order with any approximation of J, which
+ * IMEX relies on: it builds J from the stiff components only (fewer
+ * derivative calls) and handles the rest explicitly. The error estimate
+ * is rougher without the dropped coupling terms, so IMEX takes smaller
+ * steps than ROSENBROCK; it pays off when the stiff block is a small part
+ * of a large system. J is a finite-difference Jacobian, reused across
+ * rejected substeps.
+ *
+ * If the step shrinks below min_step or max_steps is reached, the state is
+ * left at the last accepted substep and stats.ok is false.
+ */
+class OdeIntegrator {
+public:
+  OdeIntegrator() { config_ = OdeConfig{}; }
+  explicit OdeIntegrator(const OdeConfig &config) : config_(config) {}
+
+  OdeStats integrate(OdeSystem &system, double dt,
+                     OdeMethod method = OdeMethod::ROSENBROCK);
+
+  /** Next substep size; 0 before the first call or after reset(). */
+  double step_size() const { return h_; }
+  void reset() { h_ = 0.0; }
+
+  const OdeConfig &config() const { return config_; }
+
+private:
+  OdeConfig config_;
+  double h_ = 0.0;
+
+  // Workspace, sized to the system on each call
+  size_t n_ = 0;
+  std::vector<double> y_, y_new_, err_, f0_, tmp_;
+  std::vector<double> k_[7];
+  std::vector<double> jac_, lu_, dfdt_;
+  std::vector<size_t> pivot_;
+
+  void resize(size_t n);
+  double error_norm(const double *y, const double *y_new, const double *err) const;
+  double initial_step(double dt) const;
+
+  // One substep from (t, y_) to y_new_ with error estimate err_; f0_ holds
+  // f(t, y_) on entry
+  void dormand_prince_step(const OdeSystem &system, double t, double h, OdeStats &stats);
+  bool rosenbrock_step(const OdeSystem &system, double t, double h, OdeStats &stats);
+
+  void jacobian(const OdeSystem &system, double t, bool stiff_only, OdeStats &stats);
+  bool factor(double h_d);
+  void solve(double *b) const;
+};
+
+} // namespace biology
+} // namespace isolated
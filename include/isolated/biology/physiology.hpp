@@ -5,6 +5,7 @@
  * @brief Unified physiology orchestrator integrating all biological systems.
  */
 
+#include <algorithm>
 #include <isolated/biology/blood_chemistry.hpp>
 #include <isolated/biology/circulation.hpp>
 #include <isolated/biology/metabolism.hpp>
@@ -66,6 +67,9 @@ public:
     bool is_critical = false;
   };
 
+  // Heart rate the circulation settles to without hemorrhage (bpm)
+  static constexpr double RESTING_HEART_RATE = 70.0;
+
   explicit UnifiedPhysiologySystem(const Config &config);
 
   PhysiologySnapshot step(double dt, const EnvironmentState &env);
@@ -104,9 +108,13 @@ inline UnifiedPhysiologySystem::UnifiedPhysiologySystem(const Config &config)
 inline void
 UnifiedPhysiologySystem::couple_systems(double dt,
                                         const EnvironmentState &env) {
-  // ANS affects heart rate
+  // ANS drives heart rate above the resting rate; compensation for blood
+  // loss can push it higher still. Scaling the previous beat's rate instead
+  // would compound every step.
   auto ans_response = nervous_.compute_response();
-  circulation_.heart_rate *= ans_response.heart_rate_modifier;
+  circulation_.heart_rate =
+      std::max(circulation_.heart_rate,
+               RESTING_HEART_RATE * ans_response.heart_rate_modifier);
 
   // Circulation affects blood chemistry
   blood_chemistry_.electrolytes.potassium = circulation_.potassium;
@@ -0,0 +1,183 @@
+#pragma once
+
+/**
+ * @file physiology_batch.hpp
+ * @brief Batched SoA physiology for many people at once.
+ */
+
+#include <isolated/biology/physiology.hpp>
+#include <isolated/core/task_pool.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace isolated {
+namespace biology {
+
+/**
+ * @brief UnifiedPhysiologySystem for N people, stored as SoA arrays.
+ *
+ * Person i evolves exactly as a UnifiedPhysiologySystem built with the same
+ * Config and stepped with the same dt and EnvironmentState: every
+ * expression is evaluated in the scalar model's order, so results match bit
+ * for bit (the build disables FMA contraction so both paths round alike).
+ * step() runs each subsystem as one pass over contiguous arrays; the
+ * arithmetic passes are branch-free and vectorize, while libm calls (Hill
+ * saturation, log10 for pH) sit in their own passes.
+ *
+ * Only state the unified step reads or writes is kept. Vessel bleeding is
+ * not modelled: the scalar API has no way to sever a vessel, so its bleed
+ * term is always zero.
+ */
+class PhysiologyBatch {
+public:
+  using Config = UnifiedPhysiologySystem::Config;
+  using EnvironmentState = UnifiedPhysiologySystem::EnvironmentState;
+  using PhysiologySnapshot = UnifiedPhysiologySystem::PhysiologySnapshot;
+
+  struct FastForwardConfig {
+    double step = 1.0 / 6.0;        // Seconds per regular step
+    double probe = 30.0;            // Seconds of regular steps measuring drift
+    double drift_tolerance = 1e-4;  // Drift change between probe halves (scale/s)
+    double max_change = 0.05;       // Largest move of any value per jump (scale)
+    double jump_tolerance = 0.005;  // Extrapolation error a jump may leave (scale)
+    double max_jump = 3600.0;       // Seconds
+  };
+
+  struct FastForwardStats {
+    size_t steps = 0;     // Regular steps, summed over people
+    size_t jumps = 0;
+    double skipped = 0.0; // Person-seconds covered by jumps
+  };
+
+  PhysiologyBatch() = default;
+
+  /**
+   * @brief Add a person in the state of a freshly built scalar model.
+   * @return Index of the new person.
+   */
+  size_t add(const Config &config);
+
+  /**
+   * @brief Remove a person; the last person moves into `index`.
+   */
+  void remove(size_t index);
+
+  size_t size() const { return heart_rate_.size(); }
+
+  /**
+   * @brief Move a person, state intact, to the end of another batch. The
+   * last person here moves into `index`.
+   * @return Index of the person in `to`.
+   */
+  size_t transfer(size_t index, PhysiologyBatch &to);
+
+  void set_environment(size_t index, const EnvironmentState &env);
+
+  /**
+   * @brief Step everyone by dt.
+   * @param pool Optional pool to split large batches across
+   */
+  void step(double dt, core::TaskPool *pool = nullptr);
+
+  /**
+   * @brief Advance everyone by `duration`, jumping across quasi-steady
+   * stretches instead of stepping through them.
+   *
+   * Each person runs on their own clock. A probe of regular steps measures
+   * how every value drifts; if the drift was the same over both halves of
+   * the probe, the person is quasi-steady and their state is extrapolated
+   * along it, for as long as no value moves more than max_change of its
+   * scale (its magnitude, at least 1). The next probe checks the jump: if
+   * the drift has changed, the jump crossed a threshold or clamp and is
+   * retried at half the length. Anyone still settling, or disturbed by a
+   * stimulus such as add_pain(), fails the check and keeps stepping
+   * regularly until they settle again.
+   *
+   * A person at rest settles within about an hour of a disturbance, after
+   * which eight hours take a dozen probes.
+   */
+  FastForwardStats fast_forward(double duration, const FastForwardConfig &config,
+                                core::TaskPool *pool = nullptr);
+  FastForwardStats fast_forward(double duration, core::TaskPool *pool = nullptr) {
+    return fast_forward(duration, FastForwardConfig{}, pool);
+  }
+
+  /**
+   * @brief Vitals as the scalar model's step() would have returned them.
+   */
+  PhysiologySnapshot snapshot(size_t index) const;
+
+  // Events and injuries, as on the scalar subsystems
+  void add_pain(size_t index, double amount);
+  void add_stress(size_t index, double amount);
+  void add_fatigue(size_t index, double amount);
+
+  void set_blood_volume(size_t index, double litres) {
+    blood_volume_[index] = litres;
+  }
+
+  double heart_rate(size_t index) const { return heart_rate_[index]; }
+  double blood_volume(size_t index) const { return blood_volume_[index]; }
+  double liver_glycogen(size_t index) const { return liver_glycogen_[index]; }
+
+private:
+  // Environment
+  std::vector<double> ambient_temp_c_;
+  std::vector<double> activity_;
+
+  // Circulation
+  std::vector<double> heart_rate_;
+  std::vector<double> stroke_volume_;
+  std::vector<double> blood_volume_;
+  std::vector<double> max_blood_volume_;
+  std::vector<double> cardiac_phase_;
+  std::vector<double> cardiac_output_;
+
+  // Respiration
+  std::vector<double> pao2_;
+  std::vector<double> paco2_;
+  std::vector<double> sao2_;
+  std::vector<double> alveolar_ventilation_;
+
+  // Metabolism
+  std::vector<double> basal_metabolic_rate_;
+  std::vector<double> blood_glucose_;
+  std::vector<double> liver_glycogen_;
+  std::vector<double> muscle_glycogen_;
+  std::vector<double> blood_lactate_;
+  std::vector<double> metabolic_rate_;
+
+  // Blood chemistry
+  std::vector<double> chem_lactate_;
+  std::vector<double> bicarbonate_;
+  std::vector<double> chem_pco2_;
+  std::vector<double> ph_;
+  std::vector<double> reported_hco3_;  // Before coupling adds lactate
+
+  // Autonomic nervous system
+  std::vector<double> sympathetic_;
+  std::vector<double> parasympathetic_;
+  std::vector<double> stress_;
+  std::vector<double> pain_;
+  std::vector<double> consciousness_;
+  std::vector<double> fatigue_;
+
+  // Inspired O2 (mmHg) under the default respiratory config
+  double inspired_po2_ = 0.0;
+
+  // People per parallel slice
+  static constexpr size_t PARALLEL_GRAIN = 256;
+
+  // Every per-person array, for add/remove/transfer
+  using Array = std::vector<double> PhysiologyBatch::*;
+  static constexpr size_t ARRAY_COUNT = 29;
+  static const Array ARRAYS[ARRAY_COUNT];
+
+  void step_range(double dt, size_t begin, size_t end);
+  void fast_forward_person(size_t index, double duration,
+                           const FastForwardConfig &config,
+                           FastForwardStats &stats);
+};
+
+} // namespace biology
+} // namespace isolated
@@ -5,6 +5,7 @@
  * @brief Respiratory system with gas exchange and hemoglobin binding.
  */
 
+#include <isolated/biology/ode.hpp>
 #include <algorithm>
 #include <cmath>
 
@@ -68,16 +69,58 @@ public:
   State step(double dt, double ambient_po2, double ambient_pco2,
              double metabolic_rate = 1.0);
 
+  /**
+   * @brief step() with arterial gas equilibration integrated adaptively
+   * instead of by one Euler step, for macro-steps longer than the
+   * equilibration time constant.
+   */
+  State step_integrated(double dt, OdeIntegrator &integrator,
+                        double metabolic_rate = 1.0,
+                        OdeMethod method = OdeMethod::ROSENBROCK);
+
   void set_respiratory_rate(double rate) { config_.respiratory_rate = rate; }
   void set_tidal_volume(double vol) { config_.tidal_volume_ml = vol; }
 
   const State &get_state() const { return state_; }
 
 private:
+  static constexpr double GAS_EXCHANGE_TAU = 5.0; // s
+
   Config config_;
   State state_;
   HemoglobinModel hemoglobin_;
 
+  /**
+   * @brief PaO2 and PaCO2 relaxing toward their targets, as an OdeSystem.
+   */
+  class GasExchange : public OdeSystem {
+  public:
+    GasExchange(RespiratorySystem &system, double paco2_target)
+        : system_(system), paco2_target_(paco2_target) {}
+
+    size_t dimension() const override { return 2; }
+    void get_state(double *y) const override {
+      y[0] = system_.state_.pao2;
+      y[1] = system_.state_.paco2;
+    }
+    void set_state(const double *y) override {
+      system_.state_.pao2 = y[0];
+      system_.state_.paco2 = y[1];
+    }
+    void derivatives(double, const double *y, double *dydt) const override {
+      double pao2_ideal =
+          system_.alveolar_gas_equation(system_.config_.fio2, y[1]);
+      dydt[0] = (pao2_ideal - y[0]) / GAS_EXCHANGE_TAU;
+      dydt[1] = (paco2_target_ - y[1]) / GAS_EXCHANGE_TAU;
+    }
+
+  private:
+    RespiratorySystem &system_;
+    double paco2_target_;
+  };
+
+  void update_ventilation(double metabolic_rate);
+  double paco2_target() const;
   double alveolar_gas_equation(double fio2, double paco2) const;
 };
 
@@ -129,11 +172,7 @@ inline double RespiratorySystem::alveolar_gas_equation(double fio2,
   return pio2 - (paco2 / 0.8); // Simplified with RQ = 0.8
 }
 
-inline RespiratorySystem::State RespiratorySystem::step(double dt,
-                                                        double ambient_po2,
-                                                        double ambient_pco2,
-                                                        double metabolic_rate) {
-  // Update ventilation
+inline void RespiratorySystem::update_ventilation(double metabolic_rate) {
   state_.minute_ventilation =
       config_.tidal_volume_ml * config_.respiratory_rate / 1000.0;
   state_.alveolar_ventilation =
@@ -143,18 +182,29 @@ inline RespiratorySystem::State RespiratorySystem::step(double dt,
   // Metabolic demand
   state_.vo2 = 250.0 * metabolic_rate;
   state_.vco2 = 200.0 * metabolic_rate;
+}
+
+inline double RespiratorySystem::paco2_target() const {
+  // CO2 clearance proportional to alveolar ventilation
+  return 40.0 * (state_.vco2 / 200.0) /
+         std::max(0.1, state_.alveolar_ventilation / 4.2);
+}
+
+inline RespiratorySystem::State RespiratorySystem::step(double dt,
+                                                        double ambient_po2,
+                                                        double ambient_pco2,
+                                                        double metabolic_rate) {
+  update_ventilation(metabolic_rate);
 
   // Alveolar gas equation
   double pao2_ideal = alveolar_gas_equation(config_.fio2, state_.paco2);
 
   // Simple equilibration toward ideal
-  double tau = 5.0; // Time constant
+  double tau = GAS_EXCHANGE_TAU;
   state_.pao2 += (pao2_ideal - state_.pao2) * dt / tau;
 
-  // CO2 clearance proportional to alveolar ventilation
-  double paco2_target = 40.0 * (state_.vco2 / 200.0) /
-                        std::max(0.1, state_.alveolar_ventilation / 4.2);
-  state_.paco2 += (paco2_target - state_.paco2) * dt / tau;
+  double target = paco2_target();
+  state_.paco2 += (target - state_.paco2) * dt / tau;
 
   // Clamp values
   state_.pao2 = std::clamp(state_.pao2, 20.0, 150.0);
@@ -166,5 +216,20 @@ inline RespiratorySystem::State RespiratorySystem::step(double dt,
   return state_;
 }
 
+inline RespiratorySystem::State
+RespiratorySystem::step_integrated(double dt, OdeIntegrator &integrator,
+                                   double metabolic_rate, OdeMethod method) {
+  update_ventilation(metabolic_rate);
+
+  GasExchange gas(*this, paco2_target());
+  integrator.integrate(gas, dt, method);
+
+  state_.pao2 = std::clamp(state_.pao2, 20.0, 150.0);
+  state_.paco2 = std::clamp(state_.paco2, 15.0, 80.0);
+  state_.sao2 = hemoglobin_.compute_saturation(state_.pao2);
+
+  return state_;
+}
+
 } // namespace biology
 } // namespace isolated
@@ -12,8 +12,10 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <string>
+#include <cstddef>
+#include <cstdint>
 
 namespace isolated {
 namespace biology {
@@ -304,19 +306,35 @@ private:
 // PROPRIOCEPTION SYSTEM
 // ============================================================================
 
+/**
+ * @brief Peripheral nerve regions, indexing ProprioceptionState::limbs.
+ */
+enum class NerveRegion : uint8_t { ARM_LEFT, ARM_RIGHT, LEG_LEFT, LEG_RIGHT, COUNT };
+
+constexpr size_t NERVE_REGION_COUNT = static_cast<size_t>(NerveRegion::COUNT);
+
+/** Display name ("arm_left"), for the UI. */
+inline const char *nerve_region_name(NerveRegion region) {
+  constexpr const char *NAMES[NERVE_REGION_COUNT] = {"arm_left", "arm_right",
+                                                     "leg_left", "leg_right"};
+  return NAMES[static_cast<size_t>(region)];
+}
+
 struct ProprioceptionState {
   double position_sense = 1.0; // 0-1 joint position awareness
   double movement_sense = 1.0; // 0-1 kinesthesia
   double force_sense = 1.0;    // 0-1 force/weight perception
 
-  // Regional damage (simplified to limbs)
-  double arm_left = 1.0;
-  double arm_right = 1.0;
-  double leg_left = 1.0;
-  double leg_right = 1.0;
+  // Regional function (simplified to limbs), indexed by NerveRegion
+  std::array<double, NERVE_REGION_COUNT> limbs = {1.0, 1.0, 1.0, 1.0};
+
+  double &limb(NerveRegion region) { return limbs[static_cast<size_t>(region)]; }
+  double limb(NerveRegion region) const {
+    return limbs[static_cast<size_t>(region)];
+  }
 
   double effective_coordination() const {
-    double limb_avg = (arm_left + arm_right + leg_left + leg_right) / 4.0;
+    double limb_avg = (limbs[0] + limbs[1] + limbs[2] + limbs[3]) / 4.0;
     return position_sense * movement_sense * limb_avg;
   }
 };
@@ -327,16 +345,8 @@ public:
     update_metabolic_effects(blood_glucose, vitamin_b12);
   }
 
-  void apply_nerve_damage(const std::string &region, double severity) {
-    if (region == "arm_left")
-      state_.arm_left *= (1.0 - severity);
-    else if (region == "arm_right")
-      state_.arm_right *= (1.0 - severity);
-    else if (region == "leg_left")
-      state_.leg_left *= (1.0 - severity);
-    else if (region == "leg_right")
-      state_.leg_right *= (1.0 - severity);
-
+  void apply_nerve_damage(NerveRegion region, double severity) {
+    state_.limb(region) *= (1.0 - severity);
     state_.position_sense *= (1.0 - severity * 0.2);
   }
 
@@ -346,11 +356,11 @@ public:
     double affected = 1.0 - level_fraction;
 
     if (affected > 0.5) {
-      state_.arm_left *= (1.0 - severity);
-      state_.arm_right *= (1.0 - severity);
+      state_.limb(NerveRegion::ARM_LEFT) *= (1.0 - severity);
+      state_.limb(NerveRegion::ARM_RIGHT) *= (1.0 - severity);
     }
-    state_.leg_left *= (1.0 - severity);
-    state_.leg_right *= (1.0 - severity);
+    state_.limb(NerveRegion::LEG_LEFT) *= (1.0 - severity);
+    state_.limb(NerveRegion::LEG_RIGHT) *= (1.0 - severity);
     state_.position_sense *= (1.0 - severity * affected);
   }
 
@@ -371,8 +381,8 @@ private:
     if (b12 < 200.0) {
       double deficit = (200.0 - b12) / 200.0;
       state_.position_sense -= deficit * 0.001;
-      state_.leg_left -= deficit * 0.001;
-      state_.leg_right -= deficit * 0.001;
+      state_.limb(NerveRegion::LEG_LEFT) -= deficit * 0.001;
+      state_.limb(NerveRegion::LEG_RIGHT) -= deficit * 0.001;
     }
   }
 };
@@ -0,0 +1,246 @@
+#pragma once
+
+/**
+ * @file telemetry.hpp
+ * @brief Fixed-memory vitals history at several resolutions.
+ */
+
+#include <isolated/biology/physiology.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace isolated {
+namespace biology {
+
+// ============================================================================
+// VITALS AND RESOLUTIONS
+// ============================================================================
+
+/**
+ * @brief Vitals kept in the telemetry history.
+ */
+enum class Vital : uint8_t {
+  HEART_RATE,       // bpm
+  MEAN_PRESSURE,    // MAP, mmHg
+  SAO2,             // Fraction
+  RESPIRATORY_RATE, // Breaths/min
+  BLOOD_PH,
+  BLOOD_GLUCOSE,    // mg/dL
+  COUNT
+};
+
+constexpr size_t VITAL_COUNT = static_cast<size_t>(Vital::COUNT);
+
+/** Display name ("Heart rate"), for the UI. */
+inline const char *vital_name(Vital vital) {
+  constexpr const char *NAMES[VITAL_COUNT] = {"Heart rate",       "MAP",
+                                              "SaO2",             "Resp. rate",
+                                              "pH",               "Glucose"};
+  return NAMES[static_cast<size_t>(vital)];
+}
+
+enum class TelemetryResolution : uint8_t { SECOND, MINUTE, HOUR, COUNT };
+
+constexpr size_t TELEMETRY_RESOLUTION_COUNT =
+    static_cast<size_t>(TelemetryResolution::COUNT);
+
+/** Seconds per bin at each resolution. */
+constexpr double TELEMETRY_PERIOD[TELEMETRY_RESOLUTION_COUNT] = {1.0, 60.0, 3600.0};
+
+/** Bins kept at each resolution: 10 minutes, a day, two weeks. */
+constexpr size_t TELEMETRY_CAPACITY[TELEMETRY_RESOLUTION_COUNT] = {600, 1440, 336};
+
+/**
+ * @brief One bin of samples. `index` is the bin's start time over its
+ * period, so missing indices are gaps (a fast-forwarded night).
+ */
+struct TelemetryBin {
+  uint32_t index;
+  float min;
+  float max;
+  float mean;
+};
+
+// ============================================================================
+// TELEMETRY RING
+// ============================================================================
+
+/**
+ * @brief Single-producer ring of the newest bins, readable from another
+ * thread without locks.
+ *
+ * The writer never waits. A reader copies what it wants, then re-reads the
+ * head and drops anything the writer may have overwritten meanwhile, like
+ * a seqlock with one sequence number per slot.
+ */
+class TelemetryRing {
+public:
+  // One spare slot is the one the writer may be filling, so readers
+  // always get `capacity` whole bins
+  explicit TelemetryRing(size_t capacity)
+      : slots_(new Slot[capacity + 1]), capacity_(capacity) {}
+
+  /** Append, overwriting the oldest bin once full. Writer thread only. */
+  void push(const TelemetryBin &bin);
+
+  /**
+   * @brief Copy up to `max` of the newest bins, oldest first. Any thread.
+   * @return Bins copied.
+   */
+  size_t read(TelemetryBin *out, size_t max) const;
+
+  /** Bins ever pushed. */
+  uint64_t pushed() const { return head_.load(std::memory_order_acquire); }
+  size_t capacity() const { return capacity_; }
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> index{0};
+    std::atomic<float> min{0.0f};
+    std::atomic<float> max{0.0f};
+    std::atomic<float> mean{0.0f};
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t capacity_;
+  std::atomic<uint64_t> head_{0};
+};
+
+// ============================================================================
+// VITALS TELEMETRY
+// ============================================================================
+
+/**
+ * @brief One person's vitals history: every vital binned at every
+ * resolution, in about 230 KB that never grows.
+ *
+ * record() is called by the simulation with each new snapshot; a bin is
+ * pushed when the first sample of the next bin arrives, so the newest
+ * readable bin is the last complete one. The UI reads rings from any
+ * thread while the simulation writes.
+ */
+class VitalsTelemetry {
+public:
+  VitalsTelemetry();
+
+  /** Add a sample of every vital at time t (seconds, non-decreasing). */
+  void record(double t, const UnifiedPhysiologySystem::PhysiologySnapshot &snap);
+  void record(double t, Vital vital, double value);
+
+  const TelemetryRing &ring(Vital vital, TelemetryResolution resolution) const {
+    return *rings_[slot(vital, resolution)];
+  }
+
+private:
+  // Open bin, writer thread only
+  struct Accumulator {
+    uint32_t index = 0;
+    uint32_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+  };
+
+  static constexpr size_t SLOTS = VITAL_COUNT * TELEMETRY_RESOLUTION_COUNT;
+  std::array<std::unique_ptr<TelemetryRing>, SLOTS> rings_;
+  std::array<Accumulator, SLOTS> open_;
+
+  static size_t slot(Vital vital, TelemetryResolution resolution) {
+    return static_cast<size_t>(vital) * TELEMETRY_RESOLUTION_COUNT +
+           static_cast<size_t>(resolution);
+  }
+};
+
+// ============================================================================
+// INLINE IMPLEMENTATIONS
+// ============================================================================
+
+inline void TelemetryRing::push(const TelemetryBin &bin) {
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  // Orders the previous head store before this slot's writes, so a reader
+  // that sees any of them also sees that head and drops the slot
+  std::atomic_thread_fence(std::memory_order_release);
+  Slot &slot = slots_[head % (capacity_ + 1)];
+  slot.index.store(bin.index, std::memory_order_relaxed);
+  slot.min.store(bin.min, std::memory_order_relaxed);
+  slot.max.store(bin.max, std::memory_order_relaxed);
+  slot.mean.store(bin.mean, std::memory_order_relaxed);
+  head_.store(head + 1, std::memory_order_release);
+}
+
+inline size_t TelemetryRing::read(TelemetryBin *out, size_t max) const {
+  uint64_t head = head_.load(std::memory_order_acquire);
+  size_t n = static_cast<size_t>(std::min<uint64_t>({head, capacity_, max}));
+  uint64_t first = head - n;
+  for (size_t j = 0; j < n; ++j) {
+    const Slot &slot = slots_[(first + j) % (capacity_ + 1)];
+    out[j] = {slot.index.load(std::memory_order_relaxed),
+              slot.min.load(std::memory_order_relaxed),
+              slot.max.load(std::memory_order_relaxed),
+              slot.mean.load(std::memory_order_relaxed)};
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  // The writer may be filling the slot of bin `after` - capacity - 1
+  uint64_t after = head_.load(std::memory_order_relaxed);
+  uint64_t valid_from = after > capacity_ ? after - capacity_ : 0;
+  if (first < valid_from) {
+    size_t stale = static_cast<size_t>(std::min<uint64_t>(n, valid_from - first));
+    std::copy(out + stale, out + n, out);
+    n -= stale;
+  }
+  return n;
+}
+
+inline VitalsTelemetry::VitalsTelemetry() {
+  for (size_t v = 0; v < VITAL_COUNT; ++v) {
+    for (size_t r = 0; r < TELEMETRY_RESOLUTION_COUNT; ++r) {
+      rings_[v * TELEMETRY_RESOLUTION_COUNT + r] =
+          std::make_unique<TelemetryRing>(TELEMETRY_CAPACITY[r]);
+    }
+  }
+}
+
+inline void
+VitalsTelemetry::record(double t,
+                        const UnifiedPhysiologySystem::PhysiologySnapshot &snap) {
+  double map = snap.blood_pressure_diastolic +
+               (snap.blood_pressure_systolic - snap.blood_pressure_diastolic) / 3.0;
+  record(t, Vital::HEART_RATE, snap.heart_rate);
+  record(t, Vital::MEAN_PRESSURE, map);
+  record(t, Vital::SAO2, snap.sao2);
+  record(t, Vital::RESPIRATORY_RATE, snap.respiratory_rate);
+  record(t, Vital::BLOOD_PH, snap.blood_ph);
+  record(t, Vital::BLOOD_GLUCOSE, snap.blood_glucose);
+}
+
+inline void VitalsTelemetry::record(double t, Vital vital, double value) {
+  for (size_t r = 0; r < TELEMETRY_RESOLUTION_COUNT; ++r) {
+    size_t s = static_cast<size_t>(vital) * TELEMETRY_RESOLUTION_COUNT + r;
+    Accumulator &open = open_[s];
+    auto index = static_cast<uint32_t>(std::floor(t / TELEMETRY_PERIOD[r]));
+
+    if (open.count > 0 && index != open.index) {
+      rings_[s]->push({open.index, static_cast<float>(open.min),
+                       static_cast<float>(open.max),
+                       static_cast<float>(open.sum / open.count)});
+      open.count = 0;
+    }
+    if (open.count == 0) {
+      open = {index, 0, value, value, 0.0};
+    }
+    open.min = std::min(open.min, value);
+    open.max = std::max(open.max, value);
+    open.sum += value;
+    ++open.count;
+  }
+}
+
+} // namespace biology
+} // namespace isolated
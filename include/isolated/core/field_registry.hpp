@@ -0,0 +1,261 @@
+#pragma once
+
+/**
+ * @file field_registry.hpp
+ * @brief Named, typed views over engine-owned field buffers.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace isolated {
+namespace core {
+
+/**
+ * @brief Non-owning strided view of one field: value i is data[i * stride].
+ *
+ * Converts implicitly from a std::vector, so functions taking a view still
+ * accept the engine's own buffers, and from FieldView<T> to
+ * FieldView<const T>.
+ */
+template <typename T>
+struct FieldView {
+    T* data = nullptr;
+    size_t size = 0;
+    std::ptrdiff_t stride = 1;  // Elements between consecutive values
+
+    FieldView() = default;
+    FieldView(T* data_, size_t size_, std::ptrdiff_t stride_ = 1)
+        : data(data_), size(size_), stride(stride_) {}
+
+    template <typename A>
+    FieldView(std::vector<std::remove_const_t<T>, A>& v) : data(v.data()), size(v.size()) {}
+
+    template <typename A, typename U = T, std::enable_if_t<std::is_const_v<U>, int> = 0>
+    FieldView(const std::vector<std::remove_const_t<T>, A>& v)
+        : data(v.data()), size(v.size()) {}
+
+    template <typename U, std::enable_if_t<std::is_same_v<T, const U>, int> = 0>
+    FieldView(const FieldView<U>& other)
+        : data(other.data), size(other.size), stride(other.stride) {}
+
+    T& operator[](size_t i) const { return data[static_cast<std::ptrdiff_t>(i) * stride]; }
+
+    bool empty() const { return size == 0; }
+    bool contiguous() const { return stride == 1; }
+};
+
+/**
+ * @brief Where engines publish their fields for each other to read in
+ * place, without copies or per-cell setters.
+ *
+ * A producer publishes a view of a buffer it owns and bumps the field's
+ * version with mark_written() whenever it changes the values; consumers
+ * look fields up by name once and compare versions to skip unchanged
+ * data. The buffer must stay where it is while published: publish again
+ * after reallocating it.
+ *
+ * Stages (engines, or any step that runs once per tick) declare the fields
+ * they read and write, and stage_order() sorts them so every field's
+ * writers run before its readers.
+ */
+class FieldRegistry {
+public:
+    using FieldId = uint32_t;
+    using StageId = uint32_t;
+
+    /**
+     * @brief Publish a view, or replace the view of a field with this name
+     * (same element type). A view of const T is read-only.
+     */
+    template <typename T>
+    FieldId publish(const std::string& name, FieldView<T> view);
+
+    template <typename T, typename A>
+    FieldId publish(const std::string& name, std::vector<T, A>& buffer) {
+        return publish(name, FieldView<T>(buffer));
+    }
+
+    bool contains(const std::string& name) const { return ids_.count(name) != 0; }
+
+    /** @throws std::out_of_range if nothing is published under name. */
+    FieldId find(const std::string& name) const;
+
+    /**
+     * @brief The published view. T may be const; a non-const T on a
+     * read-only field, or any other type, throws std::invalid_argument.
+     */
+    template <typename T>
+    FieldView<T> view(FieldId id) const;
+
+    template <typename T>
+    FieldView<T> view(const std::string& name) const { return view<T>(find(name)); }
+
+    void mark_written(FieldId id) { ++fields_.at(id).version; }
+    uint64_t version(FieldId id) const { return fields_.at(id).version; }
+
+    /** Whether the field changed since `seen`, which is then updated. */
+    bool changed(FieldId id, uint64_t& seen) const;
+
+    const std::string& name(FieldId id) const { return fields_.at(id).name; }
+    size_t field_count() const { return fields_.size(); }
+
+    StageId add_stage(std::string name, std::vector<FieldId> reads,
+                      std::vector<FieldId> writes);
+
+    const std::string& stage_name(StageId id) const { return stages_.at(id).name; }
+    size_t stage_count() const { return stages_.size(); }
+
+    /**
+     * @brief Stages with each field's writers before its readers, and
+     * several writers of one field in the order they were added; otherwise
+     * in the order added.
+     * @throws std::logic_error on a cycle, naming a stage on it.
+     */
+    std::vector<StageId> stage_order() const;
+
+private:
+    struct Field {
+        std::string name;
+        std::type_index type;
+        bool read_only;
+        void* data;
+        size_t size;
+        std::ptrdiff_t stride;
+        uint64_t version;
+    };
+
+    struct Stage {
+        std::string name;
+        std::vector<FieldId> reads;
+        std::vector<FieldId> writes;
+    };
+
+    std::vector<Field> fields_;
+    std::unordered_map<std::string, FieldId> ids_;
+    std::vector<Stage> stages_;
+};
+
+// ============================================================================
+// INLINE IMPLEMENTATIONS
+// ============================================================================
+
+template <typename T>
+FieldRegistry::FieldId FieldRegistry::publish(const std::string& name, FieldView<T> view) {
+    using Value = std::remove_const_t<T>;
+    void* data = const_cast<Value*>(view.data);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        auto id = static_cast<FieldId>(fields_.size());
+        fields_.push_back({name, std::type_index(typeid(Value)), std::is_const_v<T>, data,
+                           view.size, view.stride, 0});
+        ids_.emplace(name, id);
+        return id;
+    }
+
+    Field& field = fields_[it->second];
+    if (field.type != std::type_index(typeid(Value))) {
+        throw std::invalid_argument("FieldRegistry: '" + name + "' republished as another type");
+    }
+    field.read_only = std::is_const_v<T>;
+    field.data = data;
+    field.size = view.size;
+    field.stride = view.stride;
+    ++field.version;
+    return it->second;
+}
+
+inline FieldRegistry::FieldId FieldRegistry::find(const std::string& name) const {
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        throw std::out_of_range("FieldRegistry: no field '" + name + "'");
+    }
+    return it->second;
+}
+
+template <typename T>
+FieldView<T> FieldRegistry::view(FieldId id) const {
+    using Value = std::remove_const_t<T>;
+    const Field& field = fields_.at(id);
+    if (field.type != std::type_index(typeid(Value))) {
+        throw std::invalid_argument("FieldRegistry: '" + field.name + "' has another type");
+    }
+    if (field.read_only && !std::is_const_v<T>) {
+        throw std::invalid_argument("FieldRegistry: '" + field.name + "' is read-only");
+    }
+    return {static_cast<Value*>(field.data), field.size, field.stride};
+}
+
+inline bool FieldRegistry::changed(FieldId id, uint64_t& seen) const {
+    uint64_t now = version(id);
+    bool result = now != seen;
+    seen = now;
+    return result;
+}
+
+inline FieldRegistry::StageId FieldRegistry::add_stage(std::string name,
+                                                       std::vector<FieldId> reads,
+                                                       std::vector<FieldId> writes) {
+    stages_.push_back({std::move(name), std::move(reads), std::move(writes)});
+    return static_cast<StageId>(stages_.size() - 1);
+}
+
+inline std::vector<FieldRegistry::StageId> FieldRegistry::stage_order() const {
+    const size_t n = stages_.size();
+
+    // Writers of each field, in the order added
+    std::vector<std::vector<StageId>> writers(fields_.size());
+    for (StageId s = 0; s < n; ++s) {
+        for (FieldId f : stages_[s].writes) writers.at(f).push_back(s);
+    }
+
+    std::vector<std::vector<StageId>> successors(n);
+    std::vector<size_t> blockers(n, 0);
+    auto edge = [&](StageId from, StageId to) {
+        if (from == to) return;
+        successors[from].push_back(to);
+        ++blockers[to];
+    };
+    for (const auto& w : writers) {
+        for (size_t k = 1; k < w.size(); ++k) edge(w[k - 1], w[k]);
+    }
+    for (StageId s = 0; s < n; ++s) {
+        for (FieldId f : stages_[s].reads) {
+            for (StageId w : writers.at(f)) edge(w, s);
+        }
+    }
+
+    // Kahn's algorithm, always taking the earliest-added ready stage
+    std::vector<StageId> order;
+    std::vector<bool> done(n, false);
+    while (order.size() < n) {
+        StageId next = static_cast<StageId>(n);
+        for (StageId s = 0; s < n; ++s) {
+            if (!done[s] && blockers[s] == 0) {
+                next = s;
+                break;
+            }
+        }
+        if (next == n) {
+            for (StageId s = 0; s < n; ++s) {
+                if (!done[s]) {
+                    throw std::logic_error("FieldRegistry: dependency cycle through stage '" +
+                                           stages_[s].name + "'");
+                }
+            }
+        }
+        done[next] = true;
+        order.push_back(next);
+        for (StageId succ : successors[next]) --blockers[succ];
+    }
+    return order;
+}
+
+} // namespace core
+} // namespace isolated
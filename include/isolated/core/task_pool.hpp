@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+ * @file task_pool.hpp
+ * @brief Work-stealing thread pool for per-tick simulation tasks.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace isolated {
+namespace core {
+
+/**
+ * @brief Fixed set of workers, each with its own task deque.
+ *
+ * A worker pops its newest task (LIFO, cache-warm) and, when empty, steals
+ * the oldest task of another worker (FIFO). Tasks submitted from a worker go
+ * to that worker's deque; tasks submitted from outside are dealt round-robin.
+ *
+ * Waiting never blocks a thread that could run work: wait_until() and
+ * parallel_for() run queued tasks on the calling thread until their
+ * condition holds, so tasks may submit and wait on subtasks, and a pool
+ * with zero workers still makes progress on the caller.
+ */
+class TaskPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param workers Worker threads; 0 means hardware_concurrency() - 1,
+     * since the submitting thread also runs tasks while waiting.
+     */
+    explicit TaskPool(size_t workers = 0);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    size_t worker_count() const { return threads_.size(); }
+
+    // Threads that can run tasks concurrently, including the caller
+    size_t concurrency() const { return threads_.size() + 1; }
+
+    void submit(Task task);
+
+    /**
+     * @brief Run queued tasks on this thread until done() returns true.
+     */
+    void wait_until(const std::function<bool()>& done);
+
+    /**
+     * @brief Call fn(begin, end) over [0, count) in slices of about
+     * `grain` items and wait for all of them. Slice boundaries depend only
+     * on count and grain, never on timing.
+     */
+    void parallel_for(size_t count, size_t grain,
+                      const std::function<void(size_t, size_t)>& fn);
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;  // One per worker, plus one
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<bool> stop_{false};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+
+    void worker_loop(size_t index);
+    bool try_run_one(size_t home);
+    size_t home_queue() const;
+};
+
+} // namespace core
+} // namespace isolated
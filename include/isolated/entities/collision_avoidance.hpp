@@ -0,0 +1,102 @@
+#pragma once
+
+#include "entt/entt.hpp"
+#include <isolated/core/task_pool.hpp>
+#include <isolated/entities/components.hpp>
+#include <isolated/entities/spatial_index.hpp>
+#include <isolated/world/chunk_manager.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace isolated {
+namespace entities {
+
+struct AvoidanceConfig {
+    float radius = 0.3f;          // Agent radius (cells)
+    float neighbour_dist = 2.0f;  // Neighbours considered within this range (cells)
+    float time_horizon = 1.0f;    // Look-ahead against other agents (s)
+    float obstacle_time_horizon = 0.5f;  // Look-ahead against walls (s)
+    float max_speed = 2.0f;       // Cells per second
+    size_t max_neighbours = 10;   // Nearest neighbours kept, up to MAX_NEIGHBOURS
+};
+
+/**
+ * @brief Reciprocal collision avoidance (ORCA) between walking entities.
+ *
+ * Each entity with Position and Velocity is an agent. Its preferred
+ * velocity is its PreferredVelocity, or its current Velocity when it has
+ * none. For every agent the nearest max_neighbours agents on the same level
+ * within neighbour_dist, found through the spatial index, each contribute
+ * one half-plane of velocities that avoid collision for time_horizon
+ * seconds, assuming the other agent takes half the avoidance effort. A 2D
+ * linear program picks the allowed velocity closest to the preferred one;
+ * when the half-planes leave no room (dense crowds), it picks the velocity
+ * that violates them least. The result is written to Velocity.
+ *
+ * With a chunk manager attached, walls are static obstacles. Within
+ * OBSTACLE_REACH cells of an agent, the faces between voxels a walker cannot
+ * occupy (see world::nav_passable) and open ones on its level are merged
+ * into straight segments, and each segment facing the agent keeps it a
+ * radius clear for obstacle_time_horizon seconds. Walls are hard
+ * constraints: when a crowd leaves no room, agents give way to each other,
+ * never into a wall. Voxels in unloaded chunks are open.
+ *
+ * Agent state is gathered into SoA arrays once per update. Agents are then
+ * solved independently and in parallel against those arrays, so the result
+ * does not depend on the thread count. Per-agent work uses fixed-size
+ * stack buffers and does no allocation once the arrays have grown.
+ */
+class CollisionAvoidance {
+public:
+    static constexpr size_t MAX_NEIGHBOURS = 16;
+    static constexpr int OBSTACLE_REACH = 2;  // Cells scanned around an agent for walls
+    // Every face in the (2 * OBSTACLE_REACH + 1)^2 window, both axes
+    static constexpr size_t MAX_WALL_LINES = 2 * (2 * OBSTACLE_REACH) * (2 * OBSTACLE_REACH + 1);
+    static constexpr size_t MAX_LINES = MAX_NEIGHBOURS + MAX_WALL_LINES;
+
+    CollisionAvoidance() { config_ = AvoidanceConfig{}; }
+    explicit CollisionAvoidance(const AvoidanceConfig& config) : config_(config) {}
+
+    /**
+     * @brief Solve new velocities for every agent.
+     * @param index Spatial index holding the agents' current cells
+     * @param dt Step length, used to resolve agents that already overlap
+     * @param pool Optional pool to split the agents across
+     */
+    void update(entt::registry& registry, const SpatialIndex& index, double dt,
+                core::TaskPool* pool = nullptr);
+
+    /**
+     * @brief Treat walls in these chunks as obstacles (nullptr: agents only).
+     * Chunks are read during update(), which must not overlap loading.
+     */
+    void set_world(world::ChunkManager* chunks) { chunks_ = chunks; }
+
+    size_t agent_count() const { return entity_.size(); }
+    const AvoidanceConfig& config() const { return config_; }
+
+private:
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFFu;
+    static constexpr size_t PARALLEL_GRAIN = 128;
+
+    AvoidanceConfig config_;
+    world::ChunkManager* chunks_ = nullptr;
+
+    // Agent state, SoA
+    std::vector<entt::entity> entity_;
+    std::vector<float> x_, y_;
+    std::vector<int> z_;
+    std::vector<float> vx_, vy_;
+    std::vector<float> pref_vx_, pref_vy_;
+    std::vector<float> new_vx_, new_vy_;
+
+    // Entity index -> agent slot; stale entries are caught by checking entity_
+    std::vector<uint32_t> slot_of_;
+
+    uint32_t slot(entt::entity e) const;
+    void solve(size_t i, float dt, const SpatialIndex& index,
+               std::vector<entt::entity>& candidates);
+};
+
+} // namespace entities
+} // namespace isolated
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "raylib.h"
+#include <isolated/biology/multirate.hpp>
+#include <isolated/biology/telemetry.hpp>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -24,6 +28,15 @@ struct Velocity {
   float dy;
 };
 
+/**
+ * @brief Velocity the entity wants; collision avoidance turns it into the
+ * Velocity it actually moves with.
+ */
+struct PreferredVelocity {
+  float dx = 0.0f;
+  float dy = 0.0f;
+};
+
 /**
  * @brief Visual representation.
  */
@@ -40,13 +53,84 @@ struct Astronaut {
   // TODO: Add unique ID or DNA
 };
 
+/**
+ * @brief Voxel on a path; z is the level the entity stands on.
+ */
+struct Waypoint {
+  int x;
+  int y;
+  int z;
+};
+
 /**
  * @brief Movement path.
  */
 struct Path {
-  std::vector<Vector2> waypoints;
-  int current_index;
-  bool active;
+  std::vector<Waypoint> waypoints;
+  size_t current_index = 0;
+  bool active = false;
+};
+
+/**
+ * @brief Follows a shared flow field toward a destination; `next` is the
+ * voxel being walked to.
+ */
+struct FlowFollower {
+  uint32_t field = 0;
+  Waypoint goal{0, 0, 0};
+  Waypoint next{0, 0, 0};
+  bool stepping = false;
+};
+
+/**
+ * @brief Where a walker stopped at the end of its path or flow field.
+ * Walkers bound for the same goal stop on reaching the group gathered
+ * there, instead of pushing toward an occupied cell.
+ */
+struct Settled {
+  Waypoint goal{0, 0, 0};
+};
+
+/**
+ * @brief Simulation level of detail for an entity's biology.
+ */
+enum class SimTier : uint8_t {
+  FULL,     // Selected or in crisis: every update
+  REDUCED,  // Nearby and healthy: fewer, longer steps
+  COARSE    // Distant: rare, long steps
+};
+
+constexpr size_t SIM_TIER_COUNT = 3;
+
+/**
+ * @brief Current tier; systems on a slower tier bank dt in pending_dt and
+ * integrate it in one step once `period` seconds have built up.
+ */
+struct SimLod {
+  SimTier tier = SimTier::FULL;
+  float period = 0.0f;
+  float pending_dt = 0.0f;
+};
+
+/**
+ * @brief The entity's person in the tiered physiology: which tier's batch
+ * and the index within it.
+ */
+struct PhysiologySlot {
+  SimTier tier = SimTier::FULL;
+  size_t index = 0;
+};
+
+/**
+ * @brief Vitals published at each physiology step, for slower biology
+ * subsystems to average over their own interval and for the UI to plot.
+ */
+struct VitalSignals {
+  biology::CouplingSignal pao2{95.0};       // mmHg
+  biology::SignalCursor hematology_cursor;  // Hematology's last read of pao2
+  // Shared so a reader can hold on to it past the entity
+  std::shared_ptr<biology::VitalsTelemetry> history =
+      std::make_shared<biology::VitalsTelemetry>();
 };
 
 /**
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "entt/entt.hpp"
+#include <isolated/core/task_pool.hpp>
+#include <isolated/entities/collision_avoidance.hpp>
 #include <isolated/entities/components.hpp>
 #include <isolated/entities/spatial_index.hpp>
+#include <isolated/world/flow_field.hpp>
+#include <isolated/world/navigation.hpp>
 #include <string>
 #include <random>
 
@@ -23,10 +27,20 @@ public:
   // Spawning
   entt::entity spawn_astronaut(float x, float y, int z, const std::string &name = "Bob");
 
-  // Systems
-  void update(double dt);
+  // Systems; the pool, if given, splits collision avoidance across workers
+  void update(double dt, core::TaskPool *pool = nullptr);
+
+  // Navigation: paths are solved by the queue and followed in update()
+  void set_path_queue(world::PathQueue *queue) { path_queue_ = queue; }
+  bool request_path(entt::entity entity, int x, int y, int z);
+
+  // Crowds: walkers sharing a destination share one flow field
+  void set_flow_fields(world::FlowFieldCache *fields) { flow_fields_ = fields; }
+  bool request_flow(entt::entity entity, int x, int y, int z);
+
+  // Walls in these chunks are obstacles for collision avoidance
+  void set_chunks(world::ChunkManager *chunks) { avoidance_.set_world(chunks); }
 
-  // Queries
   // Queries
   entt::entity get_entity_at(float x, float y, int z, float radius = 0.5f) const;
   
@@ -45,14 +59,28 @@ public:
 private:
   entt::registry registry_;
   SpatialIndex spatial_index_;
+  world::PathQueue *path_queue_ = nullptr;
+  std::vector<world::PathResult> path_results_;
+  world::FlowFieldCache *flow_fields_ = nullptr;
+  std::vector<entt::entity> arrived_;
+  std::vector<entt::entity> nearby_;  // Query scratch
+  CollisionAvoidance avoidance_;
+
+  // Walking speed along paths (cells per second)
+  static constexpr float WALK_SPEED = 1.5f;
   
   // Seeded RNG for deterministic spawning
   std::mt19937 rng_;
   uint32_t seed_ = 42;
 
   // System methods
-  void update_movement(double dt);
+  void update_paths();
+  void update_movement(double dt, core::TaskPool *pool);
   void update_spatial_index();
+  void stop(entt::entity entity);  // Zero preferred and actual velocity
+  bool joins_group(entt::entity entity, const Position &pos, const Waypoint &goal);
+  void on_position_destroyed(entt::registry &registry, entt::entity entity);
+  void on_flow_follower_destroyed(entt::registry &registry, entt::entity entity);
 };
 
 } // namespace entities
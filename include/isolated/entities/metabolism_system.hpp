@@ -1,6 +1,7 @@
 #pragma once
 
 #include "entt/entt.hpp"
+#include <isolated/core/task_pool.hpp>
 #include <isolated/entities/components.hpp>
 #include <isolated/thermal/heat_engine.hpp>
 
@@ -19,14 +20,20 @@ public:
      * @param dt Delta time in seconds
      * @param registry ECS registry
      * @param thermal Thermal engine for heat injection
+     * @param pool Optional pool to split large views across; heat is still
+     * injected serially in view order, so the result does not depend on it
      */
-    static void update(double dt, entt::registry& registry, thermal::ThermalEngine& thermal);
+    static void update(double dt, entt::registry& registry, thermal::ThermalEngine& thermal,
+                       core::TaskPool* pool = nullptr);
 
 private:
     // Constants
     static constexpr float WALKING_METABOLIC_RATE = 150.0f; // Watts
     static constexpr float RESTING_METABOLIC_RATE = 80.0f;  // Watts
     static constexpr float CALORIES_PER_JOULE = 0.000239006f;
+
+    // Entities per parallel slice
+    static constexpr size_t PARALLEL_GRAIN = 256;
 };
 
 } // namespace entities
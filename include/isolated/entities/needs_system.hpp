@@ -1,6 +1,7 @@
 #pragma once
 
 #include "entt/entt.hpp"
+#include <isolated/core/task_pool.hpp>
 #include <isolated/entities/components.hpp>
 #include <isolated/fluids/lbm_engine.hpp>
 
@@ -14,6 +15,8 @@ namespace entities {
  * - O2 consumption from ambient air
  * - CO2 exhale into LBM simulation
  * - Hypoxia state transitions
+ *
+ * Entities with a SimLod on a slower tier update once per SimLod::period.
  */
 class NeedsSystem {
 public:
@@ -22,8 +25,10 @@ public:
      * @param dt Delta time in seconds
      * @param registry The ECS registry
      * @param fluids The LBM engine for gas exchange
+     * @param pool Optional pool to split large views across
      */
-    static void update(double dt, entt::registry& registry, fluids::LBMEngine& fluids);
+    static void update(double dt, entt::registry& registry, fluids::LBMEngine& fluids,
+                       core::TaskPool* pool = nullptr);
 
 private:
     // O2 consumption rate (fraction per second at rest)
@@ -40,6 +45,9 @@ private:
     
     // Minimum ambient O2 for normal breathing (fraction)
     static constexpr float MIN_AMBIENT_O2 = 0.16f; // 16% O2 minimum
+
+    // Entities per parallel slice
+    static constexpr size_t PARALLEL_GRAIN = 256;
 };
 
 } // namespace entities
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "entt/entt.hpp"
+#include <isolated/biology/physiology_batch.hpp>
+#include <isolated/core/task_pool.hpp>
+#include <isolated/entities/components.hpp>
+#include <array>
+#include <vector>
+
+namespace isolated {
+namespace entities {
+
+struct SimLodConfig {
+    float near_radius = 48.0f;     // REDUCED within this distance of the camera (cells)
+    float hysteresis = 8.0f;       // Extra distance before dropping back to COARSE (cells)
+    float level_distance = 16.0f;  // Distance one z-level apart counts as (cells)
+    float critical_score = 0.5f;   // Criticality from which an entity is FULL
+    float reduced_period = 0.5f;   // Seconds per REDUCED update
+    float coarse_period = 2.0f;    // Seconds per COARSE update
+};
+
+/**
+ * @brief Per-entity simulation LOD for physiology and needs.
+ *
+ * assign() sorts every entity with SimLod into a tier: FULL when it is the
+ * selected entity or its criticality (from Needs and vitals) reaches
+ * critical_score, REDUCED when it is near the camera focus, COARSE
+ * otherwise. Needs and physiology of slower tiers are integrated in fewer,
+ * longer steps: NeedsSystem banks dt per entity until SimLod::period has
+ * passed, and each tier's people live in their own PhysiologyBatch, stepped
+ * once its period has built up. People move between batches with their
+ * state when their tier changes; time the old tier had banked for them is
+ * dropped, which is under one coarse period.
+ */
+class SimulationLod {
+public:
+    using PhysiologyConfig = biology::PhysiologyBatch::Config;
+    using EnvironmentState = biology::PhysiologyBatch::EnvironmentState;
+    using PhysiologySnapshot = biology::PhysiologyBatch::PhysiologySnapshot;
+    using FastForwardStats = biology::PhysiologyBatch::FastForwardStats;
+
+    SimulationLod() { config_ = SimLodConfig{}; }
+    explicit SimulationLod(const SimLodConfig& config) : config_(config) {}
+
+    /**
+     * @brief Give the entity a person in the physiology and a SimLod. It
+     * starts on the FULL tier until the next assign().
+     */
+    void add(entt::registry& registry, entt::entity entity,
+             const PhysiologyConfig& config = PhysiologyConfig{});
+    void remove(entt::registry& registry, entt::entity entity);
+
+    /**
+     * @brief Re-tier every entity with SimLod.
+     * @param focus_x, focus_y, focus_z Camera focus (cells, level)
+     * @param selected Entity kept at full rate, or entt::null
+     */
+    void assign(entt::registry& registry, float focus_x, float focus_y, int focus_z,
+                entt::entity selected);
+
+    /**
+     * @brief Advance the physiology by dt; each tier steps once its period
+     * has built up.
+     */
+    void step(double dt, core::TaskPool* pool = nullptr);
+
+    /**
+     * @brief Advance the physiology across a long interval (a night's
+     * sleep), jumping over quasi-steady stretches with
+     * PhysiologyBatch::fast_forward. Time step() had banked is included.
+     */
+    FastForwardStats fast_forward(double duration, core::TaskPool* pool = nullptr);
+
+    void set_environment(const PhysiologySlot& slot, const EnvironmentState& env) {
+        batches_[tier_index(slot.tier)].set_environment(slot.index, env);
+    }
+    PhysiologySnapshot snapshot(const PhysiologySlot& slot) const {
+        return batches_[tier_index(slot.tier)].snapshot(slot.index);
+    }
+
+    /**
+     * @brief 0 for a healthy entity, 1 for one in crisis. Either input may
+     * be null.
+     */
+    static float criticality(const Needs* needs, const PhysiologySnapshot* vitals);
+
+    float period(SimTier tier) const;
+    size_t count(SimTier tier) const { return counts_[tier_index(tier)]; }
+    size_t size() const { return owners_[0].size() + owners_[1].size() + owners_[2].size(); }
+    const SimLodConfig& config() const { return config_; }
+
+private:
+    SimLodConfig config_;
+
+    // One batch per tier; owners_[t][i] holds batch t's person i
+    std::array<biology::PhysiologyBatch, SIM_TIER_COUNT> batches_;
+    std::array<std::vector<entt::entity>, SIM_TIER_COUNT> owners_;
+    std::array<double, SIM_TIER_COUNT> pending_{};
+    std::array<size_t, SIM_TIER_COUNT> counts_{};
+
+    static size_t tier_index(SimTier tier) { return static_cast<size_t>(tier); }
+
+    void move(entt::registry& registry, PhysiologySlot& slot, SimTier tier);
+    void unlink(entt::registry& registry, SimTier tier, size_t index);
+};
+
+} // namespace entities
+} // namespace isolated
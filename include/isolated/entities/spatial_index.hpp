@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
+#include <unordered_map>
 #include <vector>
 #include "entt/entt.hpp"
 
@@ -8,62 +11,200 @@ namespace entities {
 
 /**
  * @brief Spatial index for fast entity lookups by position.
- * 
- * Maps grid coordinates (x, y) to a list of entities residing in that cell.
- * Currently supports a single Z-level (2D grid).
+ *
+ * Entities are bucketed into cubic cells of cell_size voxels, aligned to the
+ * world origin so every cell lies inside one chunk (cell_size is a power of
+ * two no larger than world::CHUNK_SIZE). Only occupied cells exist: a hash maps each cell to a
+ * bucket, and the buckets are stored CSR-style as offsets into one flat
+ * entity array built by a two-pass counting sort. The world is unbounded in
+ * all three axes.
+ *
+ * set_position() stages moves and commit() publishes them. An entity that
+ * stays in its cell costs one key comparison; if nothing changed cell,
+ * commit() does nothing, otherwise it re-sorts from the cached bucket ids
+ * without touching the hash. Queries see the state of the last commit().
  */
 class SpatialIndex {
 public:
-    void init(int width, int height) {
-        width_ = width;
-        height_ = height;
-        // Resize grid to width * height
-        grid_.resize(width * height);
+    static constexpr int DEFAULT_CELL_SIZE = 4;
+
+    /**
+     * @brief Reset the index; cell_size is rounded down to a power of two.
+     */
+    void init(int cell_size = DEFAULT_CELL_SIZE) {
+        cell_shift_ = 0;
+        while ((2 << cell_shift_) <= cell_size) ++cell_shift_;
+        clear();
     }
 
     void clear() {
-        for (auto& cell : grid_) {
-            cell.clear();
+        slot_key_.clear();
+        slot_bucket_.clear();
+        slot_entity_.clear();
+        bucket_of_.clear();
+        bucket_key_.clear();
+        bucket_start_.assign(1, 0);
+        entities_.clear();
+        live_ = 0;
+        dirty_ = false;
+    }
+
+    /**
+     * @brief Insert an entity or update its position.
+     */
+    void set_position(entt::entity entity, float x, float y, int z) {
+        uint64_t key = cell_key(cell_of(floor_to_int(x)), cell_of(floor_to_int(y)),
+                                cell_of(z));
+        size_t slot = static_cast<size_t>(entt::to_entity(entity));
+        if (slot >= slot_key_.size()) {
+            slot_key_.resize(slot + 1, 0);
+            slot_bucket_.resize(slot + 1, ABSENT);
+            slot_entity_.resize(slot + 1, entt::null);
+        }
+
+        if (slot_key_[slot] == key && slot_bucket_[slot] != ABSENT &&
+            slot_entity_[slot] == entity) {
+            return;
         }
+
+        if (slot_bucket_[slot] == ABSENT) ++live_;
+        slot_key_[slot] = key;
+        slot_bucket_[slot] = bucket_for(key);
+        slot_entity_[slot] = entity;
+        dirty_ = true;
     }
 
-    void insert(entt::entity entity, int x, int y) {
-        if (x < 0 || x >= width_ || y < 0 || y >= height_) return;
-        
-        size_t index = y * width_ + x;
-        grid_[index].push_back(entity);
+    void remove(entt::entity entity) {
+        size_t slot = static_cast<size_t>(entt::to_entity(entity));
+        if (slot >= slot_bucket_.size() || slot_bucket_[slot] == ABSENT) return;
+        slot_bucket_[slot] = ABSENT;
+        --live_;
+        dirty_ = true;
     }
 
-    const std::vector<entt::entity>& get_entities_at(int x, int y) const {
-        if (x < 0 || x >= width_ || y < 0 || y >= height_) {
-            static const std::vector<entt::entity> empty;
-            return empty;
+    /**
+     * @brief Rebuild the CSR arrays if any entity changed cell.
+     */
+    void commit() {
+        if (!dirty_) return;
+        dirty_ = false;
+
+        count_buckets();
+
+        // Buckets are never erased while in use; once most are empty,
+        // rebuild the hash from the live cells
+        size_t empty = 0;
+        for (size_t b = 0; b < bucket_key_.size(); ++b) {
+            empty += bucket_start_[b + 1] == 0;
         }
-        
-        size_t index = y * width_ + x;
-        return grid_[index];
+        if (empty > 64 && empty * 2 > bucket_key_.size()) {
+            bucket_of_.clear();
+            bucket_key_.clear();
+            for (size_t slot = 0; slot < slot_bucket_.size(); ++slot) {
+                if (slot_bucket_[slot] != ABSENT) slot_bucket_[slot] = bucket_for(slot_key_[slot]);
+            }
+            count_buckets();
+        }
+
+        // Prefix sum, then scatter in slot order (deterministic)
+        for (size_t b = 0; b < bucket_key_.size(); ++b) {
+            bucket_start_[b + 1] += bucket_start_[b];
+        }
+        cursor_.assign(bucket_start_.begin(), bucket_start_.end() - 1);
+        entities_.resize(live_);
+        for (size_t slot = 0; slot < slot_bucket_.size(); ++slot) {
+            uint32_t b = slot_bucket_[slot];
+            if (b != ABSENT) entities_[cursor_[b]++] = slot_entity_[slot];
+        }
+    }
+
+    /**
+     * @brief Entities in the cell containing voxel (x, y, z).
+     */
+    std::span<const entt::entity> get_entities_at(int x, int y, int z) const {
+        return bucket(cell_key(cell_of(x), cell_of(y), cell_of(z)));
     }
-    
-    // Allow querying a range of cells (useful for radius checks)
-    void query_range(int min_x, int min_y, int max_x, int max_y, std::vector<entt::entity>& out_result) const {
-        // Clamp bounds
-        if (min_x < 0) min_x = 0;
-        if (min_y < 0) min_y = 0;
-        if (max_x >= width_) max_x = width_ - 1;
-        if (max_y >= height_) max_y = height_ - 1;
-        
-        for (int y = min_y; y <= max_y; ++y) {
-            for (int x = min_x; x <= max_x; ++x) {
-                const auto& cell = grid_[y * width_ + x];
-                out_result.insert(out_result.end(), cell.begin(), cell.end());
+
+    /**
+     * @brief Append entities in all cells overlapping the voxel box
+     * (bounds inclusive). Callers filter by exact distance.
+     */
+    void query_range(int min_x, int min_y, int min_z, int max_x, int max_y, int max_z,
+                     std::vector<entt::entity>& out_result) const {
+        int cx0 = cell_of(min_x), cx1 = cell_of(max_x);
+        int cy0 = cell_of(min_y), cy1 = cell_of(max_y);
+        int cz0 = cell_of(min_z), cz1 = cell_of(max_z);
+
+        for (int cz = cz0; cz <= cz1; ++cz) {
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    auto cell = bucket(cell_key(cx, cy, cz));
+                    out_result.insert(out_result.end(), cell.begin(), cell.end());
+                }
             }
         }
     }
 
+    size_t size() const { return live_; }
+    int cell_size() const { return 1 << cell_shift_; }
+
 private:
-    int width_ = 0;
-    int height_ = 0;
-    std::vector<std::vector<entt::entity>> grid_;
+    static constexpr uint32_t ABSENT = 0xFFFFFFFFu;
+
+    int cell_shift_ = 2;  // log2(DEFAULT_CELL_SIZE)
+    size_t live_ = 0;
+    bool dirty_ = false;
+
+    // Per entity slot (entt::to_entity): cell key, bucket, full handle
+    std::vector<uint64_t> slot_key_;
+    std::vector<uint32_t> slot_bucket_;            // ABSENT if not indexed
+    std::vector<entt::entity> slot_entity_;
+    std::unordered_map<uint64_t, uint32_t> bucket_of_;  // Cell key -> bucket
+    std::vector<uint64_t> bucket_key_;
+    std::vector<uint32_t> bucket_start_;           // CSR offsets, buckets + 1
+    std::vector<entt::entity> entities_;           // Grouped by bucket
+    std::vector<uint32_t> cursor_;                 // Scatter scratch
+
+    // Inlined floor; std::floor is a libm call without SSE4.1
+    static int floor_to_int(float v) {
+        int i = static_cast<int>(v);
+        return i - (v < static_cast<float>(i));
+    }
+
+    // Arithmetic shift floors negative coordinates too
+    int cell_of(int v) const { return v >> cell_shift_; }
+
+    static uint64_t cell_key(int cx, int cy, int cz) {
+        // 21 bits per axis, biased so negative cells pack cleanly
+        constexpr uint64_t MASK = (1ull << 21) - 1;
+        constexpr int64_t BIAS = 1 << 20;
+        return ((static_cast<uint64_t>(cx + BIAS) & MASK) << 42) |
+               ((static_cast<uint64_t>(cy + BIAS) & MASK) << 21) |
+               (static_cast<uint64_t>(cz + BIAS) & MASK);
+    }
+
+    uint32_t bucket_for(uint64_t key) {
+        auto [it, inserted] =
+            bucket_of_.try_emplace(key, static_cast<uint32_t>(bucket_key_.size()));
+        if (inserted) bucket_key_.push_back(key);
+        return it->second;
+    }
+
+    void count_buckets() {
+        bucket_start_.assign(bucket_key_.size() + 1, 0);
+        for (uint32_t b : slot_bucket_) {
+            if (b != ABSENT) ++bucket_start_[b + 1];
+        }
+    }
+
+    std::span<const entt::entity> bucket(uint64_t key) const {
+        auto it = bucket_of_.find(key);
+        // Buckets created since the last commit have no CSR range yet
+        if (it == bucket_of_.end() || it->second + 1 >= bucket_start_.size()) return {};
+        uint32_t begin = bucket_start_[it->second];
+        uint32_t end = bucket_start_[it->second + 1];
+        return {entities_.data() + begin, end - begin};
+    }
 };
 
 } // namespace entities
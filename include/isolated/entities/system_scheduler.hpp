@@ -0,0 +1,132 @@
+#pragma once
+
+#include <isolated/core/task_pool.hpp>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace isolated {
+namespace entities {
+
+/**
+ * @brief Components and shared resources a system reads or writes.
+ *
+ * Any type can be named: components (Position, Needs) or whole engines a
+ * system touches (thermal::ThermalEngine). Each type maps to one bit of a
+ * 64-bit set; past 64 types bits are shared, which can only add false
+ * conflicts, never hide a real one.
+ */
+class ComponentAccess {
+public:
+    template <typename T>
+    ComponentAccess& read() {
+        reads_ |= bit<std::remove_cv_t<T>>();
+        return *this;
+    }
+
+    template <typename T>
+    ComponentAccess& write() {
+        writes_ |= bit<std::remove_cv_t<T>>();
+        return *this;
+    }
+
+    /**
+     * @brief Conflicts with every other system, e.g. for systems that
+     * create or destroy entities.
+     */
+    static ComponentAccess exclusive() {
+        ComponentAccess a;
+        a.writes_ = ~0ull;
+        return a;
+    }
+
+    bool conflicts_with(const ComponentAccess& other) const {
+        return (writes_ & (other.reads_ | other.writes_)) != 0 ||
+               (other.writes_ & reads_) != 0;
+    }
+
+private:
+    uint64_t reads_ = 0;
+    uint64_t writes_ = 0;
+
+    static unsigned next_id() {
+        static std::atomic<unsigned> counter{0};
+        return counter++;
+    }
+
+    template <typename T>
+    static uint64_t bit() {
+        static const uint64_t b = 1ull << (next_id() % 64);
+        return b;
+    }
+};
+
+/**
+ * @brief Runs ECS systems each tick, in parallel where their declared
+ * access allows.
+ *
+ * Every tick the systems that are due form a dependency graph: a system
+ * depends on each earlier-registered system it conflicts with (one writes
+ * what the other reads or writes). Independent systems run concurrently on
+ * the task pool; conflicting ones run in registration order, so writes to
+ * shared state such as thermal heat injection happen in the same order as a
+ * serial loop. Systems can slice large views over the same pool with
+ * core::TaskPool::parallel_for().
+ *
+ * A system that throws does not stop the others; the first exception is
+ * rethrown from run() once the tick finishes.
+ */
+class SystemScheduler {
+public:
+    using SystemFn = std::function<void(double dt)>;
+
+    explicit SystemScheduler(core::TaskPool& pool) : pool_(pool) {}
+
+    /**
+     * @brief Register a system.
+     * @param interval Run every `interval` ticks with dt * interval, for
+     * throttled systems.
+     */
+    void add_system(const std::string& name, const ComponentAccess& access,
+                    SystemFn fn, int interval = 1);
+
+    /**
+     * @brief Run every system due this tick and wait for them.
+     */
+    void run(double dt);
+
+    core::TaskPool& pool() { return pool_; }
+    uint64_t tick() const { return tick_; }
+    size_t system_count() const { return systems_.size(); }
+
+private:
+    struct System {
+        std::string name;
+        ComponentAccess access;
+        SystemFn fn;
+        int interval;
+    };
+
+    core::TaskPool& pool_;
+    std::vector<System> systems_;
+    uint64_t tick_ = 0;
+
+    // Per-tick graph, reused between ticks
+    std::vector<size_t> due_;
+    std::vector<size_t> roots_;
+    std::vector<std::vector<size_t>> successors_;
+    std::unique_ptr<std::atomic<uint32_t>[]> blockers_;
+    size_t blockers_capacity_ = 0;
+
+    void execute(size_t slot, double dt, std::atomic<size_t>& remaining,
+                 std::exception_ptr& error, std::mutex& error_mutex);
+};
+
+} // namespace entities
+} // namespace isolated
@@ -9,10 +9,16 @@
  * - Breach flow with orifice equations
  * - Choked flow at sonic conditions
  * - Multi-compartment propagation network
+ * - Implicit (Newton) pressure solve over a sparse compartment graph
  */
 
+#include <Eigen/SparseCore>
+#include <Eigen/SparseLU>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +36,11 @@ constexpr double GAMMA = 1.4;             // Ratio of specific heats (air)
 constexpr double CRITICAL_RATIO = 0.528;  // (2/(γ+1))^(γ/(γ-1)) for γ=1.4
 constexpr double ATM_PRESSURE = 101325.0; // Pa
 constexpr double SPACE_PRESSURE = 0.0;    // Pa (vacuum)
+constexpr double SPACE_TEMPERATURE = 293.0; // K, assumed for inflow
+// Relative pressure difference below which orifice flow is linear in dp,
+// instead of sqrt(dp), so its derivative stays finite near equilibrium
+constexpr double LINEAR_BAND = 1e-4;
+constexpr double MIN_MASS = 0.001; // kg left in a drained compartment
 } // namespace breach_constants
 
 // ============================================================================
@@ -98,43 +109,62 @@ struct Breach {
 class BreachFlowCalculator {
 public:
   /**
-   * @brief Calculate mass flow through an orifice.
-   * Uses isentropic flow equations with choking.
+   * @brief Mass flow through an orifice and its pressure derivatives.
+   *
+   * Isentropic flow, choked below CRITICAL_RATIO. Within LINEAR_BAND of
+   * equal pressures the flow is interpolated linearly to zero, which keeps
+   * it continuous but gives the Newton solve a finite slope.
+   * @param d_up dFlow/dp_upstream (>= 0)
+   * @param d_down dFlow/dp_downstream (<= 0)
+   * @return kg/s, zero unless p_upstream >= p_downstream
    */
-  static double calculate_mass_flow(double p_upstream, double p_downstream,
-                                    double T_upstream, double area, double Cd) {
+  static double orifice_flow(double p_upstream, double p_downstream,
+                             double T_upstream, double area, double Cd,
+                             double &d_up, double &d_down) {
     using namespace breach_constants;
 
-    if (p_upstream <= p_downstream)
+    d_up = d_down = 0.0;
+    if (p_upstream < p_downstream || p_upstream <= 0.0 || area <= 0.0)
       return 0.0;
-    if (area <= 0.0)
-      return 0.0;
-
-    double pressure_ratio = p_downstream / p_upstream;
-    double rho_upstream = p_upstream / (R_AIR * T_upstream);
 
-    double mass_flow;
+    // Flow is k * p_up * S(p_down / p_up)
+    double k = Cd * area / std::sqrt(R_AIR * T_upstream);
+    double r = p_downstream / p_upstream;
 
-    if (pressure_ratio <= CRITICAL_RATIO) {
+    if (r <= CRITICAL_RATIO) {
       // Choked flow (sonic at throat)
       // m_dot = Cd * A * p * sqrt(γ/RT) * (2/(γ+1))^((γ+1)/(2(γ-1)))
       double choke_factor =
           std::pow(2.0 / (GAMMA + 1.0), (GAMMA + 1.0) / (2.0 * (GAMMA - 1.0)));
-      mass_flow = Cd * area * p_upstream *
-                  std::sqrt(GAMMA / (R_AIR * T_upstream)) * choke_factor;
-    } else {
-      // Subsonic flow
-      // m_dot = Cd * A * sqrt(2 * rho * p_up * (γ/(γ-1)) *
-      //         [(p_down/p_up)^(2/γ) - (p_down/p_up)^((γ+1)/γ)])
-      double term1 = std::pow(pressure_ratio, 2.0 / GAMMA);
-      double term2 = std::pow(pressure_ratio, (GAMMA + 1.0) / GAMMA);
-      double flow_term =
-          std::sqrt(2.0 * GAMMA / (GAMMA - 1.0) * (term1 - term2));
-      mass_flow = Cd * area * rho_upstream *
-                  std::sqrt(2.0 * p_upstream / rho_upstream) * flow_term;
+      d_up = k * std::sqrt(GAMMA) * choke_factor;
+      return d_up * p_upstream;
     }
 
-    return mass_flow;
+    if (r >= 1.0 - LINEAR_BAND) {
+      double g = k * subsonic_factor(1.0 - LINEAR_BAND) / LINEAR_BAND;
+      d_up = g;
+      d_down = -g;
+      return g * (p_upstream - p_downstream);
+    }
+
+    // Subsonic flow
+    // m_dot = Cd * A * sqrt(2 * rho * p_up * (γ/(γ-1)) *
+    //         [(p_down/p_up)^(2/γ) - (p_down/p_up)^((γ+1)/γ)])
+    double s = subsonic_factor(r);
+    double dphi = 2.0 / GAMMA * std::pow(r, 2.0 / GAMMA - 1.0) -
+                  (GAMMA + 1.0) / GAMMA * std::pow(r, 1.0 / GAMMA);
+    double ds = GAMMA / (GAMMA - 1.0) * dphi / s;
+    d_up = k * (s - r * ds);
+    d_down = k * ds;
+    return k * p_upstream * s;
+  }
+
+  /** @brief Calculate mass flow through an orifice (see orifice_flow). */
+  static double calculate_mass_flow(double p_upstream, double p_downstream,
+                                    double T_upstream, double area, double Cd) {
+    double d_up, d_down;
+    return orifice_flow(p_upstream, p_downstream, T_upstream, area, Cd, d_up,
+                        d_down);
   }
 
   static double calculate_velocity(double mass_flow, double density,
@@ -148,192 +178,140 @@ public:
     return std::sqrt(breach_constants::GAMMA * breach_constants::R_AIR *
                      temperature);
   }
+
+private:
+  // sqrt(2γ/(γ-1) * (r^(2/γ) - r^((γ+1)/γ)))
+  static double subsonic_factor(double r) {
+    using breach_constants::GAMMA;
+    double phi = std::pow(r, 2.0 / GAMMA) - std::pow(r, (GAMMA + 1.0) / GAMMA);
+    return std::sqrt(2.0 * GAMMA / (GAMMA - 1.0) * std::max(phi, 0.0));
+  }
 };
 
 // ============================================================================
 // BREACH PROPAGATION SYSTEM
 // ============================================================================
 
+/**
+ * @brief Compartments joined by breaches, as an integer-indexed graph.
+ *
+ * Compartments and breaches live in dense arrays; string ids are resolved
+ * once per topology change into a CSR list of each compartment's breaches.
+ * step() advances compartment masses with backward Euler, solving for the
+ * new pressures by Newton's method. The Jacobian has the graph's sparsity,
+ * so its LU pattern is analysed once per topology change and refactorized
+ * per iteration. Stable at any dt, where explicit choked flow overshoots
+ * once dt exceeds a compartment's time constant. A compartment never drains
+ * below MIN_MASS; one held at that floor counts as solved.
+ */
 class BreachPropagationSystem {
 public:
-  void add_compartment(const Compartment &comp) {
-    compartments_[comp.id] = comp;
-  }
+  struct Config {
+    int max_newton_iterations = 20;
+    double tolerance = 1e-9; // Mass residual relative to compartment mass
+  };
 
-  void add_breach(const Breach &breach) { breaches_.push_back(breach); }
-
-  void create_hull_breach(const std::string &compartment_id, double area) {
-    Breach breach;
-    breach.id = compartment_id + "_hull";
-    breach.type = BreachType::HULL_BREACH;
-    breach.compartment_a = compartment_id;
-    breach.compartment_b = ""; // Vacuum
-    breach.area = area;
-    breach.discharge_coeff = 0.8; // Sharp-edged orifice
-    breach.is_open = true;
-    breaches_.push_back(breach);
-  }
+  /** @brief A compartment's breach and the compartment across it. */
+  struct Link {
+    uint32_t breach;
+    uint32_t other; // NONE for vacuum
+  };
 
-  void open_door(const std::string &breach_id) {
-    for (auto &b : breaches_) {
-      if (b.id == breach_id)
-        b.is_open = true;
-    }
-  }
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
 
-  void close_door(const std::string &breach_id) {
-    for (auto &b : breaches_) {
-      if (b.id == breach_id)
-        b.is_open = false;
-    }
-  }
+  BreachPropagationSystem() { config_ = Config{}; }
+  explicit BreachPropagationSystem(const Config &config) : config_(config) {}
+
+  /** @brief Add a compartment, or replace the one with this id. */
+  uint32_t add_compartment(const Compartment &comp);
 
   /**
-   * @brief Update all breaches and compartments.
-   * @param dt Time step (seconds)
+   * @brief Add a breach. An endpoint naming no compartment, now or when the
+   * next step() runs, is vacuum.
    */
-  void step(double dt) {
-    // Update growing breaches
-    for (auto &breach : breaches_) {
-      if (breach.is_growing && breach.growth_rate > 0.0) {
-        breach.area += breach.growth_rate * dt;
-      }
-    }
+  uint32_t add_breach(const Breach &breach);
 
-    // Calculate flow through each breach
-    for (auto &breach : breaches_) {
-      if (!breach.is_open) {
-        breach.mass_flow_rate = 0.0;
-        breach.velocity = 0.0;
-        breach.is_choked = false;
-        continue;
-      }
-
-      auto *comp_a = get_compartment(breach.compartment_a);
-      auto *comp_b = get_compartment(breach.compartment_b);
-
-      double p_a = comp_a ? comp_a->pressure : breach_constants::SPACE_PRESSURE;
-      double p_b = comp_b ? comp_b->pressure : breach_constants::SPACE_PRESSURE;
-      double T_a = comp_a ? comp_a->temperature : 293.0;
-      double T_b = comp_b ? comp_b->temperature : 293.0;
-
-      // Determine flow direction
-      double p_up, p_down, T_up;
-      int direction;
-      if (p_a >= p_b) {
-        p_up = p_a;
-        p_down = p_b;
-        T_up = T_a;
-        direction = 1;
-      } else {
-        p_up = p_b;
-        p_down = p_a;
-        T_up = T_b;
-        direction = -1;
-      }
-
-      // Calculate mass flow
-      double mass_flow = BreachFlowCalculator::calculate_mass_flow(
-          p_up, p_down, T_up, breach.area, breach.discharge_coeff);
-
-      breach.mass_flow_rate = mass_flow * direction;
-
-      // Check if choked
-      breach.is_choked = (p_down / p_up) <= breach_constants::CRITICAL_RATIO;
-
-      // Calculate velocity
-      double rho_up = p_up / (breach_constants::R_AIR * T_up);
-      breach.velocity = BreachFlowCalculator::calculate_velocity(
-          mass_flow, rho_up, breach.area);
-    }
+  uint32_t create_hull_breach(const std::string &compartment_id, double area);
 
-    // Apply mass changes to compartments
-    for (auto &breach : breaches_) {
-      if (!breach.is_open || breach.mass_flow_rate == 0.0)
-        continue;
+  void open_door(const std::string &breach_id);
+  void close_door(const std::string &breach_id);
+  void set_open(uint32_t breach, bool open) { breaches_[breach].is_open = open; }
 
-      auto *comp_a = get_compartment(breach.compartment_a);
-      auto *comp_b = get_compartment(breach.compartment_b);
-
-      double dm = breach.mass_flow_rate * dt;
-
-      if (comp_a) {
-        update_compartment_mass(*comp_a, -dm);
-      }
-      if (comp_b) {
-        update_compartment_mass(*comp_b, dm);
-      }
-    }
-  }
+  /**
+   * @brief Update all breaches and compartments.
+   * @param dt Time step (seconds)
+   */
+  void step(double dt);
 
   // === Accessors ===
 
-  Compartment *get_compartment(const std::string &id) {
-    if (id.empty())
-      return nullptr;
-    auto it = compartments_.find(id);
-    return it != compartments_.end() ? &it->second : nullptr;
-  }
+  /** @return Index of the compartment or breach with this id, or NONE. */
+  uint32_t find_compartment(const std::string &id) const;
+  uint32_t find_breach(const std::string &id) const;
 
-  const Compartment *get_compartment(const std::string &id) const {
-    if (id.empty())
-      return nullptr;
-    auto it = compartments_.find(id);
-    return it != compartments_.end() ? &it->second : nullptr;
-  }
+  Compartment *get_compartment(const std::string &id);
+  const Compartment *get_compartment(const std::string &id) const;
 
+  const std::vector<Compartment> &compartments() const { return compartments_; }
+  Compartment &compartment(uint32_t i) { return compartments_[i]; }
+
+  // Breach endpoints are fixed once added; area and open state may change
   const std::vector<Breach> &breaches() const { return breaches_; }
   std::vector<Breach> &breaches() { return breaches_; }
 
-  double total_leak_rate() const {
-    double total = 0.0;
-    for (const auto &b : breaches_) {
-      if (b.compartment_b.empty()) { // Leak to vacuum
-        total += std::abs(b.mass_flow_rate);
-      }
-    }
-    return total;
-  }
-
-  double time_to_critical_pressure(const std::string &comp_id,
-                                   double critical_pressure = 50000.0) const {
-    const auto *comp = get_compartment(comp_id);
-    if (!comp)
-      return 0.0;
+  /** @brief Breaches touching compartment i. */
+  std::span<const Link> links(uint32_t i) const;
 
-    double current_mass = comp->mass();
-    double leak_rate = 0.0;
+  double total_leak_rate() const;
 
-    for (const auto &b : breaches_) {
-      if (b.compartment_a == comp_id && b.compartment_b.empty()) {
-        leak_rate += std::abs(b.mass_flow_rate);
-      }
-    }
-
-    if (leak_rate <= 0.0)
-      return std::numeric_limits<double>::infinity();
+  double time_to_critical_pressure(const std::string &comp_id,
+                                   double critical_pressure = 50000.0) const;
 
-    // Simplified linear estimate
-    double critical_mass = critical_pressure * comp->volume /
-                           (breach_constants::R_AIR * comp->temperature);
-    double mass_to_lose = current_mass - critical_mass;
+  /** @brief Newton iterations the last step() took. */
+  int last_newton_iterations() const { return last_iterations_; }
 
-    return mass_to_lose / leak_rate;
-  }
+  /**
+   * @brief Whether the last step() met the tolerance. If not (iteration
+   * limit, stalled line search or singular Jacobian), pressures are the
+   * last accepted iterate and last_residual() says how far off they are.
+   */
+  bool last_converged() const { return last_error_ <= config_.tolerance; }
+  double last_residual() const { return last_error_; }
 
 private:
-  std::unordered_map<std::string, Compartment> compartments_;
-  std::vector<Breach> breaches_;
+  Config config_;
 
-  void update_compartment_mass(Compartment &comp, double dm) {
-    double old_mass = comp.mass();
-    double new_mass = std::max(0.001, old_mass + dm);
-
-    // Update pressure (isothermal assumption for simplicity)
-    comp.pressure =
-        new_mass * breach_constants::R_AIR * comp.temperature / comp.volume;
-    comp.pressure = std::max(0.0, comp.pressure);
-  }
+  std::vector<Compartment> compartments_;
+  std::unordered_map<std::string, uint32_t> compartment_index_;
+  std::vector<Breach> breaches_;
+  std::unordered_map<std::string, uint32_t> breach_index_;
+
+  // Graph, resolved lazily after compartments or breaches are added
+  mutable bool topology_dirty_ = true;
+  mutable std::vector<uint32_t> end_a_, end_b_; // NONE = vacuum
+  mutable std::vector<uint32_t> link_start_;    // CSR offsets, n + 1
+  mutable std::vector<Link> links_;
+
+  // Newton solve; Jacobian values are written through fixed offsets
+  struct Slots {
+    int aa, ab, ba, bb; // -1 where an end is vacuum
+  };
+  mutable bool pattern_dirty_ = true;
+  std::vector<int> diag_slot_;
+  std::vector<Slots> slots_;
+  Eigen::SparseMatrix<double> jacobian_;
+  Eigen::SparseLU<Eigen::SparseMatrix<double>> solver_;
+  Eigen::VectorXd p_old_, p_, p_trial_, residual_, delta_;
+  std::vector<double> capacity_; // kg per Pa: V / (R T)
+  std::vector<uint8_t> held_;    // Per compartment: held at MIN_MASS
+  int last_iterations_ = 0;
+  double last_error_ = 0.0; // Relative mass residual after the last step()
+
+  void update_topology() const;
+  void build_pattern();
+  double signed_flow(uint32_t b, const Eigen::VectorXd &p, double &d_a,
+                     double &d_b) const;
+  double evaluate(const Eigen::VectorXd &p, double dt, bool with_jacobian);
 };
 
 } // namespace fluids
@@ -19,6 +19,7 @@
 #include <vector>
 
 #include <isolated/core/constants.hpp>
+#include <isolated/core/field_registry.hpp>
 #include <isolated/fluids/lattice.hpp>
 #include <isolated/fluids/lbm_cuda.cuh>
 
@@ -85,6 +86,14 @@ public:
   std::array<double, 3> get_velocity(size_t x, size_t y, size_t z) const;
   double get_species_density(const std::string &name, size_t x, size_t y,
                              size_t z) const;
+  // Add a source (e.g. combustion) to a species; clamped at zero
+  void add_species_density(const std::string &name, size_t x, size_t y,
+                           size_t z, double delta);
+
+  // Publish rho, velocity and species fields ("fluid.density", "fluid.ux",
+  // ..., "fluid.species.<name>") for other engines to read in place; each
+  // step() then bumps their versions
+  void publish_fields(core::FieldRegistry &registry);
 
   // Stability
   double compute_cfl() const;
@@ -124,6 +133,10 @@ private:
   std::vector<GasSpecies> species_;
   std::unordered_map<std::string, std::vector<double>> species_density_;
 
+  // Field publication (not owned)
+  core::FieldRegistry *registry_ = nullptr;
+  std::vector<core::FieldRegistry::FieldId> field_ids_;
+
   // Relaxation parameters
   std::vector<double> tau_;  // Relaxation times (MRT)
   std::vector<double> nu_t_; // Turbulent viscosity (LES)
@@ -138,6 +151,7 @@ private:
   double compute_equilibrium(int q, double rho, double ux, double uy,
                              double uz) const;
   void compute_turbulent_viscosity();
+  void mark_fields_written();
 };
 
 // === Inline implementations ===
@@ -5,6 +5,8 @@
  * @brief Multi-phase physics: condensation, aerosols, and combustion.
  */
 
+#include <isolated/core/field_registry.hpp>
+#include <isolated/perf/cache_friendly.hpp>
 #include <array>
 #include <cmath>
 #include <cstdint>
@@ -21,6 +23,10 @@ namespace fluids {
 
 /**
  * @brief Water vapor phase change system using Magnus-Tetens equation.
+ *
+ * Saturation density comes from the batched kernels in
+ * thermal/psychrometrics.hpp; the exchange itself is one parallel loop.
+ * Vapor, liquid and the exchanged amounts are densities (kg/m³).
  */
 class PhaseChangeSystem {
 public:
@@ -38,8 +44,8 @@ public:
 
   PhaseChangeSystem(size_t nx, size_t ny, const Config &config);
 
-  StepResult step(double dt, const std::vector<double> &h2o_density,
-                  const std::vector<double> &temperature);
+  StepResult step(double dt, core::FieldView<const double> h2o_density,
+                  core::FieldView<const double> temperature);
 
   const std::vector<double> &get_vapor_change() const { return vapor_change_; }
   const std::vector<double> &get_liquid_water() const { return liquid_water_; }
@@ -52,11 +58,8 @@ private:
   std::vector<double> liquid_water_;
   std::vector<double> vapor_change_;
   std::vector<double> rh_;
-
-  // Magnus-Tetens saturation vapor pressure
-  static double saturation_pressure(double temp_c) {
-    return 6.1094 * std::exp((17.625 * temp_c) / (temp_c + 243.04));
-  }
+  std::vector<double> saturation_density_;
+  std::vector<double> gathered_temperature_; // Only for strided input
 };
 
 // ============================================================================
@@ -65,16 +68,24 @@ private:
 
 enum class ParticleType : uint8_t { SMOKE = 0, DUST = 1, ASH = 2, DROPLET = 3 };
 
-struct Particle {
-  float x, y;
-  float vx = 0, vy = 0;
-  float mass = 1e-9f;     // kg
-  float lifetime = 60.0f; // seconds
-  ParticleType type = ParticleType::SMOKE;
-};
-
 /**
  * @brief Lagrangian aerosol particle system.
+ *
+ * Particles live in a structure-of-arrays layout and are stepped by one
+ * parallel loop: fluid velocity is interpolated bilinearly from the cell
+ * centres around each particle, and Brownian kicks come from a
+ * counter-based (Philox) generator keyed on the particle's slot and the
+ * step number, so results don't depend on thread count or scheduling.
+ *
+ * Each step ends with a parallel counting sort of the particles by cell,
+ * the same two-pass scheme as entities::SpatialIndex. The sort drops
+ * expired particles, leaves each cell's particles contiguous for the next
+ * advection pass, and yields the per-cell fields in one sweep:
+ * concentration, mass-weighted mean velocity, and mass deposited on solid
+ * cells. Particles that enter a solid cell deposit there. A step costs
+ * O(particles + cells): the fields are dense, and the sort runs on no
+ * more threads than there are particles per cell, so its per-thread
+ * bucket counts stay within that bound on sparse grids.
  */
 class AerosolSystem {
 public:
@@ -82,7 +93,8 @@ public:
     double gravity = 9.81;
     double drag_coefficient = 0.47;
     double brownian_diffusion = 1e-5;
-    size_t max_particles = 10000;
+    size_t max_particles = 2000000;
+    uint64_t seed = 42;
   };
 
   AerosolSystem(size_t nx, size_t ny, const Config &config);
@@ -90,28 +102,83 @@ public:
   void spawn_particles(float x, float y, size_t count = 10,
                        ParticleType type = ParticleType::SMOKE);
 
-  void step(double dt, const std::vector<double> &fluid_ux,
-            const std::vector<double> &fluid_uy,
-            const std::vector<uint8_t> &solid);
+  void step(double dt, core::FieldView<const double> fluid_ux,
+            core::FieldView<const double> fluid_uy,
+            core::FieldView<const uint8_t> solid);
 
-  const std::vector<Particle> &get_particles() const { return particles_; }
+  /** Particle type is stored as the ParticleType value. */
+  const perf::SoAParticles<float> &get_particles() const { return particles_; }
   size_t particle_count() const { return particles_.size(); }
 
+  /**
+   * @brief After step(), cell i's particles are [start[i], start[i + 1]).
+   * Particles spawned since are not included.
+   */
+  const std::vector<uint32_t> &get_cell_start() const { return cell_start_; }
+
+  /** Particle mass per cell (kg) as of the last step. */
+  const std::vector<double> &get_concentration() const { return concentration_; }
+  /** Mass-weighted mean particle velocity per cell; 0 where empty. */
+  const std::vector<double> &get_velocity_x() const { return velocity_x_; }
+  const std::vector<double> &get_velocity_y() const { return velocity_y_; }
+  /** Mass (kg) deposited on each solid cell since construction. */
+  const std::vector<double> &get_deposited() const { return deposited_; }
+
 private:
-  size_t nx_, ny_;
+  size_t nx_, ny_, n_cells_;
   Config config_;
-  std::vector<Particle> particles_;
-  std::mt19937 rng_{42};
+  perf::SoAParticles<float> particles_;
+  perf::SoAParticles<float> sorted_; // Scatter target, swapped in
+  std::vector<uint32_t> cell_;       // Per particle: destination code
+  std::vector<uint32_t> sorted_cell_;
+  std::vector<uint32_t> counts_;     // Per thread and bucket
+  std::vector<uint32_t> cell_start_; // CSR offsets, cells + 2 (last: removed)
+  std::vector<double> concentration_;
+  std::vector<double> velocity_x_;
+  std::vector<double> velocity_y_;
+  std::vector<double> deposited_;
+  uint64_t steps_ = 0;   // RNG counter for step()
+  uint64_t spawned_ = 0; // RNG counter for spawn_particles()
 
   size_t idx(size_t x, size_t y) const { return x + nx_ * y; }
+
+  // Fluid velocity at (x, y), bilinear between cell centres
+  float sample(core::FieldView<const double> field, float x, float y) const;
+
+  // Counting sort by cell_, then rebuild the fields and drop the removed
+  void sort_and_bin();
 };
 
 // ============================================================================
 // COMBUSTION SYSTEM (Fire Model)
 // ============================================================================
 
+/**
+ * @brief Heat and gas exchange of one burning cell over one step.
+ */
+struct CombustionSource {
+  uint32_t cell;      // x + nx * y
+  double heat;        // J released
+  double o2_change;   // Negative: O2 consumed
+  double co2_change;  // CO2 produced
+  size_t smoke_count; // Particles emitted
+};
+
 /**
  * @brief Simple combustion model with fuel, O2 consumption, and heat release.
+ *
+ * Only the active front is visited: the burning cells, plus candidate
+ * cells that could ignite. Candidates are the fuel-bearing neighbours of
+ * burning cells (8-connected), cells given fuel or ignited since the last
+ * step, and cells passed to add_candidate(). A cell that goes out for lack
+ * of O2 smoulders: it is checked for ignition every step until it has
+ * re-ignited or its fuel is gone. A step costs in proportion to the fire,
+ * not the map, so a fuel cell heated by something other than fire only
+ * ignites if it is made a candidate.
+ *
+ * Outputs are a sparse list of sources, one per cell that burned this
+ * step, for the thermal engine, the LBM species fields and the aerosol
+ * system to apply directly.
  */
 class CombustionSystem {
 public:
@@ -136,27 +203,51 @@ public:
   void add_fuel(size_t x, size_t y, double amount_kg);
   void ignite(size_t x, size_t y);
 
-  StepResult step(double dt, const std::vector<double> &o2_density,
-                  const std::vector<double> &temperature,
+  /** Check (x, y) for ignition on the next step. */
+  void add_candidate(size_t x, size_t y);
+
+  /**
+   * @brief Ignite candidates, then burn every burning cell.
+   * @param aerosol If set, smoke is spawned into it directly
+   */
+  StepResult step(double dt, core::FieldView<const double> o2_density,
+                  core::FieldView<const double> temperature,
                   AerosolSystem *aerosol = nullptr);
 
-  const std::vector<double> &get_heat_output() const { return heat_output_; }
+  /** Sources from the last step, one per cell that burned. */
+  const std::vector<CombustionSource> &get_sources() const { return sources_; }
+
   const std::vector<double> &get_fuel() const { return fuel_; }
-  const std::vector<bool> &get_burning() const { return burning_; }
+  /** Cells burning now, in no particular order. */
+  const std::vector<uint32_t> &get_burning_cells() const { return burning_cells_; }
+  bool is_burning(size_t x, size_t y) const {
+    return flags_[idx(x, y)] & BURNING;
+  }
+  /** Cells put out by lack of O2 that still have fuel. */
+  const std::vector<uint32_t> &get_smouldering_cells() const { return smouldering_; }
 
 private:
+  static constexpr uint8_t BURNING = 1;
+  static constexpr uint8_t CANDIDATE = 2;
+  static constexpr uint8_t SMOULDERING = 4;
+
   size_t nx_, ny_, n_cells_;
   Config config_;
 
   std::vector<double> fuel_;
-  std::vector<bool> burning_;
-  std::vector<double> heat_output_;
-  std::vector<double> o2_change_;
-  std::vector<double> co2_change_;
+  std::vector<uint8_t> flags_; // BURNING | CANDIDATE | SMOULDERING per cell
+  std::vector<uint32_t> burning_cells_;
+  std::vector<uint32_t> candidates_;
+  std::vector<uint32_t> smouldering_;
+  std::vector<CombustionSource> sources_;
 
   std::mt19937 rng_{42};
 
   size_t idx(size_t x, size_t y) const { return x + nx_ * y; }
+
+  void mark_candidate(size_t cell);
+  bool can_ignite(uint32_t cell, core::FieldView<const double> o2_density,
+                  core::FieldView<const double> temperature) const;
 };
 
 } // namespace fluids
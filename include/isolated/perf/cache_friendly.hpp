@@ -117,6 +117,7 @@ template <typename T = float> struct SoAParticles {
   AlignedVector<T> vx, vy, vz; // Velocity
   AlignedVector<T> mass;
   AlignedVector<T> radius;
+  AlignedVector<T> lifetime;   // Seconds left
   AlignedVector<uint32_t> type;
 
   void resize(size_t n) {
@@ -128,9 +129,25 @@ template <typename T = float> struct SoAParticles {
     vz.resize(n);
     mass.resize(n);
     radius.resize(n);
+    lifetime.resize(n);
     type.resize(n);
   }
 
+  void reserve(size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+    vx.reserve(n);
+    vy.reserve(n);
+    vz.reserve(n);
+    mass.reserve(n);
+    radius.reserve(n);
+    lifetime.reserve(n);
+    type.reserve(n);
+  }
+
+  void clear() { resize(0); }
+
   size_t size() const { return x.size(); }
 };
 
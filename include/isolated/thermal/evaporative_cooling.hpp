@@ -11,6 +11,7 @@
  * - Cooling power estimation
  */
 
+#include <isolated/thermal/psychrometrics.hpp>
 #include <algorithm>
 #include <cmath>
 
@@ -21,39 +22,8 @@ namespace thermal {
 // PSYCHROMETRIC CALCULATIONS
 // ============================================================================
 
-/**
- * @brief Saturation vapor pressure (Magnus formula).
- * @param T Temperature in Celsius
- * @return Saturation vapor pressure in Pa
- */
-inline double saturation_vapor_pressure(double T) {
-  // Magnus formula (accurate for -40 to 50°C)
-  return 610.78 * std::exp(17.27 * T / (T + 237.3));
-}
-
-/**
- * @brief Relative humidity from vapor pressure.
- * @param p_vapor Actual vapor pressure (Pa)
- * @param T Temperature (°C)
- * @return Relative humidity (0-1)
- */
-inline double relative_humidity(double p_vapor, double T) {
-  double p_sat = saturation_vapor_pressure(T);
-  return std::clamp(p_vapor / p_sat, 0.0, 1.0);
-}
-
-/**
- * @brief Dew point temperature.
- * @param T Temperature (°C)
- * @param RH Relative humidity (0-1)
- * @return Dew point (°C)
- */
-inline double dew_point(double T, double RH) {
-  if (RH <= 0.0)
-    return -273.15; // Absolute zero approx
-  double alpha = std::log(RH) + 17.27 * T / (T + 237.3);
-  return 237.3 * alpha / (17.27 - alpha);
-}
+// Saturation pressure, relative humidity and dew point live in
+// psychrometrics.hpp, shared with the phase-change field kernels.
 
 /**
  * @brief Wet-bulb temperature (iterative solve).
@@ -93,8 +63,8 @@ public:
     double mass_transfer_coeff = 0.01; // kg/(m²·s) typical
   };
 
-  explicit EvaporativeCooling(const Config &config = Config{})
-      : config_(config) {}
+  EvaporativeCooling() { config_ = Config{}; }
+  explicit EvaporativeCooling(const Config &config) : config_(config) {}
 
   /**
    * @brief Calculate evaporation from a wet surface.
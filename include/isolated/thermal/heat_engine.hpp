@@ -18,6 +18,7 @@
 #include <vector>
 
 #include <isolated/core/constants.hpp>
+#include <isolated/core/field_registry.hpp>
 #include <isolated/thermal/materials.hpp>
 #include <isolated/thermal/thermal_cuda.cuh>
 
@@ -90,6 +91,19 @@ public:
   // Fluid coupling
   void set_fluid_velocity(size_t x, size_t y, size_t z, double ux, double uy);
 
+  /**
+   * @brief Advect with velocity fields owned elsewhere (e.g. the LBM's
+   * "fluid.ux"/"fluid.uy"), read in place each step instead of copied in
+   * per cell. The views must cover every cell and outlive their use here;
+   * set_fluid_velocity() no longer has an effect once bound.
+   * @throws std::invalid_argument on a size mismatch
+   */
+  void bind_fluid_velocity(core::FieldView<const double> ux,
+                           core::FieldView<const double> uy);
+
+  // Publish "thermal.temperature"; each step() then bumps its version
+  void publish_fields(core::FieldRegistry &registry);
+
 private:
   ThermalConfig config_;
   size_t n_cells_;
@@ -122,8 +136,13 @@ private:
   std::unordered_map<std::tuple<size_t, size_t, size_t>, double, CoordHash>
       equipment_heat_;
 
-  // Fluid velocity for convection
+  // Fluid velocity for convection: our own buffers unless bound elsewhere
   std::vector<double> fluid_ux_, fluid_uy_;
+  core::FieldView<const double> ux_view_, uy_view_;
+
+  // Field publication (not owned)
+  core::FieldRegistry *registry_ = nullptr;
+  core::FieldRegistry::FieldId temperature_id_ = 0;
 
   // Reusable temp buffers (avoid heap allocation in hot loops)
   std::vector<double> temp_buffer_;
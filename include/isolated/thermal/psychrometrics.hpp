@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * @file psychrometrics.hpp
+ * @brief Moist-air properties, per value and batched over whole fields.
+ *
+ * Saturation vapour pressure uses the Magnus form with the
+ * Alduchov-Eskridge (1996) coefficients, within 0.4% of the Goff-Gratch
+ * reference from -40 to 50 C. The batched kernels run as one OpenMP
+ * parallel SIMD loop and use fast_exp()/fast_log(), whose error is far
+ * below the Magnus fit's own.
+ */
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace isolated {
+namespace thermal {
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+namespace psychro {
+constexpr double MAGNUS_A = 17.625;
+constexpr double MAGNUS_B = 243.04;  // C
+constexpr double MAGNUS_E0 = 610.94; // Pa, saturation pressure at 0 C
+constexpr double R_VAPOR = 461.5;    // J/(kg K)
+constexpr double KELVIN = 273.15;
+} // namespace psychro
+
+// ============================================================================
+// FAST TRANSCENDENTALS
+// ============================================================================
+
+/**
+ * @brief exp(x) by range reduction to |r| <= ln2 / 2 and a degree-7
+ * Taylor polynomial. Relative error below 1e-8 for |x| <= 708; x is
+ * clamped to that range. Branch-free, so loops over it vectorize.
+ */
+inline double fast_exp(double x) {
+  constexpr double LOG2E = 1.4426950408889634;
+  constexpr double LN2_HI = 0.693145751953125;
+  constexpr double LN2_LO = 1.42860682030941723212e-6;
+  // Adding this rounds x * log2(e) to an integer and leaves k + 1023 in
+  // the low mantissa bits, ready to shift into an exponent field
+  constexpr double SHIFTER = 0x1.8p52 + 1023.0;
+
+  x = x < -708.0 ? -708.0 : (x > 708.0 ? 708.0 : x);
+  double t = x * LOG2E + SHIFTER;
+  double k = t - SHIFTER;
+  double r = x - k * LN2_HI - k * LN2_LO;
+
+  double p = 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+
+  double scale = std::bit_cast<double>(std::bit_cast<uint64_t>(t) << 52);
+  return p * scale;
+}
+
+/**
+ * @brief Natural log for positive normal x, via the exponent bits and an
+ * atanh series on the mantissa scaled into [sqrt(1/2), sqrt(2)]. Relative
+ * error below 1e-9. Branch-free.
+ */
+inline double fast_log(double x) {
+  constexpr double LN2 = 0.6931471805599453;
+  constexpr double SQRT2 = 1.4142135623730951;
+  constexpr uint64_t MANTISSA = (uint64_t{1} << 52) - 1;
+  constexpr uint64_t ONE = uint64_t{1023} << 52;
+
+  uint64_t bits = std::bit_cast<uint64_t>(x);
+  double m = std::bit_cast<double>((bits & MANTISSA) | ONE); // [1, 2)
+  // Exponent as a double without an integer conversion
+  double e = std::bit_cast<double>((bits >> 52) | 0x4330000000000000ull) -
+             0x1p52 - 1023.0;
+  bool high = m > SQRT2;
+  m = high ? 0.5 * m : m;
+  e = high ? e + 1.0 : e;
+
+  double s = (m - 1.0) / (m + 1.0);
+  double s2 = s * s;
+  double p = 1.0 / 11.0;
+  p = p * s2 + 1.0 / 9.0;
+  p = p * s2 + 1.0 / 7.0;
+  p = p * s2 + 1.0 / 5.0;
+  p = p * s2 + 1.0 / 3.0;
+  p = p * s2 + 1.0;
+  return 2.0 * s * p + e * LN2;
+}
+
+// ============================================================================
+// SINGLE VALUES
+// ============================================================================
+
+/**
+ * @brief Saturation vapor pressure (Magnus formula).
+ * @param T Temperature in Celsius
+ * @return Saturation vapor pressure in Pa
+ */
+inline double saturation_vapor_pressure(double T) {
+  using namespace psychro;
+  return MAGNUS_E0 * fast_exp(MAGNUS_A * T / (T + MAGNUS_B));
+}
+
+/**
+ * @brief Relative humidity from vapor pressure.
+ * @param p_vapor Actual vapor pressure (Pa)
+ * @param T Temperature (°C)
+ * @return Relative humidity (0-1)
+ */
+inline double relative_humidity(double p_vapor, double T) {
+  double rh = p_vapor / saturation_vapor_pressure(T);
+  return rh < 0.0 ? 0.0 : (rh > 1.0 ? 1.0 : rh);
+}
+
+/**
+ * @brief Dew point temperature.
+ * @param T Temperature (°C)
+ * @param RH Relative humidity (0-1)
+ * @return Dew point (°C)
+ */
+inline double dew_point(double T, double RH) {
+  using namespace psychro;
+  if (RH <= 0.0)
+    return -KELVIN; // Absolute zero approx
+  double alpha = fast_log(RH) + MAGNUS_A * T / (T + MAGNUS_B);
+  return MAGNUS_B * alpha / (MAGNUS_A - alpha);
+}
+
+// ============================================================================
+// BATCHED FIELDS
+// ============================================================================
+
+// Temperatures here are in Kelvin and vapor amounts are densities (kg/m³),
+// as the thermal and LBM fields store them. Output may not alias input.
+
+/** p_sat[i] (Pa) at temperature_k[i]. */
+void saturation_vapor_pressure(const double *temperature_k, double *p_sat,
+                               size_t n);
+
+/** Vapor density at saturation (kg/m³), by the ideal gas law. */
+void saturation_vapor_density(const double *temperature_k, double *rho_sat,
+                              size_t n);
+
+/**
+ * @brief Relative humidity (fraction). Not clamped: values above 1 are
+ * supersaturation, which drives condensation.
+ */
+void relative_humidity(const double *vapor_density,
+                       const double *temperature_k, double *rh, size_t n);
+
+/** Dew point (K); 0 where there is no vapor. */
+void dew_point(const double *vapor_density, const double *temperature_k,
+               double *dew_point_k, size_t n);
+
+} // namespace thermal
+} // namespace isolated
@@ -139,6 +139,7 @@ struct Chunk {
     // Terrain data (static after generation)
     std::vector<Material> material;     // 64³ = 262K bytes
     std::vector<uint16_t> strata_age;   // Geological layer age (millions of years)
+    std::vector<uint8_t> light;         // Light level 0-MAX_LIGHT (LightField)
     
     // Physics data (dynamic, updated each step)
     std::vector<double> temperature;    // Kelvin
@@ -169,6 +170,7 @@ struct Chunk {
     void allocate() {
         material.resize(CHUNK_CELLS, Material::AIR);
         strata_age.resize(CHUNK_CELLS, 0);
+        light.resize(CHUNK_CELLS, 0);
         temperature.resize(CHUNK_CELLS, 293.0); // Room temp
         density.resize(CHUNK_CELLS, 1.225);     // Air
         pressure.resize(CHUNK_CELLS, 101325.0); // 1 atm
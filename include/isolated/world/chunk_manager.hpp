@@ -54,6 +54,12 @@ public:
      */
     Chunk* get_chunk_at(ChunkCoord coords);
     
+    /**
+     * @brief Get chunk by chunk coordinates without loading it.
+     * @return Pointer to chunk, or nullptr if not loaded.
+     */
+    Chunk* find_chunk(ChunkCoord coords);
+    
     /**
      * @brief Get voxel at world coordinates.
      */
@@ -104,6 +110,18 @@ public:
     using TerrainGenerator = std::function<void(Chunk&)>;
     void set_terrain_generator(TerrainGenerator gen) { terrain_gen_ = gen; }
     
+    /**
+     * @brief Callbacks for derived fields (lighting, pathfinding).
+     * Material listeners run after set_material() changes a voxel; load
+     * listeners run once a chunk is loaded or generated and findable;
+     * unload listeners run just before a chunk is dropped.
+     */
+    using MaterialListener = std::function<void(int, int, int, Material old_mat, Material new_mat)>;
+    using ChunkListener = std::function<void(Chunk&)>;
+    void add_material_listener(MaterialListener fn) { material_listeners_.push_back(std::move(fn)); }
+    void add_load_listener(ChunkListener fn) { load_listeners_.push_back(std::move(fn)); }
+    void add_unload_listener(ChunkListener fn) { unload_listeners_.push_back(std::move(fn)); }
+    
     // Statistics
     size_t loaded_count() const { return loaded_chunks_.size(); }
 
@@ -121,6 +139,10 @@ private:
     // Terrain generator
     TerrainGenerator terrain_gen_;
     
+    std::vector<MaterialListener> material_listeners_;
+    std::vector<ChunkListener> load_listeners_;
+    std::vector<ChunkListener> unload_listeners_;
+    
     // Internal helpers
     ChunkCoord world_to_chunk(int world_x, int world_y, int world_z) const;
     void load_chunk(ChunkCoord coords);
@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * @file flow_field.hpp
+ * @brief Shared per-destination flow fields for crowds.
+ */
+
+#include <isolated/core/task_pool.hpp>
+#include <isolated/world/navigation.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace isolated {
+namespace world {
+
+/**
+ * @brief Cache of flow fields, one per destination voxel.
+ *
+ * A field is a BFS (unit-cost Dijkstra) from its goal over the NavGraph
+ * walk rules, out to max_distance steps. Every voxel it reaches stores the
+ * move that leads one step closer to the goal, so any number of walkers
+ * heading for the same airlock share one integration and each pays one
+ * lookup per step. Directions live in per-chunk byte arrays and only chunks
+ * the field reached get one.
+ *
+ * Fields are refcounted by goal: acquire() returns the existing field when
+ * another walker already heads there. Unreferenced fields stay cached, up
+ * to max_fields, and are evicted oldest first.
+ *
+ * update() repairs the graph, then rebuilds only fields that cover, or
+ * border, a chunk whose walk flags changed since the field was built. New
+ * and stale fields are rebuilt in parallel on the pool. A field reads as
+ * empty until its first build. next_step() only reads, so walkers can
+ * sample in parallel, but not while update() runs.
+ */
+class FlowFieldCache {
+public:
+    using FieldId = uint32_t;
+    static constexpr FieldId NO_FIELD = 0xFFFFFFFFu;
+
+    explicit FlowFieldCache(NavGraph& graph, core::TaskPool* pool = nullptr,
+                            size_t max_fields = 16, int max_distance = 256)
+        : graph_(graph), pool_(pool), max_fields_(max_fields), max_distance_(max_distance) {}
+
+    /**
+     * @brief Reference the field toward `goal`, creating it if needed. It is
+     * built by the next update().
+     */
+    FieldId acquire(VoxelPos goal);
+    void release(FieldId id);
+
+    /**
+     * @brief Repair the graph, evict and rebuild fields.
+     * @return Fields rebuilt.
+     */
+    size_t update();
+
+    /**
+     * @brief The voxel one step closer to the goal from `from`. Returns
+     * false at the goal, beyond the field's reach, or before its first build.
+     */
+    bool next_step(FieldId id, VoxelPos from, VoxelPos& to) const;
+
+    bool ready(FieldId id) const { return id < fields_.size() && fields_[id].built; }
+    bool at_goal(FieldId id, VoxelPos p) const { return id < fields_.size() && fields_[id].goal == p; }
+    size_t field_count() const { return by_goal_.size(); }
+
+private:
+    static constexpr uint8_t NO_STEP = 0xFF;
+    static constexpr uint8_t AT_GOAL = 0xFE;
+
+    struct Field {
+        VoxelPos goal{0, 0, 0};
+        uint32_t refs = 0;
+        bool live = false;
+        bool built = false;
+        uint64_t generation = 0;   // Graph generation the field is valid for
+        uint64_t released_at = 0;  // Eviction order once unreferenced
+        std::unordered_map<ChunkCoord, std::vector<uint8_t>, ChunkCoordHash> dirs;
+    };
+
+    NavGraph& graph_;
+    core::TaskPool* pool_;
+    size_t max_fields_;
+    int max_distance_;
+    uint64_t release_clock_ = 0;
+
+    std::vector<Field> fields_;
+    std::vector<FieldId> free_;
+    std::unordered_map<uint64_t, FieldId> by_goal_;
+    std::vector<FieldId> stale_;
+
+    bool is_stale(const Field& field) const;
+    void evict(FieldId id);
+    void build(Field& field) const;
+
+    static uint64_t pack(VoxelPos p);
+};
+
+} // namespace world
+} // namespace isolated
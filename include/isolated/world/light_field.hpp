@@ -0,0 +1,135 @@
+#pragma once
+
+/**
+ * @file light_field.hpp
+ * @brief Per-chunk voxel light levels from bioluminescence and lamps.
+ */
+
+#include <isolated/world/chunk_manager.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace isolated {
+namespace world {
+
+constexpr uint8_t MAX_LIGHT = 15;
+
+/**
+ * @brief Extra light lost when passing through a voxel of this material.
+ * Gases cost nothing beyond the 1-level step, water and ice dim light,
+ * everything else is opaque (LIGHT_OPAQUE).
+ */
+constexpr uint8_t LIGHT_OPAQUE = 0xFF;
+uint8_t light_opacity(Material mat);
+
+/**
+ * @brief Level a voxel of this material emits by itself (magma glows);
+ * 0 for most materials. Such voxels act as sources wherever they are.
+ */
+uint8_t light_emission(Material mat);
+
+/**
+ * @brief Flood-filled light field stored in Chunk::light.
+ *
+ * Light levels spread by breadth-first search: a neighbour of a cell at
+ * level L receives L - 1 - light_opacity(material), and the brightest
+ * contribution wins. Adding or removing a source, changing a material or
+ * loading a chunk updates the field incrementally with the usual two-queue
+ * scheme (darken everything the change could have lit, then refill from the
+ * boundary), so the cost is proportional to the volume whose light changes,
+ * at most (2 * MAX_LIGHT + 1)^3 cells per change. Lookups are a single
+ * array read.
+ *
+ * Light only spreads through loaded chunks. A chunk that loads is lit from
+ * its own sources and the faces of its loaded neighbours; light that reached
+ * other chunks through a chunk that is later unloaded stays as it was.
+ */
+class LightField {
+public:
+    struct Config {
+        double lux_per_level = 5.0;  // Illuminance of one light level
+    };
+
+    /**
+     * @brief Registers material, load and unload listeners on the chunk
+     * manager; the field must outlive its use by the manager.
+     */
+    explicit LightField(ChunkManager& chunks);
+    LightField(ChunkManager& chunks, const Config& config);
+
+    /**
+     * @brief Place or replace a light source (lamp, glowing organism).
+     * @param level Emitted level at the source cell, reach in cells.
+     */
+    void add_source(int x, int y, int z, uint8_t level);
+    void remove_source(int x, int y, int z);
+
+    /**
+     * @brief Relight after the material at (x, y, z) changed, e.g. when
+     * excavated. Called automatically for ChunkManager::set_material().
+     */
+    void on_material_changed(int x, int y, int z);
+
+    /**
+     * @brief Light a freshly loaded chunk. Called automatically on load.
+     */
+    void relight_chunk(Chunk& chunk);
+
+    uint8_t level_at(int x, int y, int z) const;
+    double lux_at(int x, int y, int z) const {
+        return level_at(x, y, z) * config_.lux_per_level;
+    }
+
+    /**
+     * @brief Source level whose centre illuminance is closest to `lux`.
+     */
+    uint8_t level_for_lux(double lux) const;
+
+    size_t source_count() const { return sources_.size(); }
+
+    // Cells visited by the most recent update (for profiling)
+    size_t last_update_cells() const { return last_update_cells_; }
+
+private:
+    struct Node {
+        int x, y, z;
+        uint8_t level;
+    };
+
+    // A voxel resolved to its loaded chunk
+    struct Cell {
+        Chunk* chunk = nullptr;
+        size_t idx = 0;
+
+        explicit operator bool() const { return chunk != nullptr; }
+        uint8_t& light() const { return chunk->light[idx]; }
+        Material material() const { return chunk->material[idx]; }
+    };
+
+    ChunkManager& chunks_;
+    Config config_;
+    std::unordered_map<uint64_t, uint8_t> sources_;  // Packed position -> level
+
+    // BFS queues, reused between updates
+    std::vector<Node> add_queue_;
+    std::vector<Node> remove_queue_;
+    size_t last_update_cells_ = 0;
+
+    // Single-entry chunk lookup cache; BFS neighbours are mostly in one
+    // chunk. Cleared when that chunk unloads.
+    mutable ChunkCoord cached_coord_{0, 0, 0};
+    mutable Chunk* cached_chunk_ = nullptr;
+
+    void attach();
+    Cell locate(int x, int y, int z) const;
+
+    static uint64_t pack(int x, int y, int z);
+    uint8_t source_level(int x, int y, int z, Material mat) const;
+
+    void darken(int x, int y, int z, uint8_t level);
+    void propagate();
+};
+
+} // namespace world
+} // namespace isolated
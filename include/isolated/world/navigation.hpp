@@ -0,0 +1,249 @@
+#pragma once
+
+/**
+ * @file navigation.hpp
+ * @brief Hierarchical (HPA*) pathfinding over loaded chunks.
+ */
+
+#include <isolated/core/task_pool.hpp>
+#include <isolated/world/chunk_manager.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace isolated {
+namespace world {
+
+struct VoxelPos {
+    int x, y, z;
+
+    bool operator==(const VoxelPos& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+/**
+ * @brief Walker moves: four horizontal directions, each level, a step up or
+ * a step down.
+ */
+struct NavMove {
+    int dx, dy, dz;
+};
+inline constexpr int NAV_MOVE_COUNT = 12;
+inline constexpr NavMove NAV_MOVES[NAV_MOVE_COUNT] = {
+    {1, 0, 0},  {-1, 0, 0},  {0, 1, 0},  {0, -1, 0},
+    {1, 0, 1},  {-1, 0, 1},  {0, 1, 1},  {0, -1, 1},
+    {1, 0, -1}, {-1, 0, -1}, {0, 1, -1}, {0, -1, -1},
+};
+
+/**
+ * @brief Walkers occupy gas voxels and stand on solid ones. Liquids are
+ * neither (no swimming); ice counts as solid.
+ */
+bool nav_passable(Material mat);
+bool nav_floor(Material mat);
+
+/**
+ * @brief HPA* navigation graph over the loaded chunks.
+ *
+ * A voxel is standable when it is passable and the voxel below is floor.
+ * A walker moves one voxel north, south, east or west, stepping up or down
+ * at most one level. Stepping up needs headroom above the walker, and
+ * stepping down needs the target column clear at the walker's height.
+ * Every move costs 1 and the move set is symmetric, so the graph is
+ * undirected.
+ *
+ * The abstract graph has one node per portal cell. Every chunk border
+ * crossing between two chunks is a transition. Transitions with the same
+ * step are grouped into contiguous runs, and each run contributes a portal
+ * pair every PORTAL_SPAN cells. Each chunk caches the BFS distance between
+ * every pair of its portals. A query:
+ * - links the start and goal to their chunks' portals by BFS;
+ * - runs A* over portals;
+ * - refines each hop into voxels inside one chunk.
+ *
+ * ChunkManager listeners mark chunks dirty:
+ * - set_material marks the changed voxel's chunk and the chunks above and
+ *   below it;
+ * - a chunk load marks the new chunk and the chunk above it;
+ * - a chunk unload drops the chunk's data and marks the chunk above it.
+ *
+ * repair() rebuilds only dirty chunks:
+ * - their walk flags and their portal pairs with each neighbour;
+ * - the distance tables of every chunk whose portal set changed.
+ * Voxels in unloaded chunks are not walkable.
+ *
+ * find_path() only reads the graph, so any number of threads may call it
+ * at once, as long as repair() and ChunkManager writes are not running.
+ */
+class NavGraph {
+public:
+    static constexpr int PORTAL_SPAN = 16;  // Max transitions per portal
+
+    /**
+     * @brief Registers chunk listeners; the graph must outlive their use.
+     * @param pool Optional pool for rebuilding distance tables in parallel
+     */
+    explicit NavGraph(ChunkManager& chunks, core::TaskPool* pool = nullptr);
+
+    /**
+     * @brief Rebuild dirty chunks. Not thread-safe with find_path().
+     * @return Chunks whose distance tables were rebuilt.
+     */
+    size_t repair();
+    size_t dirty_count() const { return dirty_.size(); }
+
+    /**
+     * @brief Shortest path (up to the portal abstraction) from start to
+     * goal, both ends included. Returns false if either end is not
+     * standable or no route exists through loaded chunks.
+     */
+    bool find_path(VoxelPos start, VoxelPos goal, std::vector<VoxelPos>& out) const;
+
+    bool standable(int x, int y, int z) const;
+    bool passable(int x, int y, int z) const;
+
+    /**
+     * @brief Whether a walker can take one step from `from` to `to`, a
+     * neighbour under one of NAV_MOVES.
+     */
+    bool can_move(VoxelPos from, VoxelPos to) const;
+
+    /**
+     * @brief Repair counter; a chunk's walk flags changed at the generation
+     * of the repair that rebuilt or dropped it.
+     */
+    uint64_t generation() const { return generation_; }
+    bool changed_since(ChunkCoord c, uint64_t generation) const;
+
+    static ChunkCoord chunk_of(int x, int y, int z);
+
+    size_t chunk_count() const { return navs_.size(); }
+    size_t node_count() const { return nodes_.size() - free_nodes_.size(); }
+
+private:
+    static constexpr uint8_t PASSABLE = 1;
+    static constexpr uint8_t STANDABLE = 2;
+    static constexpr uint32_t UNREACHABLE = 0xFFFFFFFFu;
+
+    struct Link {
+        uint32_t to;
+        uint32_t cost;
+    };
+
+    struct Node {
+        VoxelPos pos;
+        ChunkCoord chunk;
+        uint32_t refs = 0;   // Transitions using this portal
+        uint32_t slot = 0;   // Index in the chunk's portal list
+        std::vector<Link> links;
+    };
+
+    struct ChunkNav {
+        std::vector<uint8_t> flags;      // PASSABLE | STANDABLE per voxel
+        std::vector<uint32_t> portals;   // Node ids in this chunk
+        std::vector<uint32_t> dist;      // portals x portals BFS distances
+    };
+
+    struct PairKey {
+        ChunkCoord a, b;
+        bool operator==(const PairKey& o) const { return a == o.a && b == o.b; }
+    };
+    struct PairKeyHash {
+        size_t operator()(const PairKey& k) const {
+            ChunkCoordHash h;
+            return h(k.a) * 31 + h(k.b);
+        }
+    };
+
+    ChunkManager& chunks_;
+    core::TaskPool* pool_;
+
+    std::unordered_map<ChunkCoord, ChunkNav, ChunkCoordHash> navs_;
+    std::unordered_set<ChunkCoord, ChunkCoordHash> dirty_;
+    uint64_t generation_ = 0;
+    std::unordered_map<ChunkCoord, uint64_t, ChunkCoordHash> changed_at_;
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_nodes_;
+    std::unordered_map<uint64_t, uint32_t> node_at_;  // Packed voxel -> node
+
+    // Portal-pair edges between two neighbouring chunks
+    std::unordered_map<PairKey, std::vector<std::pair<uint32_t, uint32_t>>, PairKeyHash> pairs_;
+
+    void mark_dirty(ChunkCoord c) { dirty_.insert(c); }
+    void drop_chunk(ChunkCoord c, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched);
+
+    void build_flags(ChunkCoord c, ChunkNav& nav);
+    void rebuild_pairs(ChunkCoord c, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched);
+    void clear_pair(const PairKey& key, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched);
+    uint32_t acquire_node(VoxelPos pos, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched);
+    void release_node(uint32_t id, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched);
+    void build_distances(ChunkCoord c, ChunkNav& nav);
+
+    const ChunkNav* nav_at(ChunkCoord c) const;
+    uint8_t flags_at(int x, int y, int z) const;
+
+    /**
+     * @brief BFS inside one chunk from `from`; `stop` ends early once
+     * reached. Fills the thread's scratch dist/parent arrays.
+     */
+    void chunk_bfs(ChunkCoord c, const ChunkNav& nav, VoxelPos from,
+                   const VoxelPos* stop, int buffer) const;
+    bool trace(ChunkCoord c, VoxelPos from, VoxelPos to, int buffer,
+               std::vector<VoxelPos>& out) const;
+
+    static uint64_t pack(VoxelPos p);
+    static PairKey pair_key(ChunkCoord a, ChunkCoord b);
+};
+
+/**
+ * @brief Result of a queued path request.
+ */
+struct PathResult {
+    uint64_t ticket = 0;
+    uint64_t tag = 0;   // Caller data, e.g. the requesting entity
+    bool found = false;
+    std::vector<VoxelPos> path;
+};
+
+/**
+ * @brief Batched, asynchronous front end for NavGraph.
+ *
+ * submit() queues a request and returns a ticket immediately. update()
+ * repairs the graph, then solves up to max_batch queued requests in
+ * parallel on the task pool. Results wait in the queue until drain() moves
+ * them out. submit(), update() and drain() are called from the simulation
+ * thread; update() must not overlap ChunkManager writes.
+ */
+class PathQueue {
+public:
+    PathQueue(NavGraph& graph, core::TaskPool& pool, size_t max_batch = 256)
+        : graph_(graph), pool_(pool), max_batch_(max_batch) {}
+
+    uint64_t submit(VoxelPos start, VoxelPos goal, uint64_t tag = 0);
+    void update();
+    void drain(std::vector<PathResult>& out);
+
+    size_t pending() const { return pending_.size(); }
+    size_t ready() const { return done_.size(); }
+
+private:
+    struct Request {
+        uint64_t ticket;
+        uint64_t tag;
+        VoxelPos start, goal;
+    };
+
+    NavGraph& graph_;
+    core::TaskPool& pool_;
+    size_t max_batch_;
+    uint64_t next_ticket_ = 1;
+
+    std::vector<Request> pending_;
+    std::vector<PathResult> done_;
+};
+
+} // namespace world
+} // namespace isolated
@@ -33,6 +33,11 @@ public:
      * @brief Generate terrain for a chunk.
      */
     void generate(Chunk& chunk);
+
+    /**
+     * @brief World Z of the first voxel above ground in column (x, y).
+     */
+    int surface_height(int world_x, int world_y) const;
     
 private:
     TerrainConfig config_;
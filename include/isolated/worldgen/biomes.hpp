@@ -5,19 +5,26 @@
  * @brief Underground biome and ecosystem modeling.
  *
  * Features:
- * - Underground ecosystems (fungus, bacteria, algae)
+ * - Underground ecosystems (fungus, bacteria, algae) on a microhabitat grid
  * - Bioluminescent regions
  * - Fossil deposits
  * - Environmental zones
  */
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <memory>
 #include <random>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <isolated/perf/cache_friendly.hpp>
+#include <isolated/world/chunk.hpp>
+#include <isolated/world/light_field.hpp>
+#include <isolated/worldgen/feature_index.hpp>
+
 namespace isolated {
 namespace worldgen {
 
@@ -44,6 +51,7 @@ struct Organism {
   double min_temp = 5.0; // °C
   double max_temp = 40.0;
   double min_humidity = 0.3; // 0-1
+  double min_o2 = 0.0;       // O2 fraction below which growth slows (0 = any)
   double optimal_ph = 7.0;
 
   // Light requirements
@@ -90,6 +98,352 @@ struct Ecosystem {
   double total_light() const { return ambient_light + bioluminescence; }
 };
 
+// ============================================================================
+// ECOSYSTEM GRID
+// ============================================================================
+
+/**
+ * @brief Ecosystem state on a coarse grid of microhabitats.
+ *
+ * Each chunk that hosts life is split into kHabitatSize³-voxel habitats and
+ * stored as one Block of SoA arrays: one array per environment field, and a
+ * population array per species. Species traits are shared across the world,
+ * so the logistic update for a species is a single branch-free loop over
+ * the block. Blocks update in parallel.
+ */
+class EcosystemGrid {
+public:
+  static constexpr size_t kHabitatSize = 8; // Voxels per habitat side
+  static constexpr size_t kAxis = world::CHUNK_SIZE / kHabitatSize;
+  static constexpr size_t kHabitats = kAxis * kAxis * kAxis; // Per chunk
+
+  struct Block {
+    perf::AlignedVector<double> temperature;       // °C
+    perf::AlignedVector<double> humidity;          // 0-1
+    perf::AlignedVector<double> organic_matter;    // kg
+    perf::AlignedVector<double> mineral_nutrients; //
+    perf::AlignedVector<double> ambient_light;     // lux
+    perf::AlignedVector<double> bioluminescence;   // lux
+    perf::AlignedVector<double> o2_level;          // fraction
+    perf::AlignedVector<double> co2_level;         // fraction
+    perf::AlignedVector<double> h2s_level;         // fraction
+    perf::AlignedVector<double> population;        // kHabitats per species
+
+    explicit Block(size_t species) {
+      Ecosystem defaults;
+      temperature.assign(kHabitats, defaults.temperature);
+      humidity.assign(kHabitats, defaults.humidity);
+      organic_matter.assign(kHabitats, defaults.organic_matter);
+      mineral_nutrients.assign(kHabitats, defaults.mineral_nutrients);
+      ambient_light.assign(kHabitats, defaults.ambient_light);
+      bioluminescence.assign(kHabitats, 0.0);
+      o2_level.assign(kHabitats, defaults.o2_level);
+      co2_level.assign(kHabitats, defaults.co2_level);
+      h2s_level.assign(kHabitats, defaults.h2s_level);
+      population.assign(species * kHabitats, 0.0);
+    }
+
+    double *species(size_t s) { return &population[s * kHabitats]; }
+    const double *species(size_t s) const { return &population[s * kHabitats]; }
+  };
+
+  /**
+   * @brief Register a species; organisms with identical traits share one.
+   * @return Species index.
+   */
+  size_t add_species(const Organism &traits) {
+    for (size_t s = 0; s < species_.size(); ++s) {
+      if (same_traits(species_[s], traits))
+        return s;
+    }
+    species_.push_back(traits);
+    species_.back().population = 0.0;
+    for (auto &[coord, block] : blocks_) {
+      block->population.resize(species_.size() * kHabitats, 0.0);
+    }
+    return species_.size() - 1;
+  }
+
+  size_t species_count() const { return species_.size(); }
+  const Organism &species(size_t s) const { return species_[s]; }
+
+  /**
+   * @brief Set the habitat containing world cell (x, y, z) to `eco`.
+   */
+  void seed(int x, int y, int z, const Ecosystem &eco) {
+    auto [coord, h] = locate(x, y, z);
+    std::vector<size_t> ids;
+    for (const auto &org : eco.organisms) {
+      ids.push_back(add_species(org));
+    }
+
+    Block &b = block_for(coord);
+    b.temperature[h] = eco.temperature;
+    b.humidity[h] = eco.humidity;
+    b.organic_matter[h] = eco.organic_matter;
+    b.mineral_nutrients[h] = eco.mineral_nutrients;
+    b.ambient_light[h] = eco.ambient_light;
+    b.o2_level[h] = eco.o2_level;
+    b.co2_level[h] = eco.co2_level;
+    b.h2s_level[h] = eco.h2s_level;
+    for (size_t s = 0; s < species_.size(); ++s) {
+      b.species(s)[h] = 0.0;
+    }
+    for (size_t k = 0; k < ids.size(); ++k) {
+      b.species(ids[k])[h] += eco.organisms[k].population;
+    }
+    update_bioluminescence(b);
+  }
+
+  /**
+   * @brief Snapshot of one habitat as an Ecosystem (for UI and tests).
+   */
+  Ecosystem snapshot(int x, int y, int z) const {
+    Ecosystem eco;
+    auto [coord, h] = locate(x, y, z);
+    auto it = blocks_.find(coord);
+    if (it == blocks_.end())
+      return eco;
+
+    const Block &b = *it->second;
+    eco.temperature = b.temperature[h];
+    eco.humidity = b.humidity[h];
+    eco.organic_matter = b.organic_matter[h];
+    eco.mineral_nutrients = b.mineral_nutrients[h];
+    eco.ambient_light = b.ambient_light[h];
+    eco.bioluminescence = b.bioluminescence[h];
+    eco.o2_level = b.o2_level[h];
+    eco.co2_level = b.co2_level[h];
+    eco.h2s_level = b.h2s_level[h];
+    for (size_t s = 0; s < species_.size(); ++s) {
+      if (b.species(s)[h] > 0.0) {
+        Organism org = species_[s];
+        org.population = b.species(s)[h];
+        eco.organisms.push_back(org);
+      }
+    }
+    return eco;
+  }
+
+  /**
+   * @brief Pull temperature, O2 and CO2 from a chunk's physics fields,
+   * averaged over each habitat. Chunks without life are ignored.
+   */
+  void sample_environment(const world::Chunk &chunk) {
+    auto it = blocks_.find(chunk.coords);
+    if (it == blocks_.end())
+      return;
+    Block &b = *it->second;
+
+    std::fill(b.temperature.begin(), b.temperature.end(), 0.0);
+    std::fill(b.o2_level.begin(), b.o2_level.end(), 0.0);
+    std::fill(b.co2_level.begin(), b.co2_level.end(), 0.0);
+
+    for (size_t z = 0; z < world::CHUNK_SIZE; ++z) {
+      for (size_t y = 0; y < world::CHUNK_SIZE; ++y) {
+        size_t row = world::Chunk::idx(0, y, z);
+        size_t hrow = kAxis * (y / kHabitatSize + kAxis * (z / kHabitatSize));
+        for (size_t x = 0; x < world::CHUNK_SIZE; ++x) {
+          size_t h = hrow + x / kHabitatSize;
+          b.temperature[h] += chunk.temperature[row + x];
+          b.o2_level[h] += chunk.o2_fraction[row + x];
+          b.co2_level[h] += chunk.co2_fraction[row + x];
+        }
+      }
+    }
+
+    constexpr double inv = 1.0 / (kHabitatSize * kHabitatSize * kHabitatSize);
+    for (size_t h = 0; h < kHabitats; ++h) {
+      b.temperature[h] = b.temperature[h] * inv - 273.15;
+      b.o2_level[h] *= inv;
+      b.co2_level[h] *= inv;
+    }
+  }
+
+  /**
+   * @brief One ecosystem tick (logistic growth, death, gas exchange).
+   * @param nutrient_regeneration Fractional mineral regrowth per tick
+   */
+  void update(double nutrient_regeneration) {
+    block_list_.clear();
+    for (auto &[coord, block] : blocks_) {
+      block_list_.push_back(block.get());
+    }
+
+#pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < block_list_.size(); ++k) {
+      update_block(*block_list_[k], nutrient_regeneration);
+    }
+  }
+
+  double bioluminescence_at(int x, int y, int z) const {
+    auto [coord, h] = locate(x, y, z);
+    auto it = blocks_.find(coord);
+    return it != blocks_.end() ? it->second->bioluminescence[h] : 0.0;
+  }
+
+  /**
+   * @brief Call f(x, y, z, lux) with the centre cell and bioluminescence of
+   * every habitat, or of every habitat in the block holding (x, y, z).
+   */
+  template <typename F> void visit_bioluminescence(F &&f) const {
+    for (const auto &[coord, block] : blocks_) {
+      visit_block(coord, *block, f);
+    }
+  }
+
+  template <typename F>
+  void visit_bioluminescence(int x, int y, int z, F &&f) const {
+    auto it = blocks_.find(locate(x, y, z).first);
+    if (it != blocks_.end()) {
+      visit_block(it->first, *it->second, f);
+    }
+  }
+
+  double total_population(size_t s) const {
+    double sum = 0.0;
+    for (const auto &[coord, block] : blocks_) {
+      const double *p = block->species(s);
+      for (size_t h = 0; h < kHabitats; ++h) {
+        sum += p[h];
+      }
+    }
+    return sum;
+  }
+
+  size_t block_count() const { return blocks_.size(); }
+  size_t habitat_count() const { return blocks_.size() * kHabitats; }
+
+private:
+  std::vector<Organism> species_;
+  std::unordered_map<world::ChunkCoord, std::unique_ptr<Block>,
+                     world::ChunkCoordHash>
+      blocks_;
+  std::vector<Block *> block_list_; // Scratch for parallel updates
+
+  static bool same_traits(const Organism &a, const Organism &b) {
+    return a.type == b.type && a.growth_rate == b.growth_rate &&
+           a.death_rate == b.death_rate && a.min_temp == b.min_temp &&
+           a.max_temp == b.max_temp && a.min_humidity == b.min_humidity &&
+           a.min_o2 == b.min_o2 && a.optimal_ph == b.optimal_ph &&
+           a.photosynthetic == b.photosynthetic &&
+           a.bioluminescent == b.bioluminescent &&
+           a.light_output == b.light_output &&
+           a.o2_production == b.o2_production &&
+           a.co2_consumption == b.co2_consumption &&
+           a.organic_production == b.organic_production;
+  }
+
+  static std::pair<world::ChunkCoord, size_t> locate(int x, int y, int z) {
+    constexpr int n = static_cast<int>(world::CHUNK_SIZE);
+    auto floor_div = [](int a, int b) {
+      return a >= 0 ? a / b : (a - b + 1) / b;
+    };
+    world::ChunkCoord c{floor_div(x, n), floor_div(y, n), floor_div(z, n)};
+    size_t lx = static_cast<size_t>(x - c.x * n) / kHabitatSize;
+    size_t ly = static_cast<size_t>(y - c.y * n) / kHabitatSize;
+    size_t lz = static_cast<size_t>(z - c.z * n) / kHabitatSize;
+    return {c, lx + kAxis * (ly + kAxis * lz)};
+  }
+
+  template <typename F>
+  static void visit_block(world::ChunkCoord c, const Block &b, F &f) {
+    constexpr int n = static_cast<int>(world::CHUNK_SIZE);
+    constexpr int size = static_cast<int>(kHabitatSize);
+    for (size_t h = 0; h < kHabitats; ++h) {
+      int hx = static_cast<int>(h % kAxis);
+      int hy = static_cast<int>(h / kAxis % kAxis);
+      int hz = static_cast<int>(h / (kAxis * kAxis));
+      f(c.x * n + hx * size + size / 2, c.y * n + hy * size + size / 2,
+        c.z * n + hz * size + size / 2, b.bioluminescence[h]);
+    }
+  }
+
+  Block &block_for(world::ChunkCoord c) {
+    auto &slot = blocks_[c];
+    if (!slot) {
+      slot = std::make_unique<Block>(species_.size());
+    }
+    return *slot;
+  }
+
+  void update_block(Block &b, double nutrient_regeneration) const {
+    double *minerals = b.mineral_nutrients.data();
+#pragma omp simd
+    for (size_t h = 0; h < kHabitats; ++h) {
+      minerals[h] += nutrient_regeneration * minerals[h];
+    }
+
+    const double *temp = b.temperature.data();
+    const double *hum = b.humidity.data();
+    const double *organic = b.organic_matter.data();
+    const double *ambient = b.ambient_light.data();
+    const double *glow = b.bioluminescence.data();
+    double *o2 = b.o2_level.data();
+    double *co2 = b.co2_level.data();
+
+    for (size_t s = 0; s < species_.size(); ++s) {
+      const Organism &sp = species_[s];
+      const double t_opt = 0.5 * (sp.min_temp + sp.max_temp);
+      const double inv_range = 1.0 / (sp.max_temp - sp.min_temp);
+      const double inv_hum = sp.min_humidity > 0.0 ? 1.0 / sp.min_humidity : 0.0;
+      const double inv_o2 = sp.min_o2 > 0.0 ? 1.0 / sp.min_o2 : 0.0;
+      const double photo = sp.photosynthetic ? 1.0 : 0.0;
+      const double o2_rate = sp.o2_production / 1e9;
+      const double co2_rate = sp.co2_consumption / 1e9;
+      double *pop = b.species(s);
+
+#pragma omp simd
+      for (size_t h = 0; h < kHabitats; ++h) {
+        // Environmental compatibility: temperature window, humidity, light
+        // for photosynthesis and O2, each scaling growth down to zero
+        double t = temp[h];
+        double env = 1.0 - std::abs(t - t_opt) * inv_range;
+        env = (t < sp.min_temp || t > sp.max_temp) ? 0.0 : env;
+        env *= hum[h] < sp.min_humidity ? hum[h] * inv_hum : 1.0;
+        double light = ambient[h] + glow[h];
+        env *= (photo > 0.0 && light < 10.0) ? light * 0.1 : 1.0;
+        env *= o2[h] < sp.min_o2 ? o2[h] * inv_o2 : 1.0;
+        env = std::clamp(env, 0.0, 1.0);
+
+        // Logistic growth
+        double p = pop[h];
+        double capacity = std::max(organic[h] * 100.0, 1e-9);
+        double growth = sp.growth_rate * env * p * (1.0 - p / capacity);
+        p = std::max(0.0, p + growth - sp.death_rate * p);
+        pop[h] = p;
+
+        // Gas exchange
+        o2[h] += o2_rate * p;
+        co2[h] -= co2_rate * p;
+      }
+    }
+
+#pragma omp simd
+    for (size_t h = 0; h < kHabitats; ++h) {
+      o2[h] = std::clamp(o2[h], 0.0, 0.5);
+      co2[h] = std::clamp(co2[h], 0.0, 0.1);
+    }
+
+    update_bioluminescence(b);
+  }
+
+  void update_bioluminescence(Block &b) const {
+    double *glow = b.bioluminescence.data();
+    std::fill(b.bioluminescence.begin(), b.bioluminescence.end(), 0.0);
+    for (size_t s = 0; s < species_.size(); ++s) {
+      if (!species_[s].bioluminescent)
+        continue;
+      const double k = species_[s].light_output / 1000.0;
+      const double *pop = b.species(s);
+#pragma omp simd
+      for (size_t h = 0; h < kHabitats; ++h) {
+        glow[h] += k * pop[h];
+      }
+    }
+  }
+};
+
 // ============================================================================
 // BIOLUMINESCENT REGION
 // ============================================================================
@@ -134,6 +488,7 @@ struct FossilDeposit {
   double density = 1.0; // Fossils per m³
   double quality = 0.5; // 0-1 preservation
   bool discovered = false;
+  bool extracted = false;
 
   double value() const {
     // Scientific/economic value
@@ -157,18 +512,76 @@ public:
 
   BiomeSystem() : rng_(42) { config_ = Config{}; }
 
-  void add_ecosystem(const std::string &id, const Ecosystem &eco) {
-    ecosystems_[id] = eco;
+  /**
+   * @brief Place an ecosystem in the microhabitat containing (x, y, z).
+   */
+  void add_ecosystem(int x, int y, int z, const Ecosystem &eco) {
+    seed_habitat(x, y, z, eco);
   }
 
   void add_bioluminescent_region(const BioluminescentRegion &region) {
+    index_.insert(FeatureKind::GLOW_REGION,
+                  static_cast<uint32_t>(glow_regions_.size()),
+                  FeatureBox::around(static_cast<int>(region.x),
+                                     static_cast<int>(region.y),
+                                     static_cast<int>(region.z),
+                                     static_cast<int>(region.radius)));
     glow_regions_.push_back(region);
+    if (light_) {
+      light_region(region);
+    }
+  }
+
+  /**
+   * @brief Light `light` with the glow regions (a source at each centre at
+   * its intensity) and glowing habitats (a source at each habitat centre
+   * at its bioluminescence), kept in step as they are added and as
+   * habitats brighten, dim or die out. Sources already placed in a
+   * previous field are removed from it; nullptr detaches. The field must
+   * outlive its use here.
+   */
+  void set_light_field(world::LightField *light) {
+    if (light_) {
+      for (const auto &[key, level] : light_levels_) {
+        auto [x, y, z] = unpack_cell(key);
+        light_->remove_source(x, y, z);
+      }
+    }
+    light_ = light;
+    region_light_.clear();
+    habitat_light_.clear();
+    light_levels_.clear();
+    if (!light_) {
+      return;
+    }
+    for (const auto &region : glow_regions_) {
+      light_region(region);
+    }
+    habitats_.visit_bioluminescence(
+        [&](int x, int y, int z, double lux) { light_habitat(x, y, z, lux); });
   }
 
   void add_fossil_deposit(const FossilDeposit &deposit) {
+    fossil_handles_.push_back(index_.insert(
+        FeatureKind::FOSSIL, static_cast<uint32_t>(fossils_.size()),
+        FeatureBox::around(static_cast<int>(deposit.x),
+                           static_cast<int>(deposit.y),
+                           static_cast<int>(deposit.z),
+                           static_cast<int>(deposit.extent))));
     fossils_.push_back(deposit);
   }
 
+  /**
+   * @brief Remove an excavated fossil deposit from further queries.
+   */
+  void extract_fossil(size_t fossil_idx) {
+    if (fossil_idx >= fossils_.size())
+      return;
+    fossils_[fossil_idx].discovered = true;
+    fossils_[fossil_idx].extracted = true;
+    index_.remove(fossil_handles_[fossil_idx]);
+  }
+
   /**
    * @brief Update all ecosystems.
    * @param dt Time step (seconds)
@@ -177,16 +590,26 @@ public:
     accumulated_time_ += dt;
 
     if (accumulated_time_ >= config_.ecosystem_update_rate) {
-      update_ecosystems();
+      habitats_.update(config_.nutrient_regeneration);
       accumulated_time_ = 0.0;
+      if (light_) {
+        habitats_.visit_bioluminescence([&](int x, int y, int z, double lux) {
+          light_habitat(x, y, z, lux);
+        });
+      }
     }
+  }
 
-    update_bioluminescence();
+  /**
+   * @brief Refresh habitat temperature and gases from a chunk's physics.
+   */
+  void sample_environment(const world::Chunk &chunk) {
+    habitats_.sample_environment(chunk);
   }
 
   // === Ecosystem seeding ===
 
-  void seed_cave_ecosystem(const std::string &id, double depth) {
+  void seed_cave_ecosystem(int x, int y, int z, double depth) {
     Ecosystem eco;
     eco.temperature = 15.0 - depth * 0.01; // Cooler with depth
     eco.humidity = 0.8;
@@ -208,10 +631,10 @@ public:
     fungus.light_output = fungus.bioluminescent ? 10.0 : 0.0;
     eco.organisms.push_back(fungus);
 
-    ecosystems_[id] = eco;
+    seed_habitat(x, y, z, eco);
   }
 
-  void seed_hydrothermal_ecosystem(const std::string &id, double temperature) {
+  void seed_hydrothermal_ecosystem(int x, int y, int z, double temperature) {
     Ecosystem eco;
     eco.temperature = temperature;
     eco.humidity = 1.0;
@@ -234,7 +657,7 @@ public:
     tubeworm.growth_rate = 0.01;
     eco.organisms.push_back(tubeworm);
 
-    ecosystems_[id] = eco;
+    seed_habitat(x, y, z, eco);
   }
 
   // === Fossil generation ===
@@ -253,7 +676,7 @@ public:
       deposit.age_million_years = age;
       deposit.quality = quality(rng_);
       deposit.density = 0.5 + quality(rng_);
-      fossils_.push_back(deposit);
+      add_fossil_deposit(deposit);
     }
   }
 
@@ -261,112 +684,142 @@ public:
 
   double get_bioluminescence_at(size_t x, size_t y, size_t z) const {
     double total = 0.0;
-    for (const auto &region : glow_regions_) {
-      total += region.light_at(x, y, z);
-    }
+    index_.visit(point_box(x, y, z), [&](uint32_t handle) {
+      const auto &f = index_.feature(handle);
+      if (f.kind == FeatureKind::GLOW_REGION) {
+        total += glow_regions_[f.ref].light_at(x, y, z);
+      }
+      return true;
+    });
     return total;
   }
 
   const FossilDeposit *get_fossil_at(size_t x, size_t y, size_t z) const {
-    for (const auto &deposit : fossils_) {
-      double dx = static_cast<double>(x) - deposit.x;
-      double dy = static_cast<double>(y) - deposit.y;
-      double dz = static_cast<double>(z) - deposit.z;
-      if (std::abs(dx) <= deposit.extent && std::abs(dy) <= deposit.extent &&
-          std::abs(dz) <= deposit.extent) {
-        return &deposit;
+    // Buckets are in insertion order, so the first hit is the oldest deposit
+    const FossilDeposit *found = nullptr;
+    index_.visit(point_box(x, y, z), [&](uint32_t handle) {
+      const auto &f = index_.feature(handle);
+      if (f.kind == FeatureKind::FOSSIL) {
+        found = &fossils_[f.ref];
+        return false;
       }
-    }
-    return nullptr;
+      return true;
+    });
+    return found;
+  }
+
+  /**
+   * @brief Indices of unextracted fossil deposits overlapping `box`,
+   * appended to `out`.
+   */
+  void fossils_in(const FeatureBox &box, std::vector<size_t> &out) const {
+    index_.visit(box, [&](uint32_t handle) {
+      const auto &f = index_.feature(handle);
+      if (f.kind == FeatureKind::FOSSIL) {
+        out.push_back(f.ref);
+      }
+      return true;
+    });
   }
 
-  Ecosystem *get_ecosystem(const std::string &id) {
-    auto it = ecosystems_.find(id);
-    return it != ecosystems_.end() ? &it->second : nullptr;
+  Ecosystem get_ecosystem(int x, int y, int z) const {
+    return habitats_.snapshot(x, y, z);
   }
 
+  const EcosystemGrid &habitats() const { return habitats_; }
+
   const std::vector<BioluminescentRegion> &glow_regions() const {
     return glow_regions_;
   }
   const std::vector<FossilDeposit> &fossils() const { return fossils_; }
+  const FeatureIndex &index() const { return index_; }
 
 private:
   Config config_;
-  std::unordered_map<std::string, Ecosystem> ecosystems_;
+  EcosystemGrid habitats_;
   std::vector<BioluminescentRegion> glow_regions_;
   std::vector<FossilDeposit> fossils_;
+  std::vector<uint32_t> fossil_handles_;
+  FeatureIndex index_; // Fossils and glow regions
   std::mt19937 rng_;
   double accumulated_time_ = 0.0;
 
-  void update_ecosystems() {
-    for (auto &[id, eco] : ecosystems_) {
-      update_single_ecosystem(eco);
-    }
+  // Light sources placed for glow regions and habitats. Both can share a
+  // cell, which then gets the brighter of the two. Keyed by pack_cell()
+  world::LightField *light_ = nullptr;
+  std::unordered_map<uint64_t, uint8_t> region_light_, habitat_light_,
+      light_levels_;
+
+  static uint64_t pack_cell(int x, int y, int z) {
+    constexpr uint64_t mask = (uint64_t{1} << 21) - 1;
+    return (static_cast<uint64_t>(x) & mask) |
+           ((static_cast<uint64_t>(y) & mask) << 21) |
+           ((static_cast<uint64_t>(z) & mask) << 42);
   }
 
-  void update_single_ecosystem(Ecosystem &eco) {
-    // Nutrient regeneration
-    eco.mineral_nutrients +=
-        config_.nutrient_regeneration * eco.mineral_nutrients;
-
-    // Update each organism population
-    for (auto &org : eco.organisms) {
-      // Check environmental compatibility
-      double env_factor = calculate_environment_factor(eco, org);
-
-      // Logistic growth
-      double carrying_capacity = eco.organic_matter * 100.0;
-      double growth = org.growth_rate * env_factor * org.population *
-                      (1.0 - org.population / carrying_capacity);
-      double death = org.death_rate * org.population;
-
-      org.population += growth - death;
-      org.population = std::max(0.0, org.population);
+  static std::array<int, 3> unpack_cell(uint64_t key) {
+    // Sign-extend each 21-bit field
+    auto axis = [key](int shift) {
+      return static_cast<int>(static_cast<int64_t>(key << (43 - shift)) >> 43);
+    };
+    return {axis(0), axis(21), axis(42)};
+  }
 
-      // Gas exchange
-      eco.o2_level += org.o2_production * org.population / 1e9;
-      eco.co2_level -= org.co2_consumption * org.population / 1e9;
+  void seed_habitat(int x, int y, int z, const Ecosystem &eco) {
+    habitats_.seed(x, y, z, eco);
+    if (light_) {
+      habitats_.visit_bioluminescence(
+          x, y, z,
+          [&](int cx, int cy, int cz, double lux) { light_habitat(cx, cy, cz, lux); });
     }
-
-    // Clamp gas levels
-    eco.o2_level = std::clamp(eco.o2_level, 0.0, 0.5);
-    eco.co2_level = std::clamp(eco.co2_level, 0.0, 0.1);
   }
 
-  double calculate_environment_factor(const Ecosystem &eco,
-                                      const Organism &org) {
-    double factor = 1.0;
+  void light_region(const BioluminescentRegion &region) {
+    uint64_t cell = pack_cell(static_cast<int>(region.x),
+                              static_cast<int>(region.y),
+                              static_cast<int>(region.z));
+    uint8_t &level = region_light_[cell];
+    level = std::max(level, light_->level_for_lux(region.intensity));
+    update_light(cell);
+  }
 
-    // Temperature
-    if (eco.temperature < org.min_temp || eco.temperature > org.max_temp) {
-      return 0.0;
+  void light_habitat(int x, int y, int z, double lux) {
+    uint64_t cell = pack_cell(x, y, z);
+    uint8_t level = light_->level_for_lux(lux);
+    auto it = habitat_light_.find(cell);
+    if ((it != habitat_light_.end() ? it->second : 0) == level) {
+      return;
     }
-    double temp_opt = (org.min_temp + org.max_temp) / 2.0;
-    factor *= 1.0 - std::abs(eco.temperature - temp_opt) /
-                        (org.max_temp - org.min_temp);
-
-    // Humidity
-    if (eco.humidity < org.min_humidity) {
-      factor *= eco.humidity / org.min_humidity;
+    if (level > 0) {
+      habitat_light_[cell] = level;
+    } else {
+      habitat_light_.erase(it);
     }
+    update_light(cell);
+  }
 
-    // Light for photosynthetic organisms
-    if (org.photosynthetic && eco.total_light() < 10.0) {
-      factor *= eco.total_light() / 10.0;
+  void update_light(uint64_t cell) {
+    auto level_in = [&](const auto &sources) -> uint8_t {
+      auto it = sources.find(cell);
+      return it != sources.end() ? it->second : 0;
+    };
+    uint8_t level = std::max(level_in(region_light_), level_in(habitat_light_));
+    if (level == level_in(light_levels_)) {
+      return;
+    }
+    auto [x, y, z] = unpack_cell(cell);
+    if (level > 0) {
+      light_levels_[cell] = level;
+      light_->add_source(x, y, z, level);
+    } else {
+      light_levels_.erase(cell);
+      light_->remove_source(x, y, z);
     }
-
-    return std::clamp(factor, 0.0, 1.0);
   }
 
-  void update_bioluminescence() {
-    for (auto &[id, eco] : ecosystems_) {
-      eco.bioluminescence = 0.0;
-      for (const auto &org : eco.organisms) {
-        if (org.bioluminescent) {
-          eco.bioluminescence += org.light_output * org.population / 1000.0;
-        }
-      }
-    }
+  static FeatureBox point_box(size_t x, size_t y, size_t z) {
+    return FeatureBox::point(static_cast<int>(x), static_cast<int>(y),
+                             static_cast<int>(z));
   }
 };
 
@@ -0,0 +1,201 @@
+#pragma once
+
+/**
+ * @file feature_index.hpp
+ * @brief Uniform-grid spatial index for point-of-interest features.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace isolated {
+namespace worldgen {
+
+// ============================================================================
+// FEATURE BOX
+// ============================================================================
+
+/**
+ * @brief Axis-aligned box in cell coordinates, bounds inclusive.
+ */
+struct FeatureBox {
+  int x0, y0, z0;
+  int x1, y1, z1;
+
+  static FeatureBox point(int x, int y, int z) { return {x, y, z, x, y, z}; }
+  static FeatureBox around(int x, int y, int z, int r) {
+    return {x - r, y - r, z - r, x + r, y + r, z + r};
+  }
+
+  bool contains(int x, int y, int z) const {
+    return x >= x0 && x <= x1 && y >= y0 && y <= y1 && z >= z0 && z <= z1;
+  }
+  bool overlaps(const FeatureBox &o) const {
+    return x0 <= o.x1 && o.x0 <= x1 && y0 <= o.y1 && o.y0 <= y1 &&
+           z0 <= o.z1 && o.z0 <= z1;
+  }
+};
+
+enum class FeatureKind : uint8_t { FOSSIL, MINERAL_DEPOSIT, GLOW_REGION };
+
+// ============================================================================
+// FEATURE INDEX
+// ============================================================================
+
+/**
+ * @brief Static spatial index for fossils, deposits and biome regions.
+ *
+ * Features are bucketed into a uniform grid of kCellSize cells per side,
+ * matching the world chunk size, so a box query touches only the chunks it
+ * overlaps. A feature spanning several buckets is reported once: only the
+ * bucket holding the low corner of its overlap with the query reports it.
+ * Queries are const and keep no scratch state, so they may run
+ * concurrently.
+ *
+ * Handles are dense and stable; remove() drops a feature from the buckets
+ * (e.g. when a deposit is mined out) without renumbering the others. Each
+ * bucket stays in insertion order, so results within a bucket are in
+ * ascending handle order.
+ */
+class FeatureIndex {
+public:
+  static constexpr int kCellSize = 64;
+
+  struct Feature {
+    FeatureBox box;
+    FeatureKind kind;
+    uint32_t ref; // Index into the owner's feature vector
+    bool alive;
+  };
+
+  void clear() {
+    features_.clear();
+    buckets_.clear();
+    live_ = 0;
+  }
+
+  uint32_t insert(FeatureKind kind, uint32_t ref, const FeatureBox &box) {
+    uint32_t handle = static_cast<uint32_t>(features_.size());
+    features_.push_back({box, kind, ref, true});
+    ++live_;
+    for_each_bucket(box, [&](uint64_t key, int, int, int) {
+      buckets_[key].push_back(handle);
+      return true;
+    });
+    return handle;
+  }
+
+  void remove(uint32_t handle) {
+    if (handle >= features_.size() || !features_[handle].alive)
+      return;
+    Feature &f = features_[handle];
+    f.alive = false;
+    --live_;
+    for_each_bucket(f.box, [&](uint64_t key, int, int, int) {
+      auto it = buckets_.find(key);
+      if (it == buckets_.end())
+        return true;
+      auto &list = it->second;
+      list.erase(std::find(list.begin(), list.end(), handle));
+      if (list.empty())
+        buckets_.erase(it);
+      return true;
+    });
+  }
+
+  /**
+   * @brief Call fn(handle) for each live feature overlapping `box`; fn
+   * returns false to stop early.
+   */
+  template <typename Fn> void visit(const FeatureBox &box, Fn &&fn) const {
+    for_each_bucket(box, [&](uint64_t key, int bx, int by, int bz) {
+      auto it = buckets_.find(key);
+      if (it == buckets_.end())
+        return true;
+      for (uint32_t handle : it->second) {
+        const FeatureBox &fb = features_[handle].box;
+        if (!fb.overlaps(box))
+          continue;
+        // Report from the bucket holding the overlap's low corner only
+        if (cell_of(std::max(fb.x0, box.x0)) == bx &&
+            cell_of(std::max(fb.y0, box.y0)) == by &&
+            cell_of(std::max(fb.z0, box.z0)) == bz && !fn(handle)) {
+          return false;
+        }
+      }
+      return true;
+    });
+  }
+
+  /**
+   * @brief Append the handles of live features overlapping `box` to `out`.
+   */
+  void query(const FeatureBox &box, std::vector<uint32_t> &out) const {
+    visit(box, [&](uint32_t handle) {
+      out.push_back(handle);
+      return true;
+    });
+  }
+
+  /**
+   * @brief Answer many box queries at once.
+   *
+   * Results for boxes[i] are out[offsets[i]] .. out[offsets[i + 1] - 1];
+   * `offsets` receives boxes.size() + 1 entries. Both outputs are reused.
+   */
+  void query_batch(const std::vector<FeatureBox> &boxes,
+                   std::vector<uint32_t> &offsets,
+                   std::vector<uint32_t> &out) const {
+    offsets.resize(boxes.size() + 1);
+    out.clear();
+    for (size_t i = 0; i < boxes.size(); ++i) {
+      offsets[i] = static_cast<uint32_t>(out.size());
+      query(boxes[i], out);
+    }
+    offsets[boxes.size()] = static_cast<uint32_t>(out.size());
+  }
+
+  const Feature &feature(uint32_t handle) const { return features_[handle]; }
+
+  size_t size() const { return live_; }
+  size_t bucket_count() const { return buckets_.size(); }
+
+private:
+  std::vector<Feature> features_;
+  std::unordered_map<uint64_t, std::vector<uint32_t>> buckets_;
+  size_t live_ = 0;
+
+  static int cell_of(int v) {
+    return v >= 0 ? v / kCellSize : (v - kCellSize + 1) / kCellSize;
+  }
+
+  static uint64_t key(int bx, int by, int bz) {
+    // 21 bits per axis, biased so negative buckets pack cleanly
+    constexpr uint64_t mask = (1ull << 21) - 1;
+    constexpr int64_t bias = 1 << 20;
+    return ((static_cast<uint64_t>(bx + bias) & mask) << 42) |
+           ((static_cast<uint64_t>(by + bias) & mask) << 21) |
+           (static_cast<uint64_t>(bz + bias) & mask);
+  }
+
+  // fn(key, bx, by, bz) returns false to stop
+  template <typename Fn>
+  static void for_each_bucket(const FeatureBox &box, Fn &&fn) {
+    int bx0 = cell_of(box.x0), bx1 = cell_of(box.x1);
+    int by0 = cell_of(box.y0), by1 = cell_of(box.y1);
+    int bz0 = cell_of(box.z0), bz1 = cell_of(box.z1);
+    for (int bz = bz0; bz <= bz1; ++bz) {
+      for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+          if (!fn(key(bx, by, bz), bx, by, bz))
+            return;
+        }
+      }
+    }
+  }
+};
+
+} // namespace worldgen
+} // namespace isolated
@@ -13,7 +13,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <random>
+#include <tuple>
 #include <vector>
 
 namespace isolated {
@@ -31,6 +33,37 @@ struct StructuralCell {
   bool collapsed = false;
 };
 
+/**
+ * @brief Structural state for a whole grid, one array per field (SoA).
+ */
+struct StructuralField {
+  std::vector<double> integrity;
+  std::vector<double> load;
+  std::vector<double> support;
+  std::vector<uint8_t> is_void;
+  std::vector<uint8_t> collapsed;
+
+  void resize(size_t n) {
+    integrity.assign(n, 1.0);
+    load.assign(n, 0.0);
+    support.assign(n, 1.0);
+    is_void.assign(n, 0);
+    collapsed.assign(n, 0);
+  }
+
+  size_t size() const { return integrity.size(); }
+
+  StructuralCell get(size_t i) const {
+    return {integrity[i], load[i], support[i], is_void[i] != 0,
+            collapsed[i] != 0};
+  }
+};
+
+struct CollapseEvent {
+  size_t x, y, z;
+  double timestamp;
+};
+
 // ============================================================================
 // SEISMIC EVENT
 // ============================================================================
@@ -77,6 +110,16 @@ struct FaultLine {
 // GEOLOGY DYNAMICS SYSTEM
 // ============================================================================
 
+/**
+ * @brief Structural integrity, seismic and fault dynamics.
+ *
+ * Only cells on the active list are swept each step: cells carrying a
+ * non-trivial load, or below the collapse threshold and not yet collapsed.
+ * Excavation, added support, seismic damage and collapses put the cells they
+ * touch on the list, and cells drop off once their load relaxes below
+ * kLoadEpsilon (the residual load is zeroed). An undisturbed grid costs
+ * nothing per step regardless of its size.
+ */
 class GeologyDynamicsSystem {
 public:
   struct Config {
@@ -86,7 +129,11 @@ public:
     double tectonic_rate = 1e-9;     // Very slow changes
   };
 
-  explicit GeologyDynamicsSystem(const Config &config = Config{})
+  // Loads below this are treated as relaxed and leave the active set
+  static constexpr double kLoadEpsilon = 1e-6;
+
+  GeologyDynamicsSystem() : rng_(42) { config_ = Config{}; }
+  explicit GeologyDynamicsSystem(const Config &config)
       : config_(config), rng_(42) {}
 
   void initialize(size_t nx, size_t ny, size_t nz) {
@@ -94,6 +141,11 @@ public:
     ny_ = ny;
     nz_ = nz;
     cells_.resize(nx * ny * nz);
+    in_active_.assign(nx * ny * nz, 0);
+    active_.clear();
+    active_sorted_ = true;
+    collapsed_cells_.clear();
+    collapse_events_.clear();
   }
 
   void add_fault_line(const FaultLine &fault) { faults_.push_back(fault); }
@@ -103,25 +155,30 @@ public:
    * @param dt Time step (seconds)
    */
   void step(double dt) {
+    current_time_ += dt;
     accumulate_fault_stress(dt);
     check_for_earthquakes();
     propagate_stress();
     check_collapses();
+    retire_settled_cells();
   }
 
   // === Cave-in mechanics ===
 
   void excavate(size_t x, size_t y, size_t z) {
-    auto &cell = at(x, y, z);
-    cell.is_void = true;
-    cell.integrity = 0.0;
+    size_t i = idx(x, y, z);
+    cells_.is_void[i] = 1;
+    cells_.integrity[i] = 0.0;
+    activate(i);
 
     // Increase load on neighbors
     apply_excavation_stress(x, y, z);
   }
 
   void add_support(size_t x, size_t y, size_t z, double strength) {
-    at(x, y, z).support += strength;
+    size_t i = idx(x, y, z);
+    cells_.support[i] += strength;
+    activate(i);
   }
 
   // === Seismic events ===
@@ -136,40 +193,63 @@ public:
 
   // === Accessors ===
 
-  StructuralCell &at(size_t x, size_t y, size_t z) {
-    return cells_[x + nx_ * (y + ny_ * z)];
+  StructuralCell cell(size_t x, size_t y, size_t z) const {
+    return cells_.get(idx(x, y, z));
   }
 
-  const StructuralCell &at(size_t x, size_t y, size_t z) const {
-    return cells_[x + nx_ * (y + ny_ * z)];
-  }
+  const StructuralField &field() const { return cells_; }
+  size_t active_count() const { return active_.size(); }
 
   const std::vector<SeismicEvent> &recent_events() const { return events_; }
   const std::vector<FaultLine> &faults() const { return faults_; }
 
+  /// Collapsed cells in the order they collapsed.
   std::vector<std::tuple<size_t, size_t, size_t>> get_collapsed_cells() const {
     std::vector<std::tuple<size_t, size_t, size_t>> result;
-    for (size_t z = 0; z < nz_; ++z) {
-      for (size_t y = 0; y < ny_; ++y) {
-        for (size_t x = 0; x < nx_; ++x) {
-          if (at(x, y, z).collapsed) {
-            result.push_back({x, y, z});
-          }
-        }
-      }
+    result.reserve(collapsed_cells_.size());
+    for (size_t i : collapsed_cells_) {
+      result.push_back({i % nx_, (i / nx_) % ny_, i / (nx_ * ny_)});
     }
     return result;
   }
 
+  /// Move collapses since the last call into `out` (oldest first).
+  void drain_collapse_events(std::vector<CollapseEvent> &out) {
+    out.insert(out.end(), collapse_events_.begin(), collapse_events_.end());
+    collapse_events_.clear();
+  }
+
 private:
   Config config_;
   size_t nx_ = 0, ny_ = 0, nz_ = 0;
-  std::vector<StructuralCell> cells_;
+  StructuralField cells_;
   std::vector<FaultLine> faults_;
   std::vector<SeismicEvent> events_;
   std::mt19937 rng_;
   double current_time_ = 0.0;
 
+  // Active set: flat cell indices plus a membership flag per cell
+  std::vector<size_t> active_;
+  std::vector<uint8_t> in_active_;
+  bool active_sorted_ = true;
+
+  std::vector<size_t> collapse_worklist_;
+  std::vector<size_t> collapsed_cells_;
+  std::vector<CollapseEvent> collapse_events_;
+
+  size_t idx(size_t x, size_t y, size_t z) const {
+    return x + nx_ * (y + ny_ * z);
+  }
+
+  void activate(size_t i) {
+    if (!in_active_[i]) {
+      in_active_[i] = 1;
+      if (!active_.empty() && i < active_.back())
+        active_sorted_ = false;
+      active_.push_back(i);
+    }
+  }
+
   void accumulate_fault_stress(double dt) {
     for (auto &fault : faults_) {
       fault.stress_accumulation += fault.slip_rate * dt / (365.25 * 86400.0);
@@ -199,16 +279,47 @@ private:
   }
 
   void apply_seismic_damage(const SeismicEvent &event) {
-    for (size_t z = 0; z < nz_; ++z) {
-      for (size_t y = 0; y < ny_; ++y) {
-        for (size_t x = 0; x < nx_; ++x) {
+    // Damage needs intensity > 0.5, i.e. distance < 100 * (2M - 1), so only
+    // the cells inside that sphere are visited
+    double radius = 100.0 * (2.0 * event.magnitude - 1.0);
+    if (radius <= 0.0 || nx_ == 0 || ny_ == 0 || nz_ == 0)
+      return;
+
+    auto axis_range = [](double c, double r, size_t n, size_t &lo,
+                         size_t &hi) {
+      double a = std::ceil(c - r), b = std::floor(c + r);
+      if (b < 0.0 || a > static_cast<double>(n - 1))
+        return false;
+      lo = static_cast<size_t>(std::max(a, 0.0));
+      hi = static_cast<size_t>(std::min(b, static_cast<double>(n - 1)));
+      return true;
+    };
+
+    size_t z0, z1, y0, y1;
+    if (!axis_range(event.z, radius, nz_, z0, z1) ||
+        !axis_range(event.y, radius, ny_, y0, y1))
+      return;
+
+    for (size_t z = z0; z <= z1; ++z) {
+      double dz = static_cast<double>(z) - event.z;
+      for (size_t y = y0; y <= y1; ++y) {
+        double dy = static_cast<double>(y) - event.y;
+        double chord_sq = radius * radius - dy * dy - dz * dz;
+        if (chord_sq < 0.0)
+          continue;
+        size_t x0, x1;
+        if (!axis_range(event.x, std::sqrt(chord_sq), nx_, x0, x1))
+          continue;
+
+        for (size_t x = x0; x <= x1; ++x) {
           double intensity = event.intensity_at(x, y, z);
-          auto &cell = at(x, y, z);
 
           // Damage proportional to intensity
           if (intensity > 0.5) {
-            cell.integrity -= (intensity - 0.5) * 0.1;
-            cell.load += intensity * 0.2;
+            size_t i = idx(x, y, z);
+            cells_.integrity[i] -= (intensity - 0.5) * 0.1;
+            cells_.load[i] += intensity * 0.2;
+            activate(i);
           }
         }
       }
@@ -229,51 +340,82 @@ private:
           if ((size_t)nx >= nx_ || (size_t)ny >= ny_ || (size_t)nz >= nz_)
             continue;
 
-          at(nx, ny, nz).load += 0.1;
+          size_t i = idx(nx, ny, nz);
+          cells_.load[i] += 0.1;
+          activate(i);
         }
       }
     }
   }
 
   void propagate_stress() {
+    // Sorted indices keep the gathers close to unit stride
+    if (!active_sorted_) {
+      std::sort(active_.begin(), active_.end());
+      active_sorted_ = true;
+    }
+
+    double *integrity = cells_.integrity.data();
+    double *load = cells_.load.data();
+    const double *support = cells_.support.data();
+    const size_t *active = active_.data();
+    const size_t n = active_.size();
+    const double rate = config_.stress_propagation;
+
     // Stress spreads from high-load to low-load cells
-    for (size_t z = 0; z < nz_; ++z) {
-      for (size_t y = 0; y < ny_; ++y) {
-        for (size_t x = 0; x < nx_; ++x) {
-          auto &cell = at(x, y, z);
-
-          // Reduce integrity under load
-          if (cell.load > cell.support) {
-            cell.integrity -=
-                (cell.load - cell.support) * config_.stress_propagation;
-          }
+#pragma omp simd
+    for (size_t k = 0; k < n; ++k) {
+      size_t i = active[k];
+      double l = load[i];
+
+      // Reduce integrity under load
+      double excess = std::max(l - support[i], 0.0);
+      integrity[i] = std::clamp(integrity[i] - excess * rate, 0.0, 1.0);
+      load[i] = l * 0.99; // Gradual stress relaxation
+    }
+  }
 
-          // Clamp values
-          cell.integrity = std::clamp(cell.integrity, 0.0, 1.0);
-          cell.load *= 0.99; // Gradual stress relaxation
-        }
+  void check_collapses() {
+    collapse_worklist_.clear();
+    for (size_t i : active_) {
+      if (!cells_.collapsed[i] &&
+          cells_.integrity[i] < config_.collapse_threshold) {
+        collapse_worklist_.push_back(i);
+      }
+    }
+
+    // The worklist is in index order (z-major), matching a full-grid scan
+    for (size_t i : collapse_worklist_) {
+      cells_.collapsed[i] = 1;
+      cells_.is_void[i] = 1;
+      collapsed_cells_.push_back(i);
+
+      size_t plane = nx_ * ny_;
+      size_t z = i / plane;
+      collapse_events_.push_back(
+          {i % nx_, (i / nx_) % ny_, z, current_time_});
+
+      // Cascade: add load to cells below, which joins the active set
+      if (z > 0) {
+        cells_.load[i - plane] += 0.5;
+        activate(i - plane);
       }
     }
   }
 
-  void check_collapses() {
-    for (size_t z = 0; z < nz_; ++z) {
-      for (size_t y = 0; y < ny_; ++y) {
-        for (size_t x = 0; x < nx_; ++x) {
-          auto &cell = at(x, y, z);
-
-          if (!cell.collapsed && cell.integrity < config_.collapse_threshold) {
-            cell.collapsed = true;
-            cell.is_void = true;
-
-            // Cascade: add load to cells below
-            if (z > 0) {
-              at(x, y, z - 1).load += 0.5;
-            }
-          }
-        }
+  void retire_settled_cells() {
+    size_t out = 0;
+    for (size_t i : active_) {
+      bool pending_collapse = !cells_.collapsed[i] &&
+                              cells_.integrity[i] < config_.collapse_threshold;
+      if (cells_.load[i] > kLoadEpsilon || pending_collapse) {
+        active_[out++] = i;
+      } else {
+        cells_.load[i] = 0.0;
+        in_active_[i] = 0;
       }
     }
+    active_.resize(out);
   }
 };
 
@@ -7,15 +7,14 @@
  * Features:
  * - Aquifer modeling
  * - Water table dynamics
- * - Flooding mechanics
+ * - Shallow-water flooding
  * - Pressure-driven flow
  * - Erosion
  */
 
 #include <algorithm>
 #include <cmath>
-#include <string>
-#include <unordered_map>
+#include <cstdint>
 #include <vector>
 
 namespace isolated {
@@ -51,7 +50,7 @@ struct Aquifer {
 
 struct WaterTable {
   std::vector<double> height; // Water table height at each (x,y)
-  size_t nx, ny;
+  size_t nx = 0, ny = 0;
   double base_height = 0.0;
 
   void initialize(size_t width, size_t depth, double initial_height) {
@@ -70,16 +69,305 @@ struct WaterTable {
 // FLOODING
 // ============================================================================
 
-struct FloodState {
-  double water_level = 0.0;  // Current flood height (m)
-  double inflow_rate = 0.0;  // m³/s water entering
-  double outflow_rate = 0.0; // m³/s water draining
-  double area = 100.0;       // m² floor area
+/**
+ * @brief Shallow-water flood solver on a 2D floor grid.
+ *
+ * Uses the local inertial form of the shallow-water equations (as in
+ * LISFLOOD-FP). Unit-width discharges live on cell faces and are driven by
+ * the free-surface slope, with Manning friction applied semi-implicitly.
+ * A lake at rest therefore stays exactly at rest over any bed, i.e. the
+ * scheme is well balanced. Face flow depth is measured above the higher of
+ * the two beds, and outflow per face is capped at a quarter of the cell's
+ * water, so depths never go negative.
+ *
+ * Only cells that are wet, or next to a wet cell or a source, are updated.
+ * They are kept as sorted runs of consecutive cells along x, and each run
+ * is swept with straight-line loops the compiler can vectorize. Dry regions
+ * cost nothing. Depth is double buffered and every buffer is sized at
+ * initialize(), so steps do not allocate once the active set has grown.
+ * The grid is surrounded by walls.
+ */
+class FloodGrid {
+public:
+  struct Config {
+    double cell_size = 1.0;  // m
+    double gravity = 9.81;   // m/s²
+    double manning_n = 0.03; // s/m^(1/3), rough rock floor
+    double dry_depth = 1e-4; // m; shallower cells count as dry
+    double cfl = 0.7;        // Fraction of the gravity-wave time step
+  };
+
+  FloodGrid() { config_ = Config{}; }
+
+  void initialize(size_t nx, size_t ny, const Config &config,
+                  double bed = 0.0) {
+    config_ = config;
+    nx_ = nx;
+    ny_ = ny;
+    stride_ = nx + 2;
+    size_t n = stride_ * (ny + 2);
+
+    bed_.assign(n, kWall);
+    h_.assign(n, 0.0);
+    h_next_.assign(n, 0.0);
+    qx_.assign(n, 0.0);
+    qy_.assign(n, 0.0);
+    active_mask_.assign(n, 0);
+    for (size_t y = 0; y < ny; ++y) {
+      std::fill_n(&bed_[cell(0, y)], nx, bed);
+    }
+
+    active_.clear();
+    next_active_.clear();
+    pending_.clear();
+    runs_.clear();
+    sources_.clear();
+  }
+
+  void set_bed(size_t x, size_t y, double elevation) {
+    bed_[cell(x, y)] = elevation;
+    pending_.push_back(cell(x, y));
+  }
+
+  /// Pour water into a cell (negative volumes drain, down to dry).
+  void add_water(size_t x, size_t y, double volume_m3) {
+    size_t i = cell(x, y);
+    double area = config_.cell_size * config_.cell_size;
+    h_[i] = std::max(0.0, h_[i] + volume_m3 / area);
+    pending_.push_back(i);
+  }
+
+  /**
+   * @brief Register a point inflow (positive) or pump (negative).
+   * @return Source id for set_source_rate().
+   */
+  size_t add_source(size_t x, size_t y, double rate_m3s) {
+    sources_.push_back({cell(x, y), rate_m3s, 0.0});
+    return sources_.size() - 1;
+  }
+
+  void set_source_rate(size_t id, double rate_m3s) {
+    sources_[id].rate = rate_m3s;
+  }
+
+  /// Volume actually delivered (or removed) by a source in the last step.
+  double source_volume(size_t id) const { return sources_[id].last_volume; }
+
+  /**
+   * @brief Seepage into the floor: each wet cell loses this fraction of
+   * its depth per second (applied implicitly, so any rate is stable).
+   */
+  void set_drainage(double per_second) { drainage_ = std::max(0.0, per_second); }
+  double drainage() const { return drainage_; }
+
+  /**
+   * @brief Advance by dt seconds, sub-stepping to stay within the CFL limit.
+   */
+  void step(double dt) {
+    for (auto &src : sources_) {
+      src.last_volume = 0.0;
+    }
+
+    double t = 0.0;
+    while (t < dt) {
+      double h_max = rebuild_active_set();
+      if (active_.empty()) {
+        break;
+      }
+
+      double wave = std::sqrt(config_.gravity * std::max(h_max, 1e-3));
+      double sub = std::min(dt - t, config_.cfl * config_.cell_size / wave);
+      update_fluxes(sub);
+      update_depths(sub);
+      t += sub;
+    }
+  }
+
+  // === Queries ===
+
+  double depth(size_t x, size_t y) const { return h_[cell(x, y)]; }
+  double bed(size_t x, size_t y) const { return bed_[cell(x, y)]; }
+  double surface(size_t x, size_t y) const {
+    return bed(x, y) + depth(x, y);
+  }
+
+  bool is_flooded(size_t x, size_t y) const { return depth(x, y) > 0.1; }
+  bool is_dangerous(size_t x, size_t y) const { return depth(x, y) > 1.0; }
+
+  double total_volume() const {
+    double sum = 0.0;
+    for (size_t y = 0; y < ny_; ++y) {
+      for (size_t x = 0; x < nx_; ++x) {
+        sum += h_[cell(x, y)];
+      }
+    }
+    return sum * config_.cell_size * config_.cell_size;
+  }
 
-  double volume() const { return water_level * area; }
+  size_t active_cells() const { return active_.size(); }
+  size_t nx() const { return nx_; }
+  size_t ny() const { return ny_; }
+
+private:
+  static constexpr double kWall = 1e30;
+
+  struct Source {
+    size_t cell;
+    double rate;        // m³/s, negative = pump
+    double last_volume; // m³ moved during the last step()
+  };
+
+  // Consecutive active cells [begin, end) in one row of the padded grid
+  struct Run {
+    size_t begin, end;
+  };
 
-  bool is_flooded() const { return water_level > 0.1; }
-  bool is_dangerous() const { return water_level > 1.0; }
+  Config config_;
+  size_t nx_ = 0, ny_ = 0, stride_ = 0;
+  double drainage_ = 0.0; // 1/s
+
+  // Padded (nx + 2) * (ny + 2) grids; the border is wall
+  std::vector<double> bed_;
+  std::vector<double> h_, h_next_;
+  std::vector<double> qx_; // Face between cell i and i + 1, m²/s
+  std::vector<double> qy_; // Face between cell i and i + stride, m²/s
+
+  std::vector<uint8_t> active_mask_;
+  std::vector<size_t> active_, next_active_, pending_;
+  std::vector<Run> runs_;
+  std::vector<Source> sources_;
+
+  size_t cell(size_t x, size_t y) const { return (x + 1) + (y + 1) * stride_; }
+
+  void mark(size_t i) {
+    if (active_mask_[i] != 2 && bed_[i] < kWall) {
+      active_mask_[i] = 2;
+      next_active_.push_back(i);
+    }
+  }
+
+  void mark_with_neighbours(size_t i) {
+    mark(i);
+    mark(i - 1);
+    mark(i + 1);
+    mark(i - stride_);
+    mark(i + stride_);
+  }
+
+  /**
+   * @brief Active = wet cells, sources, touched cells and their 4
+   * neighbours. Every face with water on either side then has both cells
+   * active. Returns the deepest active depth.
+   */
+  double rebuild_active_set() {
+    next_active_.clear();
+    double h_max = 0.0;
+
+    for (size_t i : active_) {
+      if (h_[i] > config_.dry_depth) {
+        h_max = std::max(h_max, h_[i]);
+        mark_with_neighbours(i);
+      }
+    }
+    for (size_t i : pending_) {
+      h_max = std::max(h_max, h_[i]);
+      mark_with_neighbours(i);
+    }
+    for (const auto &src : sources_) {
+      mark_with_neighbours(src.cell);
+    }
+    pending_.clear();
+
+    // Cells leaving the set: flush faces, keep both depth buffers in step
+    for (size_t i : active_) {
+      if (active_mask_[i] == 2)
+        continue;
+      active_mask_[i] = 0;
+      qx_[i] = qx_[i - 1] = 0.0;
+      qy_[i] = qy_[i - stride_] = 0.0;
+      h_next_[i] = h_[i];
+    }
+    for (size_t i : next_active_) {
+      active_mask_[i] = 1;
+    }
+
+    std::sort(next_active_.begin(), next_active_.end());
+    active_.swap(next_active_);
+
+    runs_.clear();
+    for (size_t k = 0; k < active_.size();) {
+      size_t begin = active_[k];
+      size_t end = begin + 1;
+      // Walls at both row ends keep runs within a row
+      while (++k < active_.size() && active_[k] == end) {
+        ++end;
+      }
+      runs_.push_back({begin, end});
+    }
+    return h_max;
+  }
+
+  void update_fluxes(double dt) {
+    const double g = config_.gravity;
+    const double dx = config_.cell_size;
+    const double friction = g * dt * config_.manning_n * config_.manning_n;
+    const double dry = config_.dry_depth;
+    const double cap = dx / (4.0 * dt);
+    const size_t s = stride_;
+    const double *bed = bed_.data();
+    const double *h = h_.data();
+    double *qx = qx_.data();
+    double *qy = qy_.data();
+
+    // Each active cell owns its +x and +y faces, so every face between
+    // two active cells is updated exactly once
+    auto face = [=](double q, size_t a, size_t b) {
+      double eta_a = bed[a] + h[a], eta_b = bed[b] + h[b];
+      double hf = std::max(eta_a, eta_b) - std::max(bed[a], bed[b]);
+      if (hf <= dry)
+        return 0.0;
+      double slope = (eta_b - eta_a) / dx;
+      double hf73 = hf * hf * std::cbrt(hf);
+      double qn =
+          (q - g * hf * dt * slope) / (1.0 + friction * std::abs(q) / hf73);
+      return std::clamp(qn, -h[b] * cap, h[a] * cap);
+    };
+
+    for (const Run &run : runs_) {
+#pragma omp simd
+      for (size_t i = run.begin; i < run.end; ++i) {
+        qx[i] = face(qx[i], i, i + 1);
+        qy[i] = face(qy[i], i, i + s);
+      }
+    }
+  }
+
+  void update_depths(double dt) {
+    const double k = dt / config_.cell_size;
+    const size_t s = stride_;
+    const double *h = h_.data();
+    const double *qx = qx_.data();
+    const double *qy = qy_.data();
+    double *h_next = h_next_.data();
+    const double keep = 1.0 / (1.0 + drainage_ * dt);
+
+    for (const Run &run : runs_) {
+#pragma omp simd
+      for (size_t i = run.begin; i < run.end; ++i) {
+        double net = qx[i - 1] - qx[i] + qy[i - s] - qy[i];
+        h_next[i] = std::max(0.0, h[i] + k * net) * keep;
+      }
+    }
+
+    double area = config_.cell_size * config_.cell_size;
+    for (auto &src : sources_) {
+      double dv = std::max(src.rate * dt, -h_next[src.cell] * area);
+      h_next[src.cell] += dv / area;
+      src.last_volume += dv;
+    }
+
+    h_.swap(h_next_);
+  }
 };
 
 // ============================================================================
@@ -91,22 +379,30 @@ public:
   struct Config {
     double water_density = 1000.0; // kg/m³
     double gravity = 9.81;
-    double drainage_coeff = 0.01; // Drainage rate coefficient
+    double drainage_coeff = 0.01; // 1/s, flood water seeping into the floor
     double erosion_rate = 1e-6;   // m/s per unit flow
   };
 
-  explicit HydrologySystem(const Config &config = Config{}) : config_(config) {}
+  HydrologySystem() { config_ = Config{}; }
+  explicit HydrologySystem(const Config &config) : config_(config) {}
 
   void add_aquifer(const Aquifer &aq) { aquifers_.push_back(aq); }
 
   void initialize_water_table(size_t nx, size_t ny, double height) {
     water_table_.initialize(nx, ny, height);
+    scratch_height_.assign(nx * ny, height);
   }
 
-  void add_flood_zone(const std::string &id, double area) {
-    FloodState fs;
-    fs.area = area;
-    flood_zones_[id] = fs;
+  /**
+   * @brief Set up the flood grid over the cave/habitat floor.
+   * Beds default to 0; set them with flooding().set_bed(). Water seeps
+   * into the floor at Config::drainage_coeff.
+   */
+  void initialize_flooding(size_t nx, size_t ny,
+                           const FloodGrid::Config &config = {}) {
+    flood_.initialize(nx, ny, config);
+    flood_.set_drainage(config_.drainage_coeff);
+    breaches_.clear();
   }
 
   /**
@@ -117,29 +413,29 @@ public:
   void step(double dt, double rainfall = 0.0) {
     update_aquifers(dt, rainfall);
     update_water_table(dt);
-    update_flooding(dt);
+    update_breaches(dt);
+    flood_.step(dt);
+    drain_breached_aquifers();
   }
 
   // === Flood control ===
 
-  void breach_aquifer(size_t aquifer_idx, double breach_area) {
+  /**
+   * @brief Open a breach from an aquifer into the flood grid at (x, y).
+   * Darcy inflow is recomputed each step from the aquifer's head and drawn
+   * from its volume.
+   */
+  void breach_aquifer(size_t aquifer_idx, double breach_area, size_t x,
+                      size_t y) {
     if (aquifer_idx >= aquifers_.size())
       return;
-
-    auto &aq = aquifers_[aquifer_idx];
-    double flow = calculate_darcy_flow(aq, breach_area);
-
-    // Water flows into connected flood zones
-    for (auto &[id, zone] : flood_zones_) {
-      zone.inflow_rate += flow;
-    }
+    breaches_.push_back(
+        {aquifer_idx, breach_area, flood_.add_source(x, y, 0.0)});
   }
 
-  void pump_water(const std::string &zone_id, double rate_m3s) {
-    auto it = flood_zones_.find(zone_id);
-    if (it != flood_zones_.end()) {
-      it->second.outflow_rate += rate_m3s;
-    }
+  /// Pump water out of the flood grid at (x, y).
+  size_t pump_water(size_t x, size_t y, double rate_m3s) {
+    return flood_.add_source(x, y, -rate_m3s);
   }
 
   // === Erosion ===
@@ -158,16 +454,22 @@ public:
   const WaterTable &water_table() const { return water_table_; }
   WaterTable &water_table() { return water_table_; }
 
-  FloodState *get_flood_zone(const std::string &id) {
-    auto it = flood_zones_.find(id);
-    return it != flood_zones_.end() ? &it->second : nullptr;
-  }
+  const FloodGrid &flooding() const { return flood_; }
+  FloodGrid &flooding() { return flood_; }
 
 private:
+  struct AquiferBreach {
+    size_t aquifer;
+    double area;   // m²
+    size_t source; // FloodGrid source id
+  };
+
   Config config_;
   std::vector<Aquifer> aquifers_;
   WaterTable water_table_;
-  std::unordered_map<std::string, FloodState> flood_zones_;
+  std::vector<double> scratch_height_; // Water table double buffer
+  FloodGrid flood_;
+  std::vector<AquiferBreach> breaches_;
 
   void update_aquifers(double dt, double rainfall) {
     for (auto &aq : aquifers_) {
@@ -185,8 +487,11 @@ private:
 
   void update_water_table(double dt) {
     // Simple diffusion of water table height
-    std::vector<double> new_height = water_table_.height;
-    double diffusivity = 0.1; // m²/s
+    if (water_table_.nx < 3 || water_table_.ny < 3)
+      return;
+    std::vector<double> &new_height = scratch_height_;
+    new_height = water_table_.height; // Same size: copies, no allocation
+    double diffusivity = 0.1;         // m²/s
 
     for (size_t y = 1; y < water_table_.ny - 1; ++y) {
       for (size_t x = 1; x < water_table_.nx - 1; ++x) {
@@ -198,28 +503,24 @@ private:
       }
     }
 
-    water_table_.height = new_height;
+    water_table_.height.swap(new_height);
   }
 
-  void update_flooding(double dt) {
-    for (auto &[id, zone] : flood_zones_) {
-      // Net flow
-      double net_flow = zone.inflow_rate - zone.outflow_rate;
-      double volume_change = net_flow * dt;
-
-      // Update level
-      double old_volume = zone.volume();
-      double new_volume = std::max(0.0, old_volume + volume_change);
-      zone.water_level = new_volume / zone.area;
-
-      // Natural drainage
-      if (zone.water_level > 0) {
-        double drainage = config_.drainage_coeff * zone.water_level * dt;
-        zone.water_level = std::max(0.0, zone.water_level - drainage);
-      }
+  void update_breaches(double dt) {
+    for (const auto &b : breaches_) {
+      const auto &aq = aquifers_[b.aquifer];
+      double flow = calculate_darcy_flow(aq, b.area);
+      // Never draw more than the aquifer holds
+      flow = std::min(flow, std::max(aq.current_volume, 0.0) / dt);
+      flood_.set_source_rate(b.source, flow);
+    }
+  }
 
-      // Reset flow rates for next step
-      zone.inflow_rate = 0.0;
+  void drain_breached_aquifers() {
+    for (const auto &b : breaches_) {
+      auto &aq = aquifers_[b.aquifer];
+      aq.current_volume =
+          std::max(0.0, aq.current_volume - flood_.source_volume(b.source));
     }
   }
 
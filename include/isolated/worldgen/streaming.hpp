@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * @file streaming.hpp
+ * @brief Chunk-streamed geology, caverns and ore.
+ */
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <isolated/world/chunk.hpp>
+#include <isolated/worldgen/worldgen.hpp>
+
+namespace isolated {
+namespace worldgen {
+
+/**
+ * @brief Fills world chunks with strata, caves and ore on demand.
+ *
+ * Meant to run inside ChunkManager's terrain callback after the surface
+ * pass. Only rock below the surface is rewritten; soil, water and air are
+ * left to the surface generator. Every voxel is a pure function of the seed
+ * and its world coordinates, so chunks can be generated in any order,
+ * regenerated after eviction, and memory stays proportional to the loaded
+ * chunks. generate() is const and may run on several threads at once.
+ */
+class ChunkWorldGenerator {
+public:
+  struct Config {
+    int surface_z = 50;        // World Z of geology depth 0 if no heightmap
+    // World Z of the surface in column (x, y), e.g. the terrain heightmap;
+    // depth is measured from it. Must be thread-safe. Flat if empty.
+    std::function<int(int, int)> surface_height;
+    size_t strata_depth = 256; // Cells from regolith to granite basement
+    int cave_min_depth = 8;    // No caves within this many cells of surface
+    GeologyGenerator::Config geology;
+    CavernGenerator3D::Config caverns;
+  };
+
+  explicit ChunkWorldGenerator(const Config &config, uint32_t seed = 42);
+
+  /**
+   * @brief Apply strata, caves and ore to a generated chunk.
+   * @param deposits If non-null, receives the chunk's mineral deposits in
+   *                 world coordinates.
+   */
+  void generate(world::Chunk &chunk,
+                std::vector<MineralDeposit> *deposits = nullptr) const;
+
+  static world::Material to_material(RockType rock);
+
+  const GeologyGenerator &geology() const { return geology_; }
+
+private:
+  Config config_;
+  GeologyGenerator geology_;
+  CavernGenerator3D caverns_;
+  MineralSystem minerals_;
+  std::array<double, 8> rock_density_{}; // Indexed by RockType
+
+  int surface_at(int x, int y) const {
+    return config_.surface_height ? config_.surface_height(x, y)
+                                  : config_.surface_z;
+  }
+};
+
+} // namespace worldgen
+} // namespace isolated
@@ -5,12 +5,15 @@
  * @brief Procedural world generation: noise, geology, caverns, minerals.
  */
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
 #include <random>
 #include <vector>
 
+#include <isolated/worldgen/feature_index.hpp>
+
 namespace isolated {
 namespace worldgen {
 
@@ -60,6 +63,16 @@ enum class RockType : uint8_t {
 
 /**
  * @brief Geology layer generator.
+ *
+ * Every cell is a pure function of the seed and its coordinates (z grows
+ * with depth; `depth` sets the strata thickness scale, and cells below the
+ * grid continue as basement granite). generate_region() can therefore
+ * produce any window of an unbounded world without the whole grid;
+ * generate() fills the width * height * depth grid from the origin.
+ *
+ * The strata noise is low-frequency, so it is evaluated on a lattice every
+ * `strata_lattice` cells and trilinearly interpolated; sample() and
+ * generate_region() interpolate identically.
  */
 class GeologyGenerator {
 public:
@@ -67,7 +80,8 @@ public:
     double base_layer_scale = 0.02;
     double ore_scale = 0.1;
     double ore_threshold = 0.7;
-    int ore_frequency = 5; // % chance
+    int ore_frequency = 5;  // % chance
+    int strata_lattice = 4; // Cells between strata noise samples (1 = exact)
   };
 
   GeologyGenerator(size_t width, size_t height, size_t depth,
@@ -75,15 +89,29 @@ public:
 
   void generate();
 
+  /**
+   * @brief Generate rock for the box starting at (ox, oy, oz).
+   * @param out nx * ny * nz cells, x fastest, then y, then z.
+   */
+  void generate_region(int ox, int oy, int oz, size_t nx, size_t ny,
+                       size_t nz, std::vector<RockType> &out) const;
+
+  RockType sample(int x, int y, int z) const;
+
   RockType get(size_t x, size_t y, size_t z) const;
   const std::vector<RockType> &get_grid() const { return grid_; }
 
+  uint32_t seed() const { return seed_; }
+
 private:
   size_t width_, height_, depth_;
   Config config_;
+  uint32_t seed_;
   NoiseGenerator noise_;
   std::vector<RockType> grid_;
-  std::mt19937 rng_;
+
+  double strata_noise_at_node(int lx, int ly, int lz) const;
+  RockType classify(int x, int y, int z, double strata_noise) const;
 
   size_t idx(size_t x, size_t y, size_t z) const {
     return x + width_ * (y + height_ * z);
@@ -96,6 +124,11 @@ private:
 
 /**
  * @brief Cavern and tunnel generator using cellular automata.
+ *
+ * The map is bit-packed, 64 cells per word along x (1 = solid), with one zero
+ * pad word at each end of a row. smooth() counts neighbours with bit-sliced
+ * adder networks over whole words and ping-pongs between two buffers, so an
+ * iteration allocates nothing. Border cells are never updated.
  */
 class CavernGenerator {
 public:
@@ -113,15 +146,63 @@ public:
   void smooth();
 
   bool is_open(size_t x, size_t y) const;
-  const std::vector<bool> &get_map() const { return map_; }
+
+  // Packed rows of row_stride() words; data word i of row y is at
+  // y * row_stride() + 1 + i.
+  const std::vector<uint64_t> &get_words() const { return map_; }
+  size_t row_stride() const { return stride_; }
 
 private:
   size_t width_, height_;
+  size_t stride_; // Words per row including the two pad words
   Config config_;
-  std::vector<bool> map_;
+  std::vector<uint64_t> map_, next_;
+  std::vector<uint64_t> interior_; // 1 bits for cells smooth() may update
+  std::vector<uint64_t> sum_lo_, sum_hi_;
   std::mt19937 rng_;
+};
+
+/**
+ * @brief Chunk-local 3D cavern generator.
+ *
+ * Runs the CavernGenerator automaton over the 26-cell Moore neighbourhood.
+ * The initial fill is a hash of (seed, world x, y, z) rather than a
+ * sequential RNG, and every region is smoothed with a halo of
+ * smoothing_iterations cells on each side. A chunk therefore reproduces
+ * exactly the cells a single world-sized run would produce, and chunks can
+ * be generated in any order or in parallel without seams.
+ */
+class CavernGenerator3D {
+public:
+  struct Config {
+    double initial_fill = 0.54; // Settles to ~86% rock; 0.5 hollows half
+    int smoothing_iterations = 4;
+    int birth_threshold = 14; // Open cell fills with >= this many of 26
+    int death_threshold = 13; // Solid cell survives with >= this many of 26
+  };
+
+  explicit CavernGenerator3D(const Config &config, uint32_t seed = 42);
 
-  int count_neighbors(size_t x, size_t y) const;
+  /**
+   * @brief Generate the solid mask for the world-space box starting at
+   * (ox, oy, oz) with extent nx * ny * nz.
+   * @param solid Output bits (1 = solid), rows of words_per_row(nx) words,
+   *              x fastest, then y, then z.
+   */
+  void generate_region(int ox, int oy, int oz, size_t nx, size_t ny,
+                       size_t nz, std::vector<uint64_t> &solid) const;
+
+  static size_t words_per_row(size_t nx) { return (nx + 63) / 64; }
+  size_t halo() const {
+    return static_cast<size_t>(std::max(config_.smoothing_iterations, 0));
+  }
+
+private:
+  Config config_;
+  uint32_t seed_;
+  uint64_t fill_threshold_;
+
+  bool initial_solid(int x, int y, int z) const;
 };
 
 // ============================================================================
@@ -129,7 +210,7 @@ private:
 // ============================================================================
 
 struct MineralDeposit {
-  size_t x, y, z;
+  int x, y, z; // Cell in the generating geology's coordinates
   RockType type;
   double quantity; // kg
   double purity;   // 0-1
@@ -137,21 +218,43 @@ struct MineralDeposit {
 
 /**
  * @brief Mineral deposit tracker and generator.
+ *
+ * Deposits are indexed spatially as they are added; depleted deposits stay
+ * in get_deposits() (indices are stable) but drop out of the index.
  */
 class MineralSystem {
 public:
-  MineralSystem(size_t width, size_t height, size_t depth);
+  MineralSystem(size_t width, size_t height, size_t depth, uint32_t seed = 42);
 
   void generate_deposits(const GeologyGenerator &geology, size_t count = 20);
 
+  /// Track a deposit, e.g. one reported by ChunkWorldGenerator. Returns its index.
+  size_t add_deposit(const MineralDeposit &deposit);
+
+  /**
+   * @brief Deposit for an ore cell; quantity and purity are hashed from the
+   * seed and the cell, so streamed chunks always agree.
+   */
+  MineralDeposit deposit_at(int x, int y, int z, RockType type) const;
+
   const std::vector<MineralDeposit> &get_deposits() const { return deposits_; }
 
   double extract(size_t deposit_idx, double amount_kg);
 
+  /**
+   * @brief Indices of non-depleted deposits inside `box`, appended to `out`.
+   */
+  void deposits_in(const FeatureBox &box, std::vector<size_t> &out) const;
+
+  const FeatureIndex &index() const { return index_; }
+
 private:
   size_t width_, height_, depth_;
+  uint32_t seed_;
   std::vector<MineralDeposit> deposits_;
-  std::mt19937 rng_{42};
+  std::vector<uint32_t> handles_; // Index handle per deposit
+  FeatureIndex index_;
+  std::mt19937 rng_;
 };
 
 } // namespace worldgen
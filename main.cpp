@@ -4,24 +4,35 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cmath>
 #include <iostream>
+#include <unordered_map>
 
 #include "raylib.h"
 
-#include <isolated/biology/blood_chemistry.hpp>
-#include <isolated/biology/circulation.hpp>
+#include <isolated/biology/coagulation.hpp>
+#include <isolated/biology/hematology.hpp>
+#include <isolated/biology/multirate.hpp>
 #include <isolated/core/constants.hpp>
+#include <isolated/core/field_registry.hpp>
 #include <isolated/fluids/lbm_engine.hpp>
 #include <isolated/renderer/debug_ui.hpp>
 #include <isolated/renderer/renderer.hpp>
 #include <isolated/thermal/heat_engine.hpp>
 #include <isolated/entities/entity_manager.hpp>
 #include <isolated/entities/needs_system.hpp>
+#include <isolated/entities/simulation_lod.hpp>
 #include <isolated/entities/metabolism_system.hpp>
+#include <isolated/entities/system_scheduler.hpp>
 #include <isolated/core/lod_zone_manager.hpp>
 #include <isolated/world/chunk_manager.hpp>
+#include <isolated/world/flow_field.hpp>
+#include <isolated/world/light_field.hpp>
+#include <isolated/world/navigation.hpp>
 #include <isolated/world/terrain_generator.hpp>
+#include <isolated/worldgen/streaming.hpp>
 #include <isolated/gpu/gpu_compute.hpp>
 
 using namespace isolated;
@@ -69,11 +80,9 @@ int main() {
   std::cout << "[OK] Thermal: Radiation enabled, hot/cold zones set"
             << std::endl;
 
-  // Initialize Biology Systems
-  biology::WindkesselCirculation circulation(70.0);
-  biology::BloodChemistrySystem blood_chem;
-  std::cout << "[OK] Biology: Windkessel + Blood Chemistry initialized"
-            << std::endl;
+  // Initialize Biology Systems: one physiology per astronaut, batched per
+  // LOD tier (full rate near the selection or in crisis, coarser far away)
+  entities::SimulationLod sim_lod;
 
   // Initialize Renderer
   renderer::RendererConfig render_config;
@@ -112,6 +121,23 @@ int main() {
     std::cout << "[WARN] GPU: LBM compute shader failed, using CPU fallback" << std::endl;
   }
 
+  // Engines share fields in place through the registry: thermal advection
+  // reads the LBM velocity directly, and the stage order keeps each field's
+  // writer ahead of its readers
+  core::FieldRegistry fields;
+  fluids.publish_fields(fields);
+  thermal.publish_fields(fields);
+  thermal.bind_fluid_velocity(fields.view<const double>("fluid.ux"),
+                              fields.view<const double>("fluid.uy"));
+  const auto fluid_stage = fields.add_stage(
+      "fluid", {},
+      {fields.find("fluid.density"), fields.find("fluid.ux"),
+       fields.find("fluid.uy"), fields.find("fluid.uz")});
+  fields.add_stage("thermal", {fields.find("fluid.ux"), fields.find("fluid.uy")},
+                   {fields.find("thermal.temperature")});
+  const auto physics_order = fields.stage_order();
+  const auto thermal_temperature = fields.find("thermal.temperature");
+
   // Initialize Entity Manager (ECS)
   entities::EntityManager entity_manager;
   entity_manager.init();
@@ -120,8 +146,115 @@ int main() {
   entity_manager.spawn_astronaut(50, 50, 51, "Bob");       // Z=51 is surface level
   entity_manager.spawn_astronaut(60, 40, 51, "Alice");
   entity_manager.spawn_astronaut(100, 100, 51, "Commander");
+  for (auto entity : entity_manager.registry().view<entities::Astronaut>()) {
+    sim_lod.add(entity_manager.registry(), entity);
+    entity_manager.registry().emplace<entities::VitalSignals>(entity);
+    entity_manager.registry().emplace<biology::HematologySystem>(entity);
+    entity_manager.registry().emplace<biology::CoagulationSystem>(entity);
+    entity_manager.registry().emplace<biology::OdeIntegrator>(entity);  // Coagulation's
+  }
+  std::cout << "[OK] Biology: " << sim_lod.size() << " astronauts on tiered physiology LOD"
+            << std::endl;
   
   std::cout << "[OK] ECS: EnTT initialized, 3 astronauts spawned" << std::endl;
+
+  // ECS systems run through the scheduler: independent systems in parallel,
+  // conflicting ones in the order registered here
+  core::TaskPool task_pool;
+  entities::SystemScheduler scheduler(task_pool);
+  scheduler.add_system("movement",
+                       entities::ComponentAccess()
+                           .write<entities::Position>()
+                           .write<entities::Velocity>()
+                           .write<entities::PreferredVelocity>()
+                           .write<entities::Path>()
+                           .write<entities::FlowFollower>()
+                           .write<entities::Settled>()
+                           .read<world::ChunkManager>()
+                           .write<world::PathQueue>()
+                           .write<world::FlowFieldCache>(),
+                       [&](double dt) { entity_manager.update(dt, &task_pool); });
+  // Needs and metabolism are throttled (don't need per-step accuracy)
+  scheduler.add_system("needs",
+                       entities::ComponentAccess()
+                           .read<entities::Position>()
+                           .read<entities::Metabolism>()
+                           .read<fluids::LBMEngine>()
+                           .write<entities::Needs>()
+                           .write<entities::SimLod>(),
+                       [&](double dt) {
+                         entities::NeedsSystem::update(dt, entity_manager.registry(),
+                                                       fluids, &task_pool);
+                       },
+                       5);
+  scheduler.add_system("metabolism",
+                       entities::ComponentAccess()
+                           .read<entities::Position>()
+                           .read<entities::Velocity>()
+                           .write<entities::Metabolism>()
+                           .write<thermal::ThermalEngine>(),
+                       [&](double dt) {
+                         entities::MetabolismSystem::update(dt, entity_manager.registry(),
+                                                            thermal, &task_pool);
+                       },
+                       5);
+
+  std::cout << "[OK] ECS: scheduler with " << task_pool.concurrency()
+            << " threads" << std::endl;
+
+  // Biology subsystems step at their natural timescales: the unified
+  // physiology several times a second, coagulation every few seconds and
+  // RBC turnover once a minute. Slow subsystems read fast vitals averaged
+  // over their own interval.
+  biology::MultiRateScheduler biology_clock;
+  biology_clock.add("physiology", 1.0 / 6.0, [&](double dt) {
+    const Camera2D& cam = game_renderer.get_camera();
+    sim_lod.assign(entity_manager.registry(), cam.target.x / render_config.tile_size,
+                   cam.target.y / render_config.tile_size, game_renderer.get_z_level(),
+                   game_renderer.get_selected_entity());
+
+    // Runs longer than a second only come from fast-forwarding a rest
+    bool resting = dt > 1.0;
+    auto people = entity_manager.registry().view<const entities::PhysiologySlot,
+                                                 const entities::Position,
+                                                 const entities::Velocity>();
+    for (auto [entity, slot, pos, vel] : people.each()) {
+      entities::SimulationLod::EnvironmentState env;
+      size_t gx = static_cast<size_t>(std::clamp(static_cast<int>(pos.x), 0, 199));
+      size_t gy = static_cast<size_t>(std::clamp(static_cast<int>(pos.y), 0, 199));
+      env.ambient_temp_c = thermal.get_temperature(gx, gy, 0) - 273.15;
+      env.activity_level = !resting && std::hypot(vel.dx, vel.dy) > 0.1f ? 1.5 : 1.0;
+      sim_lod.set_environment(slot, env);
+    }
+    if (resting) {
+      sim_lod.fast_forward(dt, &task_pool);
+    } else {
+      sim_lod.step(dt, &task_pool);
+    }
+
+    auto vitals = entity_manager.registry().view<const entities::PhysiologySlot,
+                                                 entities::VitalSignals>();
+    for (auto [entity, slot, signals] : vitals.each()) {
+      auto snap = sim_lod.snapshot(slot);
+      signals.pao2.publish(biology_clock.time(), snap.pao2);
+      signals.history->record(biology_clock.time(), snap);
+    }
+  }, 3600.0);
+  biology_clock.add("coagulation", 5.0, [&](double dt) {
+    auto view = entity_manager.registry().view<biology::CoagulationSystem,
+                                               biology::OdeIntegrator>();
+    for (auto [entity, coagulation, integrator] : view.each()) {
+      coagulation.step_integrated(dt, integrator);
+    }
+  }, 60.0);
+  biology_clock.add("hematology", 60.0, [&](double dt) {
+    auto view = entity_manager.registry().view<entities::VitalSignals,
+                                               biology::HematologySystem>();
+    for (auto [entity, signals, hematology] : view.each()) {
+      double pao2 = signals.pao2.mean(signals.hematology_cursor);
+      hematology.step(dt, pao2, 1.0, 0.0);
+    }
+  }, 3600.0);
   
   // Initialize LOD Zone Manager for physics optimization (Temporal slicing)
   core::LODConfig lod_config;
@@ -139,6 +272,13 @@ int main() {
   terrain_config.height_amplitude = 30.0;
   terrain_config.sea_level = 50.0;  // Surface at Z=50±30, so always Z > 20
   world::TerrainGenerator terrain_gen(terrain_config);
+
+  // Strata, caverns and ore streamed per chunk below the surface
+  worldgen::ChunkWorldGenerator::Config worldgen_config;
+  worldgen_config.surface_height = [&terrain_gen](int x, int y) {
+    return terrain_gen.surface_height(x, y);
+  };
+  worldgen::ChunkWorldGenerator world_gen(worldgen_config, terrain_config.seed);
   
   world::ChunkManagerConfig chunk_config;
   chunk_config.load_radius = 1;      // 3x3x1 = 9 chunks (minimal for performance)
@@ -147,6 +287,66 @@ int main() {
   chunk_config.save_path = "./world_data/";
   world::ChunkManager chunk_manager(chunk_config);
   
+  // Voxel light levels, kept up to date as chunks load and voxels change
+  world::LightField light_field(chunk_manager);
+
+  // Each astronaut's helmet lamp is a light source that follows them; magma
+  // glows on its own
+  constexpr uint8_t HELMET_LAMP_LEVEL = 10;
+  std::unordered_map<entt::entity, std::array<int, 3>> helmet_lamps;
+  auto update_helmet_lamps = [&]() {
+    auto& registry = entity_manager.registry();
+    // Lamps are keyed by cell, so keep a cell lit while any wearer is in it
+    auto release = [&](const std::array<int, 3>& cell) {
+      for (const auto& [entity, other] : helmet_lamps) {
+        if (other == cell) return;
+      }
+      light_field.remove_source(cell[0], cell[1], cell[2]);
+    };
+    for (auto it = helmet_lamps.begin(); it != helmet_lamps.end();) {
+      if (registry.valid(it->first) && registry.all_of<entities::Position>(it->first)) {
+        ++it;
+        continue;
+      }
+      auto cell = it->second;
+      it = helmet_lamps.erase(it);
+      release(cell);
+    }
+    auto wearers = registry.view<const entities::Astronaut, const entities::Position>();
+    for (auto [entity, astronaut, pos] : wearers.each()) {
+      std::array<int, 3> cell = {static_cast<int>(std::floor(pos.x)),
+                                 static_cast<int>(std::floor(pos.y)), pos.z};
+      auto [it, placed] = helmet_lamps.try_emplace(entity, cell);
+      if (!placed) {
+        if (it->second == cell) continue;
+        auto old_cell = it->second;
+        it->second = cell;
+        release(old_cell);
+      }
+      light_field.add_source(cell[0], cell[1], cell[2], HELMET_LAMP_LEVEL);
+    }
+  };
+
+  // HPA* navigation, repaired per chunk as chunks load and voxels change;
+  // path requests are solved in batches on the task pool. Crowds heading to
+  // one destination share a flow field instead
+  world::NavGraph nav_graph(chunk_manager, &task_pool);
+  world::PathQueue path_queue(nav_graph, task_pool);
+  world::FlowFieldCache flow_fields(nav_graph, &task_pool);
+  entity_manager.set_path_queue(&path_queue);
+  entity_manager.set_flow_fields(&flow_fields);
+  entity_manager.set_chunks(&chunk_manager);
+  scheduler.add_system("navigation",
+                       entities::ComponentAccess()
+                           .read<world::ChunkManager>()
+                           .write<world::NavGraph>()
+                           .write<world::PathQueue>()
+                           .write<world::FlowFieldCache>(),
+                       [&](double) {
+                         path_queue.update();
+                         flow_fields.update();
+                       });
+  
   // Initialize GPU Terrain Generator
   static gpu::TerrainComputeKernel gpu_terrain;
   bool gpu_terrain_ready = gpu_terrain.init(64); // 64^3 chunk size
@@ -157,7 +357,7 @@ int main() {
   }
   
   // Wire terrain generator into chunk manager
-  chunk_manager.set_terrain_generator([&terrain_gen, gpu_terrain_ready](world::Chunk& chunk) {
+  chunk_manager.set_terrain_generator([&terrain_gen, &world_gen, gpu_terrain_ready](world::Chunk& chunk) {
       if (gpu_terrain_ready) {
           auto [ox, oy, oz] = chunk.world_origin();
           // Use chunk origin for coordinate inputs
@@ -174,6 +374,7 @@ int main() {
       } else {
           terrain_gen.generate(chunk);
       }
+      world_gen.generate(chunk);
   });
   
   // Pre-load chunks around surface (Z=50 is sea_level)
@@ -230,6 +431,27 @@ int main() {
         }
     }
 
+    // INPUT: Send the selected entity to the clicked tile on this level;
+    // with Shift held, send every astronaut there along a shared flow field
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
+        Vector2 mouse_pos = GetMousePosition();
+        entt::entity selected = game_renderer.get_selected_entity();
+        if (mouse_pos.x > 220.0f) {
+            Vector2 mouse_world = GetScreenToWorld2D(mouse_pos, game_renderer.get_camera());
+            int tx = static_cast<int>(std::floor(mouse_world.x / render_config.tile_size));
+            int ty = static_cast<int>(std::floor(mouse_world.y / render_config.tile_size));
+            int tz = game_renderer.get_z_level();
+            if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) {
+                auto astronauts = entity_manager.registry().view<entities::Astronaut>();
+                for (auto entity : astronauts) {
+                    entity_manager.request_flow(entity, tx, ty, tz);
+                }
+            } else if (entity_manager.registry().valid(selected)) {
+                entity_manager.request_path(selected, tx, ty, tz);
+            }
+        }
+    }
+
     // Keyboard shortcuts for simulation control (in addition to ImGui)
     if (IsKeyPressed(KEY_SPACE))
       paused = !paused;
@@ -237,6 +459,11 @@ int main() {
       time_scale = std::min(time_scale * 2.0f, 10.0f);
     if (IsKeyPressed(KEY_MINUS) || IsKeyPressed(KEY_KP_SUBTRACT))
       time_scale = std::max(time_scale / 2.0f, 0.1f);
+    // R: the crew rests through an 8-hour night; biology fast-forwards
+    if (IsKeyPressed(KEY_R)) {
+      biology_clock.advance(8.0 * 3600.0, true);
+      debug_ui.add_log(sim_time, "Crew rested for 8 hours");
+    }
 
     // Update chunk loading EVERY FRAME (not just during simulation)
     // This ensures chunks load when navigating Z-levels even when paused
@@ -287,53 +514,49 @@ int main() {
         chunk_manager.update(world_cell_x, world_cell_y, world_cell_z);
       }
       
-      // LBM Fluid physics: GPU accelerated
-      if (gpu_lbm_ready) {
-        gpu_lbm.step(fixed_dt, 1.7); // omega ~1.7 for viscosity
-        // No sync needed every step - GPU handles it internally
-      } else {
-        fluids.step(fixed_dt);
-      }
-      
-      // Thermal physics: GPU accelerated with chunk sync
-      if (gpu_thermal_ready) {
-        // Sync chunk data TO physics buffer (every 10 steps to reduce overhead)
-        static std::vector<double> physics_temp_buffer;
-        static std::vector<double> physics_density_buffer;
-        int z_level = game_renderer.get_z_level();
-        
-        if (step_count % 10 == 0) {
-          chunk_manager.sync_to_physics(physics_temp_buffer, physics_density_buffer, 
-                                        200, 200, z_level);
-          gpu_thermal.upload_temperature(physics_temp_buffer);
+      for (auto stage : physics_order) {
+        if (stage == fluid_stage) {
+          // LBM Fluid physics: GPU accelerated
+          if (gpu_lbm_ready) {
+            gpu_lbm.step(fixed_dt, 1.7); // omega ~1.7 for viscosity
+            // No sync needed every step - GPU handles it internally
+          } else {
+            fluids.step(fixed_dt);
+          }
+          continue;
         }
-        
-        gpu_thermal.step(fixed_dt);
-        
-        // Sync results back FROM physics to chunks (every 10 steps)
-        if (step_count % 10 == 0) {
-          gpu_thermal.download_temperature(physics_temp_buffer);
-          chunk_manager.sync_from_physics(physics_temp_buffer, physics_density_buffer,
+
+        // Thermal physics: GPU accelerated with chunk sync
+        if (gpu_thermal_ready) {
+          // Sync chunk data straight into the thermal field (every 10 steps
+          // to reduce overhead), so visualization needs no extra copy
+          static std::vector<double> physics_density_buffer;
+          std::vector<double> &temperature = thermal.temperature_field();
+          int z_level = game_renderer.get_z_level();
+
+          if (step_count % 10 == 0) {
+            chunk_manager.sync_to_physics(temperature, physics_density_buffer,
                                           200, 200, z_level);
-          // Also update CPU thermal for visualization
-          thermal.temperature_field() = physics_temp_buffer;
+            gpu_thermal.upload_temperature(temperature);
+          }
+
+          gpu_thermal.step(fixed_dt);
+
+          // Sync results back FROM physics to chunks (every 10 steps)
+          if (step_count % 10 == 0) {
+            gpu_thermal.download_temperature(temperature);
+            chunk_manager.sync_from_physics(temperature, physics_density_buffer,
+                                            200, 200, z_level);
+            fields.mark_written(thermal_temperature);
+          }
+        } else {
+          thermal.step(fixed_dt);
         }
-      } else {
-        thermal.step(fixed_dt);
-      }
-      
-      // Biological systems: throttled (don't need per-step accuracy)
-      if (step_count % 10 == 0) {
-        circulation.step(fixed_dt * 10);  // Compensate for fewer updates
-        blood_chem.step(fixed_dt * 10);
-      }
-      entity_manager.update(fixed_dt);
-      
-      // Update astronaut needs (throttled - every 5 steps)
-      if (step_count % 5 == 0) {
-        entities::NeedsSystem::update(fixed_dt * 5, entity_manager.registry(), fluids);
-        entities::MetabolismSystem::update(fixed_dt * 5, entity_manager.registry(), thermal);
       }
+
+      // Biological systems, each at its own rate
+      biology_clock.advance(fixed_dt);
+      scheduler.run(fixed_dt);
       
       sim_time += fixed_dt;
       accumulator -= fixed_dt;
@@ -346,6 +569,8 @@ int main() {
       accumulator = 0.0; // Reset to prevent runaway
     }
     
+    update_helmet_lamps();
+
     auto step_end = std::chrono::high_resolution_clock::now();
     sim_step_time_ms = std::chrono::duration<double, std::milli>(step_end - step_start).count();
 
@@ -33,30 +33,39 @@ AcidBaseDisorder BloodChemistrySystem::classify_disorder() const {
   }
 }
 
-std::unordered_map<std::string, double>
-BloodChemistrySystem::get_cardiac_risk_factors() const {
-  std::unordered_map<std::string, double> risks;
+const char *cardiac_risk_name(CardiacRisk risk) {
+  static constexpr const char *NAMES[CARDIAC_RISK_COUNT] = {
+      "hypokalemia_risk",   "hyperkalemia_risk",     "hypocalcemia_risk",
+      "hypercalcemia_risk", "acidosis_cardiac_risk", "alkalosis_cardiac_risk"};
+  return NAMES[static_cast<size_t>(risk)];
+}
+
+CardiacRiskFactors BloodChemistrySystem::get_cardiac_risk_factors() const {
+  CardiacRiskFactors risks{};
+  auto risk = [&](CardiacRisk factor) -> double & {
+    return risks[static_cast<size_t>(factor)];
+  };
 
   double K = electrolytes.potassium;
   if (K < 3.0)
-    risks["hypokalemia_risk"] = 0.8;
+    risk(CardiacRisk::HYPOKALEMIA) = 0.8;
   else if (K < 3.5)
-    risks["hypokalemia_risk"] = 0.3;
+    risk(CardiacRisk::HYPOKALEMIA) = 0.3;
   else if (K > 6.0)
-    risks["hyperkalemia_risk"] = 0.9;
+    risk(CardiacRisk::HYPERKALEMIA) = 0.9;
   else if (K > 5.5)
-    risks["hyperkalemia_risk"] = 0.4;
+    risk(CardiacRisk::HYPERKALEMIA) = 0.4;
 
   double Ca = electrolytes.calcium;
   if (Ca < 7.0)
-    risks["hypocalcemia_risk"] = 0.5;
+    risk(CardiacRisk::HYPOCALCEMIA) = 0.5;
   else if (Ca > 12.0)
-    risks["hypercalcemia_risk"] = 0.4;
+    risk(CardiacRisk::HYPERCALCEMIA) = 0.4;
 
   if (abg.pH < 7.2)
-    risks["acidosis_cardiac_risk"] = 0.6;
+    risk(CardiacRisk::ACIDOSIS) = 0.6;
   else if (abg.pH > 7.55)
-    risks["alkalosis_cardiac_risk"] = 0.4;
+    risk(CardiacRisk::ALKALOSIS) = 0.4;
 
   return risks;
 }
@@ -12,30 +12,36 @@
 namespace isolated {
 namespace biology {
 
+namespace {
+
+// Every body starts from the same network, in Vessel order
+constexpr std::array<VesselSegment, VESSEL_COUNT> VESSEL_NETWORK = {{
+    {25.0, 400.0, 2.0, 500.0, 100.0, false}, // Aorta
+    {6.0, 100.0, 0.5, 400.0, 10.0, false},   // Left carotid
+    {6.0, 100.0, 0.5, 400.0, 10.0, false},   // Right carotid
+    {8.0, 400.0, 0.8, 350.0, 25.0, false},   // Left femoral
+    {8.0, 400.0, 0.8, 350.0, 25.0, false},   // Right femoral
+    {30.0, 350.0, 1.0, 200.0, 150.0, false}, // Vena cava
+}};
+
+constexpr const char *VESSEL_NAMES[VESSEL_COUNT] = {
+    "aorta",        "carotid_left",  "carotid_right",
+    "femoral_left", "femoral_right", "vena_cava"};
+
+} // namespace
+
+const char *vessel_name(Vessel vessel) {
+  return VESSEL_NAMES[static_cast<size_t>(vessel)];
+}
+
 WindkesselCirculation::WindkesselCirculation(double body_mass_kg)
-    : body_mass_(body_mass_kg) {
+    : body_mass_(body_mass_kg), vessels_(VESSEL_NETWORK) {
   blood_volume = body_mass_kg * 0.07;
   max_blood_volume_ = blood_volume;
   rr_interval_ = 60.0 / heart_rate;
 
   chamber_volumes_ = {25.0, 120.0, 25.0, 120.0}; // RA, RV, LA, LV
   valve_states_ = {false, false, false, false};
-
-  create_vessel_network();
-}
-
-void WindkesselCirculation::create_vessel_network() {
-  major_vessels_["aorta"] = {"aorta", 25.0, 400.0, 2.0, 500.0, 100.0, false};
-  major_vessels_["carotid_left"] = {"carotid_left", 6.0,  100.0, 0.5,
-                                    400.0,          10.0, false};
-  major_vessels_["carotid_right"] = {"carotid_right", 6.0,  100.0, 0.5,
-                                     400.0,           10.0, false};
-  major_vessels_["femoral_left"] = {"femoral_left", 8.0,  400.0, 0.8,
-                                    350.0,          25.0, false};
-  major_vessels_["femoral_right"] = {"femoral_right", 8.0,  400.0, 0.8,
-                                     350.0,           25.0, false};
-  major_vessels_["vena_cava"] = {"vena_cava", 30.0,  350.0, 1.0,
-                                 200.0,       150.0, false};
 }
 
 double WindkesselCirculation::compute_frank_starling_sv() {
@@ -160,7 +166,7 @@ WindkesselCirculation::StepResult WindkesselCirculation::step(double dt) {
   double current_pressure = get_instantaneous_pressure(cardiac_phase_);
   double total_bleed_rate = 0.0;
 
-  for (const auto &[name, vessel] : major_vessels_) {
+  for (const VesselSegment &vessel : vessels_) {
     total_bleed_rate += vessel.get_bleed_rate_ml_min(current_pressure);
   }
 
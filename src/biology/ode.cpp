@@ -0,0 +1,293 @@
+/**
+ * @file ode.cpp
+ * @brief Implementation of the adaptive ODE integrator.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <isolated/biology/ode.hpp>
+#include <limits>
+
+namespace isolated {
+namespace biology {
+
+namespace {
+
+// Dormand-Prince 5(4) tableau; the 7th stage is f at the new state (FSAL)
+constexpr double DP_C[7] = {0.0, 1.0 / 5, 3.0 / 10, 4.0 / 5, 8.0 / 9, 1.0, 1.0};
+constexpr double DP_A[7][6] = {
+    {},
+    {1.0 / 5},
+    {3.0 / 40, 9.0 / 40},
+    {44.0 / 45, -56.0 / 15, 32.0 / 9},
+    {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+    {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656},
+    {35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84}};
+// Fifth- minus fourth-order weights
+constexpr double DP_E[7] = {71.0 / 57600,     0.0,         -71.0 / 16695, 71.0 / 1920,
+                            -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+
+// Shampine-Reichelt Rosenbrock 2(3)
+const double ROS_D = 1.0 / (2.0 + std::sqrt(2.0));
+const double ROS_E32 = 6.0 + std::sqrt(2.0);
+
+constexpr double SAFETY = 0.9;
+constexpr double MAX_GROWTH = 5.0;
+constexpr double MIN_SHRINK = 0.2;
+
+} // namespace
+
+void OdeIntegrator::resize(size_t n) {
+  n_ = n;
+  for (auto *v : {&y_, &y_new_, &err_, &f0_, &tmp_, &dfdt_}) {
+    v->assign(n, 0.0);
+  }
+  for (auto &k : k_) {
+    k.assign(n, 0.0);
+  }
+  jac_.assign(n * n, 0.0);
+  lu_.assign(n * n, 0.0);
+  pivot_.assign(n, 0);
+}
+
+double OdeIntegrator::error_norm(const double *y, const double *y_new,
+                                 const double *err) const {
+  double sum = 0.0;
+  for (size_t i = 0; i < n_; ++i) {
+    double scale = config_.abs_tol +
+                   config_.rel_tol * std::max(std::fabs(y[i]), std::fabs(y_new[i]));
+    double e = err[i] / scale;
+    sum += e * e;
+  }
+  return std::sqrt(sum / static_cast<double>(n_));
+}
+
+double OdeIntegrator::initial_step(double dt) const {
+  // Step over which the derivative moves the state by about 1% of itself
+  double d0 = 0.0, d1 = 0.0;
+  for (size_t i = 0; i < n_; ++i) {
+    double scale = config_.abs_tol + config_.rel_tol * std::fabs(y_[i]);
+    d0 += (y_[i] / scale) * (y_[i] / scale);
+    d1 += (f0_[i] / scale) * (f0_[i] / scale);
+  }
+  d0 = std::sqrt(d0 / static_cast<double>(n_));
+  d1 = std::sqrt(d1 / static_cast<double>(n_));
+  if (d1 <= 1e-5) return dt;
+  double h = d0 <= 1e-5 ? 1e-6 : 0.01 * d0 / d1;
+  return std::clamp(h, config_.min_step, dt);
+}
+
+void OdeIntegrator::dormand_prince_step(const OdeSystem &system, double t, double h,
+                                        OdeStats &stats) {
+  k_[0] = f0_;
+  for (int s = 1; s < 7; ++s) {
+    for (size_t i = 0; i < n_; ++i) {
+      double sum = 0.0;
+      for (int j = 0; j < s; ++j) {
+        sum += DP_A[s][j] * k_[j][i];
+      }
+      tmp_[i] = y_[i] + h * sum;
+    }
+    if (s == 6) y_new_ = tmp_;
+    system.derivatives(t + DP_C[s] * h, tmp_.data(), k_[s].data());
+    ++stats.evaluations;
+  }
+  for (size_t i = 0; i < n_; ++i) {
+    double e = 0.0;
+    for (int s = 0; s < 7; ++s) {
+      e += DP_E[s] * k_[s][i];
+    }
+    err_[i] = h * e;
+  }
+}
+
+void OdeIntegrator::jacobian(const OdeSystem &system, double t, bool stiff_only,
+                             OdeStats &stats) {
+  const double eps = std::sqrt(std::numeric_limits<double>::epsilon());
+  const double threshold = config_.abs_tol / config_.rel_tol;
+  std::fill(jac_.begin(), jac_.end(), 0.0);
+
+  tmp_ = y_;
+  for (size_t j = 0; j < n_; ++j) {
+    if (stiff_only && !system.is_stiff(j)) continue;
+    double delta = eps * std::max(std::fabs(y_[j]), threshold);
+    tmp_[j] = y_[j] + delta;
+    system.derivatives(t, tmp_.data(), k_[6].data());
+    ++stats.evaluations;
+    tmp_[j] = y_[j];
+    for (size_t i = 0; i < n_; ++i) {
+      if (stiff_only && !system.is_stiff(i)) continue;
+      jac_[i * n_ + j] = (k_[6][i] - f0_[i]) / delta;
+    }
+  }
+
+  // Explicit time dependence
+  double dt_probe = eps * std::max(std::fabs(t), 1.0);
+  system.derivatives(t + dt_probe, y_.data(), k_[6].data());
+  ++stats.evaluations;
+  for (size_t i = 0; i < n_; ++i) {
+    dfdt_[i] = (k_[6][i] - f0_[i]) / dt_probe;
+  }
+  ++stats.jacobians;
+}
+
+bool OdeIntegrator::factor(double h_d) {
+  // LU with partial pivoting of I - h d J
+  for (size_t i = 0; i < n_; ++i) {
+    for (size_t j = 0; j < n_; ++j) {
+      lu_[i * n_ + j] = (i == j ? 1.0 : 0.0) - h_d * jac_[i * n_ + j];
+    }
+  }
+  for (size_t c = 0; c < n_; ++c) {
+    size_t p = c;
+    for (size_t r = c + 1; r < n_; ++r) {
+      if (std::fabs(lu_[r * n_ + c]) > std::fabs(lu_[p * n_ + c])) p = r;
+    }
+    pivot_[c] = p;
+    if (lu_[p * n_ + c] == 0.0 || !std::isfinite(lu_[p * n_ + c])) return false;
+    if (p != c) {
+      for (size_t j = 0; j < n_; ++j) {
+        std::swap(lu_[c * n_ + j], lu_[p * n_ + j]);
+      }
+    }
+    for (size_t r = c + 1; r < n_; ++r) {
+      double m = lu_[r * n_ + c] / lu_[c * n_ + c];
+      lu_[r * n_ + c] = m;
+      for (size_t j = c + 1; j < n_; ++j) {
+        lu_[r * n_ + j] -= m * lu_[c * n_ + j];
+      }
+    }
+  }
+  return true;
+}
+
+void OdeIntegrator::solve(double *b) const {
+  for (size_t c = 0; c < n_; ++c) {
+    std::swap(b[c], b[pivot_[c]]);
+    for (size_t r = c + 1; r < n_; ++r) {
+      b[r] -= lu_[r * n_ + c] * b[c];
+    }
+  }
+  for (size_t r = n_; r-- > 0;) {
+    for (size_t j = r + 1; j < n_; ++j) {
+      b[r] -= lu_[r * n_ + j] * b[j];
+    }
+    b[r] /= lu_[r * n_ + r];
+  }
+}
+
+bool OdeIntegrator::rosenbrock_step(const OdeSystem &system, double t, double h,
+                                    OdeStats &stats) {
+  if (!factor(h * ROS_D)) return false;
+  std::vector<double> &k1 = k_[0], &k2 = k_[1], &k3 = k_[2];
+  std::vector<double> &f1 = k_[3], &f2 = k_[4];
+
+  for (size_t i = 0; i < n_; ++i) {
+    k1[i] = f0_[i] + h * ROS_D * dfdt_[i];
+  }
+  solve(k1.data());
+
+  for (size_t i = 0; i < n_; ++i) {
+    tmp_[i] = y_[i] + 0.5 * h * k1[i];
+  }
+  system.derivatives(t + 0.5 * h, tmp_.data(), f1.data());
+  ++stats.evaluations;
+
+  for (size_t i = 0; i < n_; ++i) {
+    k2[i] = f1[i] - k1[i];
+  }
+  solve(k2.data());
+  for (size_t i = 0; i < n_; ++i) {
+    k2[i] += k1[i];
+    y_new_[i] = y_[i] + h * k2[i];
+  }
+
+  system.derivatives(t + h, y_new_.data(), f2.data());
+  ++stats.evaluations;
+  for (size_t i = 0; i < n_; ++i) {
+    k3[i] = f2[i] - ROS_E32 * (k2[i] - f1[i]) - 2.0 * (k1[i] - f0_[i]) +
+            h * ROS_D * dfdt_[i];
+  }
+  solve(k3.data());
+
+  for (size_t i = 0; i < n_; ++i) {
+    err_[i] = h / 6.0 * (k1[i] - 2.0 * k2[i] + k3[i]);
+  }
+  return true;
+}
+
+OdeStats OdeIntegrator::integrate(OdeSystem &system, double dt, OdeMethod method) {
+  OdeStats stats;
+  if (dt <= 0.0) return stats;
+
+  if (system.dimension() != n_) {
+    resize(system.dimension());
+    h_ = 0.0;
+  }
+  if (n_ == 0) return stats;
+  system.get_state(y_.data());
+  system.derivatives(0.0, y_.data(), f0_.data());
+  ++stats.evaluations;
+
+  const bool explicit_method = method == OdeMethod::DORMAND_PRINCE;
+  const double exponent = explicit_method ? 1.0 / 5.0 : 1.0 / 3.0;
+  const double max_step = config_.max_step > 0.0 ? config_.max_step : dt;
+
+  double h_proposed = h_ > 0.0 ? h_ : initial_step(dt);
+  bool jacobian_valid = false;
+  double t = 0.0;
+
+  while (t < dt) {
+    if (stats.accepted + stats.rejected >= config_.max_steps) {
+      stats.ok = false;
+      break;
+    }
+    double remaining = dt - t;
+    double h = std::min({h_proposed, max_step, remaining});
+    bool reaches_end = h >= remaining;
+
+    double err;
+    if (explicit_method) {
+      dormand_prince_step(system, t, h, stats);
+      err = error_norm(y_.data(), y_new_.data(), err_.data());
+    } else {
+      if (!jacobian_valid) {
+        jacobian(system, t, method == OdeMethod::IMEX, stats);
+        jacobian_valid = true;
+      }
+      err = rosenbrock_step(system, t, h, stats)
+                ? error_norm(y_.data(), y_new_.data(), err_.data())
+                : std::numeric_limits<double>::infinity();
+    }
+
+    if (std::isfinite(err) && err <= 1.0) {
+      t = reaches_end ? dt : t + h;
+      y_.swap(y_new_);
+      f0_ = explicit_method ? k_[6] : k_[4];  // f at the new state
+      jacobian_valid = false;
+      ++stats.accepted;
+
+      double growth = err > 0.0 ? std::min(MAX_GROWTH, SAFETY * std::pow(err, -exponent))
+                                : MAX_GROWTH;
+      // A step cut short by the end of dt says nothing against the proposal
+      h_proposed = reaches_end ? std::max(h_proposed, h * growth) : h * growth;
+    } else {
+      ++stats.rejected;
+      double shrink = std::isfinite(err)
+                          ? std::max(MIN_SHRINK, SAFETY * std::pow(err, -exponent))
+                          : MIN_SHRINK;
+      h_proposed = h * shrink;
+      if (h_proposed < config_.min_step) {
+        stats.ok = false;
+        break;
+      }
+    }
+  }
+
+  h_ = h_proposed;
+  system.set_state(y_.data());
+  return stats;
+}
+
+} // namespace biology
+} // namespace isolated
@@ -0,0 +1,539 @@
+/**
+ * @file physiology_batch.cpp
+ * @brief Implementation of the batched SoA physiology engine.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <isolated/biology/physiology_batch.hpp>
+
+namespace isolated {
+namespace biology {
+
+const PhysiologyBatch::Array PhysiologyBatch::ARRAYS[] = {
+    &PhysiologyBatch::ambient_temp_c_,  &PhysiologyBatch::activity_,
+    &PhysiologyBatch::heart_rate_,      &PhysiologyBatch::stroke_volume_,
+    &PhysiologyBatch::blood_volume_,    &PhysiologyBatch::max_blood_volume_,
+    &PhysiologyBatch::cardiac_phase_,   &PhysiologyBatch::cardiac_output_,
+    &PhysiologyBatch::pao2_,            &PhysiologyBatch::paco2_,
+    &PhysiologyBatch::sao2_,            &PhysiologyBatch::alveolar_ventilation_,
+    &PhysiologyBatch::basal_metabolic_rate_,
+    &PhysiologyBatch::blood_glucose_,   &PhysiologyBatch::liver_glycogen_,
+    &PhysiologyBatch::muscle_glycogen_, &PhysiologyBatch::blood_lactate_,
+    &PhysiologyBatch::metabolic_rate_,  &PhysiologyBatch::chem_lactate_,
+    &PhysiologyBatch::bicarbonate_,     &PhysiologyBatch::chem_pco2_,
+    &PhysiologyBatch::ph_,              &PhysiologyBatch::reported_hco3_,
+    &PhysiologyBatch::sympathetic_,     &PhysiologyBatch::parasympathetic_,
+    &PhysiologyBatch::stress_,          &PhysiologyBatch::pain_,
+    &PhysiologyBatch::consciousness_,   &PhysiologyBatch::fatigue_};
+
+size_t PhysiologyBatch::add(const Config &config) {
+  // Initial state comes from the scalar subsystems themselves
+  UnifiedPhysiologySystem scalar(config);
+  const WindkesselCirculation &circ = scalar.circulation();
+  const RespiratorySystem::State &resp = scalar.respiration().get_state();
+  const MetabolismSystem::State &metab = scalar.metabolism().get_state();
+  const BloodChemistrySystem &chem = scalar.blood_chemistry();
+  const AutonomicNervousSystem::State &ans = scalar.nervous().get_state();
+  const EnvironmentState env;
+
+  RespiratorySystem::Config resp_config;
+  inspired_po2_ = (resp_config.atmospheric_pressure - 47) * resp_config.fio2;
+
+  ambient_temp_c_.push_back(env.ambient_temp_c);
+  activity_.push_back(env.activity_level);
+
+  heart_rate_.push_back(circ.heart_rate);
+  stroke_volume_.push_back(circ.stroke_volume);
+  blood_volume_.push_back(circ.blood_volume);
+  max_blood_volume_.push_back(circ.blood_volume);
+  cardiac_phase_.push_back(0.0);
+  cardiac_output_.push_back((circ.heart_rate * circ.stroke_volume) / 1000.0);
+
+  pao2_.push_back(resp.pao2);
+  paco2_.push_back(resp.paco2);
+  sao2_.push_back(resp.sao2);
+  alveolar_ventilation_.push_back(resp.alveolar_ventilation);
+
+  basal_metabolic_rate_.push_back(
+      MetabolismSystem::Config{80.0, config.body_mass_kg, 0.4}.basal_metabolic_rate);
+  blood_glucose_.push_back(metab.blood_glucose);
+  liver_glycogen_.push_back(metab.liver_glycogen);
+  muscle_glycogen_.push_back(metab.muscle_glycogen);
+  blood_lactate_.push_back(metab.blood_lactate);
+  metabolic_rate_.push_back(metab.metabolic_rate);
+
+  chem_lactate_.push_back(chem.lactate);
+  bicarbonate_.push_back(chem.electrolytes.bicarbonate);
+  chem_pco2_.push_back(chem.abg.pCO2);
+  ph_.push_back(chem.abg.pH);
+  reported_hco3_.push_back(chem.electrolytes.bicarbonate);
+
+  sympathetic_.push_back(ans.sympathetic_tone);
+  parasympathetic_.push_back(ans.parasympathetic_tone);
+  stress_.push_back(ans.stress_level);
+  pain_.push_back(ans.pain_level);
+  consciousness_.push_back(ans.consciousness);
+  fatigue_.push_back(ans.fatigue);
+
+  return size() - 1;
+}
+
+void PhysiologyBatch::remove(size_t index) {
+  for (Array array : ARRAYS) {
+    (this->*array)[index] = (this->*array).back();
+    (this->*array).pop_back();
+  }
+}
+
+size_t PhysiologyBatch::transfer(size_t index, PhysiologyBatch &to) {
+  for (Array array : ARRAYS) {
+    (to.*array).push_back((this->*array)[index]);
+  }
+  to.inspired_po2_ = inspired_po2_;
+  remove(index);
+  return to.size() - 1;
+}
+
+void PhysiologyBatch::set_environment(size_t index,
+                                      const EnvironmentState &env) {
+  // Ambient gases and pressure do not reach the unified model's subsystems
+  ambient_temp_c_[index] = env.ambient_temp_c;
+  activity_[index] = env.activity_level;
+}
+
+void PhysiologyBatch::add_pain(size_t index, double amount) {
+  pain_[index] = std::min(1.0, pain_[index] + amount);
+}
+
+void PhysiologyBatch::add_stress(size_t index, double amount) {
+  stress_[index] = std::min(1.0, stress_[index] + amount);
+}
+
+void PhysiologyBatch::add_fatigue(size_t index, double amount) {
+  fatigue_[index] = std::min(1.0, fatigue_[index] + amount);
+}
+
+void PhysiologyBatch::step(double dt, core::TaskPool *pool) {
+  if (pool) {
+    pool->parallel_for(size(), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+      step_range(dt, begin, end);
+    });
+  } else {
+    step_range(dt, 0, size());
+  }
+}
+
+// ============================================================================
+// Step passes. Each mirrors the scalar code line for line; conditional
+// updates are written as selects (`x = cond ? f(x) : x`) so the passes
+// vectorize without changing a single rounding.
+// ============================================================================
+
+void PhysiologyBatch::step_range(double dt, size_t begin, size_t end) {
+  double *hr = heart_rate_.data();
+  double *phase = cardiac_phase_.data();
+  const double *bv = blood_volume_.data();
+  const double *max_bv = max_blood_volume_.data();
+  const double *activity = activity_.data();
+  const double *ambient = ambient_temp_c_.data();
+
+  // --- Circulation -----------------------------------------------------------
+  // fmod(x, c) is exactly x - c for c <= x < 2c, so only a step longer than
+  // a beat needs the libm call
+  size_t long_steps = 0;
+#pragma omp simd reduction(+ : long_steps)
+  for (size_t i = begin; i < end; ++i) {
+    double cycle_duration = 60.0 / hr[i];
+    double x = phase[i] + dt;
+    bool wraps_twice = x >= 2.0 * cycle_duration;
+    long_steps += wraps_twice;
+    phase[i] = wraps_twice ? x : (x >= cycle_duration ? x - cycle_duration : x);
+  }
+  if (long_steps > 0) {
+    for (size_t i = begin; i < end; ++i) {
+      double cycle_duration = 60.0 / hr[i];
+      if (phase[i] >= 2.0 * cycle_duration) {
+        phase[i] = std::fmod(phase[i], cycle_duration);
+      }
+    }
+  }
+
+  const double *sv = stroke_volume_.data();
+  double *co = cardiac_output_.data();
+
+#pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    // Compensatory response by hemorrhage class
+    double loss_fraction = 1.0 - (bv[i] / max_bv[i]);
+    double h = hr[i];
+    h = loss_fraction < 0.15   ? std::max(70.0, h - 0.1)
+        : loss_fraction < 0.30 ? std::min(120.0, h + 0.5)
+        : loss_fraction < 0.40 ? std::min(140.0, h + 1.0)
+                               : std::min(160.0, h + 2.0);
+    hr[i] = h;
+    co[i] = (h * sv[i]) / 1000.0;
+  }
+
+  // --- Respiration -----------------------------------------------------------
+  double *pao2 = pao2_.data();
+  double *paco2 = paco2_.data();
+  double *sao2 = sao2_.data();
+  const double *alv = alveolar_ventilation_.data();
+  const double tau = 5.0;
+
+#pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    double vco2 = 200.0 * activity[i];
+    double pao2_ideal = inspired_po2_ - (paco2[i] / 0.8);
+    double po2 = pao2[i] + (pao2_ideal - pao2[i]) * dt / tau;
+
+    double paco2_target =
+        40.0 * (vco2 / 200.0) / std::max(0.1, alv[i] / 4.2);
+    double pco2 = paco2[i] + (paco2_target - paco2[i]) * dt / tau;
+
+    pao2[i] = std::clamp(po2, 20.0, 150.0);
+    paco2[i] = std::clamp(pco2, 15.0, 80.0);
+  }
+
+  // Hill saturation at pH 7.4, pCO2 40, 37 C: the Bohr factors are exactly 1
+  const HemoglobinModel::Config hb;
+  for (size_t i = begin; i < end; ++i) {
+    double ratio = std::pow(pao2[i] / hb.p50_base, hb.hill_coefficient);
+    sao2[i] = ratio / (1.0 + ratio);
+  }
+
+  // --- Metabolism ------------------------------------------------------------
+  const double *bmr = basal_metabolic_rate_.data();
+  double *glucose = blood_glucose_.data();
+  double *liver = liver_glycogen_.data();
+  double *muscle = muscle_glycogen_.data();
+  double *lactate = blood_lactate_.data();
+  double *rate = metabolic_rate_.data();
+
+#pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    double act = activity[i];
+    double comfort_temp = 22.0;
+    double thermic = ambient[i] < comfort_temp
+                         ? 1.0 + 0.05 * (comfort_temp - ambient[i])
+                         : 1.0;
+    rate[i] = act * thermic;
+    double tee = bmr[i] * rate[i];
+
+    double carb_fraction = std::clamp(0.3 + 0.5 * (act - 1.0), 0.0, 1.0);
+    double energy_kj = tee * dt / 1000.0;
+    double glucose_used_g = energy_kj * carb_fraction / 16.7;
+    double glucose_used_mg = glucose_used_g * 1000.0;
+
+    double g = glucose[i];
+    g = g > 70.0 ? std::max(40.0, g - (glucose_used_mg * 0.3) / 50.0) : g;
+    double m = muscle[i];
+    muscle[i] = act > 1.5 && m > 0 ? std::max(0.0, m - glucose_used_g * 0.7) : m;
+
+    // Liver glucose release
+    double l = liver[i];
+    bool release_glucose = g < 80.0 && l > 0;
+    double release =
+        std::min(l * 0.01 * dt, (80.0 - g) * 0.5);
+    liver[i] = release_glucose ? l - release : l;
+    glucose[i] = release_glucose ? g + release * 20.0 : g;
+
+    double lac = lactate[i];
+    lac = act > 1.8 ? lac + (act - 1.8) * 0.5 * dt : lac;
+    lactate[i] = std::max(0.5, lac - 0.1 * dt);
+  }
+
+  // --- Blood chemistry -------------------------------------------------------
+  double *chem_lactate = chem_lactate_.data();
+  double *bicarb = bicarbonate_.data();
+  double *chem_pco2 = chem_pco2_.data();
+
+#pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    double lac = chem_lactate[i];
+    double clearance = lac * 0.5 * dt / 60.0;
+    lac = std::max(0.5, lac - clearance);
+    double hco3 = std::min(30.0, bicarb[i] + clearance * 0.5);
+
+    // Respiratory compensation
+    double pco2 = chem_pco2[i];
+    double target_pco2 = 40 - (24 - hco3) * 1.2;
+    pco2 = hco3 < 20 ? pco2 + (target_pco2 - pco2) * 0.1 * dt : pco2;
+
+    // Renal compensation (slow)
+    hco3 = pco2 > 45   ? hco3 + 0.001 * dt
+           : pco2 < 35 ? hco3 - 0.001 * dt
+                       : hco3;
+
+    bicarb[i] = std::clamp(hco3, 5.0, 35.0);
+    chem_pco2[i] = std::clamp(pco2, 15.0, 80.0);
+    chem_lactate[i] = std::clamp(lac, 0.5, 20.0);
+  }
+
+  // Henderson-Hasselbalch
+  double *ph = ph_.data();
+  double *reported_hco3 = reported_hco3_.data();
+  for (size_t i = begin; i < end; ++i) {
+    double hco3 = std::max(1.0, bicarb[i]);
+    double pco2 = std::max(1.0, chem_pco2[i]);
+    ph[i] = std::clamp(6.1 + std::log10(hco3 / (0.03 * pco2)), 6.8, 7.8);
+    reported_hco3[i] = bicarb[i];
+  }
+
+  // --- Autonomic nervous system and coupling ---------------------------------
+  double *symp = sympathetic_.data();
+  double *para = parasympathetic_.data();
+  double *stress = stress_.data();
+  double *pain = pain_.data();
+  double *conscious = consciousness_.data();
+  double *fatigue = fatigue_.data();
+
+#pragma omp simd
+  for (size_t i = begin; i < end; ++i) {
+    double volume_factor = bv[i] / max_bv[i];
+    double resistance_factor =
+        volume_factor < 0.85 ? 1.0 + (0.85 - volume_factor) * 2.0 : 1.0;
+    double sbp = 120.0 * volume_factor * resistance_factor;
+    double dbp = 80.0 * volume_factor * resistance_factor * 0.9;
+    double map = dbp + (sbp - dbp) / 3.0;
+
+    // Baroreceptor, chemoreceptor and glucose reflexes (37 C core: no
+    // thermoregulation reflex)
+    double s = symp[i];
+    double p = para[i];
+    double st = stress[i];
+    double deviation = (map - 93.0) / 93.0;
+    s -= deviation * 0.1;
+    p += deviation * 0.1;
+    s = sao2[i] < 0.90 ? s + (0.90 - sao2[i]) * 2.0 : s;
+    bool hypoglycemic = glucose[i] < 70.0;
+    s = hypoglycemic ? s + (70.0 - glucose[i]) * 0.01 : s;
+    st = hypoglycemic ? st + 0.01 : st;
+
+    s += pain[i] * 0.3;
+    s += st * 0.2;
+
+    pain[i] = std::max(0.0, pain[i] - 0.01 * dt);
+    st = std::max(0.0, st - 0.005 * dt);
+    fatigue[i] = std::max(0.0, fatigue[i] - 0.001 * dt);
+    stress[i] = st;
+
+    s = std::clamp(s, 0.0, 1.0);
+    p = std::clamp(p, 0.0, 1.0);
+    symp[i] = s;
+    para[i] = p;
+
+    double c = conscious[i];
+    c = sao2[i] < 0.70 ? c - (0.70 - sao2[i]) * dt : std::min(1.0, c + 0.1 * dt);
+    conscious[i] = std::clamp(c, 0.0, 1.0);
+
+    // Coupling: ANS drives heart rate, metabolic lactate loads the blood,
+    // arterial CO2 sets blood pCO2
+    double balance = s - p;
+    hr[i] = std::max(hr[i], UnifiedPhysiologySystem::RESTING_HEART_RATE *
+                                (1.0 + balance * 0.5));
+
+    double amount = 0.1 * dt;
+    bool lactic = lactate[i] > 2.0;
+    double hco3_consumed = std::min(amount, bicarb[i] - 5.0);
+    chem_lactate[i] = lactic ? chem_lactate[i] + amount : chem_lactate[i];
+    bicarb[i] = lactic ? bicarb[i] - hco3_consumed : bicarb[i];
+
+    chem_pco2[i] = paco2[i];
+  }
+}
+
+// ============================================================================
+// Fast-forward
+// ============================================================================
+
+PhysiologyBatch::FastForwardStats
+PhysiologyBatch::fast_forward(double duration, const FastForwardConfig &config,
+                              core::TaskPool *pool) {
+  std::vector<FastForwardStats> per_person(size());
+  auto run = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      fast_forward_person(i, duration, config, per_person[i]);
+    }
+  };
+  if (pool) {
+    pool->parallel_for(size(), 1, run);
+  } else {
+    run(0, size());
+  }
+
+  FastForwardStats total;
+  for (const FastForwardStats &stats : per_person) {
+    total.steps += stats.steps;
+    total.jumps += stats.jumps;
+    total.skipped += stats.skipped;
+  }
+  return total;
+}
+
+void PhysiologyBatch::fast_forward_person(size_t i, double duration,
+                                          const FastForwardConfig &config,
+                                          FastForwardStats &stats) {
+  const size_t half = std::max<size_t>(
+      1, static_cast<size_t>(std::lround(0.5 * config.probe / config.step)));
+  const double window = static_cast<double>(half) * config.step;
+
+  double start[ARRAY_COUNT], mid[ARRAY_COUNT], end[ARRAY_COUNT];
+  double rate[ARRAY_COUNT], scale[ARRAY_COUNT];
+  double drift[ARRAY_COUNT], origin[ARRAY_COUNT];  // Of the last jump
+  double origin_phase = 0.0;
+  auto gather = [&](double *x) {
+    for (size_t k = 0; k < ARRAY_COUNT; ++k) {
+      x[k] = (this->*ARRAYS[k])[i];
+    }
+  };
+  auto probe_half = [&] {
+    for (size_t n = 0; n < half; ++n) {
+      step_range(config.step, i, i + 1);
+    }
+    stats.steps += half;
+  };
+  // The cardiac phase wraps every beat and is carried separately
+  auto is_phase = [](size_t k) {
+    return ARRAYS[k] == &PhysiologyBatch::cardiac_phase_;
+  };
+  auto leap = [&](double jump) {
+    for (size_t k = 0; k < ARRAY_COUNT; ++k) {
+      if (is_phase(k)) continue;
+      double x = origin[k] + drift[k] * jump;
+      (this->*ARRAYS[k])[i] = origin[k] >= 0.0 ? std::max(0.0, x) : x;
+    }
+    cardiac_phase_[i] = std::fmod(origin_phase + jump, 60.0 / heart_rate_[i]);
+  };
+
+  double t = 0.0;
+  double cap = config.max_jump;  // Halved each time a jump is taken back
+  double jump = 0.0;             // Last jump, until the probe after it agrees
+  double jump_time = 0.0;
+
+  while (t < duration) {
+    if (duration - t < 2.0 * window) {
+      // Too little left to probe: finish in regular steps
+      while (t < duration) {
+        double h = std::min(config.step, duration - t);
+        step_range(h, i, i + 1);
+        t += h;
+        ++stats.steps;
+      }
+      break;
+    }
+
+    gather(start);
+    probe_half();
+    gather(mid);
+    probe_half();
+    gather(end);
+    t += 2.0 * window;
+
+    // Quasi-steady if every value drifted at the same rate over both halves
+    bool steady = true;
+    for (size_t k = 0; k < ARRAY_COUNT; ++k) {
+      if (is_phase(k)) continue;
+      scale[k] = std::max(std::fabs(end[k]), 1.0);
+      double first = (mid[k] - start[k]) / window;
+      double second = (end[k] - mid[k]) / window;
+      double spread = std::fabs(second - first);
+      steady = steady && spread <= config.drift_tolerance * scale[k];
+      // Drift the halves disagree on by half or more is jitter around a set
+      // point (glucose held by liver release), not a trend to follow
+      rate[k] = 0.5 * (first + second);
+      rate[k] = spread < 0.5 * std::fabs(rate[k]) ? rate[k] : 0.0;
+    }
+
+    if (jump > 0.0) {
+      // A jump holds if the person still drifts as it assumed; otherwise it
+      // crossed a change of regime (a threshold, a clamp) and is taken back
+      bool held = steady;
+      for (size_t k = 0; k < ARRAY_COUNT && held; ++k) {
+        if (is_phase(k)) continue;
+        held = std::fabs(rate[k] - drift[k]) * jump <= config.jump_tolerance * scale[k];
+      }
+      if (held) {
+        stats.jumps += 1;
+        stats.skipped += jump;
+        cap = std::min(config.max_jump, 2.0 * cap);
+        jump = 0.0;
+      } else {
+        t = jump_time;
+        cap = 0.5 * jump;
+        jump = 0.0;
+        if (cap < window) {
+          // Not worth jumping this close to the change: step through it
+          cap = config.max_jump;
+          leap(0.0);
+          continue;
+        }
+        jump = cap;
+        leap(jump);
+        t += jump;
+        continue;
+      }
+    }
+    if (!steady) continue;
+
+    // Leave room for the probe that verifies the jump
+    double next = std::min(cap, duration - t - 2.0 * window);
+    for (size_t k = 0; k < ARRAY_COUNT; ++k) {
+      if (is_phase(k) || rate[k] == 0.0) continue;
+      next = std::min(next, config.max_change * scale[k] / std::fabs(rate[k]));
+    }
+    if (next < window) continue;
+
+    std::copy(std::begin(end), std::end(end), origin);
+    std::copy(std::begin(rate), std::end(rate), drift);
+    origin_phase = cardiac_phase_[i];
+    jump = next;
+    jump_time = t;
+    leap(jump);
+    t += jump;
+  }
+}
+
+PhysiologyBatch::PhysiologySnapshot
+PhysiologyBatch::snapshot(size_t i) const {
+  PhysiologySnapshot snap;
+
+  double volume_factor = blood_volume_[i] / max_blood_volume_[i];
+  double resistance_factor =
+      volume_factor < 0.85 ? 1.0 + (0.85 - volume_factor) * 2.0 : 1.0;
+  double sbp = 120.0 * volume_factor * resistance_factor;
+  double dbp = 80.0 * volume_factor * resistance_factor * 0.9;
+  double map = dbp + (sbp - dbp) / 3.0;
+
+  snap.heart_rate = heart_rate_[i];
+  snap.blood_pressure_systolic = sbp;
+  snap.blood_pressure_diastolic = dbp;
+  snap.cardiac_output = cardiac_output_[i];
+
+  snap.respiratory_rate = 12.0 * (1.0 + sympathetic_[i] * 0.3);
+  snap.sao2 = sao2_[i];
+  snap.pao2 = pao2_[i];
+  snap.paco2 = paco2_[i];
+
+  snap.blood_glucose = blood_glucose_[i];
+  snap.blood_lactate = blood_lactate_[i];
+  snap.metabolic_rate = metabolic_rate_[i];
+
+  snap.blood_ph = ph_[i];
+  snap.bicarbonate = reported_hco3_[i];
+
+  snap.consciousness = consciousness_[i];
+  snap.stress_level = stress_[i];
+  snap.fatigue = fatigue_[i];
+
+  snap.is_alive = !(blood_volume_[i] < 2.0) && !(sao2_[i] < 0.50) &&
+                  !(ph_[i] < 6.9 || ph_[i] > 7.8);
+  snap.is_conscious = consciousness_[i] > 0.3;
+  snap.is_critical = sao2_[i] < 0.85 || map < 60 || map > 140;
+
+  return snap;
+}
+
+} // namespace biology
+} // namespace isolated
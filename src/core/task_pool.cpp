@@ -0,0 +1,148 @@
+/**
+ * @file task_pool.cpp
+ * @brief Work-stealing thread pool.
+ */
+
+#include <isolated/core/task_pool.hpp>
+#include <algorithm>
+#include <exception>
+
+namespace isolated {
+namespace core {
+
+namespace {
+
+// Pool and queue owned by the current worker thread, if any
+thread_local const TaskPool* tl_pool = nullptr;
+thread_local size_t tl_queue = 0;
+
+} // namespace
+
+TaskPool::TaskPool(size_t workers) {
+    if (workers == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        workers = hw > 1 ? hw - 1 : 0;
+    }
+
+    // The extra queue takes external submissions when there are no workers
+    for (size_t i = 0; i <= workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    threads_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+size_t TaskPool::home_queue() const {
+    return tl_pool == this ? tl_queue : queues_.size() - 1;
+}
+
+void TaskPool::submit(Task task) {
+    size_t q = tl_pool == this ? tl_queue : next_queue_++ % queues_.size();
+    {
+        // Count before pushing so a thief can never decrement first; taken
+        // under the sleep lock so a worker can't miss the wakeup
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        ++queued_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[q]->mutex);
+        queues_[q]->tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool TaskPool::try_run_one(size_t home) {
+    Task task;
+
+    {
+        // Own queue: newest first
+        Queue& own = *queues_[home];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+
+    // Steal the oldest task from the next non-empty queue
+    for (size_t k = 1; !task && k < queues_.size(); ++k) {
+        Queue& victim = *queues_[(home + k) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task) return false;
+    --queued_;
+    task();
+    return true;
+}
+
+void TaskPool::worker_loop(size_t index) {
+    tl_pool = this;
+    tl_queue = index;
+
+    while (true) {
+        if (try_run_one(index)) continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+        if (stop_) return;
+    }
+}
+
+void TaskPool::wait_until(const std::function<bool()>& done) {
+    size_t home = home_queue();
+    while (!done()) {
+        if (!try_run_one(home)) std::this_thread::yield();
+    }
+}
+
+void TaskPool::parallel_for(size_t count, size_t grain,
+                            const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t slices = (count + grain - 1) / grain;
+    if (slices == 1 || threads_.empty()) {
+        fn(0, count);
+        return;
+    }
+
+    std::atomic<size_t> remaining{slices};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto run_slice = [&](size_t s) {
+        try {
+            fn(s * grain, std::min(count, (s + 1) * grain));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+        --remaining;
+    };
+
+    for (size_t s = 1; s < slices; ++s) {
+        submit([&run_slice, s] { run_slice(s); });
+    }
+    run_slice(0);
+    wait_until([&] { return remaining == 0; });
+
+    if (error) std::rethrow_exception(error);
+}
+
+} // namespace core
+} // namespace isolated
@@ -0,0 +1,411 @@
+#include <isolated/entities/collision_avoidance.hpp>
+#include <isolated/world/navigation.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace isolated {
+namespace entities {
+
+namespace {
+
+constexpr float EPSILON = 1e-5f;
+
+struct Vec2 {
+    float x, y;
+};
+
+inline Vec2 operator+(Vec2 a, Vec2 b) { return {a.x + b.x, a.y + b.y}; }
+inline Vec2 operator-(Vec2 a, Vec2 b) { return {a.x - b.x, a.y - b.y}; }
+inline Vec2 operator-(Vec2 a) { return {-a.x, -a.y}; }
+inline Vec2 operator*(float s, Vec2 a) { return {s * a.x, s * a.y}; }
+inline float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+inline float det(Vec2 a, Vec2 b) { return a.x * b.y - a.y * b.x; }
+inline float length_sq(Vec2 a) { return dot(a, a); }
+inline Vec2 normalize(Vec2 a) { return (1.0f / std::sqrt(length_sq(a))) * a; }
+
+inline int floor_div(int a, int b) { return a / b - (a % b != 0 && (a < 0) != (b < 0)); }
+
+// Allowed velocities lie left of the line through `point` along `dir`
+struct Line {
+    Vec2 point;
+    Vec2 dir;
+};
+
+/**
+ * @brief Optimise along line `n` subject to lines [0, n) and the speed
+ * circle. False if the constraints leave nothing on the line.
+ */
+bool linear_program1(const Line* lines, size_t n, float radius, Vec2 opt, bool direction_opt,
+                     Vec2& result) {
+    const Line& line = lines[n];
+    float d = dot(line.point, line.dir);
+    float disc = d * d + radius * radius - length_sq(line.point);
+    if (disc < 0.0f) return false;  // Line misses the speed circle
+
+    float sqrt_disc = std::sqrt(disc);
+    float t_left = -d - sqrt_disc;
+    float t_right = -d + sqrt_disc;
+
+    for (size_t i = 0; i < n; ++i) {
+        float denom = det(line.dir, lines[i].dir);
+        float numer = det(lines[i].dir, line.point - lines[i].point);
+        if (std::fabs(denom) <= EPSILON) {
+            if (numer < 0.0f) return false;  // Parallel and outside
+            continue;
+        }
+        float t = numer / denom;
+        if (denom >= 0.0f) {
+            t_right = std::min(t_right, t);
+        } else {
+            t_left = std::max(t_left, t);
+        }
+        if (t_left > t_right) return false;
+    }
+
+    if (direction_opt) {
+        result = line.point + (dot(opt, line.dir) > 0.0f ? t_right : t_left) * line.dir;
+    } else {
+        float t = std::clamp(dot(line.dir, opt - line.point), t_left, t_right);
+        result = line.point + t * line.dir;
+    }
+    return true;
+}
+
+/**
+ * @brief Velocity closest to `opt` (or furthest along it, when
+ * direction_opt) satisfying every line. Returns the first line that could
+ * not be satisfied, or `count` on success.
+ */
+size_t linear_program2(const Line* lines, size_t count, float radius, Vec2 opt,
+                       bool direction_opt, Vec2& result) {
+    if (direction_opt) {
+        result = radius * opt;
+    } else if (length_sq(opt) > radius * radius) {
+        result = radius * normalize(opt);
+    } else {
+        result = opt;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (det(lines[i].dir, lines[i].point - result) > 0.0f) {
+            Vec2 previous = result;
+            if (!linear_program1(lines, i, radius, opt, direction_opt, result)) {
+                result = previous;
+                return i;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Infeasible case: minimise the largest violation over lines from
+ * `begin` on, keeping the result of the lines before it.
+ */
+void linear_program3(const Line* lines, size_t count, size_t obstacles, size_t begin,
+                     float radius, Vec2& result) {
+    Line projected[CollisionAvoidance::MAX_LINES];
+    float distance = 0.0f;
+
+    for (size_t i = begin; i < count; ++i) {
+        if (det(lines[i].dir, lines[i].point - result) <= distance) continue;
+
+        // Obstacle lines stay hard; only agent lines are relaxed
+        std::copy(lines, lines + obstacles, projected);
+        size_t n = obstacles;
+        for (size_t j = obstacles; j < i; ++j) {
+            Line line;
+            float determinant = det(lines[i].dir, lines[j].dir);
+            if (std::fabs(determinant) <= EPSILON) {
+                if (dot(lines[i].dir, lines[j].dir) > 0.0f) continue;  // Same direction
+                line.point = 0.5f * (lines[i].point + lines[j].point);
+            } else {
+                line.point = lines[i].point +
+                             (det(lines[j].dir, lines[i].point - lines[j].point) / determinant) *
+                                 lines[i].dir;
+            }
+            line.dir = normalize(lines[j].dir - lines[i].dir);
+            projected[n++] = line;
+        }
+
+        Vec2 previous = result;
+        if (linear_program2(projected, n, radius, {-lines[i].dir.y, lines[i].dir.x}, true,
+                            result) < n) {
+            result = previous;  // Only rounding can get here; keep the last result
+        }
+        distance = det(lines[i].dir, lines[i].point - result);
+    }
+}
+
+/**
+ * @brief One half-plane per wall segment near `pos`, written to `lines`.
+ *
+ * A voxel on level z is a wall when neither it nor the voxel above can be
+ * walked in; a one-voxel step is climbed, not avoided. Walls are read into
+ * a window around the agent's cell. Faces between a blocked and an open cell become segments, merged
+ * along runs of the same boundary and facing, so a straight wall is one
+ * segment and its closest point is straight across from the agent.
+ */
+size_t wall_lines(world::ChunkManager& chunks, Vec2 pos, int z, float radius, float horizon,
+                  float max_speed, float dt, Line* lines) {
+    constexpr int REACH = CollisionAvoidance::OBSTACLE_REACH;
+    constexpr int W = 2 * REACH + 1;
+    constexpr int N = static_cast<int>(world::CHUNK_SIZE);
+    const int x0 = static_cast<int>(std::floor(pos.x)) - REACH;
+    const int y0 = static_cast<int>(std::floor(pos.y)) - REACH;
+
+    world::Chunk* chunk = nullptr;
+    world::ChunkCoord coord{0, 0, 0};
+    auto passable = [&](int wx, int wy, int wz) {
+        world::ChunkCoord c{floor_div(wx, N), floor_div(wy, N), floor_div(wz, N)};
+        if (!chunk || !(c == coord)) {
+            chunk = chunks.find_chunk(c);
+            coord = c;
+        }
+        return !chunk || world::nav_passable(chunk->material[world::Chunk::idx(
+                             wx - c.x * N, wy - c.y * N, wz - c.z * N)]);
+    };
+
+    bool blocked[W][W];  // [y][x]
+    bool any = false;
+    for (int y = 0; y < W; ++y) {
+        for (int x = 0; x < W; ++x) {
+            blocked[y][x] = !passable(x0 + x, y0 + y, z) && !passable(x0 + x, y0 + y, z + 1);
+            any |= blocked[y][x];
+        }
+    }
+    if (!any) return 0;
+
+    size_t count = 0;
+    auto add = [&](Vec2 a, Vec2 b, Vec2 normal) {
+        // Only faces the agent is in front of
+        if (dot(pos - a, normal) <= 0.0f) return;
+        Vec2 q{std::clamp(pos.x, a.x, b.x), std::clamp(pos.y, a.y, b.y)};
+        Vec2 away = pos - q;
+        float dist = std::sqrt(length_sq(away));
+        if (dist - radius >= max_speed * horizon) return;  // Can never bind
+        Vec2 n = dist > EPSILON ? (1.0f / dist) * away : normal;
+
+        // Velocities v with dot(v, n) >= bound lie left of the line
+        float bound = dist > radius ? -(dist - radius) / horizon : (radius - dist) / dt;
+        lines[count++] = {bound * n, {n.y, -n.x}};
+    };
+
+    // Which way the face between two cells points: +1 when the open cell is
+    // on the far side, -1 when on the near side, 0 for no face
+    auto facing = [](bool near, bool far) { return near == far ? 0 : (near ? 1 : -1); };
+
+    // Faces normal to x, between columns c and c + 1, merged along y
+    for (int c = 0; c + 1 < W; ++c) {
+        for (int y = 0; y < W;) {
+            int f = facing(blocked[y][c], blocked[y][c + 1]);
+            int end = y + 1;
+            while (f != 0 && end < W && facing(blocked[end][c], blocked[end][c + 1]) == f) ++end;
+            if (f != 0) {
+                float fx = static_cast<float>(x0 + c + 1);
+                add({fx, static_cast<float>(y0 + y)}, {fx, static_cast<float>(y0 + end)},
+                    {static_cast<float>(f), 0.0f});
+            }
+            y = end;
+        }
+    }
+
+    // Faces normal to y, between rows r and r + 1, merged along x
+    for (int r = 0; r + 1 < W; ++r) {
+        for (int x = 0; x < W;) {
+            int f = facing(blocked[r][x], blocked[r + 1][x]);
+            int end = x + 1;
+            while (f != 0 && end < W && facing(blocked[r][end], blocked[r + 1][end]) == f) ++end;
+            if (f != 0) {
+                float fy = static_cast<float>(y0 + r + 1);
+                add({static_cast<float>(x0 + x), fy}, {static_cast<float>(x0 + end), fy},
+                    {0.0f, static_cast<float>(f)});
+            }
+            x = end;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+uint32_t CollisionAvoidance::slot(entt::entity e) const {
+    size_t index = static_cast<size_t>(entt::to_entity(e));
+    if (index >= slot_of_.size()) return NO_SLOT;
+    uint32_t s = slot_of_[index];
+    return s < entity_.size() && entity_[s] == e ? s : NO_SLOT;
+}
+
+void CollisionAvoidance::update(entt::registry& registry, const SpatialIndex& index, double dt,
+                                core::TaskPool* pool) {
+    if (dt <= 0.0) return;
+
+    // Gather
+    auto view = registry.view<const Position, const Velocity>();
+    entity_.clear();
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    vx_.clear();
+    vy_.clear();
+    pref_vx_.clear();
+    pref_vy_.clear();
+    for (auto [entity, pos, vel] : view.each()) {
+        size_t e = static_cast<size_t>(entt::to_entity(entity));
+        if (e >= slot_of_.size()) slot_of_.resize(e + 1, NO_SLOT);
+        slot_of_[e] = static_cast<uint32_t>(entity_.size());
+
+        const auto* pref = registry.try_get<PreferredVelocity>(entity);
+        entity_.push_back(entity);
+        x_.push_back(pos.x);
+        y_.push_back(pos.y);
+        z_.push_back(pos.z);
+        vx_.push_back(vel.dx);
+        vy_.push_back(vel.dy);
+        pref_vx_.push_back(pref ? pref->dx : vel.dx);
+        pref_vy_.push_back(pref ? pref->dy : vel.dy);
+    }
+
+    size_t count = entity_.size();
+    new_vx_.resize(count);
+    new_vy_.resize(count);
+
+    // Solve; each agent reads the gathered state and writes only its slot
+    float step = static_cast<float>(dt);
+    auto solve_range = [&](size_t begin, size_t end) {
+        thread_local std::vector<entt::entity> candidates;
+        for (size_t i = begin; i < end; ++i) {
+            solve(i, step, index, candidates);
+        }
+    };
+    if (pool) {
+        pool->parallel_for(count, PARALLEL_GRAIN, solve_range);
+    } else {
+        solve_range(0, count);
+    }
+
+    // Scatter
+    for (size_t i = 0; i < count; ++i) {
+        auto& vel = registry.get<Velocity>(entity_[i]);
+        vel.dx = new_vx_[i];
+        vel.dy = new_vy_[i];
+    }
+}
+
+void CollisionAvoidance::solve(size_t i, float dt, const SpatialIndex& index,
+                               std::vector<entt::entity>& candidates) {
+    const float range = config_.neighbour_dist;
+    const float range_sq = range * range;
+    const size_t max_neighbours = std::min(config_.max_neighbours, MAX_NEIGHBOURS);
+    const Vec2 pos{x_[i], y_[i]};
+    const Vec2 vel{vx_[i], vy_[i]};
+    const Vec2 pref{pref_vx_[i], pref_vy_[i]};
+
+    // Nearest neighbours on this level, kept sorted by distance
+    uint32_t near[MAX_NEIGHBOURS];
+    float near_dist_sq[MAX_NEIGHBOURS];
+    size_t near_count = 0;
+
+    candidates.clear();
+    index.query_range(static_cast<int>(std::floor(pos.x - range)),
+                      static_cast<int>(std::floor(pos.y - range)), z_[i],
+                      static_cast<int>(std::floor(pos.x + range)),
+                      static_cast<int>(std::floor(pos.y + range)), z_[i], candidates);
+    for (entt::entity other : candidates) {
+        uint32_t j = slot(other);
+        if (j == NO_SLOT || j == i || z_[j] != z_[i]) continue;
+
+        float dx = x_[j] - pos.x;
+        float dy = y_[j] - pos.y;
+        float d_sq = dx * dx + dy * dy;
+        if (d_sq >= range_sq) continue;
+        if (near_count == max_neighbours) {
+            if (d_sq >= near_dist_sq[near_count - 1]) continue;
+            --near_count;  // Drop the furthest
+        }
+
+        size_t k = near_count++;
+        while (k > 0 && near_dist_sq[k - 1] > d_sq) {
+            near[k] = near[k - 1];
+            near_dist_sq[k] = near_dist_sq[k - 1];
+            --k;
+        }
+        near[k] = j;
+        near_dist_sq[k] = d_sq;
+    }
+
+    // Walls first, so the infeasible case keeps them as hard constraints
+    Line lines[MAX_LINES];
+    const size_t walls = chunks_ ? wall_lines(*chunks_, pos, z_[i], config_.radius,
+                                              config_.obstacle_time_horizon,
+                                              config_.max_speed, dt, lines)
+                                 : 0;
+
+    // One ORCA half-plane per neighbour
+    const float inv_horizon = 1.0f / config_.time_horizon;
+    const float combined_radius = 2.0f * config_.radius;
+    const float combined_radius_sq = combined_radius * combined_radius;
+
+    for (size_t n = 0; n < near_count; ++n) {
+        uint32_t j = near[n];
+        Vec2 rel_pos{x_[j] - pos.x, y_[j] - pos.y};
+        Vec2 rel_vel = vel - Vec2{vx_[j], vy_[j]};
+        float dist_sq = near_dist_sq[n];
+
+        Line& line = lines[walls + n];
+        Vec2 u;
+        if (dist_sq > combined_radius_sq) {
+            // Vector from the cutoff circle's centre to the relative velocity
+            Vec2 w = rel_vel - inv_horizon * rel_pos;
+            float w_len_sq = length_sq(w);
+            float dot1 = dot(w, rel_pos);
+
+            if (dot1 < 0.0f && dot1 * dot1 > combined_radius_sq * w_len_sq) {
+                // Closest boundary point is on the cutoff circle
+                float w_len = std::sqrt(w_len_sq);
+                Vec2 unit_w = (1.0f / w_len) * w;
+                line.dir = {unit_w.y, -unit_w.x};
+                u = (combined_radius * inv_horizon - w_len) * unit_w;
+            } else {
+                // Closest boundary point is on one of the cone's legs
+                float leg = std::sqrt(dist_sq - combined_radius_sq);
+                if (det(rel_pos, w) > 0.0f) {
+                    line.dir = (1.0f / dist_sq) *
+                               Vec2{rel_pos.x * leg - rel_pos.y * combined_radius,
+                                    rel_pos.x * combined_radius + rel_pos.y * leg};
+                } else {
+                    line.dir = -(1.0f / dist_sq) *
+                               Vec2{rel_pos.x * leg + rel_pos.y * combined_radius,
+                                    -rel_pos.x * combined_radius + rel_pos.y * leg};
+                }
+                u = dot(rel_vel, line.dir) * line.dir - rel_vel;
+            }
+        } else {
+            // Already overlapping: separate within this step
+            float inv_step = 1.0f / dt;
+            Vec2 w = rel_vel - inv_step * rel_pos;
+            float w_len = std::sqrt(length_sq(w));
+            if (w_len <= EPSILON) {
+                // Same spot and velocity: split along a fixed axis by slot
+                w = {i < j ? 1.0f : -1.0f, 0.0f};
+                w_len = 1.0f;
+            }
+            Vec2 unit_w = (1.0f / w_len) * w;
+            line.dir = {unit_w.y, -unit_w.x};
+            u = (combined_radius * inv_step - w_len) * unit_w;
+        }
+        line.point = vel + 0.5f * u;
+    }
+
+    Vec2 result{0.0f, 0.0f};
+    const size_t line_count = walls + near_count;
+    size_t failed = linear_program2(lines, line_count, config_.max_speed, pref, false, result);
+    if (failed < line_count) {
+        linear_program3(lines, line_count, walls, failed, config_.max_speed, result);
+    }
+    new_vx_[i] = result.x;
+    new_vy_[i] = result.y;
+}
+
+} // namespace entities
+} // namespace isolated
@@ -1,13 +1,16 @@
 #include <isolated/entities/entity_manager.hpp>
+#include <cmath>
 
 namespace isolated {
 namespace entities {
 
 void EntityManager::init() {
   registry_.clear();
-  // Initialize spatial index (200x200 matches default grid size)
-  // TODO: Make this configurable or dynamic based on map size
-  spatial_index_.init(200, 200);
+  spatial_index_.init();
+  registry_.on_destroy<Position>()
+      .connect<&EntityManager::on_position_destroyed>(*this);
+  registry_.on_destroy<FlowFollower>()
+      .connect<&EntityManager::on_flow_follower_destroyed>(*this);
   
   // Seed the RNG for deterministic spawning
   rng_.seed(seed_);
@@ -19,6 +22,7 @@ entt::entity EntityManager::spawn_astronaut(float x, float y, int z,
 
   registry_.emplace<Position>(entity, x, y, z);
   registry_.emplace<Velocity>(entity, 0.0f, 0.0f);
+  registry_.emplace<PreferredVelocity>(entity);
   registry_.emplace<Astronaut>(entity, name);
   
   // Visuals: '@' symbol, deterministic colors from seeded RNG
@@ -35,12 +39,197 @@ entt::entity EntityManager::spawn_astronaut(float x, float y, int z,
   return entity;
 }
 
-void EntityManager::update(double dt) {
-  update_movement(dt);
+void EntityManager::update(double dt, core::TaskPool *pool) {
+  update_paths();
+  update_movement(dt, pool);
   update_spatial_index();
 }
 
-void EntityManager::update_movement(double dt) {
+bool EntityManager::request_path(entt::entity entity, int x, int y, int z) {
+  if (!path_queue_ || !registry_.all_of<Position>(entity)) return false;
+
+  const auto &pos = registry_.get<Position>(entity);
+  world::VoxelPos start{static_cast<int>(std::floor(pos.x)),
+                        static_cast<int>(std::floor(pos.y)), pos.z};
+  path_queue_->submit(start, {x, y, z}, static_cast<uint64_t>(entt::to_integral(entity)));
+  // Stand still until the path arrives, rather than keep the flow
+  // field's last heading
+  if (registry_.remove<FlowFollower>(entity)) stop(entity);
+  registry_.remove<Settled>(entity);
+  registry_.get_or_emplace<PreferredVelocity>(entity);
+  return true;
+}
+
+bool EntityManager::request_flow(entt::entity entity, int x, int y, int z) {
+  if (!flow_fields_ || !registry_.all_of<Position>(entity)) return false;
+
+  // Acquire before replacing, so re-targeting the same goal keeps the field
+  FlowFollower follower;
+  follower.field = flow_fields_->acquire({x, y, z});
+  follower.goal = {x, y, z};
+  if (auto *current = registry_.try_get<FlowFollower>(entity)) {
+    flow_fields_->release(current->field);
+    *current = follower;
+  } else {
+    registry_.emplace<FlowFollower>(entity, follower);
+  }
+  registry_.remove<Path>(entity);
+  registry_.remove<Settled>(entity);
+  registry_.get_or_emplace<PreferredVelocity>(entity);
+  return true;
+}
+
+void EntityManager::update_paths() {
+  if (!path_queue_) return;
+
+  // Results arrive in request order, so a newer request wins
+  path_results_.clear();
+  path_queue_->drain(path_results_);
+  for (const auto &result : path_results_) {
+    auto entity = static_cast<entt::entity>(result.tag);
+    if (!registry_.valid(entity)) continue;
+    if (!result.found) {
+      // Unreachable: drop any older path and stop where we are
+      registry_.remove<Path>(entity);
+      stop(entity);
+      continue;
+    }
+
+    Path path;
+    path.waypoints.reserve(result.path.size());
+    for (const auto &p : result.path) {
+      path.waypoints.push_back({p.x, p.y, p.z});
+    }
+    path.active = true;
+    registry_.emplace_or_replace<Path>(entity, std::move(path));
+  }
+}
+
+void EntityManager::stop(entt::entity entity) {
+  if (auto *preferred = registry_.try_get<PreferredVelocity>(entity)) {
+    preferred->dx = 0.0f;
+    preferred->dy = 0.0f;
+  }
+  if (auto *vel = registry_.try_get<Velocity>(entity)) {
+    vel->dx = 0.0f;
+    vel->dy = 0.0f;
+  }
+}
+
+bool EntityManager::joins_group(entt::entity entity, const Position &pos,
+                                const Waypoint &goal) {
+  // The goal is taken: stop on touching (within an agent radius of contact)
+  // a walker that already settled there
+  const float contact = 3.0f * avoidance_.config().radius;
+  nearby_.clear();
+  spatial_index_.query_range(static_cast<int>(std::floor(pos.x - contact)),
+                             static_cast<int>(std::floor(pos.y - contact)), pos.z,
+                             static_cast<int>(std::floor(pos.x + contact)),
+                             static_cast<int>(std::floor(pos.y + contact)), pos.z, nearby_);
+  for (entt::entity other : nearby_) {
+    if (other == entity) continue;
+    const auto *settled = registry_.try_get<Settled>(other);
+    if (!settled || settled->goal.x != goal.x || settled->goal.y != goal.y ||
+        settled->goal.z != goal.z) {
+      continue;
+    }
+    const auto &p = registry_.get<Position>(other);
+    float dx = p.x - pos.x;
+    float dy = p.y - pos.y;
+    if (p.z == pos.z && dx * dx + dy * dy <= contact * contact) return true;
+  }
+  return false;
+}
+
+void EntityManager::update_movement(double dt, core::TaskPool *pool) {
+  // A waypoint counts as reached within an agent radius of its centre
+  const float arrive = avoidance_.config().radius;
+  const float arrive_sq = arrive * arrive;
+
+  // Steer entities with a path toward the centre of their next waypoint
+  auto walkers = registry_.view<Position, PreferredVelocity, Path>();
+  for (auto [entity, pos, vel, path] : walkers.each()) {
+    if (!path.active) continue;
+
+    bool stepping = false;
+    while (path.current_index < path.waypoints.size()) {
+      const Waypoint &wp = path.waypoints[path.current_index];
+      float dx = wp.x + 0.5f - pos.x;
+      float dy = wp.y + 0.5f - pos.y;
+      float dist_sq = dx * dx + dy * dy;
+      if (dist_sq <= arrive_sq) {
+        pos.z = wp.z;  // Arrived: take the waypoint's level
+        ++path.current_index;
+        continue;
+      }
+      if (joins_group(entity, pos, path.waypoints.back())) break;
+      float dist = std::sqrt(dist_sq);
+      vel.dx = dx / dist * WALK_SPEED;
+      vel.dy = dy / dist * WALK_SPEED;
+      stepping = true;
+      break;
+    }
+    if (stepping) continue;
+
+    path.active = false;
+    vel.dx = 0.0f;
+    vel.dy = 0.0f;
+    if (!path.waypoints.empty()) {
+      registry_.emplace_or_replace<Settled>(entity, path.waypoints.back());
+    }
+  }
+
+  // Flow followers read one direction per voxel stepped; the field is
+  // shared by everyone heading to the same goal
+  if (flow_fields_) {
+    arrived_.clear();
+    auto followers = registry_.view<Position, PreferredVelocity, FlowFollower>();
+    for (auto [entity, pos, vel, flow] : followers.each()) {
+      world::VoxelPos here{static_cast<int>(std::floor(pos.x)),
+                           static_cast<int>(std::floor(pos.y)), pos.z};
+      if (flow.stepping) {
+        float dx = flow.next.x + 0.5f - pos.x;
+        float dy = flow.next.y + 0.5f - pos.y;
+        float dist_sq = dx * dx + dy * dy;
+        if (dist_sq > arrive_sq) {
+          if (joins_group(entity, pos, flow.goal)) {
+            vel.dx = 0.0f;
+            vel.dy = 0.0f;
+            registry_.emplace_or_replace<Settled>(entity, flow.goal);
+            arrived_.push_back(entity);
+            continue;
+          }
+          float dist = std::sqrt(dist_sq);
+          vel.dx = dx / dist * WALK_SPEED;
+          vel.dy = dy / dist * WALK_SPEED;
+          continue;
+        }
+        pos.z = flow.next.z;
+        here = {flow.next.x, flow.next.y, flow.next.z};
+        flow.stepping = false;
+      }
+
+      world::VoxelPos to{};
+      vel.dx = 0.0f;
+      vel.dy = 0.0f;
+      if (flow_fields_->next_step(flow.field, here, to)) {
+        flow.next = {to.x, to.y, to.z};
+        flow.stepping = true;
+      } else if (flow_fields_->ready(flow.field)) {
+        // At the goal, or it is out of reach
+        if (flow_fields_->at_goal(flow.field, here)) {
+          registry_.emplace_or_replace<Settled>(entity, flow.goal);
+        }
+        arrived_.push_back(entity);
+      }
+    }
+    registry_.remove<FlowFollower>(arrived_.begin(), arrived_.end());
+  }
+
+  // Turn preferred velocities into collision-free ones, using the index
+  // built at the end of the previous step (positions have not moved since)
+  avoidance_.update(registry_, spatial_index_, dt, pool);
+
   auto view = registry_.view<Position, const Velocity>();
   
   // Simple Euler integration
@@ -53,21 +242,23 @@ void EntityManager::update_movement(double dt) {
 }
 
 entt::entity EntityManager::get_entity_at(float target_x, float target_y, int target_z, float radius) const {
-  // Fast lookup using spatial index
-  int gx = static_cast<int>(target_x);
-  int gy = static_cast<int>(target_y);
-  
-  const auto& entities = spatial_index_.get_entities_at(gx, gy);
-  
-  if (entities.empty()) return entt::null;
+  // Broad phase: cells overlapping the pick circle on this level
+  std::vector<entt::entity> candidates;
+  spatial_index_.query_range(static_cast<int>(std::floor(target_x - radius)),
+                             static_cast<int>(std::floor(target_y - radius)), target_z,
+                             static_cast<int>(std::floor(target_x + radius)),
+                             static_cast<int>(std::floor(target_y + radius)), target_z,
+                             candidates);
+
+  if (candidates.empty()) return entt::null;
   
-  // If multiple entities in cell, find closest to exact click
+  // If several entities are in range, find closest to exact click
   entt::entity found = entt::null;
   float min_dist_sq = radius * radius;
   
   auto view = registry_.view<const Position>();
 
-  for (auto entity : entities) {
+  for (auto entity : candidates) {
       if (!registry_.valid(entity)) continue;
       
       const auto& pos = view.get<const Position>(entity);
@@ -89,14 +280,14 @@ entt::entity EntityManager::get_entity_at(float target_x, float target_y, int ta
 std::vector<entt::entity> EntityManager::get_entities_in_radius(float x, float y, int z, float radius) const {
   std::vector<entt::entity> result;
   // Broad phase: query spatial index for relevant cells
-  int min_x = static_cast<int>(x - radius);
-  int max_x = static_cast<int>(x + radius);
-  int min_y = static_cast<int>(y - radius);
-  int max_y = static_cast<int>(y + radius);
+  int min_x = static_cast<int>(std::floor(x - radius));
+  int max_x = static_cast<int>(std::floor(x + radius));
+  int min_y = static_cast<int>(std::floor(y - radius));
+  int max_y = static_cast<int>(std::floor(y + radius));
 
   std::vector<entt::entity> candidates;
   candidates.reserve(16); // Reserve some space
-  spatial_index_.query_range(min_x, min_y, max_x, max_y, candidates);
+  spatial_index_.query_range(min_x, min_y, z, max_x, max_y, z, candidates);
 
   // Narrow phase: exact distance check
   float r_sq = radius * radius;
@@ -120,11 +311,21 @@ std::vector<entt::entity> EntityManager::get_entities_in_radius(float x, float y
 }
 
 void EntityManager::update_spatial_index() {
-  spatial_index_.clear();
+  // Entities that stay in their cell cost a key compare; the CSR arrays are
+  // only rebuilt when something crossed a cell boundary
   auto view = registry_.view<const Position>();
   for (auto [entity, pos] : view.each()) {
-      spatial_index_.insert(entity, static_cast<int>(pos.x), static_cast<int>(pos.y));
+      spatial_index_.set_position(entity, pos.x, pos.y, pos.z);
   }
+  spatial_index_.commit();
+}
+
+void EntityManager::on_position_destroyed(entt::registry &, entt::entity entity) {
+  spatial_index_.remove(entity);
+}
+
+void EntityManager::on_flow_follower_destroyed(entt::registry &registry, entt::entity entity) {
+  if (flow_fields_) flow_fields_->release(registry.get<FlowFollower>(entity).field);
 }
 
 } // namespace entities
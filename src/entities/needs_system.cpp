@@ -1,84 +1,106 @@
 #include <isolated/entities/needs_system.hpp>
 #include <algorithm>
+#include <vector>
 
 namespace isolated {
 namespace entities {
 
-void NeedsSystem::update(double dt, entt::registry& registry, fluids::LBMEngine& fluids) {
-    float dt_f = static_cast<float>(dt);
-    
+void NeedsSystem::update(double dt, entt::registry& registry, fluids::LBMEngine& fluids,
+                         core::TaskPool* pool) {
+    // Entities only write their own Needs and SimLod, so slices are independent
     auto view = registry.view<const Position, Needs>();
+    std::vector<entt::entity> entities(view.begin(), view.end());
     
-    for (auto [entity, pos, needs] : view.each()) {
-        // Skip dead entities
-        if (needs.hypoxia_state == HypoxiaState::DEAD) continue;
+    auto update_slice = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            entt::entity entity = entities[i];
+            auto [pos, needs] = view.get(entity);
+
+            // Skip dead entities
+            if (needs.hypoxia_state == HypoxiaState::DEAD) continue;
+
+            // Slower LOD tiers bank dt and integrate it in one longer step
+            float dt_f = static_cast<float>(dt);
+            if (auto* lod = registry.try_get<SimLod>(entity)) {
+                lod->pending_dt += dt_f;
+                if (lod->pending_dt < lod->period) continue;
+                dt_f = lod->pending_dt;
+                lod->pending_dt = 0.0f;
+            }
         
-        // Get ambient O2 at astronaut's position
-        int gx = static_cast<int>(pos.x);
-        int gy = static_cast<int>(pos.y);
-        int gz = pos.z;
+            // Get ambient O2 at astronaut's position
+            int gx = static_cast<int>(pos.x);
+            int gy = static_cast<int>(pos.y);
+            int gz = pos.z;
         
-        // Clamp to grid bounds
-        gx = std::clamp(gx, 0, 199);
-        gy = std::clamp(gy, 0, 199);
-        gz = std::clamp(gz, 0, 0); // Currently only z=0
+            // Clamp to grid bounds
+            gx = std::clamp(gx, 0, 199);
+            gy = std::clamp(gy, 0, 199);
+            gz = std::clamp(gz, 0, 0); // Currently only z=0
         
-        // Read O2 fraction from LBM
-        // O2 fraction = O2 density / total density
-        double total_density = fluids.get_density(gx, gy, gz);
-        double o2_density = fluids.get_species_density("O2", gx, gy, gz);
-        float ambient_o2 = (total_density > 0.0) ? static_cast<float>(o2_density / total_density) : 0.0f;
+            // Read O2 fraction from LBM
+            // O2 fraction = O2 density / total density
+            double total_density = fluids.get_density(gx, gy, gz);
+            double o2_density = fluids.get_species_density("O2", gx, gy, gz);
+            float ambient_o2 = (total_density > 0.0) ? static_cast<float>(o2_density / total_density) : 0.0f;
         
-        // === O2 Consumption ===
-        // If ambient O2 is sufficient, maintain saturation
-        // If ambient O2 is low, saturation drops
-        if (ambient_o2 >= MIN_AMBIENT_O2) {
-            // Normal breathing: slowly recover O2 saturation
-            needs.oxygen = std::min(1.0f, needs.oxygen + 0.1f * dt_f);
-        } else {
-            // Low O2: saturation drops based on deficit
-            float deficit = MIN_AMBIENT_O2 - ambient_o2;
-            needs.oxygen = std::max(0.0f, needs.oxygen - O2_CONSUMPTION_RATE * deficit * dt_f * 10.0f);
-        }
+            // === O2 Consumption ===
+            // If ambient O2 is sufficient, maintain saturation
+            // If ambient O2 is low, saturation drops
+            if (ambient_o2 >= MIN_AMBIENT_O2) {
+                // Normal breathing: slowly recover O2 saturation
+                needs.oxygen = std::min(1.0f, needs.oxygen + 0.1f * dt_f);
+            } else {
+                // Low O2: saturation drops based on deficit
+                float deficit = MIN_AMBIENT_O2 - ambient_o2;
+                needs.oxygen = std::max(0.0f, needs.oxygen - O2_CONSUMPTION_RATE * deficit * dt_f * 10.0f);
+            }
         
-        // === Hydration (Thirst) ===
-        // Base consumption for living
-        float thirst_rate = 0.005f; // % per second base
+            // === Hydration (Thirst) ===
+            // Base consumption for living
+            float thirst_rate = 0.005f; // % per second base
         
-        // Scale by metabolic activity (Sweating)
-        if (auto* metab = registry.try_get<Metabolism>(entity)) {
-            // Assume 80W is resting. Higher watts = more sweat.
-            // Simplified sweat factor
-            float activity_factor = metab->metabolic_rate_watts / 80.0f;
-            thirst_rate *= activity_factor;
+            // Scale by metabolic activity (Sweating)
+            if (auto* metab = registry.try_get<Metabolism>(entity)) {
+                // Assume 80W is resting. Higher watts = more sweat.
+                // Simplified sweat factor
+                float activity_factor = metab->metabolic_rate_watts / 80.0f;
+                thirst_rate *= activity_factor;
             
-            // Add temp penalty if overheating (simplified)
-            if (metab->core_temperature > 311.15f) { // >38C
-                thirst_rate *= 2.0f;
+                // Add temp penalty if overheating (simplified)
+                if (metab->core_temperature > 311.15f) { // >38C
+                    thirst_rate *= 2.0f;
+                }
             }
-        }
         
-        // Water drains over time
-        needs.thirst = std::max(0.0f, needs.thirst - thirst_rate * dt_f * 0.1f); // Scaled down for playability
+            // Water drains over time
+            needs.thirst = std::max(0.0f, needs.thirst - thirst_rate * dt_f * 0.1f); // Scaled down for playability
         
-        // Note: CO2 exhale would require modifying the LBM grid which needs additional API
-        // For now, we just track hypoxia based on ambient O2
+            // Note: CO2 exhale would require modifying the LBM grid which needs additional API
+            // For now, we just track hypoxia based on ambient O2
         
-        // === Hypoxia State Transitions ===
-        HypoxiaState old_state = needs.hypoxia_state;
+            // === Hypoxia State Transitions ===
+            HypoxiaState old_state = needs.hypoxia_state;
         
-        if (needs.oxygen < HYPOXIA_DEATH_THRESHOLD) {
-            needs.hypoxia_state = HypoxiaState::DEAD;
-        } else if (needs.oxygen < HYPOXIA_COLLAPSED_THRESHOLD) {
-            needs.hypoxia_state = HypoxiaState::COLLAPSED;
-        } else if (needs.oxygen < HYPOXIA_CONFUSED_THRESHOLD) {
-            needs.hypoxia_state = HypoxiaState::CONFUSED;
-        } else {
-            needs.hypoxia_state = HypoxiaState::NORMAL;
-        }
+            if (needs.oxygen < HYPOXIA_DEATH_THRESHOLD) {
+                needs.hypoxia_state = HypoxiaState::DEAD;
+            } else if (needs.oxygen < HYPOXIA_COLLAPSED_THRESHOLD) {
+                needs.hypoxia_state = HypoxiaState::COLLAPSED;
+            } else if (needs.oxygen < HYPOXIA_CONFUSED_THRESHOLD) {
+                needs.hypoxia_state = HypoxiaState::CONFUSED;
+            } else {
+                needs.hypoxia_state = HypoxiaState::NORMAL;
+            }
         
-        // TODO: Log state transitions for event system
-        (void)old_state; // Unused for now
+            // TODO: Log state transitions for event system
+            (void)old_state; // Unused for now
+        }
+    };
+
+    if (pool) {
+        pool->parallel_for(entities.size(), PARALLEL_GRAIN, update_slice);
+    } else {
+        update_slice(0, entities.size());
     }
 }
 
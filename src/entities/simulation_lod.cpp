@@ -0,0 +1,153 @@
+#include <isolated/entities/simulation_lod.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace isolated {
+namespace entities {
+
+namespace {
+
+// 0 at `ok`, rising to 1 at `bad`, for either direction of threshold
+float severity(double value, double ok, double bad) {
+    return static_cast<float>(std::clamp((value - ok) / (bad - ok), 0.0, 1.0));
+}
+
+} // namespace
+
+void SimulationLod::add(entt::registry& registry, entt::entity entity,
+                        const PhysiologyConfig& config) {
+    size_t t = tier_index(SimTier::FULL);
+    size_t index = batches_[t].add(config);
+    owners_[t].push_back(entity);
+    registry.emplace_or_replace<PhysiologySlot>(entity, PhysiologySlot{SimTier::FULL, index});
+    registry.emplace_or_replace<SimLod>(entity, SimLod{SimTier::FULL, period(SimTier::FULL), 0.0f});
+    ++counts_[t];
+}
+
+void SimulationLod::remove(entt::registry& registry, entt::entity entity) {
+    if (auto* slot = registry.try_get<PhysiologySlot>(entity)) {
+        batches_[tier_index(slot->tier)].remove(slot->index);
+        unlink(registry, slot->tier, slot->index);
+        registry.remove<PhysiologySlot>(entity);
+    }
+    if (auto* lod = registry.try_get<SimLod>(entity)) {
+        --counts_[tier_index(lod->tier)];
+        registry.remove<SimLod>(entity);
+    }
+}
+
+void SimulationLod::unlink(entt::registry& registry, SimTier tier, size_t index) {
+    // The batch swap-removed: its last person now sits at `index`
+    auto& owners = owners_[tier_index(tier)];
+    owners[index] = owners.back();
+    owners.pop_back();
+    if (index < owners.size()) {
+        registry.get<PhysiologySlot>(owners[index]).index = index;
+    }
+}
+
+void SimulationLod::move(entt::registry& registry, PhysiologySlot& slot, SimTier tier) {
+    size_t from = tier_index(slot.tier);
+    size_t to = tier_index(tier);
+    size_t index = slot.index;
+    entt::entity entity = owners_[from][index];
+
+    size_t new_index = batches_[from].transfer(index, batches_[to]);
+    owners_[to].push_back(entity);
+    unlink(registry, slot.tier, index);
+
+    slot.tier = tier;
+    slot.index = new_index;
+}
+
+float SimulationLod::period(SimTier tier) const {
+    switch (tier) {
+        case SimTier::REDUCED: return config_.reduced_period;
+        case SimTier::COARSE: return config_.coarse_period;
+        default: return 0.0f;
+    }
+}
+
+float SimulationLod::criticality(const Needs* needs, const PhysiologySnapshot* vitals) {
+    float score = 0.0f;
+    if (needs) {
+        if (needs->hypoxia_state != HypoxiaState::NORMAL) return 1.0f;
+        score = std::max(score, severity(needs->oxygen, 0.9, 0.5));
+        score = std::max(score, severity(needs->thirst, 0.3, 0.05));
+        score = std::max(score, severity(needs->hunger, 0.3, 0.05));
+    }
+    if (vitals) {
+        if (!vitals->is_alive || vitals->is_critical) return 1.0f;
+        double map = (vitals->blood_pressure_systolic + 2.0 * vitals->blood_pressure_diastolic) / 3.0;
+        score = std::max(score, severity(vitals->heart_rate, 120.0, 160.0));
+        score = std::max(score, severity(vitals->sao2, 0.94, 0.85));
+        score = std::max(score, severity(map, 75.0, 60.0));
+        // Acidaemia is what crises here produce (hypoxia, CO2, lactate). At
+        // rest the model settles into a mild metabolic alkalosis near 7.50,
+        // so alkalaemia only counts well past that
+        score = std::max(score, severity(vitals->blood_ph, 7.35, 7.2));
+        score = std::max(score, severity(vitals->blood_ph, 7.55, 7.65));
+        score = std::max(score, severity(vitals->blood_glucose, 70.0, 50.0));
+        score = std::max(score, severity(vitals->consciousness, 0.9, 0.3));
+    }
+    return score;
+}
+
+void SimulationLod::assign(entt::registry& registry, float focus_x, float focus_y, int focus_z,
+                           entt::entity selected) {
+    counts_.fill(0);
+
+    auto view = registry.view<const Position, SimLod>();
+    for (auto [entity, pos, lod] : view.each()) {
+        auto* slot = registry.try_get<PhysiologySlot>(entity);
+        PhysiologySnapshot vitals{};
+        if (slot) vitals = snapshot(*slot);
+
+        SimTier tier;
+        if (entity == selected ||
+            criticality(registry.try_get<Needs>(entity), slot ? &vitals : nullptr) >=
+                config_.critical_score) {
+            tier = SimTier::FULL;
+        } else {
+            float dx = pos.x - focus_x;
+            float dy = pos.y - focus_y;
+            float dz = static_cast<float>(pos.z - focus_z) * config_.level_distance;
+            float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+            // Stay nearby a little longer so walkers on the edge don't flicker
+            float radius = config_.near_radius + (lod.tier == SimTier::COARSE ? 0.0f : config_.hysteresis);
+            tier = distance <= radius ? SimTier::REDUCED : SimTier::COARSE;
+        }
+
+        if (tier != lod.tier) {
+            lod.tier = tier;
+            lod.period = period(tier);
+            if (slot) move(registry, *slot, tier);
+        }
+        ++counts_[tier_index(tier)];
+    }
+}
+
+void SimulationLod::step(double dt, core::TaskPool* pool) {
+    for (size_t t = 0; t < SIM_TIER_COUNT; ++t) {
+        pending_[t] += dt;
+        if (pending_[t] < period(static_cast<SimTier>(t))) continue;
+        batches_[t].step(pending_[t], pool);
+        pending_[t] = 0.0;
+    }
+}
+
+SimulationLod::FastForwardStats SimulationLod::fast_forward(double duration,
+                                                            core::TaskPool* pool) {
+    FastForwardStats total;
+    for (size_t t = 0; t < SIM_TIER_COUNT; ++t) {
+        FastForwardStats stats = batches_[t].fast_forward(duration + pending_[t], pool);
+        pending_[t] = 0.0;
+        total.steps += stats.steps;
+        total.jumps += stats.jumps;
+        total.skipped += stats.skipped;
+    }
+    return total;
+}
+
+} // namespace entities
+} // namespace isolated
@@ -0,0 +1,85 @@
+#include <isolated/entities/system_scheduler.hpp>
+#include <algorithm>
+
+namespace isolated {
+namespace entities {
+
+void SystemScheduler::add_system(const std::string& name, const ComponentAccess& access,
+                                 SystemFn fn, int interval) {
+    systems_.push_back({name, access, std::move(fn), std::max(interval, 1)});
+}
+
+void SystemScheduler::run(double dt) {
+    due_.clear();
+    for (size_t i = 0; i < systems_.size(); ++i) {
+        if (tick_ % static_cast<uint64_t>(systems_[i].interval) == 0) {
+            due_.push_back(i);
+        }
+    }
+    ++tick_;
+    if (due_.empty()) return;
+
+    // Edges from each system to every later conflicting one; registration
+    // order decides who goes first
+    size_t n = due_.size();
+    if (successors_.size() < n) successors_.resize(n);
+    if (blockers_capacity_ < n) {
+        blockers_ = std::make_unique<std::atomic<uint32_t>[]>(n);
+        blockers_capacity_ = n;
+    }
+    for (size_t a = 0; a < n; ++a) {
+        successors_[a].clear();
+        blockers_[a] = 0;
+    }
+    for (size_t b = 0; b < n; ++b) {
+        const ComponentAccess& access_b = systems_[due_[b]].access;
+        for (size_t a = 0; a < b; ++a) {
+            if (systems_[due_[a]].access.conflicts_with(access_b)) {
+                successors_[a].push_back(b);
+                ++blockers_[b];
+            }
+        }
+    }
+
+    std::atomic<size_t> remaining{n};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    // Collect the roots first: once one runs it may release later slots,
+    // which must not be submitted a second time from here
+    roots_.clear();
+    for (size_t slot = 0; slot < n; ++slot) {
+        if (blockers_[slot] == 0) roots_.push_back(slot);
+    }
+    for (size_t slot : roots_) {
+        pool_.submit([this, slot, dt, &remaining, &error, &error_mutex] {
+            execute(slot, dt, remaining, error, error_mutex);
+        });
+    }
+    pool_.wait_until([&] { return remaining == 0; });
+
+    if (error) std::rethrow_exception(error);
+}
+
+void SystemScheduler::execute(size_t slot, double dt, std::atomic<size_t>& remaining,
+                              std::exception_ptr& error, std::mutex& error_mutex) {
+    System& system = systems_[due_[slot]];
+    try {
+        system.fn(dt * system.interval);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+    }
+
+    for (size_t next : successors_[slot]) {
+        if (--blockers_[next] == 0) {
+            pool_.submit([this, next, dt, &remaining, &error, &error_mutex] {
+                execute(next, dt, remaining, error, error_mutex);
+            });
+        }
+    }
+    --remaining;
+}
+
+} // namespace entities
+} // namespace isolated
@@ -0,0 +1,405 @@
+/**
+ * @file breach.cpp
+ * @brief Compartment graph and implicit pressure solve for breaches.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <isolated/fluids/breach.hpp>
+
+namespace isolated {
+namespace fluids {
+
+using namespace breach_constants;
+
+// ============================================================================
+// TOPOLOGY
+// ============================================================================
+
+uint32_t BreachPropagationSystem::add_compartment(const Compartment &comp) {
+  auto [it, inserted] = compartment_index_.try_emplace(
+      comp.id, static_cast<uint32_t>(compartments_.size()));
+  if (inserted) {
+    compartments_.push_back(comp);
+    topology_dirty_ = true;
+  } else {
+    compartments_[it->second] = comp;
+  }
+  return it->second;
+}
+
+uint32_t BreachPropagationSystem::add_breach(const Breach &breach) {
+  auto index = static_cast<uint32_t>(breaches_.size());
+  breaches_.push_back(breach);
+  breach_index_.try_emplace(breach.id, index); // First breach keeps an id
+  topology_dirty_ = true;
+  return index;
+}
+
+uint32_t BreachPropagationSystem::create_hull_breach(
+    const std::string &compartment_id, double area) {
+  Breach breach;
+  breach.id = compartment_id + "_hull";
+  breach.type = BreachType::HULL_BREACH;
+  breach.compartment_a = compartment_id;
+  breach.compartment_b = ""; // Vacuum
+  breach.area = area;
+  breach.discharge_coeff = 0.8; // Sharp-edged orifice
+  breach.is_open = true;
+  return add_breach(breach);
+}
+
+void BreachPropagationSystem::open_door(const std::string &breach_id) {
+  uint32_t b = find_breach(breach_id);
+  if (b != NONE)
+    breaches_[b].is_open = true;
+}
+
+void BreachPropagationSystem::close_door(const std::string &breach_id) {
+  uint32_t b = find_breach(breach_id);
+  if (b != NONE)
+    breaches_[b].is_open = false;
+}
+
+uint32_t BreachPropagationSystem::find_compartment(const std::string &id) const {
+  auto it = compartment_index_.find(id);
+  return it != compartment_index_.end() ? it->second : NONE;
+}
+
+uint32_t BreachPropagationSystem::find_breach(const std::string &id) const {
+  auto it = breach_index_.find(id);
+  return it != breach_index_.end() ? it->second : NONE;
+}
+
+Compartment *BreachPropagationSystem::get_compartment(const std::string &id) {
+  uint32_t i = find_compartment(id);
+  return i != NONE ? &compartments_[i] : nullptr;
+}
+
+const Compartment *
+BreachPropagationSystem::get_compartment(const std::string &id) const {
+  uint32_t i = find_compartment(id);
+  return i != NONE ? &compartments_[i] : nullptr;
+}
+
+std::span<const BreachPropagationSystem::Link>
+BreachPropagationSystem::links(uint32_t i) const {
+  update_topology();
+  return {links_.data() + link_start_[i], links_.data() + link_start_[i + 1]};
+}
+
+void BreachPropagationSystem::update_topology() const {
+  if (!topology_dirty_)
+    return;
+
+  const size_t n = compartments_.size();
+  const size_t m = breaches_.size();
+  end_a_.resize(m);
+  end_b_.resize(m);
+  link_start_.assign(n + 1, 0);
+  for (size_t b = 0; b < m; ++b) {
+    uint32_t a = find_compartment(breaches_[b].compartment_a);
+    uint32_t c = find_compartment(breaches_[b].compartment_b);
+    if (a == c) // A compartment open to itself carries no flow
+      a = c = NONE;
+    end_a_[b] = a;
+    end_b_[b] = c;
+    if (a != NONE)
+      ++link_start_[a + 1];
+    if (c != NONE)
+      ++link_start_[c + 1];
+  }
+  for (size_t i = 0; i < n; ++i)
+    link_start_[i + 1] += link_start_[i];
+
+  links_.resize(link_start_[n]);
+  std::vector<uint32_t> fill(link_start_.begin(), link_start_.end() - 1);
+  for (size_t b = 0; b < m; ++b) {
+    auto breach = static_cast<uint32_t>(b);
+    if (end_a_[b] != NONE)
+      links_[fill[end_a_[b]]++] = {breach, end_b_[b]};
+    if (end_b_[b] != NONE)
+      links_[fill[end_b_[b]]++] = {breach, end_a_[b]};
+  }
+
+  topology_dirty_ = false;
+  pattern_dirty_ = true;
+}
+
+void BreachPropagationSystem::build_pattern() {
+  const auto n = static_cast<Eigen::Index>(compartments_.size());
+
+  // Every breach between two compartments couples them, open or not, so
+  // doors can open and close without a new symbolic factorization
+  std::vector<Eigen::Triplet<double>> entries;
+  entries.reserve(compartments_.size() + 2 * breaches_.size());
+  for (Eigen::Index i = 0; i < n; ++i)
+    entries.emplace_back(i, i, 0.0);
+  for (size_t b = 0; b < breaches_.size(); ++b) {
+    if (end_a_[b] != NONE && end_b_[b] != NONE) {
+      entries.emplace_back(end_a_[b], end_b_[b], 0.0);
+      entries.emplace_back(end_b_[b], end_a_[b], 0.0);
+    }
+  }
+  jacobian_.resize(n, n);
+  jacobian_.setFromTriplets(entries.begin(), entries.end());
+  jacobian_.makeCompressed();
+
+  const double *values = jacobian_.valuePtr();
+  auto slot = [&](uint32_t row, uint32_t col) {
+    return static_cast<int>(&jacobian_.coeffRef(row, col) - values);
+  };
+  diag_slot_.resize(compartments_.size());
+  for (uint32_t i = 0; i < n; ++i)
+    diag_slot_[i] = slot(i, i);
+  slots_.resize(breaches_.size());
+  for (size_t b = 0; b < breaches_.size(); ++b) {
+    uint32_t a = end_a_[b];
+    uint32_t c = end_b_[b];
+    bool both = a != NONE && c != NONE;
+    slots_[b] = {a != NONE ? diag_slot_[a] : -1, both ? slot(a, c) : -1,
+                 both ? slot(c, a) : -1, c != NONE ? diag_slot_[c] : -1};
+  }
+
+  solver_.analyzePattern(jacobian_);
+  pattern_dirty_ = false;
+}
+
+// ============================================================================
+// IMPLICIT STEP
+// ============================================================================
+
+double BreachPropagationSystem::signed_flow(uint32_t b, const Eigen::VectorXd &p,
+                                            double &d_a, double &d_b) const {
+  const Breach &breach = breaches_[b];
+  uint32_t a = end_a_[b];
+  uint32_t c = end_b_[b];
+  double p_a = a != NONE ? p[a] : SPACE_PRESSURE;
+  double p_b = c != NONE ? p[c] : SPACE_PRESSURE;
+
+  double d_up, d_down;
+  if (p_a >= p_b) {
+    double T_a = a != NONE ? compartments_[a].temperature : SPACE_TEMPERATURE;
+    double q = BreachFlowCalculator::orifice_flow(
+        p_a, p_b, T_a, breach.area, breach.discharge_coeff, d_up, d_down);
+    d_a = d_up;
+    d_b = d_down;
+    return q;
+  }
+  double T_b = c != NONE ? compartments_[c].temperature : SPACE_TEMPERATURE;
+  double q = BreachFlowCalculator::orifice_flow(
+      p_b, p_a, T_b, breach.area, breach.discharge_coeff, d_up, d_down);
+  d_a = -d_down;
+  d_b = -d_up;
+  return -q;
+}
+
+double BreachPropagationSystem::evaluate(const Eigen::VectorXd &p, double dt,
+                                         bool with_jacobian) {
+  const size_t n = compartments_.size();
+  double *values = jacobian_.valuePtr();
+  if (with_jacobian) {
+    std::fill(values, values + jacobian_.nonZeros(), 0.0);
+    for (size_t i = 0; i < n; ++i)
+      values[diag_slot_[i]] = capacity_[i];
+  }
+
+  // Backward Euler: C (p - p_old) + dt * net outflow(p) = 0
+  for (size_t i = 0; i < n; ++i)
+    residual_[i] = capacity_[i] * (p[i] - p_old_[i]);
+
+  for (size_t b = 0; b < breaches_.size(); ++b) {
+    if (!breaches_[b].is_open || (end_a_[b] == NONE && end_b_[b] == NONE))
+      continue;
+    double d_a, d_b;
+    double q = dt * signed_flow(static_cast<uint32_t>(b), p, d_a, d_b);
+    if (end_a_[b] != NONE)
+      residual_[end_a_[b]] += q;
+    if (end_b_[b] != NONE)
+      residual_[end_b_[b]] -= q;
+
+    if (with_jacobian) {
+      const Slots &s = slots_[b];
+      if (s.aa >= 0)
+        values[s.aa] += dt * d_a;
+      if (s.ab >= 0)
+        values[s.ab] += dt * d_b;
+      if (s.ba >= 0)
+        values[s.ba] -= dt * d_a;
+      if (s.bb >= 0)
+        values[s.bb] -= dt * d_b;
+    }
+  }
+
+  // A compartment held on the MIN_MASS floor solves C p = MIN_MASS instead,
+  // until it would gain mass there
+  for (size_t i = 0; i < n; ++i) {
+    if (!held_[i])
+      continue;
+    double excess = capacity_[i] * p[i] - MIN_MASS;
+    if (residual_[i] < 0.0 && excess <= MIN_MASS * 1e-9) {
+      held_[i] = 0;
+      continue;
+    }
+    residual_[i] = excess;
+    if (!with_jacobian)
+      continue;
+    for (uint32_t k = link_start_[i]; k < link_start_[i + 1]; ++k) {
+      uint32_t b = links_[k].breach;
+      int slot = end_a_[b] == i ? slots_[b].ab : slots_[b].ba;
+      if (slot >= 0)
+        values[slot] = 0.0;
+    }
+    values[diag_slot_[i]] = capacity_[i];
+  }
+
+  double error = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    double scale = std::max(capacity_[i] * p_old_[i], MIN_MASS);
+    error = std::max(error, std::abs(residual_[i]) / scale);
+  }
+  return error;
+}
+
+void BreachPropagationSystem::step(double dt) {
+  // Update growing breaches
+  for (auto &breach : breaches_) {
+    if (breach.is_growing && breach.growth_rate > 0.0) {
+      breach.area += breach.growth_rate * dt;
+    }
+  }
+
+  update_topology();
+  if (pattern_dirty_)
+    build_pattern();
+
+  // Isothermal: each compartment's mass is capacity * pressure
+  const size_t n = compartments_.size();
+  capacity_.resize(n);
+  p_old_.resize(static_cast<Eigen::Index>(n));
+  residual_.resize(static_cast<Eigen::Index>(n));
+  held_.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    const Compartment &comp = compartments_[i];
+    capacity_[i] = comp.volume / (R_AIR * comp.temperature);
+    p_old_[i] = comp.pressure;
+    held_[i] = capacity_[i] * p_old_[i] <= MIN_MASS * (1.0 + 1e-9);
+  }
+  p_ = p_old_;
+
+  // Newton on the pressures, halving steps that fail to reduce the
+  // residual. A full step that would drain a compartment below MIN_MASS
+  // holds it on the floor and is recomputed, so the other compartments
+  // are solved against the pressure it will really have
+  double error = evaluate(p_, dt, true);
+  int iterations = 0;
+  bool stalled = false;
+  while (error > config_.tolerance && iterations < config_.max_newton_iterations &&
+         !stalled) {
+    ++iterations;
+    solver_.factorize(jacobian_);
+    if (solver_.info() != Eigen::Success)
+      break;
+    delta_ = solver_.solve(-residual_);
+
+    bool held = false;
+    for (size_t i = 0; i < n; ++i) {
+      if (!held_[i] && capacity_[i] * (p_[i] + delta_[i]) < MIN_MASS) {
+        held_[i] = 1;
+        held = true;
+      }
+    }
+    if (held) {
+      error = evaluate(p_, dt, true);
+      continue;
+    }
+
+    // If even a 1/16 step doesn't reduce the residual, the solve has stalled
+    stalled = true;
+    for (double lambda = 1.0; lambda >= 1.0 / 16.0; lambda *= 0.5) {
+      p_trial_ = p_ + lambda * delta_;
+      for (size_t i = 0; i < n; ++i)
+        p_trial_[i] = std::max(p_trial_[i], MIN_MASS / capacity_[i]);
+      double trial = evaluate(p_trial_, dt, true);
+      if (trial < error) {
+        p_.swap(p_trial_);
+        error = trial;
+        stalled = false;
+        break;
+      }
+    }
+  }
+  last_iterations_ = iterations;
+  last_error_ = error;
+
+  for (size_t i = 0; i < n; ++i)
+    compartments_[i].pressure = p_[i];
+
+  // Report the flows the step was integrated with
+  for (size_t b = 0; b < breaches_.size(); ++b) {
+    Breach &breach = breaches_[b];
+    if (!breach.is_open) {
+      breach.mass_flow_rate = 0.0;
+      breach.velocity = 0.0;
+      breach.is_choked = false;
+      continue;
+    }
+
+    double d_a, d_b;
+    breach.mass_flow_rate = signed_flow(static_cast<uint32_t>(b), p_, d_a, d_b);
+
+    uint32_t up = breach.mass_flow_rate >= 0.0 ? end_a_[b] : end_b_[b];
+    uint32_t down = breach.mass_flow_rate >= 0.0 ? end_b_[b] : end_a_[b];
+    double p_up = up != NONE ? p_[up] : SPACE_PRESSURE;
+    double p_down = down != NONE ? p_[down] : SPACE_PRESSURE;
+    double T_up = up != NONE ? compartments_[up].temperature : SPACE_TEMPERATURE;
+
+    breach.is_choked = p_up > 0.0 && p_down / p_up <= CRITICAL_RATIO;
+    double rho_up = p_up / (R_AIR * T_up);
+    breach.velocity = BreachFlowCalculator::calculate_velocity(
+        std::abs(breach.mass_flow_rate), rho_up, breach.area);
+  }
+}
+
+// ============================================================================
+// QUERIES
+// ============================================================================
+
+double BreachPropagationSystem::total_leak_rate() const {
+  update_topology();
+  double total = 0.0;
+  for (size_t b = 0; b < breaches_.size(); ++b) {
+    if ((end_a_[b] == NONE) != (end_b_[b] == NONE)) { // Leak to vacuum
+      total += std::abs(breaches_[b].mass_flow_rate);
+    }
+  }
+  return total;
+}
+
+double BreachPropagationSystem::time_to_critical_pressure(
+    const std::string &comp_id, double critical_pressure) const {
+  uint32_t i = find_compartment(comp_id);
+  if (i == NONE)
+    return 0.0;
+  const Compartment &comp = compartments_[i];
+
+  double leak_rate = 0.0;
+  for (const Link &link : links(i)) {
+    if (link.other == NONE) {
+      leak_rate += std::abs(breaches_[link.breach].mass_flow_rate);
+    }
+  }
+
+  if (leak_rate <= 0.0)
+    return std::numeric_limits<double>::infinity();
+
+  // Simplified linear estimate
+  double critical_mass = critical_pressure * comp.volume /
+                         (R_AIR * comp.temperature);
+  double mass_to_lose = comp.mass() - critical_mass;
+
+  return mass_to_lose / leak_rate;
+}
+
+} // namespace fluids
+} // namespace isolated
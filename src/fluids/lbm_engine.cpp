@@ -99,11 +99,19 @@ void LBMEngine::initialize_uniform(
   for (const auto &[name, frac] : fractions) {
     species_density_[name].resize(n_cells_, frac);
   }
+  if (registry_) {
+    publish_fields(*registry_); // Picks up any new species
+  }
 }
 
 void LBMEngine::add_species(const GasSpecies &species) {
   species_.push_back(species);
-  species_density_[species.name].resize(n_cells_, 0.0);
+  auto &density = species_density_[species.name];
+  density.resize(n_cells_, 0.0);
+  if (registry_) {
+    field_ids_.push_back(
+        registry_->publish("fluid.species." + species.name, density));
+  }
 }
 
 void LBMEngine::step(double dt) {
@@ -152,6 +160,7 @@ void LBMEngine::step(double dt) {
 
   stream();
   apply_boundary_conditions();
+  mark_fields_written();
 }
 
 void LBMEngine::compute_macroscopic() {
@@ -347,6 +356,33 @@ double LBMEngine::get_species_density(const std::string &name, size_t x,
   return 0.0;
 }
 
+void LBMEngine::add_species_density(const std::string &name, size_t x,
+                                    size_t y, size_t z, double delta) {
+  auto it = species_density_.find(name);
+  if (it != species_density_.end()) {
+    double &density = it->second[idx(x, y, z)];
+    density = std::max(0.0, density + delta);
+  }
+}
+
+void LBMEngine::publish_fields(core::FieldRegistry &registry) {
+  registry_ = &registry;
+  field_ids_ = {registry.publish("fluid.density", rho_),
+                registry.publish("fluid.ux", ux_),
+                registry.publish("fluid.uy", uy_),
+                registry.publish("fluid.uz", uz_)};
+  for (auto &[name, density] : species_density_) {
+    field_ids_.push_back(registry.publish("fluid.species." + name, density));
+  }
+}
+
+void LBMEngine::mark_fields_written() {
+  if (!registry_) return;
+  for (auto id : field_ids_) {
+    registry_->mark_written(id);
+  }
+}
+
 double LBMEngine::compute_cfl() const {
   double max_u = 0.0;
   for (int i = 0; i < static_cast<int>(n_cells_); ++i) {
@@ -364,6 +400,7 @@ void LBMEngine::synchronize_to_host() {
     // If we needed distribution functions f_ back, we'd copy them too
     // But usually we only need density/velocity for other systems
     cuda::copy_from_device(gpu_buffers_, rho_, ux_, uy_, uz_);
+    mark_fields_written();
   }
 }
 
@@ -5,8 +5,15 @@
 
 #define _USE_MATH_DEFINES
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <isolated/fluids/multiphase.hpp>
+#include <isolated/thermal/psychrometrics.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace isolated {
 namespace fluids {
@@ -20,144 +27,341 @@ PhaseChangeSystem::PhaseChangeSystem(size_t nx, size_t ny, const Config &config)
   liquid_water_.resize(n_cells_, 0.0);
   vapor_change_.resize(n_cells_, 0.0);
   rh_.resize(n_cells_, 0.0);
+  saturation_density_.resize(n_cells_, 0.0);
 }
 
 PhaseChangeSystem::StepResult
-PhaseChangeSystem::step(double dt, const std::vector<double> &h2o_density,
-                        const std::vector<double> &temperature) {
-  StepResult result{0.0, 0.0, 0.0};
+PhaseChangeSystem::step(double dt, core::FieldView<const double> h2o_density,
+                        core::FieldView<const double> temperature) {
+  const double *temperature_data = temperature.data;
+  if (!temperature.contiguous()) {
+    // The batched kernel wants a flat array; gather a strided view first
+    gathered_temperature_.resize(n_cells_);
+    for (size_t i = 0; i < n_cells_; ++i) {
+      gathered_temperature_[i] = temperature[i];
+    }
+    temperature_data = gathered_temperature_.data();
+  }
+  thermal::saturation_vapor_density(temperature_data,
+                                    saturation_density_.data(), n_cells_);
 
-  for (size_t i = 0; i < n_cells_; ++i) {
-    vapor_change_[i] = 0.0;
+  const double threshold = config_.rh_threshold;
+  double max_rh = 0.0, condensed = 0.0, evaporated = 0.0;
 
-    double temp_c = temperature[i] - 273.15;
-    double p_sat = saturation_pressure(temp_c);
+#pragma omp parallel for schedule(static) reduction(max : max_rh) \
+    reduction(+ : condensed, evaporated)
+  for (std::ptrdiff_t k = 0; k < static_cast<std::ptrdiff_t>(n_cells_); ++k) {
+    size_t i = static_cast<size_t>(k);
+    vapor_change_[i] = 0.0;
 
-    // Approximate vapor pressure from density (ideal gas)
-    double p_vapor = h2o_density[i] * 461.5 * temperature[i];
-    double rh = p_vapor / std::max(p_sat, 1e-10);
+    double rho_sat = std::max(saturation_density_[i], 1e-12);
+    double rh = h2o_density[i] / rho_sat;
     rh_[i] = rh * 100.0; // Store as percentage
+    max_rh = std::max(max_rh, rh_[i]);
 
-    result.max_rh = std::max(result.max_rh, rh_[i]);
-
-    if (rh > config_.rh_threshold) {
+    if (rh > threshold) {
       // Condensation
-      double excess = (rh - config_.rh_threshold) * p_sat;
-      double condensed = excess * config_.condensation_rate * dt;
-      vapor_change_[i] = -condensed;
-      liquid_water_[i] += condensed;
-      result.total_condensed += condensed;
-    } else if (liquid_water_[i] > 0 && rh < config_.rh_threshold) {
+      double excess = h2o_density[i] - threshold * rho_sat;
+      double amount = excess * config_.condensation_rate * dt;
+      vapor_change_[i] = -amount;
+      liquid_water_[i] += amount;
+      condensed += amount;
+    } else if (liquid_water_[i] > 0 && rh < threshold) {
       // Evaporation
-      double deficit = (config_.rh_threshold - rh) * p_sat;
-      double evaporated =
+      double deficit = threshold * rho_sat - h2o_density[i];
+      double amount =
           std::min(liquid_water_[i], deficit * config_.evaporation_rate * dt);
-      vapor_change_[i] = evaporated;
-      liquid_water_[i] -= evaporated;
-      result.total_evaporated += evaporated;
+      vapor_change_[i] = amount;
+      liquid_water_[i] -= amount;
+      evaporated += amount;
     }
   }
 
-  return result;
+  return {max_rh, condensed, evaporated};
 }
 
 // ============================================================================
 // AEROSOL SYSTEM
 // ============================================================================
 
-AerosolSystem::AerosolSystem(size_t nx, size_t ny, const Config &config)
-    : nx_(nx), ny_(ny), config_(config) {
-  particles_.reserve(config_.max_particles);
+namespace {
+
+// Philox4x32-10 (Salmon et al. 2011): a counter-based generator, so any
+// thread can draw the numbers for any (particle, step) directly
+std::array<uint32_t, 4> philox4x32(std::array<uint32_t, 4> ctr, uint64_t seed) {
+  uint32_t k0 = static_cast<uint32_t>(seed);
+  uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+  for (int round = 0; round < 10; ++round) {
+    uint64_t p0 = uint64_t{0xD2511F53u} * ctr[0];
+    uint64_t p1 = uint64_t{0xCD9E8D57u} * ctr[2];
+    ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ k0,
+           static_cast<uint32_t>(p1),
+           static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ k1,
+           static_cast<uint32_t>(p0)};
+    k0 += 0x9E3779B9u;
+    k1 += 0xBB67AE85u;
+  }
+  return ctr;
 }
 
-void AerosolSystem::spawn_particles(float x, float y, size_t count,
-                                    ParticleType type) {
-  std::normal_distribution<float> pos_dist(0.0f, 0.5f);
-  std::normal_distribution<float> vel_dist(0.0f, 0.1f);
-
-  for (size_t i = 0; i < count && particles_.size() < config_.max_particles;
-       ++i) {
-    Particle p;
-    p.x = x + pos_dist(rng_);
-    p.y = y + pos_dist(rng_);
-    p.vx = vel_dist(rng_);
-    p.vy = vel_dist(rng_);
-    p.type = type;
-
-    switch (type) {
-    case ParticleType::SMOKE:
-      p.mass = 1e-9f;
-      p.lifetime = 60.0f;
-      break;
-    case ParticleType::DUST:
-      p.mass = 1e-8f;
-      p.lifetime = 120.0f;
-      break;
-    case ParticleType::ASH:
-      p.mass = 1e-7f;
-      p.lifetime = 30.0f;
-      break;
-    case ParticleType::DROPLET:
-      p.mass = 1e-6f;
-      p.lifetime = 10.0f;
-      break;
-    }
+// Uniform in (0, 1) from the top 24 bits
+inline float unit_interval(uint32_t bits) {
+  return (static_cast<float>(bits >> 8) + 0.5f) * (1.0f / 16777216.0f);
+}
 
-    particles_.push_back(p);
-  }
+// Two independent standard normals (Box-Muller)
+inline void normal_pair(uint32_t a, uint32_t b, float &n0, float &n1) {
+  float r = std::sqrt(-2.0f * std::log(unit_interval(a)));
+  float theta = 2.0f * static_cast<float>(M_PI) * unit_interval(b);
+  n0 = r * std::cos(theta);
+  n1 = r * std::sin(theta);
 }
 
-void AerosolSystem::step(double dt, const std::vector<double> &fluid_ux,
-                         const std::vector<double> &fluid_uy,
-                         const std::vector<uint8_t> &solid) {
-  std::normal_distribution<float> brownian(
-      0.0f,
-      static_cast<float>(std::sqrt(2.0 * config_.brownian_diffusion * dt)));
+// Counter word 3 tells the step and spawn streams apart
+constexpr uint32_t STEP_STREAM = 0;
+constexpr uint32_t SPAWN_STREAM = 1;
 
-  for (auto it = particles_.begin(); it != particles_.end();) {
-    Particle &p = *it;
+struct AerosolTraits {
+  float mass;     // kg
+  float lifetime; // seconds
+};
 
-    // Decrease lifetime
-    p.lifetime -= static_cast<float>(dt);
+// Indexed by ParticleType
+constexpr AerosolTraits AEROSOL_TRAITS[] = {
+    {1e-9f, 60.0f}, {1e-8f, 120.0f}, {1e-7f, 30.0f}, {1e-6f, 10.0f}};
 
-    // Check removal conditions
-    if (p.lifetime <= 0 || p.x < 0 || p.x >= nx_ || p.y < 0 || p.y >= ny_) {
-      it = particles_.erase(it);
-      continue;
-    }
+constexpr float AEROSOL_RADIUS = 1e-6f; // m, for Stokes settling
+constexpr double AIR_VISCOSITY = 1.8e-5; // Pa s
+
+// Destination codes in AerosolSystem::cell_: a cell index, a solid cell
+// index with DEPOSITED set, or REMOVED
+constexpr uint32_t DEPOSITED = 0x80000000u;
+constexpr uint32_t REMOVED = 0xFFFFFFFFu;
 
-    // Get fluid velocity at particle position
-    size_t ix = static_cast<size_t>(p.x);
-    size_t iy = static_cast<size_t>(p.y);
-    size_t i = idx(ix, iy);
+} // namespace
 
-    // Check solid
-    if (!solid.empty() && solid[i]) {
-      it = particles_.erase(it);
+AerosolSystem::AerosolSystem(size_t nx, size_t ny, const Config &config)
+    : nx_(nx), ny_(ny), n_cells_(nx * ny), config_(config) {
+  particles_.reserve(std::min<size_t>(config_.max_particles, 65536));
+  cell_start_.assign(n_cells_ + 2, 0);
+  concentration_.resize(n_cells_, 0.0);
+  velocity_x_.resize(n_cells_, 0.0);
+  velocity_y_.resize(n_cells_, 0.0);
+  deposited_.resize(n_cells_, 0.0);
+}
+
+void AerosolSystem::spawn_particles(float x, float y, size_t count,
+                                    ParticleType type) {
+  size_t first = particles_.size();
+  size_t n = std::min(count, config_.max_particles - std::min(first, config_.max_particles));
+  particles_.resize(first + n);
+  const AerosolTraits &traits = AEROSOL_TRAITS[static_cast<size_t>(type)];
+
+  for (size_t j = 0; j < n; ++j) {
+    uint64_t id = spawned_ + j;
+    auto r = philox4x32({static_cast<uint32_t>(id), static_cast<uint32_t>(id >> 32),
+                         0, SPAWN_STREAM},
+                        config_.seed);
+    float dx, dy, dvx, dvy;
+    normal_pair(r[0], r[1], dx, dy);
+    normal_pair(r[2], r[3], dvx, dvy);
+
+    size_t i = first + j;
+    particles_.x[i] = x + 0.5f * dx;
+    particles_.y[i] = y + 0.5f * dy;
+    particles_.z[i] = 0.0f;
+    particles_.vx[i] = 0.1f * dvx;
+    particles_.vy[i] = 0.1f * dvy;
+    particles_.vz[i] = 0.0f;
+    particles_.mass[i] = traits.mass;
+    particles_.radius[i] = AEROSOL_RADIUS;
+    particles_.lifetime[i] = traits.lifetime;
+    particles_.type[i] = static_cast<uint32_t>(type);
+  }
+  spawned_ += n;
+}
+
+float AerosolSystem::sample(core::FieldView<const double> field, float x,
+                            float y) const {
+  // Cell centres sit at (i + 0.5, j + 0.5); clamp to the outermost ones
+  float fx = std::clamp(x - 0.5f, 0.0f, static_cast<float>(nx_ - 1));
+  float fy = std::clamp(y - 0.5f, 0.0f, static_cast<float>(ny_ - 1));
+  size_t x0 = static_cast<size_t>(fx);
+  size_t y0 = static_cast<size_t>(fy);
+  size_t x1 = std::min(x0 + 1, nx_ - 1);
+  size_t y1 = std::min(y0 + 1, ny_ - 1);
+  float tx = fx - static_cast<float>(x0);
+  float ty = fy - static_cast<float>(y0);
+
+  float bottom = static_cast<float>(field[idx(x0, y0)]) * (1.0f - tx) +
+                 static_cast<float>(field[idx(x1, y0)]) * tx;
+  float top = static_cast<float>(field[idx(x0, y1)]) * (1.0f - tx) +
+              static_cast<float>(field[idx(x1, y1)]) * tx;
+  return bottom * (1.0f - ty) + top * ty;
+}
+
+void AerosolSystem::step(double dt, core::FieldView<const double> fluid_ux,
+                         core::FieldView<const double> fluid_uy,
+                         core::FieldView<const uint8_t> solid) {
+  const auto n = static_cast<std::ptrdiff_t>(particles_.size());
+  const float fdt = static_cast<float>(dt);
+  const float sigma =
+      static_cast<float>(std::sqrt(2.0 * config_.brownian_diffusion * dt));
+  // Stokes terminal velocity over one step, per unit mass / radius
+  const float settling_scale = static_cast<float>(
+      config_.gravity / (6.0 * M_PI * AIR_VISCOSITY) * dt);
+  const float width = static_cast<float>(nx_);
+  const float height = static_cast<float>(ny_);
+  const auto step_lo = static_cast<uint32_t>(steps_);
+  const auto step_hi = static_cast<uint32_t>(steps_ >> 32);
+  ++steps_;
+
+  float *px = particles_.x.data();
+  float *py = particles_.y.data();
+  float *pvx = particles_.vx.data();
+  float *pvy = particles_.vy.data();
+  float *life = particles_.lifetime.data();
+  const float *mass = particles_.mass.data();
+  const float *radius = particles_.radius.data();
+  cell_.resize(particles_.size());
+  uint32_t *cell = cell_.data();
+
+  // Where (x, y) lands: its cell, flagged if solid, or REMOVED outside
+  auto destination = [&](float x, float y) {
+    if (!(x >= 0.0f && x < width && y >= 0.0f && y < height)) return REMOVED;
+    auto c = static_cast<uint32_t>(idx(static_cast<size_t>(x), static_cast<size_t>(y)));
+    return !solid.empty() && solid[c] ? c | DEPOSITED : c;
+  };
+
+  // Advance every particle and record where it ends up
+#pragma omp parallel for simd schedule(static)
+  for (std::ptrdiff_t k = 0; k < n; ++k) {
+    size_t i = static_cast<size_t>(k);
+    float x = px[i];
+    float y = py[i];
+    life[i] -= fdt;
+
+    // Expired, or spawned outside the domain or inside a solid cell
+    // (REMOVED has the DEPOSITED bit set too)
+    uint32_t here = life[i] > 0.0f ? destination(x, y) : REMOVED;
+    if (here & DEPOSITED) {
+      cell[i] = here;
       continue;
     }
 
-    // Advect with fluid
-    float ux = static_cast<float>(fluid_ux[i]);
-    float uy = static_cast<float>(fluid_uy[i]);
+    float ux = sample(fluid_ux, x, y);
+    float uy = sample(fluid_uy, x, y);
+    float settling = settling_scale * mass[i] / radius[i];
+
+    auto r = philox4x32({static_cast<uint32_t>(i), step_lo, step_hi, STEP_STREAM},
+                        config_.seed);
+    float kick_x, kick_y;
+    normal_pair(r[0], r[1], kick_x, kick_y);
+
+    // Relax toward the fluid velocity, then settle and diffuse
+    float vx = 0.9f * pvx[i] + 0.1f * ux + sigma * kick_x;
+    float vy = 0.9f * pvy[i] + 0.1f * uy - settling + sigma * kick_y;
+    pvx[i] = vx;
+    pvy[i] = vy;
+    px[i] = x + vx * fdt;
+    py[i] = y + vy * fdt;
+    cell[i] = destination(px[i], py[i]);
+  }
 
-    // Apply gravity (settling)
-    float settling = static_cast<float>(config_.gravity * p.mass /
-                                        (6.0 * M_PI * 1.8e-5 * 1e-6) * dt);
+  sort_and_bin();
+}
 
-    // Update velocity with drag
-    p.vx = 0.9f * p.vx + 0.1f * ux;
-    p.vy = 0.9f * p.vy + 0.1f * uy - settling;
+void AerosolSystem::sort_and_bin() {
+  const size_t n = particles_.size();
+  const size_t buckets = n_cells_ + 1; // Last bucket: removed particles
+  auto bucket = [&](uint32_t code) {
+    return code < n_cells_ ? static_cast<size_t>(code) : n_cells_;
+  };
+
+  // Each thread counts into a full row of buckets, so only use as many
+  // threads as there are particles per bucket: a sparse grid sorts on one
+  // thread and the offsets pass stays O(particles + cells)
+#ifdef _OPENMP
+  const int threads = static_cast<int>(std::clamp<size_t>(
+      n / buckets, 1, static_cast<size_t>(omp_get_max_threads())));
+#else
+  const int threads = 1;
+#endif
+  counts_.assign(static_cast<size_t>(threads) * buckets, 0);
+  sorted_.resize(n);
+  sorted_cell_.resize(n);
+
+  // Two-pass counting sort, each thread over its own contiguous slice.
+  // Offsets run cell-major, thread-minor, so the order within a cell is
+  // the old order whatever the thread count
+#pragma omp parallel num_threads(threads)
+  {
+#ifdef _OPENMP
+    const size_t team = static_cast<size_t>(omp_get_num_threads());
+    const size_t t = static_cast<size_t>(omp_get_thread_num());
+#else
+    const size_t team = 1, t = 0;
+#endif
+    const size_t begin = n * t / team;
+    const size_t end = n * (t + 1) / team;
+    uint32_t *count = counts_.data() + t * buckets;
+    for (size_t i = begin; i < end; ++i) {
+      ++count[bucket(cell_[i])];
+    }
 
-    // Add Brownian motion
-    p.vx += brownian(rng_);
-    p.vy += brownian(rng_);
+#pragma omp barrier
+#pragma omp single
+    {
+      uint32_t running = 0;
+      for (size_t b = 0; b < buckets; ++b) {
+        cell_start_[b] = running;
+        for (size_t u = 0; u < team; ++u) {
+          uint32_t c = counts_[u * buckets + b];
+          counts_[u * buckets + b] = running;
+          running += c;
+        }
+      }
+      cell_start_[buckets] = running;
+    }
 
-    // Update position
-    p.x += p.vx * static_cast<float>(dt);
-    p.y += p.vy * static_cast<float>(dt);
+    for (size_t i = begin; i < end; ++i) {
+      size_t dst = count[bucket(cell_[i])]++;
+      sorted_.x[dst] = particles_.x[i];
+      sorted_.y[dst] = particles_.y[i];
+      sorted_.z[dst] = particles_.z[i];
+      sorted_.vx[dst] = particles_.vx[i];
+      sorted_.vy[dst] = particles_.vy[i];
+      sorted_.vz[dst] = particles_.vz[i];
+      sorted_.mass[dst] = particles_.mass[i];
+      sorted_.radius[dst] = particles_.radius[i];
+      sorted_.lifetime[dst] = particles_.lifetime[i];
+      sorted_.type[dst] = particles_.type[i];
+      sorted_cell_[dst] = cell_[i];
+    }
+  }
+  std::swap(particles_, sorted_);
 
-    ++it;
+  // Removed particles sit after the last cell
+  const size_t alive = cell_start_[n_cells_];
+  for (size_t k = alive; k < n; ++k) {
+    if (sorted_cell_[k] != REMOVED) {
+      deposited_[sorted_cell_[k] & ~DEPOSITED] += particles_.mass[k];
+    }
+  }
+  particles_.resize(alive);
+
+  const auto cells = static_cast<std::ptrdiff_t>(n_cells_);
+#pragma omp parallel for schedule(static)
+  for (std::ptrdiff_t c = 0; c < cells; ++c) {
+    double mass = 0.0, momentum_x = 0.0, momentum_y = 0.0;
+    for (size_t k = cell_start_[c]; k < cell_start_[c + 1]; ++k) {
+      mass += particles_.mass[k];
+      momentum_x += particles_.mass[k] * particles_.vx[k];
+      momentum_y += particles_.mass[k] * particles_.vy[k];
+    }
+    concentration_[c] = mass;
+    velocity_x_[c] = mass > 0.0 ? momentum_x / mass : 0.0;
+    velocity_y_[c] = mass > 0.0 ? momentum_y / mass : 0.0;
   }
 }
 
@@ -168,80 +372,126 @@ void AerosolSystem::step(double dt, const std::vector<double> &fluid_ux,
 CombustionSystem::CombustionSystem(size_t nx, size_t ny, const Config &config)
     : nx_(nx), ny_(ny), n_cells_(nx * ny), config_(config) {
   fuel_.resize(n_cells_, 0.0);
-  burning_.resize(n_cells_, false);
-  heat_output_.resize(n_cells_, 0.0);
-  o2_change_.resize(n_cells_, 0.0);
-  co2_change_.resize(n_cells_, 0.0);
+  flags_.resize(n_cells_, 0);
 }
 
 void CombustionSystem::add_fuel(size_t x, size_t y, double amount_kg) {
   fuel_[idx(x, y)] += amount_kg;
+  mark_candidate(idx(x, y));
 }
 
 void CombustionSystem::ignite(size_t x, size_t y) {
-  if (fuel_[idx(x, y)] > 0) {
-    burning_[idx(x, y)] = true;
+  size_t i = idx(x, y);
+  if (fuel_[i] > 0 && !(flags_[i] & BURNING)) {
+    flags_[i] = static_cast<uint8_t>((flags_[i] & ~SMOULDERING) | BURNING);
+    burning_cells_.push_back(static_cast<uint32_t>(i));
   }
 }
 
-CombustionSystem::StepResult
-CombustionSystem::step(double dt, const std::vector<double> &o2_density,
-                       const std::vector<double> &temperature,
-                       AerosolSystem *aerosol) {
-  StepResult result{0, 0.0, 0.0, 0.0};
-
-  std::fill(heat_output_.begin(), heat_output_.end(), 0.0);
-  std::fill(o2_change_.begin(), o2_change_.end(), 0.0);
-  std::fill(co2_change_.begin(), co2_change_.end(), 0.0);
-
-  for (size_t y = 0; y < ny_; ++y) {
-    for (size_t x = 0; x < nx_; ++x) {
-      size_t i = idx(x, y);
+void CombustionSystem::add_candidate(size_t x, size_t y) {
+  mark_candidate(idx(x, y));
+}
 
-      // Check ignition conditions
-      if (!burning_[i] && fuel_[i] > 0 &&
-          temperature[i] >= config_.ignition_temp && o2_density[i] > 0.15) {
-        burning_[i] = true;
-      }
+void CombustionSystem::mark_candidate(size_t cell) {
+  if (flags_[cell] & (BURNING | CANDIDATE | SMOULDERING)) return;
+  flags_[cell] |= CANDIDATE;
+  candidates_.push_back(static_cast<uint32_t>(cell));
+}
 
-      if (!burning_[i] || fuel_[i] <= 0)
-        continue;
+bool CombustionSystem::can_ignite(uint32_t cell,
+                                  core::FieldView<const double> o2_density,
+                                  core::FieldView<const double> temperature) const {
+  return fuel_[cell] > 0 && temperature[cell] >= config_.ignition_temp &&
+         o2_density[cell] > 0.15;
+}
 
-      // Check O2 availability
-      if (o2_density[i] < 0.10) {
-        burning_[i] = false; // Extinguish
-        continue;
-      }
+CombustionSystem::StepResult
+CombustionSystem::step(double dt, core::FieldView<const double> o2_density,
+                       core::FieldView<const double> temperature,
+                       AerosolSystem *aerosol) {
+  StepResult result{0, 0.0, 0.0, 0.0};
+  sources_.clear();
+
+  // Ignition, checked on candidates only
+  for (uint32_t i : candidates_) {
+    flags_[i] &= static_cast<uint8_t>(~CANDIDATE);
+    if (!(flags_[i] & BURNING) && can_ignite(i, o2_density, temperature)) {
+      flags_[i] |= BURNING;
+      burning_cells_.push_back(i);
+    }
+  }
+  candidates_.clear();
+
+  // Smouldering cells stay listed until they re-ignite or lose their fuel
+  size_t smouldering = 0;
+  for (uint32_t i : smouldering_) {
+    if (!(flags_[i] & SMOULDERING)) continue; // Lit by ignite()
+    if (can_ignite(i, o2_density, temperature)) {
+      flags_[i] = static_cast<uint8_t>((flags_[i] & ~SMOULDERING) | BURNING);
+      burning_cells_.push_back(i);
+    } else if (fuel_[i] > 0) {
+      smouldering_[smouldering++] = i;
+    } else {
+      flags_[i] &= static_cast<uint8_t>(~SMOULDERING);
+    }
+  }
+  smouldering_.resize(smouldering);
+
+  // Burn, compacting the list in place as cells go out
+  size_t kept = 0;
+  for (size_t k = 0; k < burning_cells_.size(); ++k) {
+    uint32_t i = burning_cells_[k];
+    if (fuel_[i] <= 0) {
+      flags_[i] &= static_cast<uint8_t>(~BURNING);
+      continue;
+    }
+    // Starved of O2: out, but smoulders while it still has fuel
+    if (o2_density[i] < 0.10) {
+      flags_[i] = static_cast<uint8_t>((flags_[i] & ~BURNING) | SMOULDERING);
+      smouldering_.push_back(i);
+      continue;
+    }
 
-      // Burn fuel
-      double fuel_burned = std::min(fuel_[i], config_.burn_rate * dt);
-      fuel_[i] -= fuel_burned;
-
-      // Outputs
-      heat_output_[i] = fuel_burned * config_.heat_release_rate;
-      o2_change_[i] = -fuel_burned * config_.o2_consumption_rate;
-      co2_change_[i] = fuel_burned * config_.co2_production_rate;
-
-      result.burning_cells++;
-      result.total_heat += heat_output_[i];
-      result.o2_consumed += -o2_change_[i];
-      result.co2_produced += co2_change_[i];
-
-      // Generate smoke
-      if (aerosol) {
-        size_t smoke_count =
-            static_cast<size_t>(fuel_burned * config_.smoke_rate);
-        if (smoke_count > 0) {
-          std::uniform_real_distribution<float> pos_jitter(-0.5f, 0.5f);
-          aerosol->spawn_particles(x + pos_jitter(rng_), y + pos_jitter(rng_),
-                                   smoke_count, ParticleType::SMOKE);
-        }
+    double fuel_burned = std::min(fuel_[i], config_.burn_rate * dt);
+    fuel_[i] -= fuel_burned;
+
+    CombustionSource source{i, fuel_burned * config_.heat_release_rate,
+                            -fuel_burned * config_.o2_consumption_rate,
+                            fuel_burned * config_.co2_production_rate,
+                            static_cast<size_t>(fuel_burned * config_.smoke_rate)};
+    sources_.push_back(source);
+
+    result.burning_cells++;
+    result.total_heat += source.heat;
+    result.o2_consumed += -source.o2_change;
+    result.co2_produced += source.co2_change;
+
+    // Fuel-bearing neighbours may catch next step
+    size_t x = i % nx_, y = i / nx_;
+    for (size_t cy = (y > 0 ? y - 1 : 0); cy <= std::min(y + 1, ny_ - 1); ++cy) {
+      for (size_t cx = (x > 0 ? x - 1 : 0); cx <= std::min(x + 1, nx_ - 1); ++cx) {
+        size_t n = idx(cx, cy);
+        if (fuel_[n] > 0) mark_candidate(n);
       }
+    }
 
-      // Extinguish if no fuel left
-      if (fuel_[i] <= 0) {
-        burning_[i] = false;
-      }
+    if (fuel_[i] <= 0) {
+      flags_[i] &= static_cast<uint8_t>(~BURNING);
+      continue;
+    }
+    burning_cells_[kept++] = i;
+  }
+  burning_cells_.resize(kept);
+
+  // Generate smoke
+  if (aerosol) {
+    std::uniform_real_distribution<float> pos_jitter(-0.5f, 0.5f);
+    for (const auto &source : sources_) {
+      if (source.smoke_count == 0) continue;
+      float x = static_cast<float>(source.cell % nx_);
+      float y = static_cast<float>(source.cell / nx_);
+      aerosol->spawn_particles(x + pos_jitter(rng_), y + pos_jitter(rng_),
+                               source.smoke_count, ParticleType::SMOKE);
     }
   }
 
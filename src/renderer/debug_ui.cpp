@@ -13,6 +13,10 @@
 #include "rlImGui.h"
 #include "raylib.h"
 
+#include <cfloat>
+#include <cstdio>
+#include <vector>
+
 namespace isolated {
 namespace renderer {
 
@@ -297,6 +301,12 @@ void DebugUI::draw_sidebar(const fluids::LBMEngine &fluids,
                     if (auto* vel = registry->try_get<entities::Velocity>(selected_entity)) {
                         ImGui::Text("Vel: (%.3f, %.3f)", vel->dx, vel->dy);
                     }
+
+                    // Simulation LOD
+                    if (auto* lod = registry->try_get<entities::SimLod>(selected_entity)) {
+                        static const char* tier_names[] = {"Full", "Reduced", "Coarse"};
+                        ImGui::Text("Sim LOD: %s", tier_names[static_cast<size_t>(lod->tier)]);
+                    }
                     
                     // Visuals
                     if (auto* render = registry->try_get<entities::Renderable>(selected_entity)) {
@@ -394,6 +404,47 @@ void DebugUI::draw_sidebar(const fluids::LBMEngine &fluids,
                     ImGui::EndTabItem();
                 }
 
+                // === TAB 4: VITALS (history) ===
+                if (ImGui::BeginTabItem("Vitals")) {
+                    auto* signals = registry->try_get<entities::VitalSignals>(selected_entity);
+                    if (signals && signals->history) {
+                        ImGui::Spacing();
+                        static int resolution = 0;
+                        ImGui::RadioButton("10 min", &resolution, 0);
+                        ImGui::SameLine();
+                        ImGui::RadioButton("1 day", &resolution, 1);
+                        ImGui::SameLine();
+                        ImGui::RadioButton("2 weeks", &resolution, 2);
+                        auto res = static_cast<biology::TelemetryResolution>(resolution);
+
+                        // Mean per bin; the label gives the newest bin's range
+                        static std::vector<biology::TelemetryBin> bins;
+                        static std::vector<float> means;
+                        for (size_t v = 0; v < biology::VITAL_COUNT; ++v) {
+                            auto vital = static_cast<biology::Vital>(v);
+                            const auto& ring = signals->history->ring(vital, res);
+                            bins.resize(ring.capacity());
+                            bins.resize(ring.read(bins.data(), bins.size()));
+                            means.resize(bins.size());
+                            for (size_t i = 0; i < bins.size(); ++i) means[i] = bins[i].mean;
+
+                            char overlay[64] = "";
+                            if (!bins.empty()) {
+                                std::snprintf(overlay, sizeof(overlay), "%.4g (%.4g - %.4g)",
+                                              bins.back().mean, bins.back().min, bins.back().max);
+                            }
+                            ImGui::Text("%s", biology::vital_name(vital));
+                            ImGui::PushID(static_cast<int>(v));
+                            ImGui::PlotLines("##vital", means.data(), static_cast<int>(means.size()),
+                                             0, overlay, FLT_MAX, FLT_MAX, ImVec2(-1, 36));
+                            ImGui::PopID();
+                        }
+                    } else {
+                        ImGui::TextDisabled("No Vitals History");
+                    }
+                    ImGui::EndTabItem();
+                }
+
                 ImGui::EndTabBar();
             }
 
@@ -410,6 +461,15 @@ void DebugUI::draw_sidebar(const fluids::LBMEngine &fluids,
       ImGui::Text("Frame: %.1f ms", GetFrameTime() * 1000.0f);
       ImGui::Text("Sim:   %.1f ms", sim_step_time_ms);
 
+      // Entities per simulation LOD tier
+      if (registry) {
+        size_t tiers[entities::SIM_TIER_COUNT] = {};
+        for (auto [entity, lod] : registry->view<const entities::SimLod>().each()) {
+          ++tiers[static_cast<size_t>(lod.tier)];
+        }
+        ImGui::Text("Bio LOD: %zu full, %zu reduced, %zu coarse", tiers[0], tiers[1], tiers[2]);
+      }
+
       // Frame time graph
       static float frame_times[60] = {0};
       static int idx = 0;
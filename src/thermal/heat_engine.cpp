@@ -7,6 +7,7 @@
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <stdexcept>
 #include <isolated/thermal/heat_engine.hpp>
 #include <omp.h>
 
@@ -38,6 +39,8 @@ ThermalEngine::ThermalEngine(const ThermalConfig &config) : config_(config) {
   // Fluid velocity
   fluid_ux_.resize(n_cells_, 0.0);
   fluid_uy_.resize(n_cells_, 0.0);
+  ux_view_ = fluid_ux_;
+  uy_view_ = fluid_uy_;
 
   // Preallocate temp buffers (avoid heap allocation in hot loops)
   temp_buffer_.resize(n_cells_, 0.0);
@@ -73,6 +76,10 @@ void ThermalEngine::step(double dt) {
 
     step_phase_change(dt);
   }
+
+  if (registry_) {
+    registry_->mark_written(temperature_id_);
+  }
 }
 
 void ThermalEngine::step_conduction(double dt) {
@@ -160,8 +167,8 @@ void ThermalEngine::step_advection(double dt) {
       for (int x = 1; x < static_cast<int>(config_.nx) - 1; ++x) {
         size_t i = idx(static_cast<size_t>(x), static_cast<size_t>(y), static_cast<size_t>(z));
 
-        double ux = fluid_ux_[i];
-        double uy = fluid_uy_[i];
+        double ux = ux_view_[i];
+        double uy = uy_view_[i];
 
         // Upwind advection
         double dTdx = (ux > 0)
@@ -340,5 +347,20 @@ void ThermalEngine::set_fluid_velocity(size_t x, size_t y, size_t z, double ux,
   fluid_uy_[i] = uy;
 }
 
+void ThermalEngine::bind_fluid_velocity(core::FieldView<const double> ux,
+                                        core::FieldView<const double> uy) {
+  if (ux.size != n_cells_ || uy.size != n_cells_) {
+    throw std::invalid_argument(
+        "ThermalEngine: fluid velocity size does not match the grid");
+  }
+  ux_view_ = ux;
+  uy_view_ = uy;
+}
+
+void ThermalEngine::publish_fields(core::FieldRegistry &registry) {
+  registry_ = &registry;
+  temperature_id_ = registry.publish("thermal.temperature", temperature_);
+}
+
 } // namespace thermal
 } // namespace isolated
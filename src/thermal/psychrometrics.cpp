@@ -0,0 +1,62 @@
+/**
+ * @file psychrometrics.cpp
+ * @brief Batched moist-air kernels.
+ */
+
+#include <cstddef>
+#include <isolated/thermal/psychrometrics.hpp>
+
+namespace isolated {
+namespace thermal {
+
+using namespace psychro;
+
+namespace {
+
+inline double saturation_pressure_k(double temperature_k) {
+  double t = temperature_k - KELVIN;
+  return MAGNUS_E0 * fast_exp(MAGNUS_A * t / (t + MAGNUS_B));
+}
+
+} // namespace
+
+void saturation_vapor_pressure(const double *temperature_k, double *p_sat,
+                               size_t n) {
+#pragma omp parallel for simd schedule(static)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i) {
+    p_sat[i] = saturation_pressure_k(temperature_k[i]);
+  }
+}
+
+void saturation_vapor_density(const double *temperature_k, double *rho_sat,
+                              size_t n) {
+#pragma omp parallel for simd schedule(static)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i) {
+    double t = temperature_k[i];
+    rho_sat[i] = saturation_pressure_k(t) / (R_VAPOR * t);
+  }
+}
+
+void relative_humidity(const double *vapor_density,
+                       const double *temperature_k, double *rh, size_t n) {
+#pragma omp parallel for simd schedule(static)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i) {
+    double t = temperature_k[i];
+    rh[i] = vapor_density[i] * R_VAPOR * t / saturation_pressure_k(t);
+  }
+}
+
+void dew_point(const double *vapor_density, const double *temperature_k,
+               double *dew_point_k, size_t n) {
+#pragma omp parallel for simd schedule(static)
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(n); ++i) {
+    // Invert Magnus at the actual vapor pressure
+    double p = vapor_density[i] * R_VAPOR * temperature_k[i];
+    double alpha = fast_log(p > 0.0 ? p / MAGNUS_E0 : 1.0);
+    double td = MAGNUS_B * alpha / (MAGNUS_A - alpha) + KELVIN;
+    dew_point_k[i] = p > 0.0 ? td : 0.0;
+  }
+}
+
+} // namespace thermal
+} // namespace isolated
@@ -98,6 +98,11 @@ Chunk* ChunkManager::get_chunk_at(ChunkCoord coords) {
     return it != loaded_chunks_.end() ? it->second.get() : nullptr;
 }
 
+Chunk* ChunkManager::find_chunk(ChunkCoord coords) {
+    auto it = loaded_chunks_.find(coords);
+    return it != loaded_chunks_.end() ? it->second.get() : nullptr;
+}
+
 Material ChunkManager::get_material(int world_x, int world_y, int world_z) {
     Chunk* chunk = get_chunk(world_x, world_y, world_z);
     if (!chunk) return Material::AIR;
@@ -129,8 +134,16 @@ void ChunkManager::set_material(int world_x, int world_y, int world_z, Material
     auto local_y = ((world_y % static_cast<int>(CHUNK_SIZE)) + CHUNK_SIZE) % CHUNK_SIZE;
     auto local_z = ((world_z % static_cast<int>(CHUNK_SIZE)) + CHUNK_SIZE) % CHUNK_SIZE;
     
-    chunk->material[Chunk::idx(local_x, local_y, local_z)] = mat;
+    Material& cell = chunk->material[Chunk::idx(local_x, local_y, local_z)];
+    Material old_mat = cell;
+    cell = mat;
     chunk->dirty = true;
+    
+    if (old_mat != mat) {
+        for (auto& fn : material_listeners_) {
+            fn(world_x, world_y, world_z, old_mat, mat);
+        }
+    }
 }
 
 void ChunkManager::set_temperature(int world_x, int world_y, int world_z, double temp) {
@@ -287,11 +300,19 @@ void ChunkManager::load_chunk(ChunkCoord coords) {
     // Add to LRU (newest at back)
     lru_order_.push_back(coords);
     lru_map_[coords] = std::prev(lru_order_.end());
+    
+    Chunk& loaded = *loaded_chunks_[coords];
+    for (auto& fn : load_listeners_) {
+        fn(loaded);
+    }
 }
 
 void ChunkManager::unload_chunk(ChunkCoord coords) {
     auto it = loaded_chunks_.find(coords);
     if (it != loaded_chunks_.end()) {
+        for (auto& fn : unload_listeners_) {
+            fn(*it->second);
+        }
         if (it->second->dirty) {
             save_to_disk(*it->second);
         }
@@ -0,0 +1,200 @@
+/**
+ * @file flow_field.cpp
+ * @brief Shared per-destination flow fields.
+ */
+
+#include <isolated/world/flow_field.hpp>
+
+namespace isolated {
+namespace world {
+
+namespace {
+
+constexpr int N = static_cast<int>(CHUNK_SIZE);
+constexpr size_t VOXELS = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+} // namespace
+
+uint64_t FlowFieldCache::pack(VoxelPos p) {
+    constexpr uint64_t MASK = (1ull << 21) - 1;
+    constexpr int64_t BIAS = 1 << 20;
+    return ((static_cast<uint64_t>(p.x + BIAS) & MASK) << 42) |
+           ((static_cast<uint64_t>(p.y + BIAS) & MASK) << 21) |
+           (static_cast<uint64_t>(p.z + BIAS) & MASK);
+}
+
+FlowFieldCache::FieldId FlowFieldCache::acquire(VoxelPos goal) {
+    uint64_t key = pack(goal);
+    auto it = by_goal_.find(key);
+    if (it != by_goal_.end()) {
+        ++fields_[it->second].refs;
+        return it->second;
+    }
+
+    FieldId id;
+    if (!free_.empty()) {
+        id = free_.back();
+        free_.pop_back();
+    } else {
+        id = static_cast<FieldId>(fields_.size());
+        fields_.emplace_back();
+    }
+
+    Field& field = fields_[id];
+    field.goal = goal;
+    field.refs = 1;
+    field.live = true;
+    field.built = false;
+    field.dirs.clear();
+    by_goal_[key] = id;
+    return id;
+}
+
+void FlowFieldCache::release(FieldId id) {
+    if (id >= fields_.size() || !fields_[id].live || fields_[id].refs == 0) return;
+    if (--fields_[id].refs == 0) fields_[id].released_at = ++release_clock_;
+}
+
+void FlowFieldCache::evict(FieldId id) {
+    Field& field = fields_[id];
+    by_goal_.erase(pack(field.goal));
+    field.live = false;
+    field.built = false;
+    field.dirs.clear();
+    free_.push_back(id);
+}
+
+bool FlowFieldCache::is_stale(const Field& field) const {
+    // A border chunk changing can open or close routes into the field
+    auto changed_near = [&](ChunkCoord c) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (graph_.changed_since({c.x + dx, c.y + dy, c.z + dz}, field.generation)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    };
+
+    if (changed_near(NavGraph::chunk_of(field.goal.x, field.goal.y, field.goal.z))) return true;
+    for (const auto& [c, dirs] : field.dirs) {
+        if (changed_near(c)) return true;
+    }
+    return false;
+}
+
+size_t FlowFieldCache::update() {
+    graph_.repair();
+    uint64_t generation = graph_.generation();
+
+    stale_.clear();
+    for (FieldId id = 0; id < fields_.size(); ++id) {
+        Field& field = fields_[id];
+        if (!field.live) continue;
+        if (field.built && (field.generation == generation || !is_stale(field))) {
+            field.generation = generation;
+            continue;
+        }
+        // Nobody is heading there; rebuild on the next acquire instead
+        if (field.refs == 0) {
+            evict(id);
+            continue;
+        }
+        stale_.push_back(id);
+    }
+
+    // Over budget: drop the longest-unused unreferenced fields
+    while (by_goal_.size() > max_fields_) {
+        FieldId oldest = NO_FIELD;
+        for (FieldId id = 0; id < fields_.size(); ++id) {
+            const Field& field = fields_[id];
+            if (field.live && field.refs == 0 &&
+                (oldest == NO_FIELD || field.released_at < fields_[oldest].released_at)) {
+                oldest = id;
+            }
+        }
+        if (oldest == NO_FIELD) break;
+        evict(oldest);
+    }
+
+    // Fields are independent; fields_ is not resized meanwhile
+    auto rebuild = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            build(fields_[stale_[i]]);
+        }
+    };
+    if (pool_) {
+        pool_->parallel_for(stale_.size(), 1, rebuild);
+    } else {
+        rebuild(0, stale_.size());
+    }
+    return stale_.size();
+}
+
+void FlowFieldCache::build(Field& field) const {
+    field.dirs.clear();
+    field.generation = graph_.generation();
+    field.built = true;
+
+    const VoxelPos goal = field.goal;
+    if (!graph_.standable(goal.x, goal.y, goal.z)) return;
+
+    // Most neighbours share the previous voxel's chunk
+    ChunkCoord cached{0, 0, 0};
+    uint8_t* cached_dirs = nullptr;
+    auto slot = [&](VoxelPos p) -> uint8_t& {
+        ChunkCoord c = NavGraph::chunk_of(p.x, p.y, p.z);
+        if (!cached_dirs || !(c == cached)) {
+            auto [it, inserted] = field.dirs.try_emplace(c);
+            if (inserted) it->second.assign(VOXELS, NO_STEP);
+            cached = c;
+            cached_dirs = it->second.data();
+        }
+        return cached_dirs[Chunk::idx(p.x - c.x * N, p.y - c.y * N, p.z - c.z * N)];
+    };
+
+    // BFS outward from the goal; each voxel found stores the move back
+    // toward the voxel it was found from
+    std::vector<VoxelPos> queue;
+    queue.push_back(goal);
+    slot(goal) = AT_GOAL;
+
+    size_t head = 0;
+    for (int d = 0; d < max_distance_ && head < queue.size(); ++d) {
+        size_t layer_end = queue.size();
+        for (; head < layer_end; ++head) {
+            VoxelPos to = queue[head];
+            for (int m = 0; m < NAV_MOVE_COUNT; ++m) {
+                VoxelPos from{to.x - NAV_MOVES[m].dx, to.y - NAV_MOVES[m].dy,
+                              to.z - NAV_MOVES[m].dz};
+                if (!graph_.standable(from.x, from.y, from.z)) continue;
+                uint8_t& dir = slot(from);
+                if (dir != NO_STEP || !graph_.can_move(from, to)) continue;
+                dir = static_cast<uint8_t>(m);
+                queue.push_back(from);
+            }
+        }
+    }
+}
+
+bool FlowFieldCache::next_step(FieldId id, VoxelPos from, VoxelPos& to) const {
+    if (id >= fields_.size()) return false;
+    const Field& field = fields_[id];
+
+    ChunkCoord c = NavGraph::chunk_of(from.x, from.y, from.z);
+    auto it = field.dirs.find(c);
+    if (it == field.dirs.end()) return false;
+
+    uint8_t dir = it->second[Chunk::idx(from.x - c.x * N, from.y - c.y * N, from.z - c.z * N)];
+    if (dir >= NAV_MOVE_COUNT) return false;
+
+    const NavMove& m = NAV_MOVES[dir];
+    to = {from.x + m.dx, from.y + m.dy, from.z + m.dz};
+    return true;
+}
+
+} // namespace world
+} // namespace isolated
@@ -0,0 +1,311 @@
+/**
+ * @file light_field.cpp
+ * @brief Incremental BFS voxel lighting.
+ */
+
+#include <isolated/world/light_field.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace isolated {
+namespace world {
+
+namespace {
+
+constexpr int NEIGHBOURS[6][3] = {
+    {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+};
+
+int floor_div(int a, int b) {
+    return a >= 0 ? a / b : (a - b + 1) / b;
+}
+
+} // namespace
+
+uint8_t light_opacity(Material mat) {
+    switch (mat) {
+        case Material::AIR:
+        case Material::OXYGEN:
+        case Material::NITROGEN:
+        case Material::CO2:
+        case Material::METHANE:
+        case Material::WATER_VAPOR:
+        case Material::HYDROGEN:
+        case Material::AMMONIA:
+        case Material::SULFUR_DIOXIDE:
+            return 0;
+        case Material::WATER:
+            return 1;
+        case Material::ICE:
+        case Material::CO2_ICE:
+            return 2;
+        default:
+            return LIGHT_OPAQUE;
+    }
+}
+
+uint8_t light_emission(Material mat) {
+    switch (mat) {
+        case Material::MAGMA:
+            return 12;
+        default:
+            return 0;
+    }
+}
+
+LightField::LightField(ChunkManager& chunks) : chunks_(chunks) {
+    config_ = Config{};
+    attach();
+}
+
+LightField::LightField(ChunkManager& chunks, const Config& config)
+    : chunks_(chunks), config_(config) {
+    attach();
+}
+
+void LightField::attach() {
+    chunks_.add_material_listener([this](int x, int y, int z, Material, Material) {
+        on_material_changed(x, y, z);
+    });
+    chunks_.add_load_listener([this](Chunk& chunk) { relight_chunk(chunk); });
+    chunks_.add_unload_listener([this](Chunk& chunk) {
+        if (cached_chunk_ == &chunk) cached_chunk_ = nullptr;
+    });
+}
+
+uint64_t LightField::pack(int x, int y, int z) {
+    // 21 bits per axis, offset so negative coordinates pack cleanly
+    constexpr uint64_t MASK = (1ull << 21) - 1;
+    constexpr int64_t BIAS = 1 << 20;
+    return ((static_cast<uint64_t>(x + BIAS) & MASK) << 42) |
+           ((static_cast<uint64_t>(y + BIAS) & MASK) << 21) |
+           (static_cast<uint64_t>(z + BIAS) & MASK);
+}
+
+uint8_t LightField::source_level(int x, int y, int z, Material mat) const {
+    uint8_t level = light_emission(mat);
+    if (!sources_.empty()) {
+        auto it = sources_.find(pack(x, y, z));
+        if (it != sources_.end()) level = std::max(level, it->second);
+    }
+    return level;
+}
+
+LightField::Cell LightField::locate(int x, int y, int z) const {
+    constexpr int N = static_cast<int>(CHUNK_SIZE);
+    ChunkCoord cc{floor_div(x, N), floor_div(y, N), floor_div(z, N)};
+
+    if (!cached_chunk_ || !(cc == cached_coord_)) {
+        cached_chunk_ = chunks_.find_chunk(cc);
+        cached_coord_ = cc;
+        if (!cached_chunk_) return {};
+    }
+
+    return {cached_chunk_, Chunk::idx(x - cc.x * N, y - cc.y * N, z - cc.z * N)};
+}
+
+uint8_t LightField::level_at(int x, int y, int z) const {
+    Cell cell = locate(x, y, z);
+    return cell ? cell.light() : 0;
+}
+
+uint8_t LightField::level_for_lux(double lux) const {
+    double level = std::round(lux / config_.lux_per_level);
+    return static_cast<uint8_t>(std::clamp(level, 0.0, static_cast<double>(MAX_LIGHT)));
+}
+
+void LightField::add_source(int x, int y, int z, uint8_t level) {
+    level = std::min(level, MAX_LIGHT);
+
+    auto it = sources_.find(pack(x, y, z));
+    if (it != sources_.end() && it->second > level) {
+        // Dimming: clear the old light first
+        remove_source(x, y, z);
+    }
+    sources_[pack(x, y, z)] = level;
+
+    last_update_cells_ = 0;
+    Cell cell = locate(x, y, z);
+    if (cell && cell.light() < level) {
+        cell.light() = level;
+        add_queue_.push_back({x, y, z, level});
+    }
+    propagate();
+}
+
+void LightField::remove_source(int x, int y, int z) {
+    if (sources_.erase(pack(x, y, z)) == 0) return;
+
+    last_update_cells_ = 0;
+    Cell cell = locate(x, y, z);
+    if (cell && cell.light() > 0) {
+        darken(x, y, z, cell.light());
+    }
+    propagate();
+}
+
+void LightField::on_material_changed(int x, int y, int z) {
+    last_update_cells_ = 0;
+    Cell cell = locate(x, y, z);
+    if (!cell) return;
+
+    // Remove whatever passed through the old material...
+    if (cell.light() > 0) {
+        darken(x, y, z, cell.light());
+    }
+
+    // ...then let the neighbours refill the cell under the new one
+    for (const auto& d : NEIGHBOURS) {
+        int nx = x + d[0], ny = y + d[1], nz = z + d[2];
+        Cell n = locate(nx, ny, nz);
+        if (n && n.light() > 1) {
+            add_queue_.push_back({nx, ny, nz, n.light()});
+        }
+    }
+
+    // A glowing material lights its own cell
+    uint8_t emitted = source_level(x, y, z, cell.material());
+    if (cell.light() < emitted) {
+        cell.light() = emitted;
+        add_queue_.push_back({x, y, z, emitted});
+    }
+    propagate();
+}
+
+void LightField::relight_chunk(Chunk& chunk) {
+    constexpr int N = static_cast<int>(CHUNK_SIZE);
+    auto [ox, oy, oz] = chunk.world_origin();
+    last_update_cells_ = 0;
+
+    std::fill(chunk.light.begin(), chunk.light.end(), 0);
+
+    // Light entering through the faces of loaded neighbours
+    for (const auto& d : NEIGHBOURS) {
+        if (!chunks_.find_chunk({chunk.coords.x + d[0], chunk.coords.y + d[1],
+                                 chunk.coords.z + d[2]})) {
+            continue;
+        }
+
+        // Fixed coordinate of the neighbour's face, the other two vary
+        int axis = d[0] != 0 ? 0 : (d[1] != 0 ? 1 : 2);
+        int fixed = d[axis] > 0 ? N : -1;
+        for (int v = 0; v < N; ++v) {
+            for (int u = 0; u < N; ++u) {
+                int p[3];
+                p[axis] = fixed;
+                p[(axis + 1) % 3] = u;
+                p[(axis + 2) % 3] = v;
+                int wx = ox + p[0], wy = oy + p[1], wz = oz + p[2];
+                Cell n = locate(wx, wy, wz);
+                if (n && n.light() > 1) {
+                    add_queue_.push_back({wx, wy, wz, n.light()});
+                }
+            }
+        }
+    }
+
+    // Glowing voxels inside the chunk
+    for (int z = 0; z < N; ++z) {
+        for (int y = 0; y < N; ++y) {
+            for (int x = 0; x < N; ++x) {
+                size_t i = Chunk::idx(x, y, z);
+                uint8_t level = light_emission(chunk.material[i]);
+                if (level > chunk.light[i]) {
+                    chunk.light[i] = level;
+                    add_queue_.push_back({ox + x, oy + y, oz + z, level});
+                }
+            }
+        }
+    }
+
+    // Sources inside the chunk
+    for (const auto& [key, level] : sources_) {
+        constexpr uint64_t MASK = (1ull << 21) - 1;
+        constexpr int BIAS = 1 << 20;
+        int sx = static_cast<int>((key >> 42) & MASK) - BIAS;
+        int sy = static_cast<int>((key >> 21) & MASK) - BIAS;
+        int sz = static_cast<int>(key & MASK) - BIAS;
+        if (sx < ox || sx >= ox + N || sy < oy || sy >= oy + N ||
+            sz < oz || sz >= oz + N) {
+            continue;
+        }
+        size_t i = Chunk::idx(sx - ox, sy - oy, sz - oz);
+        if (chunk.light[i] < level) {
+            chunk.light[i] = level;
+            add_queue_.push_back({sx, sy, sz, level});
+        }
+    }
+
+    propagate();
+}
+
+void LightField::darken(int x, int y, int z, uint8_t level) {
+    // Zero every cell that may have been lit through (x, y, z). Brighter or
+    // equal neighbours are lit from elsewhere and seed the refill.
+    locate(x, y, z).light() = 0;
+    remove_queue_.push_back({x, y, z, level});
+
+    for (size_t head = 0; head < remove_queue_.size(); ++head) {
+        Node node = remove_queue_[head];
+        ++last_update_cells_;
+
+        for (const auto& d : NEIGHBOURS) {
+            int nx = node.x + d[0], ny = node.y + d[1], nz = node.z + d[2];
+            Cell n = locate(nx, ny, nz);
+            if (!n) continue;
+
+            uint8_t nl = n.light();
+            if (nl != 0 && nl < node.level) {
+                n.light() = 0;
+                remove_queue_.push_back({nx, ny, nz, nl});
+            } else if (nl >= node.level) {
+                add_queue_.push_back({nx, ny, nz, nl});
+            }
+        }
+    }
+
+    // Sources and glowing voxels inside the darkened region shine again
+    for (const Node& node : remove_queue_) {
+        Cell cell = locate(node.x, node.y, node.z);
+        uint8_t level = source_level(node.x, node.y, node.z, cell.material());
+        if (cell.light() < level) {
+            cell.light() = level;
+            add_queue_.push_back({node.x, node.y, node.z, level});
+        }
+    }
+
+    remove_queue_.clear();
+}
+
+void LightField::propagate() {
+    for (size_t head = 0; head < add_queue_.size(); ++head) {
+        Node node = add_queue_[head];
+        ++last_update_cells_;
+
+        // Re-read: the cell may have been brightened since it was queued
+        Cell cell = locate(node.x, node.y, node.z);
+        if (!cell) continue;
+        uint8_t level = cell.light();
+        if (level <= 1) continue;
+
+        for (const auto& d : NEIGHBOURS) {
+            int nx = node.x + d[0], ny = node.y + d[1], nz = node.z + d[2];
+            Cell n = locate(nx, ny, nz);
+            if (!n) continue;
+
+            uint8_t opacity = light_opacity(n.material());
+            if (opacity == LIGHT_OPAQUE) continue;
+
+            int nl = static_cast<int>(level) - 1 - opacity;
+            if (nl > n.light()) {
+                n.light() = static_cast<uint8_t>(nl);
+                add_queue_.push_back({nx, ny, nz, static_cast<uint8_t>(nl)});
+            }
+        }
+    }
+
+    add_queue_.clear();
+}
+
+} // namespace world
+} // namespace isolated
@@ -0,0 +1,643 @@
+/**
+ * @file navigation.cpp
+ * @brief HPA* pathfinding with per-chunk repair.
+ */
+
+#include <isolated/world/navigation.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+namespace isolated {
+namespace world {
+
+namespace {
+
+constexpr int N = static_cast<int>(CHUNK_SIZE);
+constexpr size_t VOXELS = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+constexpr const NavMove* MOVES = NAV_MOVES;
+constexpr uint8_t NO_MOVE = 0xFF;
+
+// Chunks a move can reach: the four horizontal neighbours and the chunk
+// itself, each one level down, level or up
+constexpr int NEIGHBOUR_COUNT = 14;
+constexpr int NEIGHBOURS[NEIGHBOUR_COUNT][3] = {
+    {1, 0, -1}, {-1, 0, -1}, {0, 1, -1}, {0, -1, -1}, {0, 0, -1},
+    {1, 0, 0},  {-1, 0, 0},  {0, 1, 0},  {0, -1, 0},
+    {1, 0, 1},  {-1, 0, 1},  {0, 1, 1},  {0, -1, 1},  {0, 0, 1},
+};
+
+int floor_div(int a, int b) {
+    return a >= 0 ? a / b : (a - b + 1) / b;
+}
+
+int neighbour_index(ChunkCoord from, ChunkCoord to) {
+    for (int k = 0; k < NEIGHBOUR_COUNT; ++k) {
+        if (from.x + NEIGHBOURS[k][0] == to.x && from.y + NEIGHBOURS[k][1] == to.y &&
+            from.z + NEIGHBOURS[k][2] == to.z) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+bool before(ChunkCoord a, ChunkCoord b) {
+    if (a.z != b.z) return a.z < b.z;
+    if (a.y != b.y) return a.y < b.y;
+    return a.x < b.x;
+}
+
+// Per-thread search buffers, reused between queries
+struct Scratch {
+    // Two chunk-sized BFS buffers: start side and goal side
+    std::vector<uint32_t> dist[2];
+    std::vector<uint32_t> stamp[2];
+    std::vector<uint8_t> parent[2];
+    uint32_t epoch[2] = {0, 0};
+    std::vector<uint32_t> queue;
+
+    // Abstract A* state, indexed by node id
+    std::vector<uint32_t> g;
+    std::vector<uint32_t> came_from;
+    std::vector<uint32_t> node_stamp;
+    uint32_t node_epoch = 0;
+
+    uint32_t next_epoch(int buffer) {
+        if (dist[buffer].size() != VOXELS) {
+            dist[buffer].assign(VOXELS, 0);
+            stamp[buffer].assign(VOXELS, 0);
+            parent[buffer].assign(VOXELS, NO_MOVE);
+        }
+        if (++epoch[buffer] == 0) {
+            std::fill(stamp[buffer].begin(), stamp[buffer].end(), 0);
+            epoch[buffer] = 1;
+        }
+        return epoch[buffer];
+    }
+
+    uint32_t next_node_epoch(size_t nodes) {
+        if (g.size() < nodes) {
+            g.resize(nodes);
+            came_from.resize(nodes);
+            node_stamp.resize(nodes, 0);
+        }
+        if (++node_epoch == 0) {
+            std::fill(node_stamp.begin(), node_stamp.end(), 0);
+            node_epoch = 1;
+        }
+        return node_epoch;
+    }
+};
+
+Scratch& scratch() {
+    thread_local Scratch s;
+    return s;
+}
+
+} // namespace
+
+bool nav_passable(Material mat) {
+    return static_cast<uint8_t>(mat) < static_cast<uint8_t>(Material::WATER);
+}
+
+bool nav_floor(Material mat) {
+    return static_cast<uint8_t>(mat) >= static_cast<uint8_t>(Material::ICE) &&
+           mat != Material::MAX_MATERIALS;
+}
+
+// ============================================================================
+// NavGraph
+// ============================================================================
+
+NavGraph::NavGraph(ChunkManager& chunks, core::TaskPool* pool)
+    : chunks_(chunks), pool_(pool) {
+    chunks_.add_material_listener([this](int x, int y, int z, Material old_mat, Material new_mat) {
+        if (nav_passable(old_mat) == nav_passable(new_mat) &&
+            nav_floor(old_mat) == nav_floor(new_mat)) {
+            return;
+        }
+        // The voxel is a floor for the one above and headroom for the one
+        // below, so their chunks' transitions can change too
+        mark_dirty(chunk_of(x, y, z));
+        mark_dirty(chunk_of(x, y, z + 1));
+        mark_dirty(chunk_of(x, y, z - 1));
+    });
+    chunks_.add_load_listener([this](Chunk& chunk) {
+        mark_dirty(chunk.coords);
+        mark_dirty({chunk.coords.x, chunk.coords.y, chunk.coords.z + 1});
+    });
+    chunks_.add_unload_listener([this](Chunk& chunk) {
+        mark_dirty(chunk.coords);
+        mark_dirty({chunk.coords.x, chunk.coords.y, chunk.coords.z + 1});
+    });
+}
+
+ChunkCoord NavGraph::chunk_of(int x, int y, int z) {
+    return {floor_div(x, N), floor_div(y, N), floor_div(z, N)};
+}
+
+uint64_t NavGraph::pack(VoxelPos p) {
+    // 21 bits per axis, offset so negative coordinates pack cleanly
+    constexpr uint64_t MASK = (1ull << 21) - 1;
+    constexpr int64_t BIAS = 1 << 20;
+    return ((static_cast<uint64_t>(p.x + BIAS) & MASK) << 42) |
+           ((static_cast<uint64_t>(p.y + BIAS) & MASK) << 21) |
+           (static_cast<uint64_t>(p.z + BIAS) & MASK);
+}
+
+NavGraph::PairKey NavGraph::pair_key(ChunkCoord a, ChunkCoord b) {
+    return before(a, b) ? PairKey{a, b} : PairKey{b, a};
+}
+
+const NavGraph::ChunkNav* NavGraph::nav_at(ChunkCoord c) const {
+    auto it = navs_.find(c);
+    return it != navs_.end() ? &it->second : nullptr;
+}
+
+uint8_t NavGraph::flags_at(int x, int y, int z) const {
+    ChunkCoord c = chunk_of(x, y, z);
+    const ChunkNav* nav = nav_at(c);
+    if (!nav) return 0;
+    return nav->flags[Chunk::idx(x - c.x * N, y - c.y * N, z - c.z * N)];
+}
+
+bool NavGraph::standable(int x, int y, int z) const {
+    return (flags_at(x, y, z) & STANDABLE) != 0;
+}
+
+bool NavGraph::passable(int x, int y, int z) const {
+    return (flags_at(x, y, z) & PASSABLE) != 0;
+}
+
+bool NavGraph::can_move(VoxelPos from, VoxelPos to) const {
+    if (!standable(to.x, to.y, to.z)) return false;
+    if (to.z > from.z) return passable(from.x, from.y, from.z + 1);  // Headroom
+    if (to.z < from.z) return passable(to.x, to.y, from.z);          // Ledge
+    return true;
+}
+
+bool NavGraph::changed_since(ChunkCoord c, uint64_t generation) const {
+    auto it = changed_at_.find(c);
+    return it != changed_at_.end() && it->second > generation;
+}
+
+// ----------------------------------------------------------------------------
+// Repair
+// ----------------------------------------------------------------------------
+
+size_t NavGraph::repair() {
+    if (dirty_.empty()) return 0;
+
+    std::vector<ChunkCoord> dirty(dirty_.begin(), dirty_.end());
+    std::sort(dirty.begin(), dirty.end(), before);
+    dirty_.clear();
+    ++generation_;
+
+    std::unordered_set<ChunkCoord, ChunkCoordHash> touched;
+    std::vector<ChunkCoord> rebuilt;
+
+    // All flags first: transitions read both sides of each border
+    for (ChunkCoord c : dirty) {
+        if (chunks_.find_chunk(c)) {
+            build_flags(c, navs_[c]);
+            rebuilt.push_back(c);
+            changed_at_[c] = generation_;
+        } else if (navs_.count(c)) {
+            drop_chunk(c, touched);
+            changed_at_[c] = generation_;
+        }
+    }
+    for (ChunkCoord c : rebuilt) {
+        rebuild_pairs(c, touched);
+        touched.insert(c);
+    }
+
+    std::vector<ChunkCoord> work;
+    for (ChunkCoord c : touched) {
+        if (navs_.count(c)) work.push_back(c);
+    }
+    std::sort(work.begin(), work.end(), before);
+
+    // Tables are independent per chunk; navs_ is not resized meanwhile
+    auto build = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            build_distances(work[i], navs_.find(work[i])->second);
+        }
+    };
+    if (pool_) {
+        pool_->parallel_for(work.size(), 1, build);
+    } else {
+        build(0, work.size());
+    }
+    return work.size();
+}
+
+void NavGraph::drop_chunk(ChunkCoord c, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched) {
+    for (const auto& o : NEIGHBOURS) {
+        clear_pair(pair_key(c, {c.x + o[0], c.y + o[1], c.z + o[2]}), touched);
+    }
+    navs_.erase(c);
+    touched.erase(c);
+}
+
+void NavGraph::build_flags(ChunkCoord c, ChunkNav& nav) {
+    const Chunk* chunk = chunks_.find_chunk(c);
+    const Chunk* below = chunks_.find_chunk({c.x, c.y, c.z - 1});
+
+    nav.flags.assign(VOXELS, 0);
+    for (int z = 0; z < N; ++z) {
+        for (int y = 0; y < N; ++y) {
+            for (int x = 0; x < N; ++x) {
+                size_t i = Chunk::idx(x, y, z);
+                if (!nav_passable(chunk->material[i])) continue;
+
+                bool floor = z > 0 ? nav_floor(chunk->material[Chunk::idx(x, y, z - 1)])
+                                   : below && nav_floor(below->material[Chunk::idx(x, y, N - 1)]);
+                nav.flags[i] = PASSABLE | (floor ? STANDABLE : 0);
+            }
+        }
+    }
+}
+
+void NavGraph::rebuild_pairs(ChunkCoord c, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched) {
+    for (const auto& o : NEIGHBOURS) {
+        clear_pair(pair_key(c, {c.x + o[0], c.y + o[1], c.z + o[2]}), touched);
+    }
+
+    const ChunkNav& nav = navs_.find(c)->second;
+    int ox = c.x * N, oy = c.y * N, oz = c.z * N;
+
+    // Every border crossing out of the chunk, bucketed by neighbour and move
+    struct Transition {
+        VoxelPos from, to;
+    };
+    std::vector<std::vector<Transition>> buckets(NEIGHBOUR_COUNT * 12);
+
+    for (int z = 0; z < N; ++z) {
+        for (int y = 0; y < N; ++y) {
+            bool shell = z == 0 || z == N - 1 || y == 0 || y == N - 1;
+            for (int x = 0; x < N; x += shell ? 1 : N - 1) {
+                if (!(nav.flags[Chunk::idx(x, y, z)] & STANDABLE)) continue;
+
+                VoxelPos from{ox + x, oy + y, oz + z};
+                for (int m = 0; m < 12; ++m) {
+                    VoxelPos to{from.x + MOVES[m].dx, from.y + MOVES[m].dy, from.z + MOVES[m].dz};
+                    ChunkCoord tc = chunk_of(to.x, to.y, to.z);
+                    if (tc == c || !can_move(from, to)) continue;
+                    buckets[neighbour_index(c, tc) * 12 + m].push_back({from, to});
+                }
+            }
+        }
+    }
+
+    // Contiguous runs of the same crossing become portal pairs, one per
+    // PORTAL_SPAN transitions, placed mid-span
+    std::unordered_map<uint64_t, size_t> index;
+    std::vector<uint8_t> seen;
+    std::vector<size_t> run;
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        const auto& list = buckets[b];
+        if (list.empty()) continue;
+
+        index.clear();
+        for (size_t i = 0; i < list.size(); ++i) index[pack(list[i].from)] = i;
+        seen.assign(list.size(), 0);
+
+        for (size_t first = 0; first < list.size(); ++first) {
+            if (seen[first]) continue;
+            run.clear();
+            run.push_back(first);
+            seen[first] = 1;
+            for (size_t head = 0; head < run.size(); ++head) {
+                VoxelPos p = list[run[head]].from;
+                const int steps[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0},
+                                         {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+                for (const auto& s : steps) {
+                    auto it = index.find(pack({p.x + s[0], p.y + s[1], p.z + s[2]}));
+                    if (it != index.end() && !seen[it->second]) {
+                        seen[it->second] = 1;
+                        run.push_back(it->second);
+                    }
+                }
+            }
+
+            for (size_t s = 0; s < run.size(); s += PORTAL_SPAN) {
+                size_t mid = s + (std::min(run.size(), s + PORTAL_SPAN) - s) / 2;
+                const Transition& t = list[run[mid]];
+                uint32_t a = acquire_node(t.from, touched);
+                uint32_t b2 = acquire_node(t.to, touched);
+                nodes_[a].links.push_back({b2, 1});
+                nodes_[b2].links.push_back({a, 1});
+                pairs_[pair_key(c, chunk_of(t.to.x, t.to.y, t.to.z))].push_back({a, b2});
+            }
+        }
+    }
+}
+
+void NavGraph::clear_pair(const PairKey& key, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched) {
+    auto it = pairs_.find(key);
+    if (it == pairs_.end()) return;
+
+    auto unlink = [this](uint32_t from, uint32_t to) {
+        auto& links = nodes_[from].links;
+        auto l = std::find_if(links.begin(), links.end(),
+                              [to](const Link& link) { return link.to == to; });
+        if (l != links.end()) links.erase(l);
+    };
+    for (auto [a, b] : it->second) {
+        unlink(a, b);
+        unlink(b, a);
+        release_node(a, touched);
+        release_node(b, touched);
+    }
+    pairs_.erase(it);
+}
+
+uint32_t NavGraph::acquire_node(VoxelPos pos, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched) {
+    uint64_t key = pack(pos);
+    auto it = node_at_.find(key);
+    if (it != node_at_.end()) {
+        ++nodes_[it->second].refs;
+        return it->second;
+    }
+
+    uint32_t id;
+    if (!free_nodes_.empty()) {
+        id = free_nodes_.back();
+        free_nodes_.pop_back();
+    } else {
+        id = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    Node& node = nodes_[id];
+    node.pos = pos;
+    node.chunk = chunk_of(pos.x, pos.y, pos.z);
+    node.refs = 1;
+    node.links.clear();
+    node_at_[key] = id;
+    navs_[node.chunk].portals.push_back(id);
+    touched.insert(node.chunk);
+    return id;
+}
+
+void NavGraph::release_node(uint32_t id, std::unordered_set<ChunkCoord, ChunkCoordHash>& touched) {
+    Node& node = nodes_[id];
+    if (--node.refs > 0) return;
+
+    node_at_.erase(pack(node.pos));
+    auto it = navs_.find(node.chunk);
+    if (it != navs_.end()) {
+        auto& portals = it->second.portals;
+        portals.erase(std::find(portals.begin(), portals.end(), id));
+        touched.insert(node.chunk);
+    }
+    free_nodes_.push_back(id);
+}
+
+void NavGraph::build_distances(ChunkCoord c, ChunkNav& nav) {
+    Scratch& s = scratch();
+    size_t count = nav.portals.size();
+    nav.dist.assign(count * count, UNREACHABLE);
+
+    // Each portal belongs to one chunk, so parallel builds touch disjoint nodes
+    for (size_t a = 0; a < count; ++a) {
+        nodes_[nav.portals[a]].slot = static_cast<uint32_t>(a);
+    }
+
+    for (size_t a = 0; a < count; ++a) {
+        chunk_bfs(c, nav, nodes_[nav.portals[a]].pos, nullptr, 0);
+        for (size_t b = 0; b < count; ++b) {
+            const VoxelPos& p = nodes_[nav.portals[b]].pos;
+            size_t i = Chunk::idx(p.x - c.x * N, p.y - c.y * N, p.z - c.z * N);
+            if (s.stamp[0][i] == s.epoch[0]) nav.dist[a * count + b] = s.dist[0][i];
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Search
+// ----------------------------------------------------------------------------
+
+void NavGraph::chunk_bfs(ChunkCoord c, const ChunkNav& nav, VoxelPos from,
+                         const VoxelPos* stop, int buffer) const {
+    Scratch& s = scratch();
+    uint32_t epoch = s.next_epoch(buffer);
+    auto& dist = s.dist[buffer];
+    auto& stamp = s.stamp[buffer];
+    auto& parent = s.parent[buffer];
+    const auto& flags = nav.flags;
+
+    int ox = c.x * N, oy = c.y * N, oz = c.z * N;
+    uint32_t start = static_cast<uint32_t>(Chunk::idx(from.x - ox, from.y - oy, from.z - oz));
+    uint32_t target = stop ? static_cast<uint32_t>(Chunk::idx(stop->x - ox, stop->y - oy,
+                                                              stop->z - oz))
+                           : UNREACHABLE;
+
+    s.queue.clear();
+    s.queue.push_back(start);
+    stamp[start] = epoch;
+    dist[start] = 0;
+    parent[start] = NO_MOVE;
+
+    for (size_t head = 0; head < s.queue.size(); ++head) {
+        uint32_t i = s.queue[head];
+        if (i == target) break;
+
+        int x = static_cast<int>(i % CHUNK_SIZE);
+        int y = static_cast<int>((i / CHUNK_SIZE) % CHUNK_SIZE);
+        int z = static_cast<int>(i / (CHUNK_SIZE * CHUNK_SIZE));
+
+        for (int m = 0; m < 12; ++m) {
+            int nx = x + MOVES[m].dx, ny = y + MOVES[m].dy, nz = z + MOVES[m].dz;
+            if (nx < 0 || nx >= N || ny < 0 || ny >= N || nz < 0 || nz >= N) continue;
+
+            size_t j = Chunk::idx(nx, ny, nz);
+            if (stamp[j] == epoch || !(flags[j] & STANDABLE)) continue;
+            if (MOVES[m].dz > 0 && !(flags[Chunk::idx(x, y, z + 1)] & PASSABLE)) continue;
+            if (MOVES[m].dz < 0 && !(flags[Chunk::idx(nx, ny, z)] & PASSABLE)) continue;
+
+            stamp[j] = epoch;
+            dist[j] = dist[i] + 1;
+            parent[j] = static_cast<uint8_t>(m);
+            s.queue.push_back(static_cast<uint32_t>(j));
+        }
+    }
+}
+
+bool NavGraph::trace(ChunkCoord c, VoxelPos from, VoxelPos to, int buffer,
+                     std::vector<VoxelPos>& out) const {
+    Scratch& s = scratch();
+    int ox = c.x * N, oy = c.y * N, oz = c.z * N;
+    size_t i = Chunk::idx(to.x - ox, to.y - oy, to.z - oz);
+    if (s.stamp[buffer][i] != s.epoch[buffer]) return false;
+
+    size_t first = out.size();
+    VoxelPos p = to;
+    while (!(p == from)) {
+        out.push_back(p);
+        const NavMove& m = MOVES[s.parent[buffer][Chunk::idx(p.x - ox, p.y - oy, p.z - oz)]];
+        p = {p.x - m.dx, p.y - m.dy, p.z - m.dz};
+    }
+    out.push_back(from);
+    std::reverse(out.begin() + static_cast<std::ptrdiff_t>(first), out.end());
+    return true;
+}
+
+bool NavGraph::find_path(VoxelPos start, VoxelPos goal, std::vector<VoxelPos>& out) const {
+    out.clear();
+    if (!standable(start.x, start.y, start.z) || !standable(goal.x, goal.y, goal.z)) {
+        return false;
+    }
+    if (start == goal) {
+        out.push_back(start);
+        return true;
+    }
+
+    ChunkCoord cs = chunk_of(start.x, start.y, start.z);
+    ChunkCoord cg = chunk_of(goal.x, goal.y, goal.z);
+    const ChunkNav& ns = *nav_at(cs);
+    const ChunkNav& ng = *nav_at(cg);
+    Scratch& s = scratch();
+
+    // Start side; a goal in the same chunk is usually reached directly
+    chunk_bfs(cs, ns, start, nullptr, 0);
+    if (cs == cg && trace(cs, start, goal, 0, out)) return true;
+    chunk_bfs(cg, ng, goal, nullptr, 1);
+
+    auto local_dist = [&](int buffer, ChunkCoord c, VoxelPos p) {
+        size_t i = Chunk::idx(p.x - c.x * N, p.y - c.y * N, p.z - c.z * N);
+        return s.stamp[buffer][i] == s.epoch[buffer] ? s.dist[buffer][i] : UNREACHABLE;
+    };
+
+    // A* over portals, with two virtual nodes for the endpoints
+    const uint32_t START = static_cast<uint32_t>(nodes_.size());
+    const uint32_t GOAL = START + 1;
+    uint32_t epoch = s.next_node_epoch(nodes_.size() + 2);
+
+    auto heuristic = [&](uint32_t n) -> uint32_t {
+        if (n == GOAL) return 0;
+        const VoxelPos& p = nodes_[n].pos;
+        uint32_t flat = static_cast<uint32_t>(std::abs(p.x - goal.x) + std::abs(p.y - goal.y));
+        uint32_t rise = static_cast<uint32_t>(std::abs(p.z - goal.z));
+        return std::max(flat, rise);
+    };
+
+    using Entry = std::pair<uint32_t, uint32_t>;  // f, node
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    auto relax = [&](uint32_t n, uint32_t cost, uint32_t from) {
+        if (s.node_stamp[n] == epoch && s.g[n] <= cost) return;
+        s.node_stamp[n] = epoch;
+        s.g[n] = cost;
+        s.came_from[n] = from;
+        open.push({cost + heuristic(n), n});
+    };
+
+    for (uint32_t p : ns.portals) {
+        uint32_t d = local_dist(0, cs, nodes_[p].pos);
+        if (d != UNREACHABLE) relax(p, d, START);
+    }
+
+    bool found = false;
+    while (!open.empty()) {
+        auto [f, n] = open.top();
+        open.pop();
+        if (n == GOAL) {
+            found = true;
+            break;
+        }
+        if (f != s.g[n] + heuristic(n)) continue;  // Stale entry
+
+        const Node& node = nodes_[n];
+        uint32_t g = s.g[n];
+        for (const Link& link : node.links) {
+            relax(link.to, g + link.cost, n);
+        }
+
+        const ChunkNav& nav = navs_.find(node.chunk)->second;
+        size_t count = nav.portals.size();
+        const uint32_t* row = nav.dist.data() + node.slot * count;
+        for (size_t q = 0; q < count; ++q) {
+            if (row[q] != UNREACHABLE && nav.portals[q] != n) {
+                relax(nav.portals[q], g + row[q], n);
+            }
+        }
+
+        if (node.chunk == cg) {
+            uint32_t d = local_dist(1, cg, node.pos);
+            if (d != UNREACHABLE) relax(GOAL, g + d, n);
+        }
+    }
+    if (!found) return false;
+
+    std::vector<uint32_t> hops;
+    for (uint32_t n = s.came_from[GOAL]; n != START; n = s.came_from[n]) {
+        hops.push_back(n);
+    }
+    std::reverse(hops.begin(), hops.end());
+
+    // Refine: both end segments come from the BFS trees already built
+    std::vector<VoxelPos> tail;
+    trace(cg, goal, nodes_[hops.back()].pos, 1, tail);
+    std::reverse(tail.begin(), tail.end());
+    trace(cs, start, nodes_[hops.front()].pos, 0, out);
+
+    std::vector<VoxelPos> segment;
+    for (size_t h = 1; h < hops.size(); ++h) {
+        const Node& a = nodes_[hops[h - 1]];
+        const Node& b = nodes_[hops[h]];
+        if (!(a.chunk == b.chunk)) {
+            out.push_back(b.pos);  // Single border crossing
+            continue;
+        }
+        chunk_bfs(a.chunk, navs_.find(a.chunk)->second, a.pos, &b.pos, 0);
+        segment.clear();
+        trace(a.chunk, a.pos, b.pos, 0, segment);
+        out.insert(out.end(), segment.begin() + 1, segment.end());
+    }
+    out.insert(out.end(), tail.begin() + 1, tail.end());
+    return true;
+}
+
+// ============================================================================
+// PathQueue
+// ============================================================================
+
+uint64_t PathQueue::submit(VoxelPos start, VoxelPos goal, uint64_t tag) {
+    uint64_t ticket = next_ticket_++;
+    pending_.push_back({ticket, tag, start, goal});
+    return ticket;
+}
+
+void PathQueue::update() {
+    graph_.repair();
+
+    size_t count = std::min(pending_.size(), max_batch_);
+    if (count == 0) return;
+
+    size_t base = done_.size();
+    done_.resize(base + count);
+    pool_.parallel_for(count, 4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Request& req = pending_[i];
+            PathResult& result = done_[base + i];
+            result.ticket = req.ticket;
+            result.tag = req.tag;
+            result.found = graph_.find_path(req.start, req.goal, result.path);
+        }
+    });
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(count));
+}
+
+void PathQueue::drain(std::vector<PathResult>& out) {
+    for (auto& result : done_) {
+        out.push_back(std::move(result));
+    }
+    done_.clear();
+}
+
+} // namespace world
+} // namespace isolated
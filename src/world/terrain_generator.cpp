@@ -86,6 +86,16 @@ double TerrainGenerator::fbm2d(double x, double y, int octaves, double persisten
     return total / max_value;
 }
 
+int TerrainGenerator::surface_height(int world_x, int world_y) const {
+    // Generate height using FBM noise
+    double height_noise = fbm2d(
+        world_x * config_.terrain_scale,
+        world_y * config_.terrain_scale,
+        6, 0.5
+    );
+    return static_cast<int>(config_.sea_level + height_noise * config_.height_amplitude);
+}
+
 void TerrainGenerator::generate(Chunk& chunk) {
     auto [ox, oy, oz] = chunk.world_origin();
     
@@ -93,15 +103,7 @@ void TerrainGenerator::generate(Chunk& chunk) {
         for (size_t x = 0; x < CHUNK_SIZE; ++x) {
             double world_x = ox + static_cast<double>(x);
             double world_y = oy + static_cast<double>(y);
-            
-            // Generate height using FBM noise
-            double height_noise = fbm2d(
-                world_x * config_.terrain_scale,
-                world_y * config_.terrain_scale,
-                6, 0.5
-            );
-            
-            int surface_z = static_cast<int>(config_.sea_level + height_noise * config_.height_amplitude);
+            int surface_z = surface_height(ox + static_cast<int>(x), oy + static_cast<int>(y));
             
             for (size_t z = 0; z < CHUNK_SIZE; ++z) {
                 int world_z = oz + static_cast<int>(z);
@@ -0,0 +1,172 @@
+/**
+ * @file streaming.cpp
+ * @brief Chunk-streamed geology, caverns and ore.
+ */
+
+#include <algorithm>
+#include <limits>
+
+#include <isolated/thermal/materials.hpp>
+#include <isolated/worldgen/streaming.hpp>
+
+namespace isolated {
+namespace worldgen {
+
+namespace {
+
+bool is_rock(world::Material mat) {
+  switch (mat) {
+  case world::Material::GRANITE:
+  case world::Material::BASALT:
+  case world::Material::LIMESTONE:
+  case world::Material::SANDSTONE:
+  case world::Material::SHALE:
+  case world::Material::MARBLE:
+  case world::Material::REGOLITH:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool is_solid(world::Material mat) {
+  return static_cast<uint8_t>(mat) >= static_cast<uint8_t>(world::Material::ICE);
+}
+
+} // namespace
+
+ChunkWorldGenerator::ChunkWorldGenerator(const Config &config, uint32_t seed)
+    : config_(config), geology_(0, 0, config.strata_depth, config.geology, seed),
+      caverns_(config.caverns, seed), minerals_(0, 0, 0, seed) {
+  for (size_t i = 0; i < rock_density_.size(); ++i) {
+    world::Material mat = to_material(static_cast<RockType>(i));
+    rock_density_[i] =
+        thermal::MATERIALS.at(world::material_to_string(mat)).density;
+  }
+}
+
+world::Material ChunkWorldGenerator::to_material(RockType rock) {
+  switch (rock) {
+  case RockType::REGOLITH:
+    return world::Material::REGOLITH;
+  case RockType::BASALT:
+    return world::Material::BASALT;
+  case RockType::GRANITE:
+    return world::Material::GRANITE;
+  case RockType::ICE:
+  case RockType::ORE_WATER_ICE:
+    return world::Material::ICE;
+  case RockType::ORE_IRON:
+    return world::Material::IRON_ORE;
+  case RockType::ORE_URANIUM:
+    return world::Material::URANIUM_ORE;
+  case RockType::AIR:
+  default:
+    return world::Material::AIR;
+  }
+}
+
+void ChunkWorldGenerator::generate(world::Chunk &chunk,
+                                   std::vector<MineralDeposit> *deposits) const {
+  using world::CHUNK_SIZE;
+  auto [ox, oy, oz] = chunk.world_origin();
+  const int n = static_cast<int>(CHUNK_SIZE);
+
+  // Surface height per column, and the range it spans in this chunk
+  std::vector<int> surface(CHUNK_SIZE * CHUNK_SIZE);
+  int lowest = std::numeric_limits<int>::max();
+  int highest = std::numeric_limits<int>::min();
+  for (int y = 0; y < n; ++y) {
+    for (int x = 0; x < n; ++x) {
+      int s = surface_at(ox + x, oy + y);
+      surface[x + n * y] = s;
+      lowest = std::min(lowest, s);
+      highest = std::max(highest, s);
+    }
+  }
+
+  // Entirely above the geology surface: nothing to do
+  if (highest - oz <= 0) {
+    return;
+  }
+
+  // Geology runs with z = depth below the surface. Generate the depth
+  // range any voxel of this chunk falls in; voxel (x, y, z) reads depth
+  // surface[x, y] - (oz + z) from it.
+  const int top_depth = std::max(lowest - (oz + n - 1), 1);
+  const int slab = highest - oz - top_depth + 1;
+  std::vector<RockType> rock;
+  geology_.generate_region(ox, oy, top_depth, CHUNK_SIZE, CHUNK_SIZE,
+                           static_cast<size_t>(slab), rock);
+  auto rock_at = [&](int x, int y, int depth) {
+    return rock[(static_cast<size_t>(depth - top_depth) * CHUNK_SIZE + y) *
+                    CHUNK_SIZE +
+                x];
+  };
+
+  // Strata and ore veins replace the surface pass's generic rock
+  for (int z = 0; z < n; ++z) {
+    for (int y = 0; y < n; ++y) {
+      for (int x = 0; x < n; ++x) {
+        int depth = surface[x + n * y] - (oz + z);
+        if (depth < 1)
+          continue;
+        size_t idx = world::Chunk::idx(x, y, z);
+        RockType r = rock_at(x, y, depth);
+        if (r == RockType::AIR || !is_rock(chunk.material[idx]))
+          continue;
+
+        double depth_factor = static_cast<double>(depth) / config_.strata_depth;
+        chunk.material[idx] = to_material(r);
+        chunk.density[idx] = rock_density_[static_cast<size_t>(r)];
+        chunk.strata_age[idx] =
+            depth_factor < 0.2 ? 10 : (depth_factor < 0.6 ? 500 : 4000);
+      }
+    }
+  }
+
+  // Caverns: the 3D automaton is seam-free, so carve straight from its mask
+  if (highest - oz >= config_.cave_min_depth) {
+    std::vector<uint64_t> solid;
+    caverns_.generate_region(ox, oy, oz, CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE,
+                             solid);
+    const size_t words = CavernGenerator3D::words_per_row(CHUNK_SIZE);
+
+    for (int z = 0; z < n; ++z) {
+      for (int y = 0; y < n; ++y) {
+        const uint64_t *row = &solid[(z * CHUNK_SIZE + y) * words];
+        for (int x = 0; x < n; ++x) {
+          if (surface[x + n * y] - (oz + z) < config_.cave_min_depth ||
+              ((row[x / 64] >> (x % 64)) & 1))
+            continue;
+          size_t idx = world::Chunk::idx(x, y, z);
+          if (!is_solid(chunk.material[idx]))
+            continue;
+          chunk.material[idx] = world::Material::AIR;
+          chunk.density[idx] = 1.225;
+        }
+      }
+    }
+  }
+
+  // Every ore voxel that survived cave carving is a deposit
+  if (deposits) {
+    for (int z = 0; z < n; ++z) {
+      for (int y = 0; y < n; ++y) {
+        for (int x = 0; x < n; ++x) {
+          int depth = surface[x + n * y] - (oz + z);
+          if (depth < 1)
+            continue;
+          RockType r = rock_at(x, y, depth);
+          if (r < RockType::ORE_IRON ||
+              chunk.material[world::Chunk::idx(x, y, z)] != to_material(r))
+            continue;
+          deposits->push_back(minerals_.deposit_at(ox + x, oy + y, oz + z, r));
+        }
+      }
+    }
+  }
+}
+
+} // namespace worldgen
+} // namespace isolated
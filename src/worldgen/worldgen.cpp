@@ -7,9 +7,47 @@
 #include <cmath>
 #include <isolated/worldgen/worldgen.hpp>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace isolated {
 namespace worldgen {
 
+namespace {
+
+// SplitMix64 finaliser.
+uint64_t mix64(uint64_t h) {
+  h ^= h >> 30;
+  h *= 0xBF58476D1CE4E5B9ull;
+  h ^= h >> 27;
+  h *= 0x94D049BB133111EBull;
+  h ^= h >> 31;
+  return h;
+}
+
+// Counter-based hash of a world cell. Generators that must be seekable draw
+// their randomness from this instead of a sequential RNG; `stream` separates
+// independent draws at the same cell.
+uint64_t hash_cell(uint32_t seed, int x, int y, int z, uint32_t stream) {
+  return mix64(((static_cast<uint64_t>(seed) << 32) | stream) ^
+               (static_cast<uint64_t>(static_cast<uint32_t>(x)) *
+                0x9E3779B97F4A7C15ull) ^
+               (static_cast<uint64_t>(static_cast<uint32_t>(y)) *
+                0xC2B2AE3D27D4EB4Full) ^
+               (static_cast<uint64_t>(static_cast<uint32_t>(z)) *
+                0x165667B19E3779F9ull));
+}
+
+// Uniform double in [0, 1) from the top 53 bits.
+double unit_interval(uint64_t h) { return (h >> 11) * 0x1.0p-53; }
+
+constexpr uint32_t kCaveStream = 0;
+constexpr uint32_t kOreStream = 1;
+constexpr uint32_t kDepositStream = 2;
+
+} // namespace
+
 // ============================================================================
 // NOISE GENERATOR
 // ============================================================================
@@ -136,84 +174,393 @@ double NoiseGenerator::fbm3d(double x, double y, double z, int octaves,
 GeologyGenerator::GeologyGenerator(size_t width, size_t height, size_t depth,
                                    const Config &config, uint32_t seed)
     : width_(width), height_(height), depth_(depth), config_(config),
-      noise_(seed), rng_(seed) {
+      seed_(seed), noise_(seed) {
   grid_.resize(width * height * depth, RockType::AIR);
 }
 
 void GeologyGenerator::generate() {
-  std::uniform_int_distribution<int> ore_dist(0, 99);
-
-  for (size_t z = 0; z < depth_; ++z) {
-    double depth_factor = static_cast<double>(z) / depth_;
-
-    for (size_t y = 0; y < height_; ++y) {
-      for (size_t x = 0; x < width_; ++x) {
-        // Base terrain using noise
-        double n = noise_.fbm3d(x * config_.base_layer_scale,
-                                y * config_.base_layer_scale,
-                                z * config_.base_layer_scale, 4);
-
-        // Determine rock type based on depth and noise
-        RockType type = RockType::AIR;
-
-        if (n + depth_factor > 0.3) {
-          if (depth_factor < 0.2) {
-            type = RockType::REGOLITH;
-          } else if (depth_factor < 0.6) {
-            type = RockType::BASALT;
-          } else {
-            type = RockType::GRANITE;
-          }
-
-          // Ore deposits
-          if (ore_dist(rng_) < config_.ore_frequency) {
-            double ore_n =
-                noise_.noise3d(x * config_.ore_scale, y * config_.ore_scale,
-                               z * config_.ore_scale);
-            if (ore_n > config_.ore_threshold) {
-              int ore_type = ore_dist(rng_) % 3;
-              switch (ore_type) {
-              case 0:
-                type = RockType::ORE_IRON;
-                break;
-              case 1:
-                type = RockType::ORE_URANIUM;
-                break;
-              case 2:
-                type = RockType::ORE_WATER_ICE;
-                break;
-              }
-            }
-          }
-        }
+  generate_region(0, 0, 0, width_, height_, depth_, grid_);
+}
+
+namespace {
+
+int floor_div(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
 
-        grid_[idx(x, y, z)] = type;
+double trilinear(const double (&c)[8], double fx, double fy, double fz) {
+  double x00 = c[0] + fx * (c[1] - c[0]);
+  double x10 = c[2] + fx * (c[3] - c[2]);
+  double x01 = c[4] + fx * (c[5] - c[4]);
+  double x11 = c[6] + fx * (c[7] - c[6]);
+  double y0 = x00 + fy * (x10 - x00);
+  double y1 = x01 + fy * (x11 - x01);
+  return y0 + fz * (y1 - y0);
+}
+
+} // namespace
+
+double GeologyGenerator::strata_noise_at_node(int lx, int ly, int lz) const {
+  const int s = std::max(config_.strata_lattice, 1);
+  return noise_.fbm3d(lx * s * config_.base_layer_scale,
+                      ly * s * config_.base_layer_scale,
+                      lz * s * config_.base_layer_scale, 4);
+}
+
+void GeologyGenerator::generate_region(int ox, int oy, int oz, size_t nx,
+                                       size_t ny, size_t nz,
+                                       std::vector<RockType> &out) const {
+  out.resize(nx * ny * nz);
+  if (out.empty())
+    return;
+
+  // Lattice nodes covering the box, evaluated once each
+  const int s = std::max(config_.strata_lattice, 1);
+  const int lx0 = floor_div(ox, s), ly0 = floor_div(oy, s),
+            lz0 = floor_div(oz, s);
+  const int lnx = floor_div(ox + static_cast<int>(nx) - 1, s) - lx0 + 2;
+  const int lny = floor_div(oy + static_cast<int>(ny) - 1, s) - ly0 + 2;
+  const int lnz = floor_div(oz + static_cast<int>(nz) - 1, s) - lz0 + 2;
+  std::vector<double> nodes(static_cast<size_t>(lnx) * lny * lnz);
+  for (int k = 0; k < lnz; ++k) {
+    for (int j = 0; j < lny; ++j) {
+      for (int i = 0; i < lnx; ++i) {
+        nodes[i + lnx * (j + lny * k)] =
+            strata_noise_at_node(lx0 + i, ly0 + j, lz0 + k);
       }
     }
   }
+
+  size_t idx = 0;
+  for (size_t z = 0; z < nz; ++z) {
+    const int wz = oz + static_cast<int>(z);
+    const int k = floor_div(wz, s) - lz0;
+    const double fz = static_cast<double>(wz - (lz0 + k) * s) / s;
+    for (size_t y = 0; y < ny; ++y) {
+      const int wy = oy + static_cast<int>(y);
+      const int j = floor_div(wy, s) - ly0;
+      const double fy = static_cast<double>(wy - (ly0 + j) * s) / s;
+      for (size_t x = 0; x < nx; ++x) {
+        const int wx = ox + static_cast<int>(x);
+        const int i = floor_div(wx, s) - lx0;
+        const double fx = static_cast<double>(wx - (lx0 + i) * s) / s;
+        const double *n = &nodes[i + lnx * (j + lny * k)];
+        const size_t dy = lnx, dz = static_cast<size_t>(lnx) * lny;
+        const double c[8] = {n[0],      n[1],      n[dy],      n[dy + 1],
+                             n[dz],     n[dz + 1], n[dz + dy], n[dz + dy + 1]};
+        out[idx++] = classify(wx, wy, wz, trilinear(c, fx, fy, fz));
+      }
+    }
+  }
+}
+
+RockType GeologyGenerator::sample(int x, int y, int z) const {
+  const int s = std::max(config_.strata_lattice, 1);
+  const int i = floor_div(x, s), j = floor_div(y, s), k = floor_div(z, s);
+  const double c[8] = {
+      strata_noise_at_node(i, j, k),         strata_noise_at_node(i + 1, j, k),
+      strata_noise_at_node(i, j + 1, k),     strata_noise_at_node(i + 1, j + 1, k),
+      strata_noise_at_node(i, j, k + 1),     strata_noise_at_node(i + 1, j, k + 1),
+      strata_noise_at_node(i, j + 1, k + 1), strata_noise_at_node(i + 1, j + 1, k + 1)};
+  return classify(x, y, z,
+                  trilinear(c, static_cast<double>(x - i * s) / s,
+                            static_cast<double>(y - j * s) / s,
+                            static_cast<double>(z - k * s) / s));
+}
+
+RockType GeologyGenerator::classify(int x, int y, int z,
+                                    double strata_noise) const {
+  double depth_factor = static_cast<double>(z) / depth_;
+
+  // Determine rock type based on depth and noise
+  if (strata_noise + depth_factor <= 0.3) {
+    return RockType::AIR;
+  }
+
+  RockType type;
+  if (depth_factor < 0.2) {
+    type = RockType::REGOLITH;
+  } else if (depth_factor < 0.6) {
+    type = RockType::BASALT;
+  } else {
+    type = RockType::GRANITE;
+  }
+
+  // Ore deposits
+  uint64_t h = hash_cell(seed_, x, y, z, kOreStream);
+  if (static_cast<int>(h % 100) < config_.ore_frequency) {
+    double ore_n = noise_.noise3d(x * config_.ore_scale, y * config_.ore_scale,
+                                  z * config_.ore_scale);
+    if (ore_n > config_.ore_threshold) {
+      switch ((h >> 32) % 3) {
+      case 0:
+        type = RockType::ORE_IRON;
+        break;
+      case 1:
+        type = RockType::ORE_URANIUM;
+        break;
+      case 2:
+        type = RockType::ORE_WATER_ICE;
+        break;
+      }
+    }
+  }
+
+  return type;
 }
 
 RockType GeologyGenerator::get(size_t x, size_t y, size_t z) const {
   return grid_[idx(x, y, z)];
 }
 
+// ============================================================================
+// BIT-SLICED CELLULAR AUTOMATON
+// ============================================================================
+//
+// Cells are packed 64 per word along x and every row carries one zero pad
+// word at each end, so the shifted neighbour reads of a data word never leave
+// its row. Each pass runs over the flat word array (rows, and in 3D planes,
+// back to back), which gives AVX2 long contiguous loops; results computed for
+// pad words and border cells are discarded by the interior mask.
+//
+// Neighbour counts are held bit-sliced: one word per bit of the count, so a
+// word of lanes holds 64 counts at once. Horizontal triples are summed with a
+// full adder, rows and planes with ripple-carry adders, and the birth/death
+// rule becomes a comparison of the bit-sliced count against a constant. The
+// count includes the cell itself, which turns "solid with >= d neighbours"
+// into "sum >= d + 1" and leaves "open with >= b neighbours" as "sum >= b".
+
+namespace {
+
+struct Lane64 {
+  static constexpr size_t kWords = 1;
+  uint64_t v;
+
+  static Lane64 load(const uint64_t *p) { return {*p}; }
+  void store(uint64_t *p) const { *p = v; }
+  static Lane64 zero() { return {0}; }
+  static Lane64 ones() { return {~uint64_t{0}}; }
+
+  Lane64 shl1() const { return {v << 1}; }
+  Lane64 shr1() const { return {v >> 1}; }
+  Lane64 shl63() const { return {v << 63}; }
+  Lane64 shr63() const { return {v >> 63}; }
+
+  friend Lane64 operator&(Lane64 a, Lane64 b) { return {a.v & b.v}; }
+  friend Lane64 operator|(Lane64 a, Lane64 b) { return {a.v | b.v}; }
+  friend Lane64 operator^(Lane64 a, Lane64 b) { return {a.v ^ b.v}; }
+  // ~a & b
+  friend Lane64 andnot(Lane64 a, Lane64 b) { return {~a.v & b.v}; }
+};
+
+#if defined(__AVX2__)
+struct Lane256 {
+  static constexpr size_t kWords = 4;
+  __m256i v;
+
+  static Lane256 load(const uint64_t *p) {
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p))};
+  }
+  void store(uint64_t *p) const {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+  }
+  static Lane256 zero() { return {_mm256_setzero_si256()}; }
+  static Lane256 ones() { return {_mm256_set1_epi64x(-1)}; }
+
+  Lane256 shl1() const { return {_mm256_slli_epi64(v, 1)}; }
+  Lane256 shr1() const { return {_mm256_srli_epi64(v, 1)}; }
+  Lane256 shl63() const { return {_mm256_slli_epi64(v, 63)}; }
+  Lane256 shr63() const { return {_mm256_srli_epi64(v, 63)}; }
+
+  friend Lane256 operator&(Lane256 a, Lane256 b) {
+    return {_mm256_and_si256(a.v, b.v)};
+  }
+  friend Lane256 operator|(Lane256 a, Lane256 b) {
+    return {_mm256_or_si256(a.v, b.v)};
+  }
+  friend Lane256 operator^(Lane256 a, Lane256 b) {
+    return {_mm256_xor_si256(a.v, b.v)};
+  }
+  friend Lane256 andnot(Lane256 a, Lane256 b) {
+    return {_mm256_andnot_si256(a.v, b.v)};
+  }
+};
+#endif
+
+// Run kernel over word indices [begin, end), widest lanes first.
+template <typename Kernel>
+void for_each_lane(size_t begin, size_t end, Kernel &&kernel) {
+  size_t i = begin;
+#if defined(__AVX2__)
+  for (; i + Lane256::kWords <= end; i += Lane256::kWords) {
+    kernel.template operator()<Lane256>(i);
+  }
+#endif
+  for (; i < end; ++i) {
+    kernel.template operator()<Lane64>(i);
+  }
+}
+
+template <typename L> L majority(L a, L b, L c) {
+  return (a & b) | (c & (a ^ b));
+}
+
+// Bit-sliced comparison: lanes where the N-bit count s is >= k.
+template <typename L, size_t N> L at_least(const L (&s)[N], int k) {
+  if (k <= 0)
+    return L::ones();
+  if (k >= (1 << N))
+    return L::zero();
+  L gt = L::zero();
+  L eq = L::ones();
+  for (size_t b = N; b-- > 0;) {
+    if ((k >> b) & 1) {
+      eq = eq & s[b];
+    } else {
+      gt = gt | (eq & s[b]);
+      eq = andnot(s[b], eq);
+    }
+  }
+  return gt | eq;
+}
+
+// next = rule(sum) inside the interior mask, current value elsewhere.
+template <typename L, size_t N>
+void apply_rule(const L (&sum)[N], const uint64_t *cur, const uint64_t *mask,
+                uint64_t *next, size_t i, int birth, int death) {
+  L self = L::load(cur + i);
+  L m = L::load(mask + i);
+  L rule = (self & at_least(sum, death + 1)) | andnot(self, at_least(sum, birth));
+  ((rule & m) | andnot(m, self)).store(next + i);
+}
+
+// Sum of each cell with its west and east neighbours, as 2 bit planes.
+void horizontal_sums(const uint64_t *cur, uint64_t *lo, uint64_t *hi,
+                     size_t total) {
+  for_each_lane(1, total - 1, [&]<typename L>(size_t i) {
+    L c = L::load(cur + i);
+    L w = c.shl1() | L::load(cur + i - 1).shr63();
+    L e = c.shr1() | L::load(cur + i + 1).shl63();
+    (w ^ c ^ e).store(lo + i);
+    majority(w, c, e).store(hi + i);
+  });
+}
+
+// Add the 2-bit sums at i - stride, i and i + stride into a 4-bit sum.
+template <typename L>
+void add_three_2bit(const uint64_t *lo, const uint64_t *hi, size_t i,
+                    size_t stride, L (&out)[4]) {
+  L a0 = L::load(lo + i - stride), a1 = L::load(hi + i - stride);
+  L b0 = L::load(lo + i), b1 = L::load(hi + i);
+  L c0 = L::load(lo + i + stride), c1 = L::load(hi + i + stride);
+
+  // a + b (3 bits)
+  L t0 = a0 ^ b0;
+  L k = a0 & b0;
+  L t1 = a1 ^ b1 ^ k;
+  L t2 = majority(a1, b1, k);
+
+  // + c (4 bits)
+  out[0] = t0 ^ c0;
+  k = t0 & c0;
+  out[1] = t1 ^ c1 ^ k;
+  k = majority(t1, c1, k);
+  out[2] = t2 ^ k;
+  out[3] = t2 & k;
+}
+
+void ca_step_2d(const uint64_t *cur, uint64_t *next, const uint64_t *mask,
+                uint64_t *lo, uint64_t *hi, size_t stride, size_t rows,
+                int birth, int death) {
+  if (rows < 3)
+    return;
+  const size_t total = stride * rows;
+  horizontal_sums(cur, lo, hi, total);
+  for_each_lane(stride, total - stride, [&]<typename L>(size_t i) {
+    L sum[4];
+    add_three_2bit(lo, hi, i, stride, sum);
+    apply_rule(sum, cur, mask, next, i, birth, death);
+  });
+}
+
+// q0..q3 hold the 4-bit in-plane (3x3) sums; planes are `plane` words apart.
+void ca_step_3d(const uint64_t *cur, uint64_t *next, const uint64_t *mask,
+                uint64_t *lo, uint64_t *hi, uint64_t *const q[4],
+                size_t stride, size_t rows, size_t planes, int birth,
+                int death) {
+  if (rows < 3 || planes < 3)
+    return;
+  const size_t plane = stride * rows;
+  const size_t total = plane * planes;
+  horizontal_sums(cur, lo, hi, total);
+  for_each_lane(stride, total - stride, [&]<typename L>(size_t i) {
+    L sum[4];
+    add_three_2bit(lo, hi, i, stride, sum);
+    for (size_t b = 0; b < 4; ++b)
+      sum[b].store(q[b] + i);
+  });
+  for_each_lane(plane, total - plane, [&]<typename L>(size_t i) {
+    L a[4], b[4], c[4];
+    for (size_t j = 0; j < 4; ++j) {
+      a[j] = L::load(q[j] + i - plane);
+      b[j] = L::load(q[j] + i);
+      c[j] = L::load(q[j] + i + plane);
+    }
+    // Three 4-bit sums (each <= 9) into 5 bits (<= 27)
+    L sum[5];
+    L ka = L::zero(), kb = L::zero();
+    for (size_t j = 0; j < 4; ++j) {
+      L t = a[j] ^ b[j] ^ ka;
+      ka = majority(a[j], b[j], ka);
+      sum[j] = t ^ c[j] ^ kb;
+      kb = majority(t, c[j], kb);
+    }
+    sum[4] = ka ^ kb;
+    apply_rule(sum, cur, mask, next, i, birth, death);
+  });
+}
+
+// Interior mask for a padded row of `width` cells: bits 1..width-2.
+void fill_row_mask(uint64_t *row, size_t width) {
+  for (size_t x = 1; x + 1 < width; ++x) {
+    row[1 + x / 64] |= uint64_t{1} << (x % 64);
+  }
+}
+
+} // namespace
+
 // ============================================================================
 // CAVERN GENERATOR
 // ============================================================================
 
 CavernGenerator::CavernGenerator(size_t width, size_t height,
                                  const Config &config, uint32_t seed)
-    : width_(width), height_(height), config_(config), rng_(seed) {
-  map_.resize(width * height, false);
+    : width_(width), height_(height), stride_((width + 63) / 64 + 2),
+      config_(config), rng_(seed) {
+  const size_t total = stride_ * height;
+  map_.assign(total, 0);
+  next_.assign(total, 0);
+  sum_lo_.assign(total, 0);
+  sum_hi_.assign(total, 0);
+  interior_.assign(total, 0);
+  for (size_t y = 1; y + 1 < height; ++y) {
+    fill_row_mask(&interior_[y * stride_], width);
+  }
 }
 
 void CavernGenerator::generate() {
   std::bernoulli_distribution fill_dist(config_.initial_fill);
 
-  // Initial random fill
-  for (size_t i = 0; i < map_.size(); ++i) {
-    map_[i] = fill_dist(rng_);
+  // Initial random fill (same draw order as the unpacked row-major map)
+  std::fill(map_.begin(), map_.end(), 0);
+  for (size_t y = 0; y < height_; ++y) {
+    uint64_t *row = &map_[y * stride_ + 1];
+    for (size_t x = 0; x < width_; ++x) {
+      if (fill_dist(rng_)) {
+        row[x / 64] |= uint64_t{1} << (x % 64);
+      }
+    }
   }
+  // Border cells never change, so both buffers must agree on them
+  next_ = map_;
 
   // Smooth with cellular automata
   for (int i = 0; i < config_.smoothing_iterations; ++i) {
@@ -222,52 +569,101 @@ void CavernGenerator::generate() {
 }
 
 void CavernGenerator::smooth() {
-  std::vector<bool> new_map = map_;
-
-  for (size_t y = 1; y < height_ - 1; ++y) {
-    for (size_t x = 1; x < width_ - 1; ++x) {
-      int neighbors = count_neighbors(x, y);
-      size_t i = x + width_ * y;
-
-      if (map_[i]) {
-        // Currently solid
-        new_map[i] = neighbors >= config_.death_threshold;
-      } else {
-        // Currently open
-        new_map[i] = neighbors >= config_.birth_threshold;
+  ca_step_2d(map_.data(), next_.data(), interior_.data(), sum_lo_.data(),
+             sum_hi_.data(), stride_, height_, config_.birth_threshold,
+             config_.death_threshold);
+  map_.swap(next_);
+}
+
+bool CavernGenerator::is_open(size_t x, size_t y) const {
+  return !((map_[y * stride_ + 1 + x / 64] >> (x % 64)) & 1);
+}
+
+// ============================================================================
+// 3D CAVERN GENERATOR
+// ============================================================================
+
+CavernGenerator3D::CavernGenerator3D(const Config &config, uint32_t seed)
+    : config_(config), seed_(seed) {
+  double fill = std::clamp(config.initial_fill, 0.0, 1.0);
+  // Compare the top 53 hash bits so the threshold is exact in a double
+  fill_threshold_ = static_cast<uint64_t>(std::ldexp(fill, 53));
+}
+
+bool CavernGenerator3D::initial_solid(int x, int y, int z) const {
+  return (hash_cell(seed_, x, y, z, kCaveStream) >> 11) < fill_threshold_;
+}
+
+void CavernGenerator3D::generate_region(int ox, int oy, int oz, size_t nx,
+                                        size_t ny, size_t nz,
+                                        std::vector<uint64_t> &solid) const {
+  const size_t h = halo();
+  const int hi = static_cast<int>(h);
+  const size_t rx = nx + 2 * h, ry = ny + 2 * h, rz = nz + 2 * h;
+  const size_t stride = words_per_row(rx) + 2;
+  const size_t plane = stride * ry;
+  const size_t total = plane * rz;
+
+  std::vector<uint64_t> cur(total, 0), next(total, 0), mask(total, 0);
+  std::vector<uint64_t> lo(total, 0), hi_bits(total, 0);
+  std::vector<uint64_t> q_store(4 * total, 0);
+  uint64_t *const q[4] = {&q_store[0], &q_store[total], &q_store[2 * total],
+                          &q_store[3 * total]};
+
+  for (size_t z = 0; z < rz; ++z) {
+    for (size_t y = 0; y < ry; ++y) {
+      uint64_t *row = &cur[z * plane + y * stride + 1];
+      int wy = oy - hi + static_cast<int>(y);
+      int wz = oz - hi + static_cast<int>(z);
+      for (size_t x = 0; x < rx; ++x) {
+        if (initial_solid(ox - hi + static_cast<int>(x), wy, wz)) {
+          row[x / 64] |= uint64_t{1} << (x % 64);
+        }
+      }
+      if (z > 0 && z + 1 < rz && y > 0 && y + 1 < ry) {
+        fill_row_mask(&mask[z * plane + y * stride], rx);
       }
     }
   }
+  next = cur;
 
-  map_ = std::move(new_map);
-}
+  for (size_t i = 0; i < h; ++i) {
+    ca_step_3d(cur.data(), next.data(), mask.data(), lo.data(),
+               hi_bits.data(), q, stride, ry, rz, config_.birth_threshold,
+               config_.death_threshold);
+    cur.swap(next);
+  }
 
-int CavernGenerator::count_neighbors(size_t x, size_t y) const {
-  int count = 0;
-  for (int dy = -1; dy <= 1; ++dy) {
-    for (int dx = -1; dx <= 1; ++dx) {
-      if (dx == 0 && dy == 0)
-        continue;
-      size_t nx = x + dx;
-      size_t ny = y + dy;
-      if (map_[nx + width_ * ny]) {
-        ++count;
+  // Extract the inner box, dropping the halo (bit offset h along x)
+  const size_t out_words = words_per_row(nx);
+  solid.assign(out_words * ny * nz, 0);
+  const size_t word_off = h / 64, bit_off = h % 64;
+  for (size_t z = 0; z < nz; ++z) {
+    for (size_t y = 0; y < ny; ++y) {
+      const uint64_t *src = &cur[(z + h) * plane + (y + h) * stride + 1];
+      uint64_t *dst = &solid[(z * ny + y) * out_words];
+      for (size_t w = 0; w < out_words; ++w) {
+        uint64_t v = src[w + word_off] >> bit_off;
+        if (bit_off != 0) {
+          // Reads the trailing pad word at worst, which is zero
+          v |= src[w + word_off + 1] << (64 - bit_off);
+        }
+        dst[w] = v;
+      }
+      if (nx % 64 != 0) {
+        dst[out_words - 1] &= (uint64_t{1} << (nx % 64)) - 1;
       }
     }
   }
-  return count;
-}
-
-bool CavernGenerator::is_open(size_t x, size_t y) const {
-  return !map_[x + width_ * y];
 }
 
 // ============================================================================
 // MINERAL SYSTEM
 // ============================================================================
 
-MineralSystem::MineralSystem(size_t width, size_t height, size_t depth)
-    : width_(width), height_(height), depth_(depth) {}
+MineralSystem::MineralSystem(size_t width, size_t height, size_t depth,
+                             uint32_t seed)
+    : width_(width), height_(height), depth_(depth), seed_(seed), rng_(seed) {}
 
 void MineralSystem::generate_deposits(const GeologyGenerator &geology,
                                       size_t count) {
@@ -278,6 +674,8 @@ void MineralSystem::generate_deposits(const GeologyGenerator &geology,
   std::uniform_real_distribution<double> purity_dist(0.2, 0.95);
 
   deposits_.clear();
+  handles_.clear();
+  index_.clear();
 
   for (size_t i = 0; i < count; ++i) {
     size_t x = x_dist(rng_);
@@ -289,17 +687,39 @@ void MineralSystem::generate_deposits(const GeologyGenerator &geology,
     // Only create deposits for ore types
     if (type >= RockType::ORE_IRON) {
       MineralDeposit deposit;
-      deposit.x = x;
-      deposit.y = y;
-      deposit.z = z;
+      deposit.x = static_cast<int>(x);
+      deposit.y = static_cast<int>(y);
+      deposit.z = static_cast<int>(z);
       deposit.type = type;
       deposit.quantity = quantity_dist(rng_);
       deposit.purity = purity_dist(rng_);
-      deposits_.push_back(deposit);
+      add_deposit(deposit);
     }
   }
 }
 
+size_t MineralSystem::add_deposit(const MineralDeposit &deposit) {
+  size_t i = deposits_.size();
+  deposits_.push_back(deposit);
+  handles_.push_back(
+      index_.insert(FeatureKind::MINERAL_DEPOSIT, static_cast<uint32_t>(i),
+                    FeatureBox::point(deposit.x, deposit.y, deposit.z)));
+  return i;
+}
+
+MineralDeposit MineralSystem::deposit_at(int x, int y, int z,
+                                         RockType type) const {
+  uint64_t h = hash_cell(seed_, x, y, z, kDepositStream);
+  MineralDeposit deposit;
+  deposit.x = x;
+  deposit.y = y;
+  deposit.z = z;
+  deposit.type = type;
+  deposit.quantity = 100.0 + 9900.0 * unit_interval(h);
+  deposit.purity = 0.2 + 0.75 * unit_interval(mix64(h));
+  return deposit;
+}
+
 double MineralSystem::extract(size_t deposit_idx, double amount_kg) {
   if (deposit_idx >= deposits_.size())
     return 0.0;
@@ -307,8 +727,19 @@ double MineralSystem::extract(size_t deposit_idx, double amount_kg) {
   MineralDeposit &d = deposits_[deposit_idx];
   double extracted = std::min(d.quantity, amount_kg);
   d.quantity -= extracted;
+  if (d.quantity <= 0.0) {
+    index_.remove(handles_[deposit_idx]);
+  }
   return extracted * d.purity;
 }
 
+void MineralSystem::deposits_in(const FeatureBox &box,
+                                std::vector<size_t> &out) const {
+  index_.visit(box, [&](uint32_t handle) {
+    out.push_back(index_.feature(handle).ref);
+    return true;
+  });
+}
+
 } // namespace worldgen
 } // namespace isolated
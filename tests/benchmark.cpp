@@ -6,17 +6,24 @@
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <string>
 #include <vector>
 
 // Core systems
 #include <isolated/core/constants.hpp>
+#include <isolated/fluids/breach.hpp>
 #include <isolated/fluids/lattice.hpp>
 #include <isolated/fluids/lbm_engine.hpp>
 #include <isolated/fluids/multiphase.hpp>
 #include <isolated/thermal/heat_engine.hpp>
 #include <isolated/thermal/materials.hpp>
+#include <isolated/worldgen/biomes.hpp>
 #include <isolated/worldgen/worldgen.hpp>
 
+// Entities
+#include <isolated/entities/collision_avoidance.hpp>
+#include <isolated/entities/spatial_index.hpp>
+
 // Biology systems
 #include <isolated/biology/blood_chemistry.hpp>
 #include <isolated/biology/circulation.hpp>
@@ -24,6 +31,7 @@
 #include <isolated/biology/immune.hpp>
 #include <isolated/biology/integumentary.hpp>
 #include <isolated/biology/metabolism.hpp>
+#include <isolated/biology/physiology_batch.hpp>
 #include <isolated/biology/muscular.hpp>
 #include <isolated/biology/nervous.hpp>
 #include <isolated/biology/respiration.hpp>
@@ -213,6 +221,20 @@ int main() {
     print_result(results.back());
   }
 
+  {
+    fluids::AerosolSystem::Config cfg;
+    fluids::AerosolSystem aerosol(100, 100, cfg);
+    aerosol.spawn_particles(50, 50, 1000000);
+    std::vector<double> ux(10000, 0.1);
+    std::vector<double> uy(10000, 0.05);
+    std::vector<uint8_t> solid(10000, 0);
+
+    results.push_back(
+        run_benchmark("Aerosols 1M particles", 10,
+                      [&]() { aerosol.step(dt, ux, uy, solid); }));
+    print_result(results.back());
+  }
+
   // Multiphase - Combustion
   {
     fluids::CombustionSystem::Config cfg;
@@ -227,6 +249,57 @@ int main() {
     print_result(results.back());
   }
 
+  // One small fire on a large map: cost follows the fire, not the grid
+  {
+    fluids::CombustionSystem::Config cfg;
+    fluids::CombustionSystem fire(1000, 1000, cfg);
+    for (size_t y = 495; y < 505; ++y) {
+      for (size_t x = 495; x < 505; ++x) fire.add_fuel(x, y, 10.0);
+    }
+    fire.ignite(500, 500);
+    std::vector<double> o2(1000000, 0.21);
+    std::vector<double> temp(1000000, 600.0);
+
+    results.push_back(run_benchmark("Combustion 1 fire 1000x1000", PHYSICS_ITERS,
+                                    [&]() { fire.step(dt, o2, temp); }));
+    print_result(results.back());
+  }
+
+  // A base of 64x64 rooms, doors between neighbours and a few hull breaches,
+  // stepped at 1 s (well past the explicit stability limit)
+  {
+    fluids::BreachPropagationSystem base;
+    const int w = 64;
+    auto room = [](int i) { return "room" + std::to_string(i); };
+    for (int y = 0; y < w; ++y) {
+      for (int x = 0; x < w; ++x) {
+        fluids::Compartment c;
+        c.id = room(y * w + x);
+        c.pressure = 101325.0 - (x + y) * 50.0;
+        base.add_compartment(c);
+        fluids::Breach door;
+        door.type = fluids::BreachType::DOOR;
+        door.compartment_b = c.id;
+        door.area = 1.0;
+        if (x > 0) {
+          door.id = c.id + "_w";
+          door.compartment_a = room(y * w + x - 1);
+          base.add_breach(door);
+        }
+        if (y > 0) {
+          door.id = c.id + "_n";
+          door.compartment_a = room((y - 1) * w + x);
+          base.add_breach(door);
+        }
+      }
+    }
+    for (int k = 0; k < 16; ++k) base.create_hull_breach(room(k * 257), 0.05);
+
+    results.push_back(run_benchmark("Breach network 4096 rooms", PHYSICS_ITERS / 10,
+                                    [&]() { base.step(1.0); }));
+    print_result(results.back());
+  }
+
   std::cout << "\n═══ WORLD GENERATION ═══\n";
 
   // Noise Generation
@@ -262,6 +335,34 @@ int main() {
     print_result(results.back());
   }
 
+  // Chunk-local 3D caverns (64^3 plus halo)
+  {
+    worldgen::CavernGenerator3D::Config cfg;
+    worldgen::CavernGenerator3D cavern(cfg);
+    std::vector<uint64_t> solid;
+    int chunk = 0;
+
+    results.push_back(run_benchmark("Cavern 3D 64^3 chunk", 10, [&]() {
+      cavern.generate_region(64 * chunk++, 0, 0, 64, 64, 64, solid);
+    }));
+    print_result(results.back());
+  }
+
+  // Ecosystem microhabitats: 64 chunks x 512 habitats
+  {
+    worldgen::BiomeSystem biomes;
+    for (int c = 0; c < 64; ++c) {
+      for (int h = 0; h < 64; h += 8) {
+        biomes.seed_cave_ecosystem(64 * c + h, h, h, 150.0);
+      }
+    }
+
+    results.push_back(run_benchmark("Ecosystems 32k habitats", 10, [&]() {
+      biomes.step(86400.0);
+    }));
+    print_result(results.back());
+  }
+
   // =========================================================================
   // BIOLOGY BENCHMARKS
   // =========================================================================
@@ -386,6 +487,95 @@ int main() {
     print_result(results.back());
   }
 
+  // Colony physiology: scalar per-person models vs the SoA batch
+  std::cout << "\n═══ BIOLOGY - COLONY ═══\n";
+  {
+    std::vector<biology::UnifiedPhysiologySystem> people(
+        10, biology::UnifiedPhysiologySystem(biology::UnifiedPhysiologySystem::Config{}));
+    biology::UnifiedPhysiologySystem::EnvironmentState env;
+
+    results.push_back(run_benchmark("Colony scalar x10", BIO_ITERS, [&]() {
+      for (auto &person : people) person.step(dt, env);
+    }));
+    print_result(results.back());
+  }
+  {
+    biology::PhysiologyBatch batch;
+    for (int i = 0; i < 1000; ++i) batch.add({});
+
+    results.push_back(run_benchmark("Colony batch x1000", BIO_ITERS,
+                                    [&]() { batch.step(dt); }));
+    print_result(results.back());
+  }
+  {
+    // A settled crew of 50 sleeping through the night
+    biology::PhysiologyBatch crew;
+    for (int i = 0; i < 50; ++i) crew.add({});
+    for (int n = 0; n < 3600 * 6; ++n) crew.step(1.0 / 6.0);
+
+    results.push_back(run_benchmark("Colony sleep 8h x50", 10,
+                                    [&]() { crew.fast_forward(8.0 * 3600.0); }));
+    print_result(results.back());
+  }
+
+  // =========================================================================
+  // ENTITY BENCHMARKS
+  // =========================================================================
+  std::cout << "\n═══ ENTITIES ═══\n";
+
+  // Spatial index re-index, 1% of entities crossing a cell per step
+  {
+    constexpr size_t N = 100000;
+    std::vector<float> xs(N), ys(N);
+    std::vector<int> zs(N);
+    for (size_t i = 0; i < N; ++i) {
+      xs[i] = static_cast<float>((i * 7919) % 1000) - 500.0f;
+      ys[i] = static_cast<float>((i * 104729) % 1000) - 500.0f;
+      zs[i] = static_cast<int>(i % 16) - 8;
+    }
+
+    entities::SpatialIndex index;
+    index.init();
+    size_t step = 0;
+
+    results.push_back(run_benchmark("Spatial index 100k", 100, [&]() {
+      for (size_t k = 0; k < N / 100; ++k) {
+        xs[(step * 1013 + k * 97) % N] += 4.0f;
+      }
+      ++step;
+      for (size_t i = 0; i < N; ++i) {
+        index.set_position(static_cast<entt::entity>(i), xs[i], ys[i], zs[i]);
+      }
+      index.commit();
+    }));
+    print_result(results.back());
+  }
+
+  // ORCA avoidance, two crowds meeting head-on in a 12-cell corridor
+  {
+    constexpr int N = 2000;
+    entt::registry registry;
+    entities::SpatialIndex index;
+    index.init();
+    for (int i = 0; i < N; ++i) {
+      auto e = registry.create();
+      int side = i % 2, k = i / 2;
+      float x = side ? 30.0f + (k / 17) * 0.7f : 28.0f - (k / 17) * 0.7f;
+      float y = 0.5f + (k % 17) * 0.7f;
+      registry.emplace<entities::Position>(e, x, y, 0);
+      registry.emplace<entities::Velocity>(e, 0.0f, 0.0f);
+      registry.emplace<entities::PreferredVelocity>(e, side ? -1.5f : 1.5f, 0.0f);
+      index.set_position(e, x, y, 0);
+    }
+    index.commit();
+
+    entities::CollisionAvoidance avoidance;
+    results.push_back(run_benchmark("ORCA avoidance 2k", 100, [&]() {
+      avoidance.update(registry, index, 0.01);
+    }));
+    print_result(results.back());
+  }
+
   // =========================================================================
   // SUMMARY
   // =========================================================================
@@ -406,7 +596,10 @@ int main() {
       total_physics += r.per_step_us;
     } else if (r.name.find("Perlin") == std::string::npos &&
                r.name.find("Geology") == std::string::npos &&
-               r.name.find("Cavern") == std::string::npos) {
+               r.name.find("Cavern") == std::string::npos &&
+               r.name.find("Spatial") == std::string::npos &&
+               r.name.find("Colony") == std::string::npos &&
+               r.name.find("ORCA") == std::string::npos) {
       total_bio += r.per_step_us;
     }
   }
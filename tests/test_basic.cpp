@@ -3,13 +3,49 @@
  * @brief Basic unit tests for core systems.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <filesystem>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <isolated/biology/blood_chemistry.hpp>
+#include <isolated/biology/circulation.hpp>
+#include <isolated/biology/coagulation.hpp>
+#include <isolated/biology/lymphatic.hpp>
+#include <isolated/biology/multirate.hpp>
+#include <isolated/biology/ode.hpp>
+#include <isolated/biology/respiration.hpp>
+#include <isolated/biology/sensory.hpp>
+#include <isolated/biology/telemetry.hpp>
+#include <isolated/biology/physiology_batch.hpp>
 #include <isolated/core/constants.hpp>
+#include <isolated/core/field_registry.hpp>
+#include <isolated/entities/entity_manager.hpp>
+#include <isolated/entities/needs_system.hpp>
+#include <isolated/entities/simulation_lod.hpp>
+#include <isolated/entities/spatial_index.hpp>
+#include <isolated/entities/system_scheduler.hpp>
+#include <isolated/fluids/breach.hpp>
 #include <isolated/fluids/lattice.hpp>
+#include <isolated/fluids/lbm_engine.hpp>
+#include <isolated/fluids/multiphase.hpp>
+#include <isolated/thermal/psychrometrics.hpp>
+#include <isolated/world/flow_field.hpp>
+#include <isolated/world/light_field.hpp>
+#include <isolated/world/navigation.hpp>
+#include <isolated/worldgen/biomes.hpp>
+#include <isolated/worldgen/geology_dynamics.hpp>
+#include <isolated/worldgen/hydrology.hpp>
+#include <isolated/worldgen/streaming.hpp>
+#include <isolated/worldgen/worldgen.hpp>
 
 using namespace isolated;
 
@@ -61,12 +97,1644 @@ void test_blood_chemistry() {
   std::cout << "  Blood Chemistry: PASS" << std::endl;
 }
 
+void test_biology_topology() {
+  std::cout << "Testing enum-indexed biology topology..." << std::endl;
+
+  biology::WindkesselCirculation circulation;
+  assert(circulation.vessel(biology::Vessel::AORTA).diameter_mm == 25.0);
+  assert(!circulation.vessel(biology::Vessel::FEMORAL_LEFT).is_severed);
+  assert(std::string(biology::vessel_name(biology::Vessel::FEMORAL_LEFT)) == "femoral_left");
+
+  biology::ProprioceptionSystem proprioception;
+  proprioception.apply_nerve_damage(biology::NerveRegion::LEG_LEFT, 0.5);
+  assert(proprioception.state().limb(biology::NerveRegion::LEG_LEFT) == 0.5);
+  assert(proprioception.state().limb(biology::NerveRegion::LEG_RIGHT) == 1.0);
+  assert(proprioception.state().effective_coordination() < 1.0);
+
+  biology::LymphaticSystem lymphatic;
+  lymphatic.apply_lymph_node_removal(biology::LymphRegion::ARM);
+  assert(lymphatic.state().edema(biology::LymphRegion::ARM) > 0.0);
+  assert(lymphatic.state().edema(biology::LymphRegion::LEG) == 0.0);
+  assert(lymphatic.state().lymphedema);
+
+  biology::BloodChemistrySystem chem;
+  chem.electrolytes.potassium = 2.5;
+  auto risks = chem.get_cardiac_risk_factors();
+  for (size_t i = 0; i < biology::CARDIAC_RISK_COUNT; ++i) {
+    bool hypokalemia = i == static_cast<size_t>(biology::CardiacRisk::HYPOKALEMIA);
+    assert(risks[i] == (hypokalemia ? 0.8 : 0.0));
+  }
+  assert(std::string(biology::cardiac_risk_name(biology::CardiacRisk::HYPOKALEMIA)) ==
+         "hypokalemia_risk");
+
+  std::cout << "  Biology topology: PASS" << std::endl;
+}
+
+void test_physiology_batch() {
+  std::cout << "Testing batched physiology..." << std::endl;
+
+  // Varied people and conditions: cold, exercise above the lactate
+  // threshold, blood loss in every hemorrhage class, pain
+  struct Case {
+    double mass, temp, activity, blood_loss, pain;
+  };
+  const Case cases[] = {{70.0, 20.0, 1.0, 0.0, 0.0},  {55.0, 5.0, 1.6, 0.1, 0.0},
+                        {90.0, 30.0, 2.4, 0.2, 0.5}, {70.0, -10.0, 2.0, 0.35, 0.2},
+                        {62.0, 22.0, 0.8, 0.5, 1.0}};
+
+  std::vector<biology::UnifiedPhysiologySystem> scalar;
+  biology::PhysiologyBatch batch;
+  for (const auto &c : cases) {
+    biology::UnifiedPhysiologySystem::Config cfg;
+    cfg.body_mass_kg = c.mass;
+    scalar.emplace_back(cfg);
+    size_t i = batch.add(cfg);
+
+    double volume = scalar.back().circulation().blood_volume * (1.0 - c.blood_loss);
+    scalar.back().circulation().blood_volume = volume;
+    batch.set_blood_volume(i, volume);
+    scalar.back().nervous().add_pain(c.pain);
+    batch.add_pain(i, c.pain);
+  }
+
+  auto same = [](const biology::UnifiedPhysiologySystem::PhysiologySnapshot &a,
+                 const biology::UnifiedPhysiologySystem::PhysiologySnapshot &b) {
+    return a.heart_rate == b.heart_rate && a.blood_pressure_systolic == b.blood_pressure_systolic &&
+           a.blood_pressure_diastolic == b.blood_pressure_diastolic &&
+           a.cardiac_output == b.cardiac_output && a.respiratory_rate == b.respiratory_rate &&
+           a.sao2 == b.sao2 && a.pao2 == b.pao2 && a.paco2 == b.paco2 &&
+           a.blood_glucose == b.blood_glucose && a.blood_lactate == b.blood_lactate &&
+           a.metabolic_rate == b.metabolic_rate && a.blood_ph == b.blood_ph &&
+           a.bicarbonate == b.bicarbonate && a.consciousness == b.consciousness &&
+           a.stress_level == b.stress_level && a.fatigue == b.fatigue &&
+           a.is_alive == b.is_alive && a.is_conscious == b.is_conscious &&
+           a.is_critical == b.is_critical;
+  };
+
+  // Every step must match bit for bit, including beat-long steps
+  for (int step = 0; step < 500; ++step) {
+    double dt = step % 100 == 99 ? 2.0 : 0.1;
+    std::vector<biology::UnifiedPhysiologySystem::PhysiologySnapshot> expected;
+    for (size_t i = 0; i < scalar.size(); ++i) {
+      biology::UnifiedPhysiologySystem::EnvironmentState env;
+      env.ambient_temp_c = cases[i].temp;
+      env.activity_level = cases[i].activity;
+      expected.push_back(scalar[i].step(dt, env));
+      batch.set_environment(i, env);
+    }
+    batch.step(dt);
+    for (size_t i = 0; i < scalar.size(); ++i) {
+      assert(same(batch.snapshot(i), expected[i]));
+    }
+  }
+
+  // Removal keeps the others' state
+  auto last = batch.snapshot(batch.size() - 1);
+  batch.remove(0);
+  assert(batch.size() == 4);
+  assert(same(batch.snapshot(0), last));
+
+  // Transfer (LOD tier changes) carries state to another batch
+  biology::PhysiologyBatch other;
+  auto moving = batch.snapshot(1);
+  auto tail = batch.snapshot(3);
+  size_t moved = batch.transfer(1, other);
+  assert(batch.size() == 3 && other.size() == 1 && moved == 0);
+  assert(same(other.snapshot(moved), moving));
+  assert(same(batch.snapshot(1), tail));
+
+  std::cout << "  Physiology batch: PASS" << std::endl;
+}
+
+void test_physiology_fast_forward() {
+  std::cout << "Testing physiology fast-forward..." << std::endl;
+
+  const double step = 1.0 / 6.0;
+  const double night = 8.0 * 3600.0;
+  const size_t crew = 50;
+
+  // References stepped all the way: one calm, one in pain at bedtime.
+  // Everyone first settles for an hour of the day.
+  biology::PhysiologyBatch calm, pained, batch;
+  calm.add({});
+  pained.add({});
+  for (size_t i = 0; i < crew; ++i) {
+    batch.add({});
+  }
+  for (int n = 0; n < 3600 * 6; ++n) {
+    calm.step(step);
+    pained.step(step);
+    batch.step(step);
+  }
+  pained.add_pain(0, 0.8);
+  batch.add_pain(crew - 1, 0.8);
+  for (int n = 0; n < 8 * 3600 * 6; ++n) {
+    calm.step(step);
+    pained.step(step);
+  }
+
+  auto stats = batch.fast_forward(night);
+  assert(std::fabs(stats.skipped / crew - night) < 0.1 * night);
+  assert(stats.steps < crew * static_cast<size_t>(night / step) / 20);
+
+  auto close = [&](size_t i, const biology::PhysiologyBatch &ref) {
+    auto a = batch.snapshot(i);
+    auto b = ref.snapshot(0);
+    return a.heart_rate == b.heart_rate && std::fabs(a.blood_glucose - b.blood_glucose) < 0.5 &&
+           std::fabs(a.blood_ph - b.blood_ph) < 1e-3 &&
+           std::fabs(a.bicarbonate - b.bicarbonate) < 0.1 && a.sao2 == b.sao2 &&
+           std::fabs(batch.liver_glycogen(i) - ref.liver_glycogen(0)) < 0.5;
+  };
+  assert(close(0, calm));
+  assert(close(crew - 1, pained));
+
+  // Heart rate settles instead of compounding under autonomic drive
+  assert(std::isfinite(calm.heart_rate(0)) && calm.heart_rate(0) <= 160.0);
+
+  // A stimulus falls back to regular steps until the person settles
+  biology::PhysiologyBatch quiet, hurt;
+  quiet.add({});
+  hurt.add({});
+  for (int n = 0; n < 3600 * 6; ++n) {
+    quiet.step(step);
+    hurt.step(step);
+  }
+  hurt.add_pain(0, 1.0);
+  auto quiet_stats = quiet.fast_forward(3600.0);
+  auto hurt_stats = hurt.fast_forward(3600.0);
+  assert(hurt_stats.steps > quiet_stats.steps);
+  assert(hurt_stats.skipped < quiet_stats.skipped);
+
+  std::cout << "  Physiology fast-forward: PASS (" << stats.steps / crew
+            << " steps per person for 8 h)" << std::endl;
+}
+
+void test_simulation_lod() {
+  std::cout << "Testing simulation LOD..." << std::endl;
+  using entities::SimTier;
+
+  entt::registry registry;
+  entities::SimulationLod lod;
+  auto person = [&](float x, float y, int z) {
+    auto e = registry.create();
+    registry.emplace<entities::Position>(e, x, y, z);
+    registry.emplace<entities::Needs>(e);
+    lod.add(registry, e);
+    return e;
+  };
+  auto tier = [&](entt::entity e) { return registry.get<entities::SimLod>(e).tier; };
+
+  // Camera distance: near_radius 48, one level counts as 16 cells
+  auto near = person(30.0f, 0.0f, 0);
+  auto far = person(100.0f, 0.0f, 0);
+  auto below = person(0.0f, 0.0f, -4);
+  auto picked = person(500.0f, 0.0f, 0);
+  auto hungry = person(500.0f, 10.0f, 0);
+  registry.get<entities::Needs>(hungry).hunger = 0.05f;
+  lod.assign(registry, 0.0f, 0.0f, 0, picked);
+  assert(tier(near) == SimTier::REDUCED);
+  assert(tier(far) == SimTier::COARSE);
+  assert(tier(below) == SimTier::COARSE);
+  assert(tier(picked) == SimTier::FULL);
+  assert(tier(hungry) == SimTier::FULL);  // Criticality promotes
+  assert(lod.count(SimTier::FULL) == 2 && lod.count(SimTier::REDUCED) == 1 &&
+         lod.count(SimTier::COARSE) == 2);
+  assert(registry.get<entities::SimLod>(far).period == lod.config().coarse_period);
+
+  // Hysteresis: at 52 cells the near walker stays REDUCED and the far one
+  // stays COARSE; past 56 the near one drops
+  registry.get<entities::Position>(near).x = 52.0f;
+  registry.get<entities::Position>(far).x = 52.0f;
+  lod.assign(registry, 0.0f, 0.0f, 0, picked);
+  assert(tier(near) == SimTier::REDUCED && tier(far) == SimTier::COARSE);
+  registry.get<entities::Position>(near).x = 57.0f;
+  registry.get<entities::Position>(far).x = 47.0f;
+  lod.assign(registry, 0.0f, 0.0f, 0, entt::null);
+  assert(tier(near) == SimTier::COARSE && tier(far) == SimTier::REDUCED);
+  assert(tier(picked) == SimTier::COARSE);  // No longer selected
+
+  // Moving between tiers keeps the person's physiology
+  registry.get<entities::Needs>(hungry).hunger = 1.0f;
+  auto before = lod.snapshot(registry.get<entities::PhysiologySlot>(hungry));
+  lod.assign(registry, 0.0f, 0.0f, 0, entt::null);
+  assert(tier(hungry) == SimTier::COARSE);
+  auto after = lod.snapshot(registry.get<entities::PhysiologySlot>(hungry));
+  assert(after.heart_rate == before.heart_rate && after.blood_ph == before.blood_ph);
+
+  // A healthy person idling for two hours stays well below the FULL
+  // threshold; resting drift alone must not promote
+  biology::PhysiologyBatch idle;
+  idle.add(biology::PhysiologyBatch::Config{});
+  for (int s = 0; s < 7200; ++s) idle.step(1.0);
+  auto vitals = idle.snapshot(0);
+  assert(entities::SimulationLod::criticality(nullptr, &vitals) < 0.1f);
+
+  // Needs bank dt on slower tiers and catch up in one step
+  fluids::LBMConfig lbm_cfg;
+  lbm_cfg.nx = 8;
+  lbm_cfg.ny = 8;
+  fluids::LBMEngine air(lbm_cfg);
+  air.initialize_uniform({{"O2", 0.21}});
+  entt::registry crew;
+  auto every_step = crew.create();
+  auto banked = crew.create();
+  for (auto e : {every_step, banked}) {
+    crew.emplace<entities::Position>(e, 2.0f, 2.0f, 0);
+    crew.emplace<entities::Needs>(e);
+  }
+  crew.emplace<entities::SimLod>(banked, entities::SimLod{SimTier::COARSE, 2.0f, 0.0f});
+  for (int s = 0; s < 3; ++s) entities::NeedsSystem::update(0.5, crew, air);
+  assert(crew.get<entities::Needs>(banked).thirst == 1.0f);
+  assert(crew.get<entities::Needs>(every_step).thirst < 1.0f);
+  assert(crew.get<entities::SimLod>(banked).pending_dt == 1.5f);
+  entities::NeedsSystem::update(0.5, crew, air);
+  assert(crew.get<entities::SimLod>(banked).pending_dt == 0.0f);
+  assert(std::abs(crew.get<entities::Needs>(banked).thirst -
+                  crew.get<entities::Needs>(every_step).thirst) < 1e-6f);
+
+  std::cout << "  Simulation LOD: PASS" << std::endl;
+}
+
+void test_vitals_telemetry() {
+  std::cout << "Testing vitals telemetry..." << std::endl;
+
+  // Heart rate ramps 60 -> 120 every minute, sampled at 6 Hz for 2 hours
+  biology::VitalsTelemetry telemetry;
+  int samples = 2 * 3600 * 6;
+  for (int n = 0; n <= samples; ++n) {
+    double t = n / 6.0;
+    telemetry.record(t, biology::Vital::HEART_RATE, 60.0 + std::fmod(t, 60.0));
+  }
+
+  std::vector<biology::TelemetryBin> bins(2000);
+  auto read = [&](biology::TelemetryResolution resolution) {
+    const auto &ring = telemetry.ring(biology::Vital::HEART_RATE, resolution);
+    bins.resize(2000);
+    bins.resize(ring.read(bins.data(), bins.size()));
+    return bins.size();
+  };
+
+  // Seconds: the ring keeps the newest 10 minutes
+  assert(read(biology::TelemetryResolution::SECOND) == 600);
+  assert(bins.back().index == 7199 && bins.front().index == 6600);
+  assert(bins.back().min == 119.0f && bins.back().max > 119.8f);
+
+  // Minutes and hours: every complete bin spans the whole ramp
+  assert(read(biology::TelemetryResolution::MINUTE) == 120);
+  for (const auto &bin : bins) {
+    assert(bin.min == 60.0f && bin.max > 119.8f);
+    assert(std::fabs(bin.mean - 89.92f) < 0.01f);
+  }
+  assert(read(biology::TelemetryResolution::HOUR) == 2);
+  assert(bins[0].index == 0 && bins[1].index == 1);
+
+  // A skipped night leaves a gap in the indices, not filler bins
+  telemetry.record(7200.0 + 8 * 3600.0, biology::Vital::HEART_RATE, 70.0);
+  assert(read(biology::TelemetryResolution::SECOND) == 600);
+  assert(bins.back().index == 7200);
+  telemetry.record(7201.0 + 8 * 3600.0, biology::Vital::HEART_RATE, 70.0);
+  read(biology::TelemetryResolution::SECOND);
+  assert(bins.back().index == 7200 + 8 * 3600);
+
+  // A reader racing the writer only ever sees whole, in-order bins
+  biology::TelemetryRing ring(64);
+  const uint32_t pushes = 200000;
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (uint32_t i = 0; i < pushes; ++i) {
+      float f = static_cast<float>(i);
+      ring.push({i, f, f + 1.0f, f + 0.5f});
+    }
+    done = true;
+  });
+  biology::TelemetryBin seen[64];
+  size_t reads = 0;
+  while (!done || reads == 0) {
+    size_t n = ring.read(seen, 64);
+    for (size_t j = 0; j < n; ++j) {
+      float f = static_cast<float>(seen[j].index);
+      assert(seen[j].min == f && seen[j].max == f + 1.0f && seen[j].mean == f + 0.5f);
+      assert(j == 0 || seen[j].index == seen[j - 1].index + 1);
+    }
+    ++reads;
+  }
+  writer.join();
+  assert(ring.pushed() == pushes);
+  assert(ring.read(seen, 64) == 64 && seen[63].index == pushes - 1);
+
+  std::cout << "  Vitals telemetry: PASS" << std::endl;
+}
+
+void test_multirate() {
+  std::cout << "Testing multi-rate biology scheduling..." << std::endl;
+
+  // A fast producer sampled every 0.5 s; a slow consumer every 60 s reads
+  // its mean and must see the whole interval
+  biology::MultiRateScheduler clock;
+  biology::CouplingSignal signal(0.0);
+  biology::SignalCursor cursor;
+  std::vector<double> means;
+  double slow_dt = 0.0;
+  std::vector<std::string> order;
+
+  auto fast = clock.add("fast", 0.5, [&](double) {
+    signal.publish(clock.time(), clock.time());  // Signal = t
+    if (clock.time() == 60.0) order.push_back("fast");
+  }, 30.0);
+  auto slow = clock.add("slow", 60.0, [&](double dt) {
+    slow_dt = dt;
+    means.push_back(signal.mean(cursor));
+    if (clock.time() == 60.0) order.push_back("slow");
+  }, 3600.0);
+
+  // Tick at 60 Hz for two minutes
+  for (int i = 0; i < 7200; ++i) clock.advance(1.0 / 60.0);
+  assert(std::fabs(clock.time() - 120.0) < 1e-6);
+  assert(clock.run_count(fast) == 240);
+  assert(clock.run_count(slow) == 2);
+  assert(std::fabs(slow_dt - 60.0) < 1e-6);
+  // Producers added first run first at shared times
+  assert(order.size() == 2 && order[0] == "fast" && order[1] == "slow");
+  // Mean of t over [0, 60] then [60, 120]
+  assert(std::fabs(means[0] - 30.0) < 1e-6);
+  assert(std::fabs(means[1] - 90.0) < 1e-6);
+
+  // Interpolation between samples, trend held for one interval past them
+  biology::CouplingSignal slow_signal;
+  slow_signal.publish(0.0, 10.0);
+  slow_signal.publish(60.0, 16.0);
+  assert(std::fabs(slow_signal.at(30.0) - 13.0) < 1e-12);
+  assert(std::fabs(slow_signal.at(90.0) - 19.0) < 1e-12);
+  assert(std::fabs(slow_signal.at(1000.0) - 22.0) < 1e-12);
+
+  // Fast-forwarding three days runs each subsystem at its max period
+  size_t before = clock.run_count(fast);
+  size_t runs = clock.advance(3 * 86400.0, true);
+  assert(clock.run_count(fast) - before == 3 * 86400 / 30);
+  assert(runs < 10000);
+  assert(std::fabs(slow_dt - 3600.0) < 1e-6);
+
+  // A period that never advances the clock is refused rather than hanging
+  // advance(); a negative max_period just means no faster fast-forward
+  for (double bad : {0.0, -1.0, std::nan("")}) {
+    bool threw = false;
+    try { clock.add("stuck", bad, [](double) {}); } catch (const std::invalid_argument &) { threw = true; }
+    assert(threw);
+  }
+  assert(clock.size() == 2);
+  auto capped = clock.add("capped", 10.0, [](double) {}, -5.0);
+  clock.advance(100.0, true);
+  assert(clock.run_count(capped) == 10);
+
+  std::cout << "  Multi-rate: PASS" << std::endl;
+}
+
+void test_ode_integrator() {
+  std::cout << "Testing adaptive ODE integration..." << std::endl;
+
+  // Stiff linear pair: a fast mode (rate 1000/s) slaved to a slow one
+  struct Stiff : biology::OdeSystem {
+    double y[2] = {1.0, 1.0};
+    size_t dimension() const override { return 2; }
+    void get_state(double *out) const override { out[0] = y[0]; out[1] = y[1]; }
+    void set_state(const double *in) override { y[0] = in[0]; y[1] = in[1]; }
+    void derivatives(double, const double *s, double *d) const override {
+      d[0] = -1000.0 * s[0] + s[1];
+      d[1] = -0.1 * s[1];
+    }
+    bool is_stiff(size_t i) const override { return i == 0; }
+  };
+  auto exact = [](double t) {
+    double slow = std::exp(-0.1 * t);
+    return std::pair<double, double>{(1.0 - 1.0 / 999.9) * std::exp(-1000.0 * t) +
+                                         slow / 999.9,
+                                     slow};
+  };
+
+  const biology::OdeMethod methods[] = {biology::OdeMethod::DORMAND_PRINCE,
+                                        biology::OdeMethod::ROSENBROCK,
+                                        biology::OdeMethod::IMEX};
+  size_t evaluations[3];
+  for (int m = 0; m < 3; ++m) {
+    Stiff system;
+    biology::OdeIntegrator integrator;
+    biology::OdeStats stats;
+    for (int i = 0; i < 10; ++i) {
+      auto s = integrator.integrate(system, 1.0, methods[m]);
+      assert(s.ok);
+      stats.evaluations += s.evaluations;
+    }
+    auto [y0, y1] = exact(10.0);
+    assert(std::fabs(system.y[0] - y0) < 1e-5);  // Tiny: abs_tol governs
+    assert(std::fabs(system.y[1] - y1) < 1e-3 * y1);
+    evaluations[m] = stats.evaluations;
+  }
+  // Stability, not accuracy, bounds the explicit step on the fast mode
+  assert(evaluations[1] * 10 < evaluations[0]);
+  assert(evaluations[2] * 2 < evaluations[0]);
+
+  // Gas exchange over a minute in one macro-step: one Euler step
+  // overshoots, the integrated step matches a fine Euler reference
+  biology::RespiratorySystem fine({}), coarse({}), integrated({});
+  for (auto *r : {&fine, &coarse, &integrated}) r->set_respiratory_rate(20.0);
+  for (int i = 0; i < 6000; ++i) fine.step(0.01, 150.0, 0.3);
+  coarse.step(60.0, 150.0, 0.3);
+  biology::OdeIntegrator integrator;
+  integrated.step_integrated(60.0, integrator);
+  assert(std::fabs(integrated.get_state().paco2 - fine.get_state().paco2) < 0.1);
+  assert(std::fabs(integrated.get_state().pao2 - fine.get_state().pao2) < 0.1);
+  assert(std::fabs(coarse.get_state().paco2 - fine.get_state().paco2) > 1.0);
+
+  // Likewise the coagulation cascade after an injury: thrombin and fibrin
+  // grow off factor Xa and platelets deactivate within the minute
+  biology::CoagulationSystem clot_fine, clot_coarse, clot_integrated;
+  for (auto *c : {&clot_fine, &clot_coarse, &clot_integrated}) {
+    c->activate_extrinsic_pathway(1.0);
+    c->activate_platelets(1.0);
+    c->form_clot(0, 0.5);
+  }
+  for (int i = 0; i < 6000; ++i) clot_fine.step(0.01);
+  clot_coarse.step(60.0);
+  biology::OdeIntegrator clot_integrator;
+  clot_integrated.step_integrated(60.0, clot_integrator);
+  auto relative = [](double a, double b) { return std::fabs(a - b) / std::fabs(b); };
+  const auto &reference = clot_fine.get_state();
+  const auto &state = clot_integrated.get_state();
+  assert(relative(state.factor_X.activity, reference.factor_X.activity) < 1e-3);
+  assert(relative(state.factor_II.activity, reference.factor_II.activity) < 1e-2);
+  assert(relative(state.activated_platelets, reference.activated_platelets) < 1e-2);
+  assert(relative(clot_integrated.get_clots()[0].fibrin_mass,
+                  clot_fine.get_clots()[0].fibrin_mass) < 1e-2);
+  assert(relative(clot_coarse.get_state().factor_II.activity,
+                  reference.factor_II.activity) > 1.0);
+
+  std::cout << "  ODE integrator: PASS" << std::endl;
+}
+
+void test_aerosol_particles() {
+  std::cout << "Testing aerosol particles..." << std::endl;
+
+  const size_t nx = 100, ny = 100;
+  fluids::AerosolSystem::Config cfg;
+  cfg.gravity = 0.0;
+  cfg.brownian_diffusion = 0.0;
+  cfg.max_particles = 5000;
+
+  // Linear flow: bilinear sampling must reproduce it exactly
+  std::vector<double> ux(nx * ny), uy(nx * ny);
+  for (size_t y = 0; y < ny; ++y) {
+    for (size_t x = 0; x < nx; ++x) {
+      ux[x + nx * y] = 0.01 * (x + 0.5);
+      uy[x + nx * y] = -0.02 * (y + 0.5);
+    }
+  }
+  std::vector<uint8_t> solid;
+
+  fluids::AerosolSystem aerosol(nx, ny, cfg);
+  aerosol.spawn_particles(50.0f, 40.0f, 3000);
+  const auto &p = aerosol.get_particles();
+  assert(aerosol.particle_count() == 3000);
+  std::vector<float> x0(p.x.begin(), p.x.end()), y0(p.y.begin(), p.y.end());
+  std::vector<float> vx0(p.vx.begin(), p.vx.end()), vy0(p.vy.begin(), p.vy.end());
+
+  // The step re-sorts particles by cell, so compare sorted velocities
+  std::vector<float> want_vx(3000), want_vy(3000);
+  for (size_t i = 0; i < 3000; ++i) {
+    want_vx[i] = 0.9f * vx0[i] + 0.001f * x0[i];
+    want_vy[i] = 0.9f * vy0[i] - 0.002f * y0[i];
+  }
+  aerosol.step(0.1, ux, uy, solid);
+  assert(aerosol.particle_count() == 3000);
+  std::vector<float> got_vx(p.vx.begin(), p.vx.end()), got_vy(p.vy.begin(), p.vy.end());
+  for (auto *v : {&want_vx, &want_vy, &got_vx, &got_vy}) std::sort(v->begin(), v->end());
+  for (size_t i = 0; i < 3000; ++i) {
+    assert(std::fabs(got_vx[i] - want_vx[i]) < 1e-5f);
+    assert(std::fabs(got_vy[i] - want_vy[i]) < 1e-5f);
+  }
+
+  // The cap holds, and a solid region removes what enters it
+  aerosol.spawn_particles(50.0f, 40.0f, 5000);
+  assert(aerosol.particle_count() == 5000);
+  std::vector<uint8_t> wall(nx * ny, 0);
+  for (size_t y = 0; y < ny; ++y) {
+    for (size_t x = 0; x < 50; ++x) wall[x + nx * y] = 1;
+  }
+  aerosol.step(0.1, ux, uy, wall);
+  size_t survivors = aerosol.particle_count();
+  assert(survivors > 1000 && survivors < 4000);
+  for (size_t i = 0; i < survivors; ++i) assert(p.x[i] >= 50.0f);
+
+  // Binning: particles grouped by cell, fields match a brute-force sum,
+  // and everything removed by the wall was deposited on it
+  const auto &start = aerosol.get_cell_start();
+  double total_mass = 0.0, deposited = 0.0;
+  for (size_t c = 0; c < nx * ny; ++c) {
+    double mass = 0.0, momentum = 0.0;
+    for (size_t k = start[c]; k < start[c + 1]; ++k) {
+      assert(size_t(p.x[k]) + nx * size_t(p.y[k]) == c);
+      mass += p.mass[k];
+      momentum += p.mass[k] * p.vx[k];
+    }
+    assert(std::fabs(aerosol.get_concentration()[c] - mass) < 1e-15);
+    if (mass > 0.0) assert(std::fabs(aerosol.get_velocity_x()[c] - momentum / mass) < 1e-6);
+    total_mass += mass;
+    deposited += aerosol.get_deposited()[c];
+    if (aerosol.get_deposited()[c] > 0.0) assert(wall[c]);
+  }
+  assert(start[nx * ny] == survivors);
+  assert(std::fabs(total_mass - survivors * 1e-9) < 1e-12);
+  assert(std::fabs(deposited - (5000 - survivors) * 1e-9) < 1e-12);
+
+  // Particles leaving the domain or outliving their lifetime are removed
+  aerosol.spawn_particles(0.1f, 50.0f, 100);
+  std::vector<double> west(nx * ny, -50.0), still(nx * ny, 0.0);
+  aerosol.step(1.0, west, still, solid);
+  aerosol.step(1.0, west, still, solid);
+  for (size_t i = 0; i < aerosol.particle_count(); ++i) assert(p.x[i] >= 0.0f);
+  aerosol.step(60.0, still, still, solid);
+  assert(aerosol.particle_count() == 0);
+
+  // Counter-based noise: identical seeds give identical trajectories
+  cfg.brownian_diffusion = 1e-3;
+  fluids::AerosolSystem a(nx, ny, cfg), b(nx, ny, cfg);
+  for (auto *sys : {&a, &b}) {
+    sys->spawn_particles(30.0f, 30.0f, 500, fluids::ParticleType::DUST);
+    for (int s = 0; s < 5; ++s) sys->step(0.1, ux, uy, solid);
+  }
+  assert(a.particle_count() == b.particle_count());
+  for (size_t i = 0; i < a.particle_count(); ++i) {
+    assert(a.get_particles().x[i] == b.get_particles().x[i]);
+    assert(a.get_particles().y[i] == b.get_particles().y[i]);
+  }
+
+  std::cout << "  Aerosol particles: PASS" << std::endl;
+}
+
+void test_combustion_front() {
+  std::cout << "Testing active-front combustion..." << std::endl;
+
+  const size_t nx = 200, ny = 200;
+  fluids::CombustionSystem::Config cfg;
+  fluids::CombustionSystem fire(nx, ny, cfg);
+  std::vector<double> o2(nx * ny, 0.21), temp(nx * ny, 300.0);
+  auto cell = [&](size_t x, size_t y) { return x + nx * y; };
+
+  // A strip of fuel lit at one end, and a distant cold fuel pile
+  for (size_t x = 10; x < 20; ++x) fire.add_fuel(x, 100, 0.05);
+  fire.add_fuel(150, 150, 1.0);
+  fire.ignite(10, 100);
+  fire.step(1.0, o2, temp);
+  assert(fire.get_burning_cells().size() == 1 && fire.is_burning(10, 100));
+  assert(fire.get_sources().size() == 1 && fire.get_sources()[0].cell == cell(10, 100));
+  assert(std::fabs(fire.get_sources()[0].heat - 0.01 * cfg.heat_release_rate) < 1e-6);
+
+  // The front spreads as the neighbours heat up; the pile, heated without
+  // being a candidate, stays unlit until it is made one
+  double heat = fire.get_sources()[0].heat;
+  temp[cell(150, 150)] = 600.0;
+  for (size_t x = 11; x < 20; ++x) {
+    temp[cell(x, 100)] = 600.0;
+    auto result = fire.step(1.0, o2, temp);
+    heat += result.total_heat;
+    assert(fire.is_burning(x, 100) && !fire.is_burning(x + 1, 100));
+    assert(fire.get_sources().size() == result.burning_cells);
+    assert(fire.get_burning_cells().size() <= 5);
+  }
+  assert(!fire.is_burning(150, 150));
+  fire.add_candidate(150, 150);
+  heat += fire.step(1.0, o2, temp).total_heat;
+  assert(fire.is_burning(150, 150));
+
+  // Starved of O2 a cell goes out and smoulders, however long the O2
+  // stays low, then re-ignites once it returns
+  o2[cell(150, 150)] = 0.05;
+  for (int s = 0; s < 5; ++s) {
+    heat += fire.step(1.0, o2, temp).total_heat;
+    assert(!fire.is_burning(150, 150));
+    assert(fire.get_smouldering_cells().size() == 1 &&
+           fire.get_smouldering_cells()[0] == cell(150, 150));
+  }
+  o2[cell(150, 150)] = 0.21;
+  heat += fire.step(1.0, o2, temp).total_heat;
+  assert(fire.is_burning(150, 150) && fire.get_smouldering_cells().empty());
+
+  // The strip burns out, and all burned fuel became heat
+  o2[cell(150, 150)] = 0.0;
+  for (int s = 0; s < 10; ++s) heat += fire.step(1.0, o2, temp).total_heat;
+  assert(fire.get_burning_cells().empty());
+  for (size_t x = 10; x < 20; ++x) assert(fire.get_fuel()[cell(x, 100)] < 1e-12);
+  double burned = 10 * 0.05 + 1.0 - fire.get_fuel()[cell(150, 150)];
+  assert(std::fabs(heat - burned * cfg.heat_release_rate) < 1e-3);
+
+  std::cout << "  Combustion front: PASS" << std::endl;
+}
+
+void test_psychrometrics() {
+  std::cout << "Testing psychrometrics..." << std::endl;
+
+  // Fast transcendentals hold their documented error
+  for (double x = -700.0; x <= 700.0; x += 0.37) {
+    assert(std::fabs(thermal::fast_exp(x) / std::exp(x) - 1.0) < 1e-8);
+  }
+  for (double x = 1e-12; x < 1e12; x *= 1.13) {
+    double ref = std::log(x);
+    assert(std::fabs(thermal::fast_log(x) - ref) <= 1e-9 * std::max(1.0, std::fabs(ref)));
+  }
+
+  // Magnus against reference tables: 611.2 Pa at 0 C, 2339 Pa at 20 C
+  assert(std::fabs(thermal::saturation_vapor_pressure(0.0) - 611.2) < 1.0);
+  assert(std::fabs(thermal::saturation_vapor_pressure(20.0) / 2339.0 - 1.0) < 0.005);
+  assert(std::fabs(thermal::dew_point(20.0, 1.0) - 20.0) < 1e-6);
+  assert(thermal::relative_humidity(5000.0, 20.0) == 1.0);
+
+  // Batched kernels agree with the single-value forms
+  const size_t n = 1000;
+  std::vector<double> temp(n), vapor(n), p_sat(n), rho_sat(n), rh(n), dew(n);
+  for (size_t i = 0; i < n; ++i) {
+    temp[i] = 240.0 + 0.08 * i;
+    vapor[i] = 0.001 + 1e-5 * i;
+  }
+  thermal::saturation_vapor_pressure(temp.data(), p_sat.data(), n);
+  thermal::saturation_vapor_density(temp.data(), rho_sat.data(), n);
+  thermal::relative_humidity(vapor.data(), temp.data(), rh.data(), n);
+  thermal::dew_point(vapor.data(), temp.data(), dew.data(), n);
+  for (size_t i = 0; i < n; ++i) {
+    double t_c = temp[i] - 273.15;
+    assert(std::fabs(p_sat[i] - thermal::saturation_vapor_pressure(t_c)) < 1e-9 * p_sat[i]);
+    assert(std::fabs(rho_sat[i] * 461.5 * temp[i] - p_sat[i]) < 1e-9 * p_sat[i]);
+    assert(std::fabs(rh[i] - vapor[i] / rho_sat[i]) < 1e-9 * rh[i]);
+    // At its dew point the same vapor is exactly saturated
+    double at_dew = thermal::saturation_vapor_pressure(dew[i] - 273.15) / (461.5 * temp[i]);
+    assert(std::fabs(at_dew / vapor[i] - 1.0) < 1e-7);
+  }
+
+  // Phase change: supersaturated air condenses, dry air re-evaporates it
+  fluids::PhaseChangeSystem::Config cfg;
+  fluids::PhaseChangeSystem phase(2, 1, cfg);
+  std::vector<double> t2(2, 293.15), rho_sat2(2);
+  thermal::saturation_vapor_density(t2.data(), rho_sat2.data(), 2);
+  std::vector<double> h2o = {1.2 * rho_sat2[0], 1.2 * rho_sat2[1]};
+  auto wet = phase.step(1.0, h2o, t2);
+  assert(std::fabs(wet.max_rh - 120.0) < 1e-9);
+  double expected = (1.2 - cfg.rh_threshold) * rho_sat2[0] * cfg.condensation_rate;
+  assert(std::fabs(phase.get_liquid_water()[0] - expected) < 1e-15);
+  assert(std::fabs(wet.total_condensed - 2 * expected) < 1e-15);
+
+  h2o = {0.5 * rho_sat2[0], 0.5 * rho_sat2[1]};
+  auto dry = phase.step(1.0, h2o, t2);
+  assert(dry.total_condensed == 0.0 && dry.total_evaporated > 0.0);
+  assert(phase.get_vapor_change()[0] > 0.0);
+
+  std::cout << "  Psychrometrics: PASS" << std::endl;
+}
+
+void test_field_registry() {
+  std::cout << "Testing field registry..." << std::endl;
+
+  core::FieldRegistry fields;
+  std::vector<double> temperature(4, 293.0);
+  auto t_id = fields.publish("temperature", temperature);
+  assert(fields.find("temperature") == t_id);
+
+  // Views alias the producer's buffer: writes show up without a copy
+  auto writable = fields.view<double>(t_id);
+  writable[2] = 300.0;
+  assert(temperature[2] == 300.0);
+  assert(fields.view<const double>("temperature").data == temperature.data());
+
+  // Strided views: every other value of an interleaved buffer
+  std::vector<double> pairs = {1.0, -1.0, 2.0, -2.0, 3.0, -3.0};
+  auto p_id = fields.publish("pairs.even", core::FieldView<const double>(pairs.data(), 3, 2));
+  auto even = fields.view<const double>(p_id);
+  assert(!even.contiguous() && even[2] == 3.0);
+
+  // Wrong type, writes to a read-only field and unknown names throw
+  bool threw = false;
+  try { fields.view<float>(t_id); } catch (const std::invalid_argument &) { threw = true; }
+  assert(threw);
+  threw = false;
+  try { fields.view<double>(p_id); } catch (const std::invalid_argument &) { threw = true; }
+  assert(threw);
+  threw = false;
+  try { fields.find("missing"); } catch (const std::out_of_range &) { threw = true; }
+  assert(threw);
+
+  // Versions tell readers whether anything changed
+  uint64_t seen = fields.version(t_id);
+  assert(!fields.changed(t_id, seen));
+  fields.mark_written(t_id);
+  assert(fields.changed(t_id, seen) && !fields.changed(t_id, seen));
+
+  // Writers run before readers regardless of the order stages were added
+  auto v_id = fields.publish("velocity", pairs);
+  auto render = fields.add_stage("render", {t_id, v_id}, {});
+  auto heat = fields.add_stage("heat", {v_id}, {t_id});
+  auto flow = fields.add_stage("flow", {}, {v_id});
+  auto order = fields.stage_order();
+  assert((order == std::vector<core::FieldRegistry::StageId>{flow, heat, render}));
+  fields.add_stage("feedback", {t_id}, {v_id}); // velocity <-> temperature
+  threw = false;
+  try { fields.stage_order(); } catch (const std::logic_error &) { threw = true; }
+  assert(threw);
+
+  // Consumers accept strided views: phase change gathers them itself
+  fluids::PhaseChangeSystem::Config cfg;
+  fluids::PhaseChangeSystem flat(3, 1, cfg), strided(3, 1, cfg);
+  std::vector<double> t_flat = {280.0, 290.0, 300.0};
+  std::vector<double> t_mixed = {280.0, 0.0, 290.0, 0.0, 300.0, 0.0};
+  std::vector<double> h2o = {0.02, 0.02, 0.02};
+  auto a = flat.step(1.0, h2o, t_flat);
+  auto b = strided.step(1.0, h2o, core::FieldView<const double>(t_mixed.data(), 3, 2));
+  assert(a.max_rh == b.max_rh && a.total_condensed == b.total_condensed);
+
+  // The LBM publishes its macroscopic and species fields in place
+  fluids::LBMConfig lbm_cfg;
+  lbm_cfg.nx = 8;
+  lbm_cfg.ny = 8;
+  fluids::LBMEngine lbm(lbm_cfg);
+  lbm.initialize_uniform({{"O2", 0.21}});
+  core::FieldRegistry engine_fields;
+  lbm.publish_fields(engine_fields);
+  auto o2 = engine_fields.view<const double>("fluid.species.O2");
+  assert(o2.size == 64 && o2[10] == 0.21);
+  lbm.add_species_density("O2", 2, 1, 0, 0.1);
+  assert(std::fabs(o2[10] - 0.31) < 1e-12);
+  auto ux_id = engine_fields.find("fluid.ux");
+  uint64_t ux_seen = engine_fields.version(ux_id);
+  lbm.step(1.0);
+  assert(engine_fields.changed(ux_id, ux_seen));
+
+  std::cout << "  Field registry: PASS" << std::endl;
+}
+
+void test_breach_network() {
+  std::cout << "Testing breach compartment network..." << std::endl;
+  using fluids::BreachFlowCalculator;
+
+  // Orifice flow is continuous at the choke point and its derivatives match
+  // finite differences
+  const double p_up = 101325.0;
+  const double rc = fluids::breach_constants::CRITICAL_RATIO;
+  double q_choked = BreachFlowCalculator::calculate_mass_flow(p_up, rc * p_up, 293.0, 0.01, 0.65);
+  double q_sub = BreachFlowCalculator::calculate_mass_flow(p_up, (rc + 1e-6) * p_up, 293.0, 0.01, 0.65);
+  assert(std::fabs(q_sub / q_choked - 1.0) < 1e-3);
+  for (double r : {0.6, 0.8, 0.95, 0.99999}) {
+    double d_up, d_down, u, d;
+    double q = BreachFlowCalculator::orifice_flow(p_up, r * p_up, 293.0, 0.01, 0.65, d_up, d_down);
+    const double h = 1e-3;
+    double q_hi = BreachFlowCalculator::orifice_flow(p_up + h, r * p_up, 293.0, 0.01, 0.65, u, d);
+    assert(std::fabs((q_hi - q) / h - d_up) < 1e-4 * std::fabs(d_up));
+    q_hi = BreachFlowCalculator::orifice_flow(p_up, r * p_up + h, 293.0, 0.01, 0.65, u, d);
+    assert(std::fabs((q_hi - q) / h - d_down) < 1e-4 * std::fabs(d_down));
+  }
+
+  // Two rooms through a door: one huge step equalizes without overshoot
+  // and conserves mass
+  fluids::BreachPropagationSystem rooms;
+  fluids::Compartment hab;
+  hab.id = "hab";
+  hab.volume = 200.0;
+  fluids::Compartment lab = hab;
+  lab.id = "lab";
+  lab.volume = 50.0;
+  lab.pressure = 60000.0;
+  rooms.add_compartment(hab);
+  rooms.add_compartment(lab);
+  fluids::Breach door;
+  door.id = "door";
+  door.type = fluids::BreachType::DOOR;
+  door.compartment_a = "hab";
+  door.compartment_b = "lab";
+  door.area = 2.0;
+  rooms.add_breach(door);
+  double mass0 = rooms.get_compartment("hab")->mass() + rooms.get_compartment("lab")->mass();
+
+  rooms.close_door("door");
+  rooms.step(1.0);
+  assert(rooms.get_compartment("lab")->pressure == 60000.0);
+  assert(rooms.breaches()[0].mass_flow_rate == 0.0);
+
+  rooms.open_door("door");
+  rooms.step(1000.0);
+  double p_hab = rooms.get_compartment("hab")->pressure;
+  double p_lab = rooms.get_compartment("lab")->pressure;
+  double mass1 = rooms.get_compartment("hab")->mass() + rooms.get_compartment("lab")->mass();
+  assert(p_hab >= p_lab && p_hab - p_lab < 1.0);
+  assert(std::fabs(mass1 / mass0 - 1.0) < 1e-9);
+  assert(rooms.last_converged() && rooms.last_newton_iterations() < 20);
+
+  // Cut off before converging, the step says so
+  fluids::BreachPropagationSystem::Config one_iteration;
+  one_iteration.max_newton_iterations = 1;
+  fluids::BreachPropagationSystem hasty(one_iteration);
+  hasty.add_compartment(hab);
+  hasty.add_compartment(lab);
+  hasty.add_breach(door);
+  hasty.step(1000.0);
+  assert(!hasty.last_converged() && hasty.last_residual() > one_iteration.tolerance);
+
+  // Hull breach to vacuum: large steps drain monotonically, never negative
+  uint32_t hull = rooms.create_hull_breach("lab", 0.05);
+  assert(rooms.links(rooms.find_compartment("lab")).size() == 2);
+  double previous = p_lab;
+  for (int i = 0; i < 10; ++i) {
+    rooms.step(60.0);
+    double p = rooms.get_compartment("lab")->pressure;
+    assert(p > 0.0 && p < previous);
+    previous = p;
+  }
+  assert(rooms.breaches()[hull].is_choked || previous < 1000.0);
+  assert(rooms.total_leak_rate() == std::fabs(rooms.breaches()[hull].mass_flow_rate));
+
+  // Drained to the MIN_MASS floor, later steps hold it there in a couple of
+  // iterations instead of running into the iteration limit
+  for (int i = 0; i < 40; ++i) {
+    rooms.step(60.0);
+    assert(rooms.last_converged());
+  }
+  const auto *drained = rooms.get_compartment("lab");
+  assert(std::fabs(drained->mass() - fluids::breach_constants::MIN_MASS) < 1e-9);
+  rooms.step(60.0);
+  assert(rooms.last_converged() && rooms.last_newton_iterations() <= 1);
+
+  // A corridor of 2000 compartments with a breach at one end: the implicit
+  // solve converges and conserves mass apart from the leak
+  fluids::BreachPropagationSystem base;
+  const int n = 2000;
+  for (int i = 0; i < n; ++i) {
+    fluids::Compartment c;
+    c.id = "c" + std::to_string(i);
+    c.pressure = i < n / 2 ? 101325.0 : 70000.0;
+    base.add_compartment(c);
+    if (i > 0) {
+      fluids::Breach d;
+      d.id = "d" + std::to_string(i);
+      d.compartment_a = "c" + std::to_string(i - 1);
+      d.compartment_b = c.id;
+      d.area = 1.5;
+      base.add_breach(d);
+    }
+  }
+  auto total_mass = [&]() {
+    double m = 0.0;
+    for (const auto &c : base.compartments()) m += c.mass();
+    return m;
+  };
+  double before = total_mass();
+  base.step(5.0);
+  assert(std::fabs(total_mass() / before - 1.0) < 1e-9);
+  assert(base.last_converged() && base.last_newton_iterations() < 20);
+  assert(base.get_compartment("c999")->pressure < 101325.0);
+  assert(base.get_compartment("c1000")->pressure > 70000.0);
+
+  base.create_hull_breach("c0", 0.1);
+  before = total_mass();
+  base.step(5.0);
+  double leaked = base.total_leak_rate() * 5.0;
+  assert(std::fabs((before - total_mass()) / leaked - 1.0) < 1e-6);
+
+  std::cout << "  Breach network: PASS" << std::endl;
+}
+
+void test_cavern_chunks() {
+  std::cout << "Testing 3D cavern chunks..." << std::endl;
+
+  worldgen::CavernGenerator3D::Config cfg;
+  worldgen::CavernGenerator3D caverns(cfg, 7);
+
+  // Two adjacent chunks must match one region covering both
+  std::vector<uint64_t> a, b, both;
+  caverns.generate_region(0, 0, 0, 64, 16, 16, a);
+  caverns.generate_region(64, 0, 0, 64, 16, 16, b);
+  caverns.generate_region(0, 0, 0, 128, 16, 16, both);
+  for (size_t row = 0; row < 16 * 16; ++row) {
+    assert(a[row] == both[2 * row]);
+    assert(b[row] == both[2 * row + 1]);
+  }
+
+  // Streamed chunks measure depth from each column's own surface, and the
+  // default caverns leave the underground mostly rock
+  worldgen::ChunkWorldGenerator::Config world_cfg;
+  world_cfg.surface_height = [](int x, int) { return 40 + x / 4; };
+  worldgen::ChunkWorldGenerator world_gen(world_cfg, 7);
+  world::Chunk chunk(world::ChunkCoord{0, 0, 0});
+  std::fill(chunk.material.begin(), chunk.material.end(), world::Material::GRANITE);
+  world_gen.generate(chunk);
+  size_t deep = 0, deep_solid = 0;
+  for (int z = 0; z < 64; ++z) {
+    for (int y = 0; y < 64; ++y) {
+      for (int x = 0; x < 64; ++x) {
+        auto mat = chunk.material[world::Chunk::idx(x, y, z)];
+        int depth = 40 + x / 4 - z;
+        if (depth < 1) {
+          assert(mat == world::Material::GRANITE); // Above ground: untouched
+        } else if (depth < world_cfg.cave_min_depth) {
+          assert(mat != world::Material::AIR);
+        } else {
+          ++deep;
+          deep_solid += mat != world::Material::AIR;
+        }
+      }
+    }
+  }
+  assert(deep_solid > 0.75 * deep && deep_solid < deep);
+
+  std::cout << "  Cavern chunks: PASS" << std::endl;
+}
+
+void test_geology_streaming() {
+  std::cout << "Testing seekable geology..." << std::endl;
+
+  worldgen::GeologyGenerator::Config cfg;
+  worldgen::GeologyGenerator geo(32, 32, 32, cfg, 11);
+  geo.generate();
+
+  // A window generated on its own matches the full grid and point samples
+  std::vector<worldgen::RockType> window;
+  geo.generate_region(5, 9, 13, 8, 8, 8, window);
+  for (size_t z = 0; z < 8; ++z) {
+    for (size_t y = 0; y < 8; ++y) {
+      for (size_t x = 0; x < 8; ++x) {
+        auto rock = window[x + 8 * (y + 8 * z)];
+        assert(rock == geo.get(x + 5, y + 9, z + 13));
+        assert(rock == geo.sample(static_cast<int>(x) + 5,
+                                  static_cast<int>(y) + 9,
+                                  static_cast<int>(z) + 13));
+      }
+    }
+  }
+
+  std::cout << "  Geology streaming: PASS" << std::endl;
+}
+
+void test_geology_active_set() {
+  std::cout << "Testing active-set geology dynamics..." << std::endl;
+
+  worldgen::GeologyDynamicsSystem geo;
+  geo.initialize(64, 64, 64);
+  geo.step(1.0);
+  assert(geo.active_count() == 0);
+
+  // Excavation collapses the void and wakes its 26 neighbours
+  geo.excavate(32, 32, 32);
+  assert(geo.active_count() == 27);
+  geo.step(1.0);
+  std::vector<worldgen::CollapseEvent> events;
+  geo.drain_collapse_events(events);
+  assert(events.size() == 1 && events[0].z == 32);
+  assert(geo.cell(32, 32, 31).load > 0.5);
+
+  // Relaxed loads eventually leave the active set
+  for (int i = 0; i < 3000 && geo.active_count() > 0; ++i) {
+    geo.step(1.0);
+  }
+  assert(geo.active_count() == 0);
+
+  // A quake too weak to damage anything touches no cells
+  geo.trigger_earthquake(10, 10, 10, 0.5);
+  assert(geo.active_count() == 0);
+
+  std::cout << "  Geology active set: PASS" << std::endl;
+}
+
+void test_light_field() {
+  std::cout << "Testing incremental light field..." << std::endl;
+
+  world::ChunkManagerConfig cfg;
+  cfg.save_path = "./test_world_data/";
+  world::ChunkManager chunks(cfg);
+  world::LightField light(chunks);
+  chunks.get_chunk_at({0, 0, 0}); // Default terrain: air above z = 0
+
+  light.add_source(10, 10, 10, 8);
+  assert(light.level_at(10, 10, 10) == 8);
+  assert(light.level_at(13, 10, 10) == 5);
+  assert(light.level_at(12, 12, 11) == 3); // Manhattan distance 5
+
+  // A wall darkens the cells behind it, removing it relights them
+  chunks.set_material(11, 10, 10, world::Material::GRANITE);
+  assert(light.level_at(11, 10, 10) == 0);
+  assert(light.level_at(12, 10, 10) == 4); // Around the wall
+  chunks.set_material(11, 10, 10, world::Material::AIR);
+  assert(light.level_at(12, 10, 10) == 6);
+
+  light.remove_source(10, 10, 10);
+  assert(light.level_at(10, 10, 10) == 0);
+  assert(light.level_at(13, 10, 10) == 0);
+
+  // Magma glows by itself, and stops when it cools to rock
+  chunks.set_material(20, 10, 10, world::Material::MAGMA);
+  assert(light.level_at(20, 10, 10) == 12);
+  assert(light.level_at(22, 10, 10) == 10);
+  chunks.set_material(20, 10, 10, world::Material::BASALT);
+  assert(light.level_at(22, 10, 10) == 0);
+
+  // Glow regions and glowing habitats are light sources while they glow
+  worldgen::BiomeSystem biomes;
+  biomes.set_light_field(&light);
+  worldgen::BioluminescentRegion glow{30, 30, 30};
+  glow.intensity = 50.0;
+  biomes.add_bioluminescent_region(glow);
+  assert(light.level_at(30, 30, 30) == 10);
+  assert(light.level_at(31, 30, 30) == 9);
+  biomes.seed_cave_ecosystem(41, 41, 41, 200.0); // Glowing fungus
+  const uint8_t habitat_level = light.level_for_lux(biomes.get_ecosystem(41, 41, 41).bioluminescence);
+  assert(habitat_level > 0 && light.level_at(44, 44, 44) == habitat_level);
+  biomes.add_ecosystem(41, 41, 41, worldgen::Ecosystem{}); // Died out
+  assert(light.level_at(44, 44, 44) == 0);
+  assert(light.source_count() == 1);
+  biomes.set_light_field(nullptr);
+  assert(light.level_at(31, 30, 30) == 0 && light.source_count() == 0);
+
+  // Unloading a chunk drops it from the lookup cache; reloading relights it
+  // from its glowing voxels and sources
+  world::ChunkManagerConfig stream_cfg;
+  stream_cfg.load_radius = 0;
+  stream_cfg.unload_radius = 0;
+  stream_cfg.save_path = "./test_light_data/";
+  world::ChunkManager streamed(stream_cfg);
+  world::LightField streamed_light(streamed);
+  streamed.get_chunk_at({0, 0, 0});
+  streamed.set_material(20, 10, 10, world::Material::MAGMA);
+  streamed_light.add_source(5, 5, 5, 8);
+  assert(streamed_light.level_at(5, 5, 5) == 8);
+  streamed.update(5 * 64.0f, 0.0f, 0.0f);
+  assert(!streamed.find_chunk({0, 0, 0}));
+  assert(streamed_light.level_at(5, 5, 5) == 0);
+  streamed.get_chunk_at({0, 0, 0});
+  assert(streamed_light.level_at(5, 5, 5) == 8);
+  assert(streamed_light.level_at(20, 10, 10) == 12);
+  std::filesystem::remove_all(stream_cfg.save_path);
+
+  std::cout << "  Light field: PASS" << std::endl;
+}
+
+void test_feature_index() {
+  std::cout << "Testing feature spatial index..." << std::endl;
+
+  // A fossil straddling a chunk boundary is found from both sides, once
+  worldgen::BiomeSystem biomes;
+  worldgen::FossilDeposit fossil;
+  fossil.x = 63;
+  fossil.y = 10;
+  fossil.z = 10;
+  fossil.extent = 3;
+  biomes.add_fossil_deposit(fossil);
+  assert(biomes.get_fossil_at(61, 10, 10) != nullptr);
+  assert(biomes.get_fossil_at(66, 12, 8) != nullptr);
+  assert(biomes.get_fossil_at(67, 10, 10) == nullptr);
+
+  std::vector<size_t> found;
+  biomes.fossils_in({0, 0, 0, 127, 63, 63}, found);
+  assert(found.size() == 1);
+
+  biomes.extract_fossil(0);
+  assert(biomes.get_fossil_at(63, 10, 10) == nullptr);
+
+  // Mined-out deposits leave the index
+  worldgen::MineralSystem minerals(64, 64, 64);
+  minerals.add_deposit({5, 5, 5, worldgen::RockType::ORE_IRON, 100.0, 0.5});
+  minerals.add_deposit({200, 5, 5, worldgen::RockType::ORE_IRON, 100.0, 0.5});
+  std::vector<size_t> near;
+  minerals.deposits_in({0, 0, 0, 63, 63, 63}, near);
+  assert(near.size() == 1 && near[0] == 0);
+  minerals.extract(0, 1000.0);
+  near.clear();
+  minerals.deposits_in({0, 0, 0, 63, 63, 63}, near);
+  assert(near.empty());
+
+  std::cout << "  Feature index: PASS" << std::endl;
+}
+
+void test_flood_grid() {
+  std::cout << "Testing shallow-water flooding..." << std::endl;
+
+  worldgen::FloodGrid::Config cfg;
+
+  // Well balanced: still water over an uneven floor stays still
+  worldgen::FloodGrid lake;
+  lake.initialize(32, 32, cfg);
+  for (size_t y = 0; y < 32; ++y) {
+    for (size_t x = 0; x < 32; ++x) {
+      double bed = 0.2 * std::sin(0.4 * x) * std::cos(0.3 * y);
+      lake.set_bed(x, y, bed);
+      lake.add_water(x, y, 0.5 - bed);
+    }
+  }
+  lake.step(5.0);
+  assert(std::abs(lake.surface(7, 19) - 0.5) < 1e-9);
+
+  // Dam break conserves water and leaves distant dry cells untouched
+  worldgen::FloodGrid dam;
+  dam.initialize(256, 256, cfg);
+  dam.add_water(20, 20, 10.0);
+  dam.step(10.0);
+  assert(std::abs(dam.total_volume() - 10.0) < 1e-9);
+  assert(dam.depth(21, 20) > 0.0);
+  assert(dam.active_cells() < 1000);
+
+  // Flood water seeps into the floor at the hydrology drainage rate
+  worldgen::HydrologySystem hydro;
+  hydro.initialize_flooding(8, 8, cfg);
+  for (size_t y = 0; y < 8; ++y) {
+    for (size_t x = 0; x < 8; ++x) {
+      hydro.flooding().add_water(x, y, 0.5);
+    }
+  }
+  hydro.step(10.0);
+  double seeped = 32.0 * std::exp(-0.01 * 10.0);
+  assert(std::abs(hydro.flooding().total_volume() - seeped) < 0.1);
+  assert(std::abs(hydro.flooding().depth(0, 0) - hydro.flooding().depth(4, 5)) <
+         1e-12);
+
+  std::cout << "  Flood grid: PASS" << std::endl;
+}
+
+void test_ecosystem_grid() {
+  std::cout << "Testing ecosystem microhabitats..." << std::endl;
+
+  worldgen::BiomeSystem biomes;
+  biomes.seed_cave_ecosystem(4, 4, 4, 150.0);
+  biomes.seed_cave_ecosystem(100, 4, 4, 50.0);
+  assert(biomes.habitats().block_count() == 2);
+  assert(biomes.get_ecosystem(4, 4, 4).bioluminescence > 0.0);
+  assert(biomes.get_ecosystem(100, 4, 4).bioluminescence == 0.0);
+
+  // Overcrowded bacteria die back below their seeded population
+  for (int day = 0; day < 5; ++day) {
+    biomes.step(86400.0);
+  }
+  auto eco = biomes.get_ecosystem(4, 4, 4);
+  assert(eco.total_population() < 1e6);
+  assert(biomes.get_ecosystem(20, 4, 4).organisms.empty()); // Next habitat
+
+  // Temperature comes from the chunk's physics fields (Kelvin)
+  world::Chunk chunk({0, 0, 0});
+  std::fill(chunk.temperature.begin(), chunk.temperature.end(), 283.15);
+  biomes.sample_environment(chunk);
+  assert(std::abs(biomes.get_ecosystem(4, 4, 4).temperature - 10.0) < 1e-9);
+
+  std::cout << "  Ecosystem grid: PASS" << std::endl;
+}
+
+void test_spatial_index() {
+  std::cout << "Testing entity spatial index..." << std::endl;
+
+  entt::registry registry;
+  entities::SpatialIndex index;
+  index.init();
+
+  // Entities scattered around a chunk corner, straddling cell (4 voxel) and
+  // chunk (64 voxel) boundaries, including negative coordinates
+  struct Placed {
+    entt::entity entity;
+    float x, y;
+    int z;
+    bool removed = false;
+  };
+  std::vector<Placed> placed;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> coord(50.0f, 78.0f);
+  std::uniform_int_distribution<int> level(-2, 1);
+  for (int i = 0; i < 400; ++i) {
+    placed.push_back({registry.create(), coord(rng), coord(rng) - 64.0f, level(rng), false});
+  }
+  for (const auto &p : placed) index.set_position(p.entity, p.x, p.y, p.z);
+  index.commit();
+  assert(index.size() == placed.size());
+
+  // Box query plus exact distance filter, as EntityManager does, against
+  // brute force
+  auto check = [&](float cx, float cy, int cz, float radius) {
+    std::vector<entt::entity> found;
+    index.query_range(static_cast<int>(std::floor(cx - radius)),
+                      static_cast<int>(std::floor(cy - radius)), cz,
+                      static_cast<int>(std::floor(cx + radius)),
+                      static_cast<int>(std::floor(cy + radius)), cz, found);
+    std::vector<entt::entity> within;
+    for (entt::entity e : found) {
+      for (const auto &p : placed) {
+        if (p.entity != e) continue;
+        assert(!p.removed);
+        float dx = p.x - cx, dy = p.y - cy;
+        if (p.z == cz && dx * dx + dy * dy <= radius * radius) {
+          within.push_back(e);
+        }
+      }
+    }
+    std::vector<entt::entity> expected;
+    for (const auto &p : placed) {
+      float dx = p.x - cx, dy = p.y - cy;
+      if (!p.removed && p.z == cz && dx * dx + dy * dy <= radius * radius) {
+        expected.push_back(p.entity);
+      }
+    }
+    auto by_id = [](entt::entity a, entt::entity b) {
+      return entt::to_integral(a) < entt::to_integral(b);
+    };
+    std::sort(within.begin(), within.end(), by_id);
+    std::sort(expected.begin(), expected.end(), by_id);
+    assert(within == expected);
+    return expected.size();
+  };
+  size_t hits = 0;
+  hits += check(64.0f, 0.0f, 0, 5.0f);   // Chunk corner, across x, y = 0
+  hits += check(63.9f, -0.1f, -1, 3.5f); // Negative side of both seams
+  hits += check(60.0f, -4.0f, 1, 2.0f);  // Centred on a cell corner
+  hits += check(70.3f, 9.7f, -2, 8.0f);
+  assert(hits > 0);
+
+  // Moves across the chunk seam and removals show after commit()
+  for (size_t i = 0; i < placed.size(); i += 3) {
+    placed[i].x = 128.0f - placed[i].x;
+    index.set_position(placed[i].entity, placed[i].x, placed[i].y, placed[i].z);
+  }
+  for (size_t i = 1; i < placed.size(); i += 5) {
+    index.remove(placed[i].entity);
+    placed[i].removed = true;
+  }
+  index.commit();
+  assert(index.size() == placed.size() - (placed.size() + 3) / 5);
+  check(64.0f, 0.0f, 0, 5.0f);
+  check(63.9f, -0.1f, -1, 3.5f);
+  check(66.0f, 2.0f, 1, 12.0f);
+
+  std::cout << "  Spatial index: PASS" << std::endl;
+}
+
+void test_navigation() {
+  std::cout << "Testing HPA* navigation..." << std::endl;
+
+  // Floor at z = 0 across two chunks, split by a wall at x = 64 with a
+  // doorway at y = 40
+  world::ChunkManagerConfig cfg;
+  cfg.save_path = "./test_world_data/";
+  world::ChunkManager chunks(cfg);
+  chunks.set_terrain_generator([](world::Chunk &chunk) {
+    auto [ox, oy, oz] = chunk.world_origin();
+    for (int z = 0; z < 64; ++z) {
+      for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 64; ++x) {
+          int wx = ox + x, wy = oy + y, wz = oz + z;
+          bool solid = wz == 0 || (wx == 64 && wz <= 3 && wy != 40);
+          chunk.material[world::Chunk::idx(x, y, z)] =
+              solid ? world::Material::GRANITE : world::Material::AIR;
+        }
+      }
+    }
+  });
+
+  core::TaskPool pool(1);
+  world::NavGraph nav(chunks, &pool);
+  chunks.get_chunk_at({0, 0, 0});
+  chunks.get_chunk_at({1, 0, 0});
+  nav.repair();
+  assert(nav.standable(10, 10, 1));
+  assert(!nav.standable(10, 10, 2)); // No floor under it
+
+  // Through the doorway: 60 steps east, 30 north, then back south 30
+  std::vector<world::VoxelPos> path;
+  assert(nav.find_path({10, 10, 1}, {70, 10, 1}, path));
+  assert(path.front() == (world::VoxelPos{10, 10, 1}));
+  assert(path.back() == (world::VoxelPos{70, 10, 1}));
+  assert(path.size() == 121);
+  for (size_t i = 1; i < path.size(); ++i) {
+    assert(std::abs(path[i].x - path[i - 1].x) + std::abs(path[i].y - path[i - 1].y) == 1);
+  }
+
+  // Walling up the doorway repairs both chunks and cuts the route
+  for (int z = 1; z <= 3; ++z) {
+    chunks.set_material(64, 40, z, world::Material::GRANITE);
+  }
+  assert(nav.dirty_count() > 0);
+  nav.repair();
+  assert(!nav.find_path({10, 10, 1}, {70, 10, 1}, path));
+
+  // A step up onto a block and down again
+  chunks.set_material(64, 40, 1, world::Material::AIR);
+  chunks.set_material(64, 40, 2, world::Material::AIR);
+  chunks.set_material(64, 40, 3, world::Material::AIR);
+  chunks.set_material(63, 41, 1, world::Material::BASALT);
+  world::PathQueue queue(nav, pool);
+  uint64_t ticket = queue.submit({63, 45, 1}, {63, 41, 2}, 7);
+  queue.update();
+  std::vector<world::PathResult> results;
+  queue.drain(results);
+  assert(results.size() == 1 && results[0].ticket == ticket && results[0].tag == 7);
+  assert(results[0].found && results[0].path.size() == 5);
+
+  std::cout << "  Navigation: PASS" << std::endl;
+}
+
+void test_flow_fields() {
+  std::cout << "Testing flow fields..." << std::endl;
+
+  // Same layout as the navigation test: a wall at x = 64, doorway at y = 40
+  world::ChunkManagerConfig cfg;
+  cfg.save_path = "./test_world_data/";
+  world::ChunkManager chunks(cfg);
+  chunks.set_terrain_generator([](world::Chunk &chunk) {
+    auto [ox, oy, oz] = chunk.world_origin();
+    for (int z = 0; z < 64; ++z) {
+      for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 64; ++x) {
+          int wx = ox + x, wy = oy + y, wz = oz + z;
+          bool solid = wz == 0 || (wx == 64 && wz <= 3 && wy != 40);
+          chunk.material[world::Chunk::idx(x, y, z)] =
+              solid ? world::Material::GRANITE : world::Material::AIR;
+        }
+      }
+    }
+  });
+
+  world::NavGraph nav(chunks);
+  world::FlowFieldCache fields(nav);
+  chunks.get_chunk_at({0, 0, 0});
+  chunks.get_chunk_at({1, 0, 0});
+
+  // Walkers heading to the same goal share one field
+  world::VoxelPos goal{70, 10, 1};
+  auto a = fields.acquire(goal);
+  auto b = fields.acquire(goal);
+  assert(a == b && fields.field_count() == 1);
+  assert(!fields.ready(a));
+  assert(fields.update() == 1);
+  assert(fields.ready(a));
+  assert(fields.update() == 0);  // Nothing changed
+
+  // Following the field is a shortest route: matches the HPA* length
+  std::vector<world::VoxelPos> path;
+  const world::VoxelPos starts[] = {{10, 10, 1}, {5, 60, 1}, {63, 40, 1}};
+  for (const auto &start : starts) {
+    assert(nav.find_path(start, goal, path));
+    world::VoxelPos p = start, next{};
+    size_t steps = 0;
+    while (fields.next_step(a, p, next)) {
+      assert(nav.can_move(p, next));
+      p = next;
+      ++steps;
+    }
+    assert(p == goal);
+    assert(steps + 1 <= path.size());
+  }
+
+  // Closing the doorway rebuilds the field; the west side loses its route
+  for (int z = 1; z <= 3; ++z) {
+    chunks.set_material(64, 40, z, world::Material::GRANITE);
+  }
+  assert(fields.update() == 1);
+  world::VoxelPos next{};
+  assert(!fields.next_step(a, {10, 10, 1}, next));
+  assert(fields.next_step(a, {100, 10, 1}, next));
+
+  // Unreferenced fields are evicted once their terrain changes
+  fields.release(a);
+  fields.release(b);
+  assert(fields.field_count() == 1);
+  chunks.set_material(64, 40, 3, world::Material::AIR);
+  fields.update();
+  assert(fields.field_count() == 0);
+
+  std::cout << "  Flow fields: PASS" << std::endl;
+}
+
+void test_entity_paths() {
+  std::cout << "Testing entity path following..." << std::endl;
+
+  // Open floor at z = 0
+  world::ChunkManagerConfig cfg;
+  cfg.save_path = "./test_world_data/";
+  world::ChunkManager chunks(cfg);
+  chunks.set_terrain_generator([](world::Chunk &chunk) {
+    auto [ox, oy, oz] = chunk.world_origin();
+    for (int z = 0; z < 64; ++z) {
+      for (int i = 0; i < 64 * 64; ++i) {
+        chunk.material[world::Chunk::idx(i % 64, i / 64, z)] =
+            oz + z == 0 ? world::Material::GRANITE : world::Material::AIR;
+      }
+    }
+  });
+  core::TaskPool pool(1);
+  world::NavGraph nav(chunks, &pool);
+  chunks.get_chunk_at({0, 0, 0});
+  nav.repair();
+  world::PathQueue queue(nav, pool);
+  world::FlowFieldCache fields(nav);
+
+  entities::EntityManager em;
+  em.init();
+  em.set_path_queue(&queue);
+  em.set_flow_fields(&fields);
+  auto &registry = em.registry();
+  auto walker = em.spawn_astronaut(10.5f, 10.5f, 1);
+
+  auto speed = [&] {
+    const auto &vel = registry.get<entities::Velocity>(walker);
+    const auto &pref = registry.get<entities::PreferredVelocity>(walker);
+    return std::abs(vel.dx) + std::abs(vel.dy) + std::abs(pref.dx) + std::abs(pref.dy);
+  };
+
+  // Leaving a flow field for a path that cannot be found: stand still
+  assert(em.request_flow(walker, 40, 10, 1));
+  fields.update();
+  for (int i = 0; i < 5; ++i) em.update(0.1);
+  assert(speed() > 0.0f);
+  assert(em.request_path(walker, 20, 20, 5));  // Mid-air, not standable
+  assert(speed() == 0.0f);
+  auto held = registry.get<entities::Position>(walker);
+  for (int i = 0; i < 3; ++i) {
+    queue.update();
+    em.update(0.1);
+  }
+  assert(speed() == 0.0f);
+  assert(registry.get<entities::Position>(walker).x == held.x);
+
+  // A failed request also drops the path being walked
+  assert(em.request_path(walker, 20, 10, 1));
+  queue.update();
+  for (int i = 0; i < 5; ++i) em.update(0.1);
+  assert(registry.all_of<entities::Path>(walker) && speed() > 0.0f);
+  assert(em.request_path(walker, 20, 20, 5));
+  queue.update();
+  em.update(0.1);
+  assert(!registry.all_of<entities::Path>(walker));
+  assert(speed() == 0.0f);
+
+  std::cout << "  Entity paths: PASS" << std::endl;
+}
+
+void test_crowd_avoidance() {
+  std::cout << "Testing crowd avoidance..." << std::endl;
+
+  // A corridor two voxels wide (y = 20, 21) between walls, floor at z = 0
+  world::ChunkManagerConfig cfg;
+  cfg.save_path = "./test_world_data/";
+  world::ChunkManager chunks(cfg);
+  chunks.set_terrain_generator([](world::Chunk &chunk) {
+    auto [ox, oy, oz] = chunk.world_origin();
+    for (int z = 0; z < 64; ++z) {
+      for (int y = 0; y < 64; ++y) {
+        for (int x = 0; x < 64; ++x) {
+          int wy = oy + y, wz = oz + z;
+          bool solid = wz == 0 || (wz <= 3 && (wy < 20 || wy > 21));
+          chunk.material[world::Chunk::idx(x, y, z)] =
+              solid ? world::Material::GRANITE : world::Material::AIR;
+        }
+      }
+    }
+  });
+  world::NavGraph nav(chunks);
+  world::FlowFieldCache fields(nav);
+  chunks.get_chunk_at({0, 0, 0});
+  nav.repair();
+
+  entities::EntityManager em;
+  em.init();
+  em.set_flow_fields(&fields);
+  em.set_chunks(&chunks);
+  auto &registry = em.registry();
+  std::vector<entt::entity> crowd;
+  for (int i = 0; i < 12; ++i) {
+    auto e = em.spawn_astronaut(8.5f + (i / 2), 20.5f + (i % 2), 1);
+    assert(em.request_flow(e, 40, 20, 1));
+    crowd.push_back(e);
+  }
+  fields.update();
+
+  // Nobody overlaps another walker or a wall on the way, and everyone
+  // settles around the one goal instead of jostling for it
+  const float radius = entities::AvoidanceConfig{}.radius;
+  const float slack = 0.02f;
+  std::vector<entities::Position> before;
+  for (int step = 0; step < 1200; ++step) {
+    if (step == 1180) {
+      for (auto e : crowd) before.push_back(registry.get<entities::Position>(e));
+    }
+    em.update(0.05);
+    for (size_t i = 0; i < crowd.size(); ++i) {
+      const auto &a = registry.get<entities::Position>(crowd[i]);
+      assert(a.y - radius >= 20.0f - slack && a.y + radius <= 22.0f + slack);
+      for (size_t j = i + 1; j < crowd.size(); ++j) {
+        const auto &b = registry.get<entities::Position>(crowd[j]);
+        float dx = a.x - b.x, dy = a.y - b.y;
+        assert(dx * dx + dy * dy >= (2 * radius - slack) * (2 * radius - slack));
+      }
+    }
+  }
+  for (size_t i = 0; i < crowd.size(); ++i) {
+    auto e = crowd[i];
+    assert(!registry.all_of<entities::FlowFollower>(e));
+    assert(registry.all_of<entities::Settled>(e));
+    const auto &pos = registry.get<entities::Position>(e);
+    assert(pos.x == before[i].x && pos.y == before[i].y);
+    assert(pos.x > 32.0f && pos.x < 42.0f);  // Queued up to the goal
+  }
+
+  std::cout << "  Crowd avoidance: PASS" << std::endl;
+}
+
+void test_system_scheduler() {
+  std::cout << "Testing parallel system scheduler..." << std::endl;
+
+  struct Position {};
+  struct Needs {};
+  struct Heat {};
+
+  core::TaskPool pool(3);
+  entities::SystemScheduler scheduler(pool);
+
+  std::mutex log_mutex;
+  std::vector<std::string> log;
+  auto record = [&](const std::string &name) {
+    std::lock_guard<std::mutex> lock(log_mutex);
+    log.push_back(name);
+  };
+
+  // Heat writers conflict and must keep registration order; "needs" runs
+  // every other tick with a doubled dt
+  std::vector<int> heat;
+  double needs_dt = 0.0;
+  scheduler.add_system("move", entities::ComponentAccess().write<Position>(),
+                       [&](double) { record("move"); });
+  scheduler.add_system("heat_a",
+                       entities::ComponentAccess().read<Position>().write<Heat>(),
+                       [&](double) { heat.push_back(1); record("heat_a"); });
+  scheduler.add_system("needs",
+                       entities::ComponentAccess().read<const Position>().write<Needs>(),
+                       [&](double dt) {
+                         needs_dt = dt;
+                         // Nested slices run on the same pool
+                         std::vector<int> out(1000, 0);
+                         pool.parallel_for(out.size(), 64, [&](size_t b, size_t e) {
+                           for (size_t i = b; i < e; ++i) out[i] = static_cast<int>(i);
+                         });
+                         for (size_t i = 0; i < out.size(); ++i) assert(out[i] == static_cast<int>(i));
+                         record("needs");
+                       },
+                       2);
+  scheduler.add_system("heat_b", entities::ComponentAccess().write<Heat>(),
+                       [&](double) { heat.push_back(2); record("heat_b"); });
+
+  auto position = [&](const std::string &name) {
+    return std::find(log.begin(), log.end(), name) - log.begin();
+  };
+  for (int tick = 0; tick < 20; ++tick) {
+    log.clear();
+    scheduler.run(0.01);
+    assert(log.size() == (tick % 2 == 0 ? 4u : 3u));
+    assert(position("move") < position("heat_a"));
+    assert(position("heat_a") < position("heat_b"));
+    if (tick % 2 == 0) assert(position("move") < position("needs"));
+  }
+  assert(heat.size() == 40);
+  for (size_t i = 0; i < heat.size(); ++i) assert(heat[i] == (i % 2 == 0 ? 1 : 2));
+  assert(std::abs(needs_dt - 0.02) < 1e-12);
+
+  // Exceptions surface from run() after the tick completes
+  scheduler.add_system("fails", entities::ComponentAccess(),
+                       [](double) { throw std::runtime_error("boom"); });
+  bool caught = false;
+  try {
+    scheduler.run(0.01);
+  } catch (const std::runtime_error &) {
+    caught = true;
+  }
+  assert(caught);
+
+  std::cout << "  System scheduler: PASS" << std::endl;
+}
+
 int main() {
   std::cout << "=== Running Unit Tests ===" << std::endl;
 
   test_constants();
   test_lattice();
   test_blood_chemistry();
+  test_biology_topology();
+  test_physiology_batch();
+  test_physiology_fast_forward();
+  test_simulation_lod();
+  test_vitals_telemetry();
+  test_multirate();
+  test_ode_integrator();
+  test_aerosol_particles();
+  test_combustion_front();
+  test_psychrometrics();
+  test_field_registry();
+  test_breach_network();
+  test_cavern_chunks();
+  test_geology_streaming();
+  test_geology_active_set();
+  test_light_field();
+  test_feature_index();
+  test_flood_grid();
+  test_ecosystem_grid();
+  test_system_scheduler();
+  test_spatial_index();
+  test_navigation();
+  test_flow_fields();
+  test_entity_paths();
+  test_crowd_avoidance();
 
   std::cout << std::endl;
   std::cout << "All tests PASSED!" << std::endl;